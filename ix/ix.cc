@@ -653,7 +653,7 @@ RC IndexManager::insertEntry(IXFileHandle &ixfileHandle, const Attribute &attrib
             //free(newChild.keyRidPair.key);
         }
         free(page);
-        return 0;
+        return ixfileHandle.fh.commit();
     }
 
     free(page);
@@ -1325,7 +1325,7 @@ RC IndexManager::deleteEntry(IXFileHandle &ixfileHandle, const Attribute &attrib
         }
 
         free(page);
-        return 0;
+        return ixfileHandle.fh.commit();
     }
 
     free(page);
@@ -2411,6 +2411,7 @@ unsigned IX_NonLeafNode::getNodeSize() const
 // IX ScanIterator declarations
 IX_ScanIterator::IX_ScanIterator()
 {
+    readAheadStarted = false;
 }
 
 IX_ScanIterator::~IX_ScanIterator()
@@ -2437,6 +2438,7 @@ RC IX_ScanIterator::initialize(IXFileHandle &ixfileHandle,
     this->highKey = highKey;
     this->lowKeyInclusive = lowKeyInclusive;
     this->highKeyInclusive = highKeyInclusive;
+    this->readAheadStarted = false;
     return 0;
 }
 
@@ -2445,20 +2447,27 @@ RC IX_ScanIterator::getNextEntry(RID &rid, void *key)
     PageNum pageNum = ixfh.currentRid.pageNum;
     unsigned slotNum = ixfh.currentRid.slotNum;
 
-    void *page = malloc(PAGE_SIZE);
-    memset(page, 0, PAGE_SIZE);
+    // Leaves are pinned and read in place, one at a time.
+    void *page = NULL;
 
-    while (pageNum != (unsigned)NULL_INDICATOR && pageNum < ixfh.fh.getNumberOfPages() && ixfh.fh.readPage(pageNum, page) == 0)
+    while (pageNum != (unsigned)NULL_INDICATOR && pageNum < ixfh.fh.getNumberOfPages() && ixfh.fh.pinPage(pageNum, page) == 0)
     {
         IX_Page pageFormat(page);
         pageFormat.deepLoadHeader(page);
 
         if (!pageFormat.isLeaf)
         {
-            free(page);
+            ixfh.fh.unpinPage(pageNum, false);
             return -1;
         }
 
+        // Leaves are not stored in order, so read-ahead is told to follow their next-page links.
+        if (!readAheadStarted && pageFormat.nextPage != (unsigned)NULL_INDICATOR)
+        {
+            ixfh.fh.prefetchPageChain(pageFormat.nextPage, getNextLeafPageNum);
+            readAheadStarted = true;
+        }
+
         while ( slotNum < pageFormat.numberOfSlots)
         {
             IX_LeafNode currentNode(page, pageFormat.slotDirectory[slotNum]);
@@ -2467,7 +2476,7 @@ RC IX_ScanIterator::getNextEntry(RID &rid, void *key)
             {
                 returnKey(currentNode, key, rid);
                 setNextRid(++slotNum, pageNum, pageFormat.numberOfSlots, pageFormat.nextPage);
-                free(page);
+                ixfh.fh.unpinPage(pageNum, false);
                 free(currentNode.key);
                 return 0;
             }
@@ -2475,7 +2484,7 @@ RC IX_ScanIterator::getNextEntry(RID &rid, void *key)
             {
                 returnKey(currentNode, key, rid);
                 setNextRid(++slotNum, pageNum, pageFormat.numberOfSlots, pageFormat.nextPage);
-                free(page);
+                ixfh.fh.unpinPage(pageNum, false);
                 free(currentNode.key);
                 return 0;
             }
@@ -2483,7 +2492,7 @@ RC IX_ScanIterator::getNextEntry(RID &rid, void *key)
             {
                 returnKey(currentNode, key, rid);
                 setNextRid(++slotNum, pageNum, pageFormat.numberOfSlots, pageFormat.nextPage);
-                free(page);
+                ixfh.fh.unpinPage(pageNum, false);
                 free(currentNode.key);
                 return 0;
             }
@@ -2491,27 +2500,33 @@ RC IX_ScanIterator::getNextEntry(RID &rid, void *key)
             {
                 returnKey(currentNode, key, rid);
                 setNextRid(++slotNum, pageNum, pageFormat.numberOfSlots, pageFormat.nextPage);
-                free(page);
+                ixfh.fh.unpinPage(pageNum, false);
                 free(currentNode.key);
                 return 0;
             }
             else if(currentNode.compare(attribute, highKey) < 0)
             {
-                free(page);
+                ixfh.fh.unpinPage(pageNum, false);
                 free(currentNode.key);
                 return -1;
             }
             free(currentNode.key);
             slotNum++;
         }
+        ixfh.fh.unpinPage(pageNum, false);
         pageNum = pageFormat.nextPage;
         slotNum = 0;
     }
 
-    free(page);
     return -1;
 }
 
+PageNum IX_ScanIterator::getNextLeafPageNum(const void *page)
+{
+    IX_Page pageFormat(page);
+    return pageFormat.isLeaf ? pageFormat.nextPage : (unsigned)NULL_INDICATOR;
+}
+
 RC IX_ScanIterator::setNextRid(unsigned &slotNum, unsigned &pageNum, 
             const unsigned &maxNumofSlots, const PageNum &nextPage )
 {
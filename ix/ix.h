@@ -165,6 +165,7 @@ public:
   void* highKey;
   bool lowKeyInclusive;
   bool highKeyInclusive;
+  bool readAheadStarted;
 
   // Constructor
   IX_ScanIterator();
@@ -187,6 +188,7 @@ public:
   RC close();
 
 private:
+  static PageNum getNextLeafPageNum(const void *page);
   RC returnKey(IX_LeafNode node, void *key, RID &rid);
   RC setNextRid(unsigned &slotNum, PageNum &pageNum, const unsigned &maxNumofSlots, const PageNum &nextPage );
 };
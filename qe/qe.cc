@@ -33,17 +33,12 @@ int Utility::compare(const Attribute &attribute, const void *leftValue, const vo
     {
         memcpy(&rightValueSize, (char *)rightValue, sizeof(unsigned));
         memcpy(&leftValueSize, (char *)leftValue, sizeof(unsigned));
-        unsigned compareLen = max(leftValueSize, rightValueSize);
-        char *stringleftValue = (char *)malloc(compareLen + 1);
-        char *stringrightValue = (char *)malloc(compareLen + 1);
-        memset(stringleftValue, '\0', compareLen + 1);
-        memset(stringrightValue, '\0', compareLen + 1);
-        memcpy(stringleftValue, (char *)leftValue + sizeof(unsigned), leftValueSize);
-        memcpy(stringrightValue, (char *)rightValue + sizeof(unsigned), rightValueSize);
-
-        compareResult = strcmp(stringrightValue, stringleftValue);
-        free(stringleftValue);
-        free(stringrightValue);
+        compareResult = memcmp((char *)rightValue + sizeof(unsigned), (char *)leftValue + sizeof(unsigned),
+                               min(leftValueSize, rightValueSize));
+        if (compareResult == 0)
+        {
+            compareResult = (int)rightValueSize - (int)leftValueSize;
+        }
     }
     else if (attribute.type == TypeInt)
     {
@@ -129,100 +124,89 @@ RC Utility::applyComparisionOperator(const Attribute &attr, const CompOp op, con
     return -1;
 }
 
-void Utility::createReturnData(const vector<Attribute> &attributes, RecordManager &record, void *data)
+void Utility::createReturnData(const RecordView &leftRecord, const RecordView &rightRecord, void *data)
 {
-    unsigned nullIndicatorSize = ceil((double)attributes.size() / CHAR_BIT);
-    char *nullIndicator = (char *)malloc(nullIndicatorSize);
-    memset(nullIndicator, 0, nullIndicatorSize);
+    // A joined tuple is every field of the left tuple followed by every field of the right one.
+    unsigned numberOfFields = leftRecord.numberOfFields + rightRecord.numberOfFields;
+    unsigned nullIndicatorSize = ceil((double)numberOfFields / CHAR_BIT);
+    memset(data, 0, nullIndicatorSize);
 
     unsigned pointer = nullIndicatorSize;
-    int j = 0;
-    for (int i = 0; i < record.fieldValues.size() && j < attributes.size(); i++)
+    for (unsigned j = 0; j < numberOfFields; j++)
     {
-        if (attributes[j].name == record.fieldValues[i].name)
+        const RecordView &record = j < leftRecord.numberOfFields ? leftRecord : rightRecord;
+        unsigned i = j < leftRecord.numberOfFields ? j : j - leftRecord.numberOfFields;
+        if (record.isNull(i))
         {
-            if (record.fieldValues[i].length < -1)
-            {
-                if (record.fieldValues[i].type == TypeVarChar)
-                {
-                    memcpy((char *)data + pointer, &record.fieldValues[i].length, sizeof(int));
-                    pointer += sizeof(int);
-                }
+            *((char *)data + j / 8) |= (1 << (CHAR_BIT - 1 - (j % CHAR_BIT)));
+            continue;
+        }
 
-                memcpy((char *)data + pointer, (char *)record.fieldValues[i].value,
-                       record.fieldValues[i].length);
-                pointer += record.fieldValues[i].length;
-            }
-            else
-            {
-                nullIndicator[j / 8] |= (1 << (CHAR_BIT - 1 - (j % CHAR_BIT)));
-            }
-            j++;
+        unsigned length = record.getLength(i);
+        if (record.types[i] == TypeVarChar)
+        {
+            memcpy((char *)data + pointer, &length, sizeof(int));
+            pointer += sizeof(int);
         }
-    }
 
-    memcpy((char *)data, nullIndicator, nullIndicatorSize);
+        memcpy((char *)data + pointer, record.getField(i), length);
+        pointer += length;
+    }
     return;
 }
 
-void Utility::createReturnData(const vector<Attribute> &attributes, RecordManager &leftRecord, RecordManager &rightRecord, void *data)
+int Utility::getIndex(const vector<Attribute> &attributes, const string &name)
 {
-    unsigned nullIndicatorSize = ceil((double)attributes.size() / CHAR_BIT);
-    char *nullIndicator = (char *)malloc(nullIndicatorSize);
-    memset(nullIndicator, 0, nullIndicatorSize);
-
-    unsigned pointer = nullIndicatorSize;
-    int j = 0;
-    for (int i = 0; i < leftRecord.fieldValues.size(); i++)
+    for (int i = 0; i < attributes.size(); i++)
     {
-        if (attributes[j].name == leftRecord.fieldValues[i].name)
+        if (attributes[i].name == name)
         {
-            if (leftRecord.fieldValues[i].length < -1)
-            {
-                if (leftRecord.fieldValues[i].type == TypeVarChar)
-                {
-                    memcpy((char *)data + pointer, &leftRecord.fieldValues[i].length, sizeof(int));
-                    pointer += sizeof(int);
-                }
-
-                memcpy((char *)data + pointer, (char *)leftRecord.fieldValues[i].value,
-                       leftRecord.fieldValues[i].length);
-                pointer += leftRecord.fieldValues[i].length;
-            }
-            else
-            {
-                nullIndicator[j / 8] |= (1 << (CHAR_BIT - 1 - (j % CHAR_BIT)));
-            }
-            j++;
+            return i;
         }
     }
+    return -1;
+}
 
-    for (int i = 0; i < rightRecord.fieldValues.size(); i++)
+RC Iterator::getNextBatch(RecordBatch &batch)
+{
+    vector<Attribute> attrs;
+    getAttributes(attrs);
+    RecordView recordView(attrs);
+    unsigned rawDataMaxSize = ceil((double)attrs.size() / CHAR_BIT);
+    for (unsigned i = 0; i < attrs.size(); i++)
     {
-        if (attributes[j].name == rightRecord.fieldValues[i].name)
-        {
-            if (rightRecord.fieldValues[i].length < -1)
-            {
-                if (rightRecord.fieldValues[i].type == TypeVarChar)
-                {
-                    memcpy((char *)data + pointer, &rightRecord.fieldValues[i].length, sizeof(int));
-                    pointer += sizeof(int);
-                }
+        rawDataMaxSize += attrs[i].length + (attrs[i].type == TypeVarChar ? sizeof(int) : 0);
+    }
 
-                memcpy((char *)data + pointer, (char *)rightRecord.fieldValues[i].value,
-                       rightRecord.fieldValues[i].length);
-                pointer += rightRecord.fieldValues[i].length;
-            }
-            else
-            {
-                nullIndicator[j / 8] |= (1 << (CHAR_BIT - 1 - (j % CHAR_BIT)));
-            }
-            j++;
+    // Every tuple is written where it goes in the batch, its length is only known once it is there.
+    RID rid = {0, 0};
+    batch.clear();
+    while (!batch.isFull())
+    {
+        void *data = batch.getFreeSpace(rawDataMaxSize);
+        if (getNextTuple(data) == QE_EOF || recordView.decodeData(data) != 0)
+        {
+            break;
         }
+        batch.addRecord(rid, recordView.getDataSize());
     }
 
-    memcpy((char *)data, nullIndicator, nullIndicatorSize);
-    return;
+    return batch.size() > 0 ? 0 : QE_EOF;
+}
+
+bool Iterator::getCode(const int attrIndex, unsigned &code, Dictionary *&dictionary, unsigned &field)
+{
+    return false;
+}
+
+unsigned Iterator::getPageSize()
+{
+    return PAGE_SIZE;
+}
+
+RecordFormat Iterator::getRecordFormat()
+{
+    return VariableWidthFormat;
 }
 
 Filter::Filter(Iterator *input, const Condition &condition)
@@ -230,6 +214,36 @@ Filter::Filter(Iterator *input, const Condition &condition)
     iterator = input;
     this->condition = condition;
     input->getAttributes(this->attributes);
+    conditionIndex = Utility::getIndex(attributes, condition.lhsAttr);
+    recordView.initialize(attributes);
+
+    selectionKernel = NULL;
+    if (!condition.bRhsIsAttr && conditionIndex >= 0 && attributes[conditionIndex].type == condition.rhsValue.type)
+    {
+        selectionKernel = getSelectionKernel(condition.rhsValue.type, condition.op);
+    }
+
+    // A condition on a value is also given to a table scan right under the filter, for it to pass over the
+    // pages the table's zone map rules out. What the scan returns is still checked here.
+    tableScan = dynamic_cast<TableScan *>(input);
+    if (tableScan != NULL && !condition.bRhsIsAttr && condition.op != NO_OP && conditionIndex >= 0 &&
+        attributes[conditionIndex].type == condition.rhsValue.type)
+    {
+        tableScan->setIterator(condition.lhsAttr.substr(condition.lhsAttr.find('.') + 1), condition.op, condition.rhsValue.data);
+    }
+    else
+    {
+        tableScan = NULL;
+    }
+    conditionDictionary = NULL;
+    conditionField = 0;
+    hasConditionCode = false;
+    conditionCode = 0;
+}
+
+unsigned Filter::getNumberOfSkippedPages()
+{
+    return tableScan != NULL ? tableScan->getNumberOfSkippedPages() : 0;
 }
 
 void Filter::getAttributes(vector<Attribute> &attrs) const
@@ -245,58 +259,44 @@ RC Filter::getNextTuple(void *data)
     {
         while (iterator->getNextTuple(data) != RBFM_EOF)
         {
-            RecordManager recordManager(attributes.size());
-            if (recordManager.understandData(attributes, data) == 0)
+            bool satisfied = false;
+            if (satisfiesCode(satisfied) ? satisfied : satisfies(data))
             {
-                vector<AttributeValuePair>::iterator fieldValuesIter;
-                for (fieldValuesIter = recordManager.fieldValues.begin();
-                     fieldValuesIter != recordManager.fieldValues.end(); fieldValuesIter++)
-                {
-                    if (fieldValuesIter->name == condition.lhsAttr)
-                    {
-                        break;
-                    }
-                }
+                return 0;
+            }
+        }
+    }
 
-                if (fieldValuesIter != recordManager.fieldValues.end() && fieldValuesIter->type == condition.rhsValue.type)
-                {
-                    Attribute attr;
-                    attr.name = fieldValuesIter->name;
-                    attr.type = fieldValuesIter->type;
-                    attr.length = fieldValuesIter->length;
+    return QE_EOF;
+}
 
-                    if (fieldValuesIter->length < -1)
+RC Filter::getNextBatch(RecordBatch &batch)
+{
+    if (!condition.bRhsIsAttr)
+    {
+        while (iterator->getNextBatch(batch) != QE_EOF)
+        {
+            if (selectionKernel != NULL)
+            {
+                select(batch);
+            }
+            else
+            {
+                // Tuples that fail the condition leave the selection, the ones that stay are not moved.
+                unsigned selected = 0;
+                for (unsigned i = 0; i < batch.size(); i++)
+                {
+                    if (satisfies(batch.getRecord(i)))
                     {
-                        if (fieldValuesIter->type == TypeVarChar)
-                        {
-                            void *rightValue = malloc(sizeof(int) + fieldValuesIter->length);
-                            memset(rightValue, 0, sizeof(int) + fieldValuesIter->length);
-                            memcpy((char *)rightValue, &fieldValuesIter->length, sizeof(int));
-                            memcpy((char *)rightValue + sizeof(int), (char *)fieldValuesIter->value, fieldValuesIter->length);
-
-                            if (Utility::applyComparisionOperator(attr, condition.op, condition.rhsValue.data, rightValue) == 0)
-                            {
-                                recordManager.createRecord();
-                                free(recordManager.record);
-                                free(rightValue);
-                                return 0;
-                            }
-                            free(rightValue);
-                        }
-                        else
-                        {
-                            if (Utility::applyComparisionOperator(attr, condition.op,
-                                                                  condition.rhsValue.data, fieldValuesIter->value) == 0)
-                            {
-                                recordManager.createRecord();
-                                free(recordManager.record);
-                                return 0;
-                            }
-                        }
+                        batch.selection[selected++] = batch.selection[i];
                     }
                 }
-                recordManager.createRecord();
-                free(recordManager.record);
+                batch.selection.resize(selected);
+            }
+
+            if (batch.size() > 0)
+            {
+                return 0;
             }
         }
     }
@@ -304,6 +304,95 @@ RC Filter::getNextTuple(void *data)
     return QE_EOF;
 }
 
+bool Filter::satisfies(const void *data)
+{
+    if (conditionIndex < 0 || attributes[conditionIndex].type != condition.rhsValue.type ||
+        recordView.decodeData(data) != 0 || recordView.isNull(conditionIndex))
+    {
+        return false;
+    }
+
+    // compare() takes a VarChar with its length in front, as it already is in the tuple.
+    const char *value = recordView.getField(conditionIndex);
+    if (attributes[conditionIndex].type == TypeVarChar)
+    {
+        value -= sizeof(int);
+    }
+
+    return Utility::applyComparisionOperator(attributes[conditionIndex], condition.op, condition.rhsValue.data, value) == 0;
+}
+
+bool Filter::satisfiesCode(bool &satisfied)
+{
+    unsigned code = 0;
+    Dictionary *dictionary = NULL;
+    unsigned field = 0;
+    if ((condition.op != EQ_OP && condition.op != NE_OP) || condition.rhsValue.type != TypeVarChar ||
+        !iterator->getCode(conditionIndex, code, dictionary, field))
+    {
+        return false;
+    }
+
+    // The condition's VarChar is looked up once for every dictionary the tuples come from.
+    if (dictionary != conditionDictionary || field != conditionField)
+    {
+        VarcharView value;
+        memcpy(&value.length, condition.rhsValue.data, sizeof(int));
+        value.data = (const char *)condition.rhsValue.data + sizeof(int);
+        hasConditionCode = dictionary->findCode(field, value, conditionCode);
+        conditionDictionary = dictionary;
+        conditionField = field;
+    }
+
+    satisfied = (hasConditionCode && code == conditionCode) == (condition.op == EQ_OP);
+    return true;
+}
+
+bool Filter::getCode(const int attrIndex, unsigned &code, Dictionary *&dictionary, unsigned &field)
+{
+    return iterator->getCode(attrIndex, code, dictionary, field);
+}
+
+unsigned Filter::getPageSize()
+{
+    return iterator->getPageSize();
+}
+
+RecordFormat Filter::getRecordFormat()
+{
+    return iterator->getRecordFormat();
+}
+
+RC Filter::select(RecordBatch &batch)
+{
+    // The values are gathered from the tuples first, then compared all together.
+    unsigned size = batch.size();
+    values.resize(size);
+    hasValues.resize(size);
+    selection.resize((size + CHAR_BIT - 1) / CHAR_BIT);
+    for (unsigned i = 0; i < size; i++)
+    {
+        hasValues[i] = recordView.decodeData(batch.getRecord(i)) == 0 && !recordView.isNull(conditionIndex);
+        values[i] = 0;
+        if (hasValues[i])
+        {
+            memcpy(&values[i], recordView.getField(conditionIndex), min(recordView.getLength(conditionIndex), (unsigned)sizeof(int)));
+        }
+    }
+    selectionKernel(values.data(), size, condition.rhsValue.data, selection.data());
+
+    unsigned selected = 0;
+    for (unsigned i = 0; i < size; i++)
+    {
+        if (hasValues[i] && (selection[i / CHAR_BIT] & (1 << (i % CHAR_BIT))))
+        {
+            batch.selection[selected++] = batch.selection[i];
+        }
+    }
+    batch.selection.resize(selected);
+    return 0;
+}
+
 Project::Project(Iterator *input, const vector<string> &attrNames)
 {
     this->iterator = input;
@@ -321,31 +410,70 @@ Project::Project(Iterator *input, const vector<string> &attrNames)
         if (find(attrNames.begin(), attrNames.end(), originalAttributes[i].name) != attrNames.end())
         {
             attributes.push_back(originalAttributes[i]);
+            projection.push_back(i);
         }
     }
+
+    inputData = malloc(rawDataMaxSize);
+    memset(inputData, 0, rawDataMaxSize);
+    recordView.initialize(originalAttributes);
+}
+
+Project::~Project()
+{
+    free(inputData);
 }
 
 RC Project::getNextTuple(void *data)
 {
-    void *inputData = malloc(rawDataMaxSize);
-    memset(inputData, 0, rawDataMaxSize);
     while (iterator->getNextTuple(inputData) != RBFM_EOF)
     {
-        RecordManager recordManager(originalAttributes.size());
-        if (recordManager.understandData(originalAttributes, inputData) == 0)
+        if (recordView.decodeData(inputData) == 0)
         {
-            Utility::createReturnData(attributes, recordManager, data);
-            recordManager.createRecord();
-            free(recordManager.record);
-            free(inputData);
+            recordView.createData(projection, data);
             return 0;
         }
     }
 
-    free(inputData);
     return QE_EOF;
 }
 
+RC Project::getNextBatch(RecordBatch &batch)
+{
+    // The input comes a batch at a time as well, no larger than the one asked for.
+    batch.clear();
+    inputBatch.capacity = batch.capacity;
+    while (batch.size() == 0 && iterator->getNextBatch(inputBatch) != QE_EOF)
+    {
+        for (unsigned i = 0; i < inputBatch.size(); i++)
+        {
+            if (recordView.decodeData(inputBatch.getRecord(i)) == 0)
+            {
+                unsigned length = recordView.getDataSize(projection);
+                recordView.createData(projection, batch.getFreeSpace(length));
+                batch.addRecord(inputBatch.getRID(i), length);
+            }
+        }
+    }
+
+    return batch.size() > 0 ? 0 : QE_EOF;
+}
+
+bool Project::getCode(const int attrIndex, unsigned &code, Dictionary *&dictionary, unsigned &field)
+{
+    return attrIndex >= 0 && attrIndex < (int)projection.size() && iterator->getCode(projection[attrIndex], code, dictionary, field);
+}
+
+unsigned Project::getPageSize()
+{
+    return iterator->getPageSize();
+}
+
+RecordFormat Project::getRecordFormat()
+{
+    return iterator->getRecordFormat();
+}
+
 void Project::getAttributes(vector<Attribute> &attrs) const
 {
     attrs.clear();
@@ -363,50 +491,46 @@ RC InMemoryHashTable::initialize(const Attribute &attribute, const unsigned page
     this->attributes = attributes;
     this->rawDataMaxSize = rawDataMaxSize;
     bufferMemory = 0;
+    attributeIndex = Utility::getIndex(attributes, attribute.name);
+    recordView.initialize(attributes);
+    dictionary = NULL;
+    field = 0;
+    translatedCodes.clear();
+    return 0;
 }
 
-RC Utility::getKey(const Attribute &attribute, const RecordManager &recordManager, int &key)
+RC Utility::getKey(const RecordView &record, const int index, int &key)
 {
-    for (int i = 0; i < recordManager.fieldValues.size(); i++)
+    if (index < 0 || record.isNull(index))
     {
-        if (attribute.name == recordManager.fieldValues[i].name && recordManager.fieldValues[i].length < -1)
-        {
-            memcpy(&key, (char *)recordManager.fieldValues[i].value, recordManager.fieldValues[i].length);
-            return 0;
-        }
+        return -1;
     }
-    return -1;
+
+    key = record.getInt(index);
+    return 0;
 }
 
-RC Utility::getKey(const Attribute &attribute, const RecordManager &recordManager, float &key)
+RC Utility::getKey(const RecordView &record, const int index, float &key)
 {
-    for (int i = 0; i < recordManager.fieldValues.size(); i++)
+    if (index < 0 || record.isNull(index))
     {
-        if (attribute.name == recordManager.fieldValues[i].name && recordManager.fieldValues[i].length < -1)
-        {
-            memcpy(&key, (char *)recordManager.fieldValues[i].value, recordManager.fieldValues[i].length);
-            return 0;
-        }
+        return -1;
     }
-    return -1;
+
+    key = record.getFloat(index);
+    return 0;
 }
 
-RC Utility::getKey(const Attribute &attribute, const RecordManager &recordManager, string &key)
+RC Utility::getKey(const RecordView &record, const int index, string &key)
 {
-    for (int i = 0; i < recordManager.fieldValues.size(); i++)
+    if (index < 0 || record.isNull(index))
     {
-        if (attribute.name == recordManager.fieldValues[i].name && recordManager.fieldValues[i].length < -1)
-        {
-            unsigned length = recordManager.fieldValues[i].length;
-            char *stringKey = (char *)malloc(length + 1);
-            memset(stringKey, 0, length + 1);
-            memcpy(stringKey, (char *)recordManager.fieldValues[i].value, length);
-            key.append(stringKey);
-            free(stringKey);
-            return 0;
-        }
+        return -1;
     }
-    return -1;
+
+    VarcharView value = record.getVarchar(index);
+    key.assign(value.data, value.length);
+    return 0;
 }
 
 RC InMemoryHashTable::buildNextHashTable()
@@ -414,48 +538,59 @@ RC InMemoryHashTable::buildNextHashTable()
     if (recordCounter != RBFM_EOF)
     {
         bufferMemory = 0;
-        while (bufferMemory <= pageMemoryLimit * PAGE_SIZE)
+        while (bufferMemory <= pageMemoryLimit * iterator->getPageSize())
         {
             void *data = malloc(rawDataMaxSize);
             memset(data, 0, rawDataMaxSize);
             if (iterator->getNextTuple(data) != RBFM_EOF)
             {
-                RecordManager recordManager(attributes.size());
-                if (recordManager.understandData(attributes, data) == 0)
+                if (recordView.decodeData(data) != 0)
+                {
+                    free(data);
+                    return -1;
+                }
+
+                bufferMemory += recordView.getDataSize();
+                recordCounter++;
+                // The table keeps the tuple itself, a match is only decoded when it is joined.
+                bool kept = false;
+                unsigned code = 0;
+                if (attribute.type == TypeVarChar && iterator->getCode(attributeIndex, code, dictionary, field))
+                {
+                    codeHashTable[code].push_back(data);
+                    kept = true;
+                }
+                else if (attribute.type == TypeVarChar)
                 {
-                    bufferMemory += recordManager.rawDataSize;
-                    recordCounter++;
-                    if (attribute.type == TypeVarChar)
+                    string key = "";
+                    if (Utility::getKey(recordView, attributeIndex, key) == 0)
                     {
-                        string key = "";
-                        if (Utility::getKey(attribute, recordManager, key) == 0)
-                        {
-                            stringHashTable[key].push_back(recordManager);
-                        }
+                        stringHashTable[key].push_back(data);
+                        kept = true;
                     }
-                    else if (attribute.type == TypeInt)
+                }
+                else if (attribute.type == TypeInt)
+                {
+                    int key = 0;
+                    if (Utility::getKey(recordView, attributeIndex, key) == 0)
                     {
-                        int key = 0;
-                        if (Utility::getKey(attribute, recordManager, key) == 0)
-                        {
-                            intHashTable[key].push_back(recordManager);
-                        }
+                        intHashTable[key].push_back(data);
+                        kept = true;
                     }
-                    else if (attribute.type == TypeReal)
+                }
+                else if (attribute.type == TypeReal)
+                {
+                    float key = 0.0;
+                    if (Utility::getKey(recordView, attributeIndex, key) == 0)
                     {
-                        float key = 0.0;
-                        if (Utility::getKey(attribute, recordManager, key) == 0)
-                        {
-                            doubleHashTable[key].push_back(recordManager);
-                        }
+                        doubleHashTable[key].push_back(data);
+                        kept = true;
                     }
                 }
-                else
+
+                if (!kept)
                 {
-                    recordManager.createRecord();
-                    free(recordManager.record);
                     free(data);
-                    return -1;
                 }
             }
             else
@@ -474,18 +609,67 @@ RC InMemoryHashTable::buildNextHashTable()
     return 0;
 }
 
-RC InMemoryHashTable::applyComparisionOperator(const Attribute &rightAttribute, const RecordManager &rightRecord,
-                                               const CompOp op, RecordManager &leftRecord, int &atPosition)
+bool InMemoryHashTable::getCode(Iterator *rightIterator, const RecordView &rightRecord, const int rightIndex, unsigned &code)
+{
+    if (rightIndex < 0 || rightRecord.isNull(rightIndex))
+    {
+        return false;
+    }
+
+    unsigned rightCode = 0;
+    Dictionary *rightDictionary = NULL;
+    unsigned rightField = 0;
+    if (!rightIterator->getCode(rightIndex, rightCode, rightDictionary, rightField))
+    {
+        return dictionary->findCode(field, rightRecord.getVarchar(rightIndex), code);
+    }
+    if (rightDictionary == dictionary && rightField == field)
+    {
+        code = rightCode;
+        return true;
+    }
+
+    // A code of the right side's dictionary is looked up in the left side's only the first time it is seen.
+    if (rightCode >= translatedCodes.size())
+    {
+        translatedCodes.resize(rightCode + 1, -2);
+    }
+    if (translatedCodes[rightCode] == -2)
+    {
+        unsigned leftCode = 0;
+        translatedCodes[rightCode] = dictionary->findCode(field, rightDictionary->getValue(rightField, rightCode), leftCode) ? (int)leftCode : -1;
+    }
+    code = translatedCodes[rightCode];
+    return translatedCodes[rightCode] >= 0;
+}
+
+RC InMemoryHashTable::applyComparisionOperator(Iterator *rightIterator, const RecordView &rightRecord, const int rightIndex,
+                                               const CompOp op, void *&leftData, int &atPosition)
 {
     switch (op)
     {
     case EQ_OP:
-        if (attribute.type == TypeVarChar)
+        // The left tuples are keyed on their codes if they had them, the right one is then matched by its code.
+        if (attribute.type == TypeVarChar && dictionary != NULL)
+        {
+            unsigned code = 0;
+            unordered_map<unsigned, vector<void *>>::iterator it;
+            if (getCode(rightIterator, rightRecord, rightIndex, code) && (it = codeHashTable.find(code)) != codeHashTable.end() && atPosition != -1)
+            {
+                leftData = it->second[atPosition];
+                if (it->second.size() == ++atPosition)
+                {
+                    atPosition = -1;
+                }
+                return 0;
+            }
+        }
+        else if (attribute.type == TypeVarChar)
         {
             string key = "";
-            if (Utility::getKey(rightAttribute, rightRecord, key) == 0 && stringHashTable.find(key) != stringHashTable.end() && atPosition != -1)
+            if (Utility::getKey(rightRecord, rightIndex, key) == 0 && stringHashTable.find(key) != stringHashTable.end() && atPosition != -1)
             {
-                stringHashTable[key][atPosition].copyTo(leftRecord);
+                leftData = stringHashTable[key][atPosition];
                 if (stringHashTable[key].size() == ++atPosition)
                 {
                     atPosition = -1;
@@ -496,9 +680,9 @@ RC InMemoryHashTable::applyComparisionOperator(const Attribute &rightAttribute,
         else if (attribute.type == TypeInt)
         {
             int key = 0;
-            if (Utility::getKey(rightAttribute, rightRecord, key) == 0 && intHashTable.find(key) != intHashTable.end() && atPosition != -1)
+            if (Utility::getKey(rightRecord, rightIndex, key) == 0 && intHashTable.find(key) != intHashTable.end() && atPosition != -1)
             {
-                intHashTable[key][atPosition].copyTo(leftRecord);
+                leftData = intHashTable[key][atPosition];
                 if (intHashTable[key].size() == ++atPosition)
                 {
                     atPosition = -1;
@@ -509,9 +693,9 @@ RC InMemoryHashTable::applyComparisionOperator(const Attribute &rightAttribute,
         else if (attribute.type == TypeReal)
         {
             float key = 0.0;
-            if (Utility::getKey(rightAttribute, rightRecord, key) == 0 && doubleHashTable.find(key) != doubleHashTable.end() && atPosition != -1)
+            if (Utility::getKey(rightRecord, rightIndex, key) == 0 && doubleHashTable.find(key) != doubleHashTable.end() && atPosition != -1)
             {
-                doubleHashTable[key][atPosition].copyTo(leftRecord);
+                leftData = doubleHashTable[key][atPosition];
                 if (doubleHashTable[key].size() == ++atPosition)
                 {
                     atPosition = -1;
@@ -533,46 +717,55 @@ RC InMemoryHashTable::cleanHashTable()
 {
     if (attribute.type == TypeVarChar)
     {
-        map<string, vector<RecordManager>>::iterator it;
+        map<string, vector<void *>>::iterator it;
         for (it = stringHashTable.begin(); it != stringHashTable.end(); it++)
         {
-            vector<RecordManager>::iterator recIt;
+            vector<void *>::iterator recIt;
             for (recIt = it->second.begin(); recIt != it->second.end(); recIt++)
             {
-                recIt->createRecord();
-                free(recIt->record);
+                free(*recIt);
             }
         }
         stringHashTable.clear();
+
+        unordered_map<unsigned, vector<void *>>::iterator codeIt;
+        for (codeIt = codeHashTable.begin(); codeIt != codeHashTable.end(); codeIt++)
+        {
+            vector<void *>::iterator recIt;
+            for (recIt = codeIt->second.begin(); recIt != codeIt->second.end(); recIt++)
+            {
+                free(*recIt);
+            }
+        }
+        codeHashTable.clear();
     }
     else if (attribute.type == TypeInt)
     {
-        map<int, vector<RecordManager>>::iterator it;
+        map<int, vector<void *>>::iterator it;
         for (it = intHashTable.begin(); it != intHashTable.end(); it++)
         {
-            vector<RecordManager>::iterator recIt;
+            vector<void *>::iterator recIt;
             for (recIt = it->second.begin(); recIt != it->second.end(); recIt++)
             {
-                recIt->createRecord();
-                free(recIt->record);
+                free(*recIt);
             }
         }
         intHashTable.clear();
     }
     else if (attribute.type == TypeReal)
     {
-        map<float, vector<RecordManager>, mapDoubleLess>::iterator it;
+        map<float, vector<void *>, mapDoubleLess>::iterator it;
         for (it = doubleHashTable.begin(); it != doubleHashTable.end(); it++)
         {
-            vector<RecordManager>::iterator recIt;
+            vector<void *>::iterator recIt;
             for (recIt = it->second.begin(); recIt != it->second.end(); recIt++)
             {
-                recIt->createRecord();
-                free(recIt->record);
+                free(*recIt);
             }
         }
         doubleHashTable.clear();
     }
+    return 0;
 }
 
 BNLJoin::BNLJoin(Iterator *leftIn, TableScan *rightIn, const Condition &condition, const unsigned numPages)
@@ -626,6 +819,9 @@ BNLJoin::BNLJoin(Iterator *leftIn, TableScan *rightIn, const Condition &conditio
     attributes.insert(attributes.begin(), leftAttributes.begin(), leftAttributes.end());
     attributes.insert(attributes.end(), rightAttributes.begin(), rightAttributes.end());
 
+    rightAttributeIndex = condition.bRhsIsAttr ? Utility::getIndex(rightAttributes, condition.rhsAttr) : -1;
+    leftRecordView.initialize(leftAttributes);
+    rightRecordView.initialize(rightAttributes);
     inMemoryHashTable.initialize(leftAttribute, pageMemoryLimit, leftIterator, leftAttributes, rawDataMaxSizeLeft);
     leftRecordCounter = RBFM_EOF;
     rightRecordPointer = RBFM_EOF;
@@ -644,16 +840,14 @@ RC BNLJoin::getNextTuple(void *data)
 
         if (rightDataBuffer != NULL && leftRecordPoistionInMap != -1)
         {
-            RecordManager rightRecord(rightAttributes.size());
-            rightRecord.understandData(rightAttributes, rightDataBuffer);
-            RecordManager leftRecord(leftAttributes.size());
+            void *leftData = NULL;
+            rightRecordView.decodeData(rightDataBuffer);
             if (
-                inMemoryHashTable.applyComparisionOperator(rightAttribute, rightRecord,
-                                                           condition.op, leftRecord, leftRecordPoistionInMap) == 0)
+                inMemoryHashTable.applyComparisionOperator(rightIterator, rightRecordView, rightAttributeIndex,
+                                                           condition.op, leftData, leftRecordPoistionInMap) == 0)
             {
-                Utility::createReturnData(attributes, leftRecord, rightRecord, data);
-                rightRecord.createRecord();
-                free(rightRecord.record);
+                leftRecordView.decodeData(leftData);
+                Utility::createReturnData(leftRecordView, rightRecordView, data);
                 if (leftRecordPoistionInMap == -1)
                 {
                     free(rightDataBuffer);
@@ -661,9 +855,6 @@ RC BNLJoin::getNextTuple(void *data)
                 }
                 return 0;
             }
-
-            rightRecord.createRecord();
-            free(rightRecord.record);
         }
 
         while (true)
@@ -673,28 +864,27 @@ RC BNLJoin::getNextTuple(void *data)
             if (rightIterator->getNextTuple(rightData) != RBFM_EOF)
             {
                 rightRecordPointer++;
-                RecordManager rightRecord(rightAttributes.size());
-                if (rightRecord.understandData(rightAttributes, rightData) == 0)
+                if (rightRecordView.decodeData(rightData) == 0)
                 {
-                    RecordManager leftRecord(leftAttributes.size());
+                    void *leftData = NULL;
                     leftRecordPoistionInMap = 0;
                     if (
-                        inMemoryHashTable.applyComparisionOperator(rightAttribute, rightRecord,
-                                                                   condition.op, leftRecord, leftRecordPoistionInMap) == 0)
+                        inMemoryHashTable.applyComparisionOperator(rightIterator, rightRecordView, rightAttributeIndex,
+                                                                   condition.op, leftData, leftRecordPoistionInMap) == 0)
                     {
-                        Utility::createReturnData(attributes, leftRecord, rightRecord, data);
-                        rightRecord.createRecord();
-                        free(rightRecord.record);
-                        free(rightData);
+                        leftRecordView.decodeData(leftData);
+                        Utility::createReturnData(leftRecordView, rightRecordView, data);
+                        // The right tuple is kept while more left tuples match it.
                         if (leftRecordPoistionInMap != -1)
                         {
-                            rightDataBuffer = malloc(rawDataMaxSizeRight);
-                            memcpy((char *)rightDataBuffer, (char *)rightData, rawDataMaxSizeRight);
+                            rightDataBuffer = rightData;
+                        }
+                        else
+                        {
+                            free(rightData);
                         }
                         return 0;
                     }
-                    rightRecord.createRecord();
-                    free(rightRecord.record);
                 }
                 free(rightData);
             }
@@ -770,6 +960,9 @@ INLJoin::INLJoin(Iterator *leftIn, IndexScan *rightIn, const Condition &conditio
     attributes.insert(attributes.begin(), leftAttributes.begin(), leftAttributes.end());
     attributes.insert(attributes.end(), rightAttributes.begin(), rightAttributes.end());
 
+    leftAttributeIndex = Utility::getIndex(leftAttributes, leftAttribute.name);
+    leftRecordView.initialize(leftAttributes);
+    rightRecordView.initialize(rightAttributes);
     rightRecordCounter = RBFM_EOF;
     leftDataBuffer = NULL;
     currentKey = NULL;
@@ -785,29 +978,20 @@ RC INLJoin::getNextTuple(void *data)
             memset(leftData, 0, rawDataMaxSizeLeft);
             if (leftIterator->getNextTuple(leftData) != RBFM_EOF)
             {
-                RecordManager leftRecord(leftAttributes.size());
-                if (leftRecord.understandData(leftAttributes, leftData) == 0)
+                if (leftRecordView.decodeData(leftData) == 0 && leftAttributeIndex >= 0 && !leftRecordView.isNull(leftAttributeIndex))
                 {
-                    leftDataBuffer = malloc(rawDataMaxSizeLeft);
-                    memset(leftDataBuffer, 0, rawDataMaxSizeLeft);
-                    memcpy((char *)leftDataBuffer, (char *)leftData, rawDataMaxSizeLeft);
-
-                    for (int i = 0; i < leftRecord.fieldValues.size(); i++)
-                    {
-                        if (leftAttribute.name == leftRecord.fieldValues[i].name && leftRecord.fieldValues[i].length < -1)
-                        {
-                            rightRecordCounter = 0;
-                            currentKey = malloc(leftRecord.fieldValues[i].length);
-                            memcpy((char *)currentKey, (char *)leftRecord.fieldValues[i].value, leftRecord.fieldValues[i].length);
-                            rightIterator->setIterator(currentKey, currentKey, true, true);
-                            break;
-                        }
-                    }
-
-                    leftRecord.createRecord();
-                    free(leftRecord.record);
+                    // The left tuple is kept for every right tuple its key finds.
+                    leftDataBuffer = leftData;
+                    rightRecordCounter = 0;
+                    unsigned length = leftRecordView.getLength(leftAttributeIndex);
+                    currentKey = malloc(length);
+                    memcpy((char *)currentKey, leftRecordView.getField(leftAttributeIndex), length);
+                    rightIterator->setIterator(currentKey, currentKey, true, true);
+                }
+                else
+                {
+                    free(leftData);
                 }
-                free(leftData);
             }
             else
             {
@@ -824,22 +1008,13 @@ RC INLJoin::getNextTuple(void *data)
             if (rightIterator->getNextTuple(rightData) != RBFM_EOF)
             {
                 rightRecordCounter++;
-                RecordManager rightRecord(rightAttributes.size());
-                if (rightRecord.understandData(rightAttributes, rightData) == 0)
+                if (rightRecordView.decodeData(rightData) == 0)
                 {
-                    RecordManager leftRecord(leftAttributes.size());
-                    leftRecord.understandData(leftAttributes, leftDataBuffer);
-
-                    Utility::createReturnData(attributes, leftRecord, rightRecord, data);
-                    leftRecord.createData();
-                    free(leftRecord.record);
-                    rightRecord.createData();
-                    free(rightRecord.record);
+                    leftRecordView.decodeData(leftDataBuffer);
+                    Utility::createReturnData(leftRecordView, rightRecordView, data);
                     free(rightData);
                     return 0;
                 }
-                rightRecord.createData();
-                free(rightRecord.record);
             }
             else
             {
@@ -918,6 +1093,10 @@ GHJoin::GHJoin(Iterator *leftIn, Iterator *rightIn, const Condition &condition,
     attributes.insert(attributes.begin(), leftAttributes.begin(), leftAttributes.end());
     attributes.insert(attributes.end(), rightAttributes.begin(), rightAttributes.end());
 
+    leftAttributeIndex = Utility::getIndex(leftAttributes, leftAttribute.name);
+    rightAttributeIndex = condition.bRhsIsAttr ? Utility::getIndex(rightAttributes, condition.rhsAttr) : -1;
+    leftRecordView.initialize(leftAttributes);
+    rightRecordView.initialize(rightAttributes);
     bnlJoinPointer = QE_EOF;
     rmLayer = RelationManager::instance();
     joinId = ghjCounter++;
@@ -931,73 +1110,38 @@ inline string getPartitionFileName(const string &tableName, const unsigned &join
     return tableName + "_join" + to_string(joinId) + "_" + to_string(partitionNumber) + ".part";
 }
 
-RC GHJoin::insertInPartition(const Attribute &attribute, const vector<Attribute> &attributes,
+RC GHJoin::insertInPartition(RecordView &recordView, const int keyIndex,
                              const void *recordData, const string &tableName)
 {
-    RecordManager record(attributes.size());
-    if (record.understandData(attributes, recordData) == 0)
+    if (recordView.decodeData(recordData) != 0 || keyIndex < 0 || recordView.isNull(keyIndex))
     {
-        if (attribute.type == TypeVarChar)
-        {
-            string key = "";
-            if (Utility::getKey(attribute, record, key) == 0)
-            {
-                int numberOfCharToConsider = ceil((double)numPartitions / 255);
-                int currentKey = 0;
-                for(int i = 0; i < min(numberOfCharToConsider, (int)key.length()); i++)
-                {
-                    currentKey += (int)key[i];
-                }
-
-                int belongsToPartition = currentKey % numPartitions;
-
-                RID ridDummy;
-                if (rmLayer->insertTuple(getPartitionFileName(tableName, joinId, belongsToPartition), recordData, ridDummy) == 0)
-                {
-                    record.createRecord();
-                    free(record.record);
-                    return 0;
-                }
-            }
-        }
-        else if (attribute.type == TypeInt)
-        {
-            int key = 0;
-            if (Utility::getKey(attribute, record, key) == 0)
-            {
-                int belongsToPartition = key % numPartitions;
+        return -1;
+    }
 
-                RID ridDummy;
-                if (rmLayer->insertTuple(getPartitionFileName(tableName, joinId, belongsToPartition), recordData, ridDummy) == 0)
-                {
-                    record.createRecord();
-                    free(record.record);
-                    return 0;
-                }
-            }
-        }
-        else if (attribute.type == TypeReal)
+    int belongsToPartition = 0;
+    if (recordView.types[keyIndex] == TypeVarChar)
+    {
+        VarcharView key = recordView.getVarchar(keyIndex);
+        int numberOfCharToConsider = ceil((double)numPartitions / 255);
+        int currentKey = 0;
+        for (int i = 0; i < min(numberOfCharToConsider, (int)key.length); i++)
         {
-            float key = 0.0;
-            if (Utility::getKey(attribute, record, key) == 0)
-            {
-                int belongsToPartition = (int)floor(key) % numPartitions;
-
-                RID ridDummy;
-                if (rmLayer->insertTuple(getPartitionFileName(tableName, joinId, belongsToPartition), recordData, ridDummy) == 0)
-                {
-                    record.createRecord();
-                    free(record.record);
-                    return 0;
-                }
-            }
+            currentKey += (int)key.data[i];
         }
 
-        record.createRecord();
-        free(record.record);
+        belongsToPartition = currentKey % numPartitions;
+    }
+    else if (recordView.types[keyIndex] == TypeInt)
+    {
+        belongsToPartition = recordView.getInt(keyIndex) % numPartitions;
+    }
+    else if (recordView.types[keyIndex] == TypeReal)
+    {
+        belongsToPartition = (int)floor(recordView.getFloat(keyIndex)) % numPartitions;
     }
 
-    return -1;
+    RID ridDummy;
+    return rmLayer->insertTuple(getPartitionFileName(tableName, joinId, belongsToPartition), recordData, ridDummy);
 }
 
 RC GHJoin::getNextTuple(void *data)
@@ -1005,20 +1149,29 @@ RC GHJoin::getNextTuple(void *data)
     if (buildPhase)
     {
         probePhase = true;
-        for (int i = 0; i < numPartitions; i++)
+
+        // Only when an input keeps the join VarChar dictionary encoded are the partitions dictionary encoded too,
+        // for their join to match codes: encoding the VarChars of plain inputs would look every one of them up
+        // in a dictionary to write it.
+        RecordFormat format = VariableWidthFormat;
+        if (leftAttribute.type == TypeVarChar &&
+            (leftIterator->getRecordFormat() == DictionaryFormat || rightIterator->getRecordFormat() == DictionaryFormat))
         {
-            string leftPartitionFileName = getPartitionFileName(leftTableName, joinId, i);
-            string rightPartitionFileName = getPartitionFileName(rightTableName, joinId, i);
+            format = DictionaryFormat;
+        }
 
-            rmLayer->createTable(leftPartitionFileName, leftAttributes);
-            rmLayer->createTable(rightPartitionFileName, rightAttributes);
+        // A partition has the pages of the input it holds the tuples of, so its join budgets as the input's would.
+        for (int i = 0; i < numPartitions; i++)
+        {
+            rmLayer->createTable(getPartitionFileName(leftTableName, joinId, i), leftAttributes, leftIterator->getPageSize(), format);
+            rmLayer->createTable(getPartitionFileName(rightTableName, joinId, i), rightAttributes, rightIterator->getPageSize(), format);
         }
 
         void *leftData = malloc(rawDataMaxSizeLeft);
         memset(leftData, 0, rawDataMaxSizeLeft);
-        while (leftIterator->getNextTuple(leftData) != RBFM_EOF)
+        while (leftIterator->getNextTuple(leftData) != QE_EOF)
         {
-            if (insertInPartition(leftAttribute, leftAttributes, leftData, leftTableName) != 0)
+            if (insertInPartition(leftRecordView, leftAttributeIndex, leftData, leftTableName) != 0)
             {
                 probePhase = false;
             }
@@ -1028,9 +1181,9 @@ RC GHJoin::getNextTuple(void *data)
 
         void *rightData = malloc(rawDataMaxSizeRight);
         memset(rightData, 0, rawDataMaxSizeRight);
-        while (rightIterator->getNextTuple(rightData) != RBFM_EOF)
+        while (rightIterator->getNextTuple(rightData) != QE_EOF)
         {
-            if (insertInPartition(rightAttribute, rightAttributes, rightData, rightTableName) != 0)
+            if (insertInPartition(rightRecordView, rightAttributeIndex, rightData, rightTableName) != 0)
             {
                 probePhase = false;
             }
@@ -1126,11 +1279,18 @@ Aggregate::Aggregate(Iterator *input, Attribute aggAttr, AggregateOp op)
         }
         rawDataMaxSize += attributes[i].length;
     }
+
+    attributeIndex = Utility::getIndex(attributes, attribute.name);
+    groupByAttributeIndex = -1;
+    groupByDictionary = NULL;
+    groupByField = 0;
+    recordView.initialize(attributes);
 }
 
 Aggregate::Aggregate(Iterator *input, Attribute aggAttr, Attribute groupAttr, AggregateOp op) : Aggregate(input, aggAttr, op)
 {
     groupByAttribute = groupAttr;
+    groupByAttributeIndex = Utility::getIndex(attributes, groupAttr.name);
     isGroupBy = true;
 }
 
@@ -1142,59 +1302,65 @@ RC Aggregate::getNextTuple(void *data)
         memset(recordData, 0, rawDataMaxSize);
         while (iterator->getNextTuple(recordData) != RBFM_EOF)
         {
-            RecordManager record(attributes.size());
-            if (record.understandData(attributes, recordData) == 0)
+            if (recordView.decodeData(recordData) == 0 && attributeIndex >= 0)
             {
-                for (int i = 0; i < record.fieldValues.size(); i++)
+                unsigned code = 0;
+                if (isGroupBy && groupByAttribute.type == TypeVarChar &&
+                    iterator->getCode(groupByAttributeIndex, code, groupByDictionary, groupByField))
                 {
-                    if (attribute.name == record.fieldValues[i].name)
+                    updateAggregatorStorage(recordView, codeAggregatorMap[code]);
+                }
+                else if (isGroupBy)
+                {
+                    if (groupByAttribute.type == TypeVarChar)
+                    {
+                        string key = "";
+                        if (Utility::getKey(recordView, groupByAttributeIndex, key) == 0)
+                        {
+                            updateAggregatorStorage(recordView, stringAggregatorMap[key]);
+                            stringAggIter = stringAggregatorMap.begin();
+                        }
+                    }
+                    else if (groupByAttribute.type == TypeInt)
                     {
-                        if (isGroupBy)
+                        int key = 0;
+                        if (Utility::getKey(recordView, groupByAttributeIndex, key) == 0)
                         {
-                            if (groupByAttribute.type == TypeVarChar)
-                            {
-                                string key = "";
-                                if (Utility::getKey(groupByAttribute, record, key) == 0)
-                                {
-                                    updateAggregatorStorage(record, stringAggregatorMap[key]);
-                                    stringAggIter = stringAggregatorMap.begin();
-                                }
-                            }
-                            else if (groupByAttribute.type == TypeInt)
-                            {
-                                int key = 0;
-                                if (Utility::getKey(groupByAttribute, record, key) == 0)
-                                {
-                                    updateAggregatorStorage(record, intAggregatorMap[key]);
-                                    intAggIter = intAggregatorMap.begin();
-                                }
-                            }
-                            else if (groupByAttribute.type == TypeReal)
-                            {
-                                float key = 0.0;
-                                if (Utility::getKey(groupByAttribute, record, key) == 0)
-                                {
-                                    updateAggregatorStorage(record, doubleAggregatorMap[key]);
-                                    doubleAggIter = doubleAggregatorMap.begin();
-                                }
-                            }
+                            updateAggregatorStorage(recordView, intAggregatorMap[key]);
+                            intAggIter = intAggregatorMap.begin();
                         }
-                        else
+                    }
+                    else if (groupByAttribute.type == TypeReal)
+                    {
+                        float key = 0.0;
+                        if (Utility::getKey(recordView, groupByAttributeIndex, key) == 0)
                         {
-                            updateAggregatorStorage(record, aggStorage);
+                            updateAggregatorStorage(recordView, doubleAggregatorMap[key]);
+                            doubleAggIter = doubleAggregatorMap.begin();
                         }
-                        nextKey = 0;
                     }
                 }
-
-                record.createRecord();
-                free(record.record);
+                else
+                {
+                    updateAggregatorStorage(recordView, aggStorage);
+                }
+                nextKey = 0;
             }
 
             memset(recordData, 0, rawDataMaxSize);
         }
         free(recordData);
         compute = false;
+
+        // Groups kept by their code are only decoded once, to come out in the order of their VarChars.
+        unordered_map<unsigned, AggregatorStorage>::iterator it;
+        for (it = codeAggregatorMap.begin(); it != codeAggregatorMap.end(); it++)
+        {
+            VarcharView key = groupByDictionary->getValue(groupByField, it->first);
+            stringAggregatorMap[string(key.data, key.length)] = it->second;
+        }
+        codeAggregatorMap.clear();
+        stringAggIter = stringAggregatorMap.begin();
     }
 
     if (nextKey > -1)
@@ -1209,7 +1375,7 @@ RC Aggregate::getNextTuple(void *data)
                     void *key = malloc(sizeof(int) + length);
                     memset(key, 0, sizeof(int) + length);
                     memcpy((char *)key, &length, sizeof(int));
-                    memcpy((char *)key + sizeof(int), &stringAggIter->first, length);
+                    memcpy((char *)key + sizeof(int), stringAggIter->first.data(), length);
                     createReturnData(stringAggIter->second, key, sizeof(int) + length, data);
                     stringAggIter++;
                     nextKey++;
@@ -1261,28 +1427,22 @@ RC Aggregate::getNextTuple(void *data)
     return QE_EOF;
 }
 
-void Aggregate::updateAggregatorStorage(RecordManager &record, AggregatorStorage &aggStorage)
+void Aggregate::updateAggregatorStorage(const RecordView &record, AggregatorStorage &aggStorage)
 {
-    for (int i = 0; i < record.fieldValues.size(); i++)
+    if (attribute.type == TypeInt)
     {
-        if (attribute.name == record.fieldValues[i].name)
+        int value = 0;
+        if (Utility::getKey(record, attributeIndex, value) == 0)
         {
-            if (attribute.type == TypeInt)
-            {
-                int value = 0;
-                if (Utility::getKey(attribute, record, value) == 0)
-                {
-                    aggStorage.update((float)value);
-                }
-            }
-            else if (attribute.type == TypeReal)
-            {
-                float value = 0.0;
-                if (Utility::getKey(attribute, record, value) == 0)
-                {
-                    aggStorage.update(value);
-                }
-            }
+            aggStorage.update((float)value);
+        }
+    }
+    else if (attribute.type == TypeReal)
+    {
+        float value = 0.0;
+        if (Utility::getKey(record, attributeIndex, value) == 0)
+        {
+            aggStorage.update(value);
         }
     }
     return;
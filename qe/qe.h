@@ -52,11 +52,11 @@ class Utility
   public:
     static int compare(const Attribute &attribute, const void *leftValue, const void *rightValue);
     static RC applyComparisionOperator(const Attribute &attr, const CompOp op, const void *leftValue, const void *rightValue);
-    static void createReturnData(const vector<Attribute> &attributes, RecordManager &record, void *data);
-    static void createReturnData(const vector<Attribute> &attributes, RecordManager &leftRecord, RecordManager &rightRecord, void *data);
-    static RC getKey(const Attribute &attribute, const RecordManager &recordManager, int &key);
-    static RC getKey(const Attribute &attribute, const RecordManager &recordManager, float &key);
-    static RC getKey(const Attribute &attribute, const RecordManager &recordManager, string &key);
+    static void createReturnData(const RecordView &leftRecord, const RecordView &rightRecord, void *data);
+    static int getIndex(const vector<Attribute> &attributes, const string &name);
+    static RC getKey(const RecordView &record, const int index, int &key);
+    static RC getKey(const RecordView &record, const int index, float &key);
+    static RC getKey(const RecordView &record, const int index, string &key);
 };
 
 class Iterator
@@ -64,7 +64,18 @@ class Iterator
     // All the relational operators and access methods are iterators.
   public:
     virtual RC getNextTuple(void *data) = 0;
+    // As many tuples as the batch holds, QE_EOF if there are none. Operators that do not produce
+    // batches of their own fill it a tuple at a time, without RIDs.
+    virtual RC getNextBatch(RecordBatch &batch);
     virtual void getAttributes(vector<Attribute> &attrs) const = 0;
+    // For a VarChar the input keeps dictionary encoded, its code in the tuple getNextTuple() returned last, with the
+    // dictionary and field the code is looked up in. Two tuples with codes of the same dictionary and field have the
+    // same VarChar exactly when they have the same code. false for any other attribute.
+    virtual bool getCode(const int attrIndex, unsigned &code, Dictionary *&dictionary, unsigned &field);
+    // Size of the pages of the table the tuples come from, PAGE_SIZE if they come from none.
+    virtual unsigned getPageSize();
+    // Format of the table the tuples come from, VariableWidthFormat if they come from none.
+    virtual RecordFormat getRecordFormat();
     virtual ~Iterator(){};
 };
 
@@ -75,14 +86,18 @@ class TableScan : public Iterator
     RelationManager &rm;
     RM_ScanIterator *iter;
     string tableName;
+    string relationName; // the table scanned, tableName may be its alias
     vector<Attribute> attrs;
     vector<string> attrNames;
     RID rid;
+    unsigned numberOfThreads; // worker threads of the RM scan
 
-    TableScan(RelationManager &rm, const string &tableName, const char *alias = NULL) : rm(rm)
+    TableScan(RelationManager &rm, const string &tableName, const char *alias = NULL, const unsigned numberOfThreads = 1) : rm(rm)
     {
         //Set members
         this->tableName = tableName;
+        this->relationName = tableName;
+        this->numberOfThreads = numberOfThreads;
 
         // Get Attributes from RM
         rm.getAttributes(tableName, attrs);
@@ -97,7 +112,7 @@ class TableScan : public Iterator
 
         // Call RM scan to get an iterator
         iter = new RM_ScanIterator();
-        rm.scan(tableName, "", NO_OP, NULL, attrNames, *iter);
+        rm.scan(tableName, "", NO_OP, NULL, attrNames, *iter, numberOfThreads);
 
         // Set alias
         if (alias)
@@ -110,7 +125,22 @@ class TableScan : public Iterator
         iter->close();
         delete iter;
         iter = new RM_ScanIterator();
-        rm.scan(tableName, "", NO_OP, NULL, attrNames, *iter);
+        rm.scan(relationName, "", NO_OP, NULL, attrNames, *iter, numberOfThreads);
+    };
+
+    // Start a new iterator that only returns the tuples whose attrName satisfies compOp and value,
+    // passing over the pages the table's zone map rules out. value is not copied.
+    void setIterator(const string &attrName, const CompOp compOp, const void *value)
+    {
+        iter->close();
+        delete iter;
+        iter = new RM_ScanIterator();
+        rm.scan(relationName, attrName, compOp, value, attrNames, *iter, numberOfThreads);
+    };
+
+    unsigned getNumberOfSkippedPages()
+    {
+        return iter->getNumberOfSkippedPages();
     };
 
     RC getNextTuple(void *data)
@@ -118,6 +148,26 @@ class TableScan : public Iterator
         return iter->getNextTuple(rid, data);
     };
 
+    RC getNextBatch(RecordBatch &batch)
+    {
+        return iter->getNextBatch(batch);
+    };
+
+    bool getCode(const int attrIndex, unsigned &code, Dictionary *&dictionary, unsigned &field)
+    {
+        return attrIndex >= 0 && iter->getCode(attrIndex, code, dictionary, field);
+    };
+
+    unsigned getPageSize()
+    {
+        return iter->getPageSize();
+    };
+
+    RecordFormat getRecordFormat()
+    {
+        return iter->getRecordFormat();
+    };
+
     void getAttributes(vector<Attribute> &attrs) const
     {
         attrs.clear();
@@ -222,13 +272,33 @@ class Filter : public Iterator
     Iterator *iterator;
     Condition condition;
     vector<Attribute> attributes;
+    int conditionIndex;
+    RecordView recordView;
+    SelectionKernel selectionKernel; // checks a batch at once if the condition is on an Int or Real
+    vector<int> values;              // the batch's values of the condition attribute, 4 bytes each
+    vector<bool> hasValues;          // whether a tuple has one, it is not null
+    vector<unsigned char> selection;
+    TableScan *tableScan;            // the input, if the condition was pushed down into its scan
+    Dictionary *conditionDictionary; // the one the input's codes of the condition attribute were last in
+    unsigned conditionField;
+    bool hasConditionCode;           // whether the condition's VarChar has a code there
+    unsigned conditionCode;
 
     Filter(Iterator *input,           // Iterator of input R
            const Condition &condition // Selection condition
     );
     ~Filter(){};
 
+    unsigned getNumberOfSkippedPages(); // pages the table scan under the filter passed over
+
     RC getNextTuple(void *data);
+    RC getNextBatch(RecordBatch &batch); // drops the tuples that fail the condition from the batch's selection
+    bool getCode(const int attrIndex, unsigned &code, Dictionary *&dictionary, unsigned &field);
+    unsigned getPageSize();
+    RecordFormat getRecordFormat();
+    bool satisfies(const void *data);
+    bool satisfiesCode(bool &satisfied); // = and != on a dictionary encoded VarChar, false if the tuple has no code
+    RC select(RecordBatch &batch);       // the same through the selection kernel
     // For attribute in vector<Attribute>, name it as rel.attr
     void getAttributes(vector<Attribute> &attrs) const;
 };
@@ -240,13 +310,21 @@ class Project : public Iterator
     Iterator *iterator;
     vector<Attribute> attributes;
     vector<Attribute> originalAttributes;
+    vector<int> projection;
     unsigned rawDataMaxSize;
+    void *inputData;
+    RecordBatch inputBatch;
+    RecordView recordView;
 
     Project(Iterator *input,                  // Iterator of input R
             const vector<string> &attrNames); // vector containing attribute names
-    ~Project(){};
+    ~Project();
 
     RC getNextTuple(void *data);
+    RC getNextBatch(RecordBatch &batch);
+    bool getCode(const int attrIndex, unsigned &code, Dictionary *&dictionary, unsigned &field);
+    unsigned getPageSize();
+    RecordFormat getRecordFormat();
     // For attribute in vector<Attribute>, name it as rel.attr
     void getAttributes(vector<Attribute> &attrs) const;
 };
@@ -272,9 +350,15 @@ class InMemoryHashTable
     vector<Attribute> attributes;
     unsigned rawDataMaxSize;
     unsigned bufferMemory;
-    map<int, vector<RecordManager>> intHashTable;
-    map<float, vector<RecordManager>, mapDoubleLess> doubleHashTable;
-    map<string, vector<RecordManager>> stringHashTable;
+    int attributeIndex;
+    RecordView recordView;
+    map<int, vector<void *>> intHashTable; // tuples are kept as they came from the iterator
+    map<float, vector<void *>, mapDoubleLess> doubleHashTable;
+    map<string, vector<void *>> stringHashTable;
+    unordered_map<unsigned, vector<void *>> codeHashTable; // VarChars by their code, if the iterator keeps them encoded
+    Dictionary *dictionary;                                // the codes' dictionary, NULL until a tuple has one
+    unsigned field;
+    vector<int> translatedCodes; // the code in dictionary of a code of the probing side's, -1 if it has none
 
     InMemoryHashTable(){};
     ~InMemoryHashTable(){};
@@ -283,8 +367,9 @@ class InMemoryHashTable
                   const vector<Attribute> &leftAttributes, const unsigned rawDataMaxSize);
     RC buildNextHashTable();
     RC cleanHashTable();
-    RC applyComparisionOperator(const Attribute &rightAttribute, const RecordManager &rightRecord,
-                                const CompOp op, RecordManager &leftRecord, int &atPosition);
+    RC applyComparisionOperator(Iterator *rightIterator, const RecordView &rightRecord, const int rightIndex,
+                                const CompOp op, void *&leftData, int &atPosition);
+    bool getCode(Iterator *rightIterator, const RecordView &rightRecord, const int rightIndex, unsigned &code); // the right tuple's key in dictionary
 };
 
 class BNLJoin : public Iterator
@@ -300,6 +385,9 @@ class BNLJoin : public Iterator
     vector<Attribute> attributes;
     Attribute leftAttribute;
     Attribute rightAttribute;
+    int rightAttributeIndex;
+    RecordView leftRecordView;
+    RecordView rightRecordView;
     InMemoryHashTable inMemoryHashTable;
     unsigned leftRecordCounter;
     unsigned rightRecordPointer;
@@ -333,6 +421,9 @@ class INLJoin : public Iterator
     vector<Attribute> attributes;
     Attribute leftAttribute;
     Attribute rightAttribute;
+    int leftAttributeIndex;
+    RecordView leftRecordView;
+    RecordView rightRecordView;
     unsigned rightRecordCounter;
     unsigned rawDataMaxSizeRight;
     unsigned rawDataMaxSizeLeft;
@@ -374,6 +465,10 @@ class GHJoin : public Iterator
     vector<Attribute> attributes;
     Attribute leftAttribute;
     Attribute rightAttribute;
+    int leftAttributeIndex;
+    int rightAttributeIndex;
+    RecordView leftRecordView;
+    RecordView rightRecordView;
     unsigned bnlJoinPointer;
     unsigned rawDataMaxSizeRight;
     unsigned rawDataMaxSizeLeft;
@@ -386,8 +481,8 @@ class GHJoin : public Iterator
     ~GHJoin();
 
     RC getNextTuple(void *data);
-    RC insertInPartition(const Attribute &attribute, const vector<Attribute> &attributes, 
-                               const void *recordData, const string &tableName);
+    RC insertInPartition(RecordView &recordView, const int keyIndex,
+                         const void *recordData, const string &tableName);
     // For attribute in vector<Attribute>, name it as rel.attr
     void getAttributes(vector<Attribute> &attrs) const;
 };
@@ -427,10 +522,16 @@ class Aggregate : public Iterator
     map<float, AggregatorStorage>::iterator doubleAggIter;
     map<int, AggregatorStorage> intAggregatorMap;
     map<int, AggregatorStorage>::iterator intAggIter;
+    unordered_map<unsigned, AggregatorStorage> codeAggregatorMap; // VarChar groups by their code, while the input is read
+    Dictionary *groupByDictionary;
+    unsigned groupByField;
     AggregatorStorage aggStorage;
     bool isGroupBy;
     bool compute;
     int nextKey;
+    int attributeIndex;
+    int groupByAttributeIndex;
+    RecordView recordView;
 
     // Mandatory
     // Basic aggregation
@@ -448,7 +549,7 @@ class Aggregate : public Iterator
     );
     ~Aggregate(){};
 
-    void updateAggregatorStorage(RecordManager &record, AggregatorStorage &aggStorage);
+    void updateAggregatorStorage(const RecordView &record, AggregatorStorage &aggStorage);
     void createReturnData(AggregatorStorage &aggStorage, void *key, int keyLength, void *data);
     RC getNextTuple(void *data);
     // Please name the output attribute as aggregateOp(aggAttr)
@@ -0,0 +1,308 @@
+#include <fstream>
+#include <iostream>
+
+#include <vector>
+#include <map>
+#include <set>
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "qe_test_util.h"
+
+// dictleft (A int, B varchar(30)) and dictright (B varchar(30), C real), joined and grouped on B.
+// Many tuples share every B, the case DictionaryFormat keeps as codes. A and C are sometimes null.
+const int dictLeftTupleCount = 1000;
+const int dictRightTupleCount = 300;
+
+string getDictionaryKey(const int k) {
+	return "dictionary key " + to_string(k);
+}
+
+int createDictionaryLeftTable(const string &tableName, const RecordFormat format) {
+	vector<Attribute> attrs;
+
+	Attribute attr;
+	attr.name = "A";
+	attr.type = TypeInt;
+	attr.length = 4;
+	attrs.push_back(attr);
+
+	attr.name = "B";
+	attr.type = TypeVarChar;
+	attr.length = 30;
+	attrs.push_back(attr);
+
+	rm->deleteTable(tableName);
+	return rm->createTable(tableName, attrs, PAGE_SIZE, format);
+}
+
+int createDictionaryRightTable(const string &tableName, const RecordFormat format) {
+	vector<Attribute> attrs;
+
+	Attribute attr;
+	attr.name = "B";
+	attr.type = TypeVarChar;
+	attr.length = 30;
+	attrs.push_back(attr);
+
+	attr.name = "C";
+	attr.type = TypeReal;
+	attr.length = 4;
+	attrs.push_back(attr);
+
+	rm->deleteTable(tableName);
+	return rm->createTable(tableName, attrs, PAGE_SIZE, format);
+}
+
+// Writes a value of a tuple in the format of getNextTuple(), and sets its null bit if it has none
+int appendDictionaryField(const AttrType type, const bool isNull, const unsigned field, const int intValue,
+		const float realValue, const string &varcharValue, void *buf, int offset) {
+	if (isNull) {
+		((unsigned char *)buf)[field / 8] |= 1 << (7 - field % 8);
+	} else if (type == TypeInt) {
+		memcpy((char *)buf + offset, &intValue, sizeof(int));
+		offset += sizeof(int);
+	} else if (type == TypeReal) {
+		memcpy((char *)buf + offset, &realValue, sizeof(float));
+		offset += sizeof(float);
+	} else {
+		int length = varcharValue.size();
+		memcpy((char *)buf + offset, &length, sizeof(int));
+		offset += sizeof(int);
+		memcpy((char *)buf + offset, varcharValue.data(), length);
+		offset += length;
+	}
+	return offset;
+}
+
+int populateDictionaryTables(const string &leftTableName, const string &rightTableName) {
+	RID rid;
+	void *tuple = malloc(bufSize);
+	RC rc = success;
+	for (int i = 0; i < dictLeftTupleCount && rc == success; i++) {
+		memset(tuple, 0, 1);
+		int offset = appendDictionaryField(TypeInt, i % 29 == 3, 0, i, 0, "", tuple, 1);
+		appendDictionaryField(TypeVarChar, false, 1, 0, 0, getDictionaryKey(i % 50), tuple, offset);
+		rc = rm->insertTuple(leftTableName, tuple, rid);
+	}
+	for (int i = 0; i < dictRightTupleCount && rc == success; i++) {
+		memset(tuple, 0, 1);
+		int offset = appendDictionaryField(TypeVarChar, false, 0, 0, 0, getDictionaryKey(i % 75), tuple, 1);
+		appendDictionaryField(TypeReal, i % 31 == 2, 1, 0, i * 1.5, "", tuple, offset);
+		rc = rm->insertTuple(rightTableName, tuple, rid);
+	}
+	free(tuple);
+	return rc;
+}
+
+// A tuple of the join as text: dictleft.A, dictleft.B, dictright.B, dictright.C
+string getDictionaryJoinRow(const bool hasA, const int a, const string &leftB, const string &rightB, const bool hasC,
+		const float c) {
+	return (hasA ? to_string(a) : "null") + "|" + leftB + "|" + rightB + "|" + (hasC ? to_string(c) : "null");
+}
+
+string parseDictionaryJoinTuple(const void *data) {
+	unsigned char nullsIndicator = *(unsigned char *)data;
+	const char *field = (const char *)data + 1;
+	int a = 0;
+	if ((nullsIndicator & (1 << 7)) == 0) {
+		memcpy(&a, field, sizeof(int));
+		field += sizeof(int);
+	}
+	string b[2];
+	for (unsigned i = 0; i < 2; i++) {
+		int length = 0;
+		memcpy(&length, field, sizeof(int));
+		b[i] = string(field + sizeof(int), length);
+		field += sizeof(int) + length;
+	}
+	float c = 0;
+	if ((nullsIndicator & (1 << 4)) == 0) {
+		memcpy(&c, field, sizeof(float));
+	}
+	return getDictionaryJoinRow((nullsIndicator & (1 << 7)) == 0, a, b[0], b[1], (nullsIndicator & (1 << 4)) == 0, c);
+}
+
+// The record format of a partition the join wrote, while the join still has its partitions
+unsigned getPartitionRecordFormat(const GHJoin &join, const string &tableName) {
+	FileHandle fileHandle;
+	string fileName = tableName + "_join" + to_string(join.joinId) + "_0.part.tbl";
+	if (rbfm->openFile(fileName, fileHandle) != success) {
+		return UINT_MAX;
+	}
+	unsigned format = fileHandle.getRecordFormat();
+	rbfm->closeFile(fileHandle);
+	return format;
+}
+
+// Whether a scan of the table, and a filter and a projection over one, report the format of the table
+RC checkDictionaryRecordFormat(const string &tableName, const RecordFormat format) {
+	TableScan *input = new TableScan(*rm, tableName);
+	Condition cond;
+	cond.lhsAttr = tableName + ".B";
+	cond.op = NE_OP;
+	cond.bRhsIsAttr = false;
+	cond.rhsValue.type = TypeVarChar;
+	void *value = malloc(bufSize);
+	appendDictionaryField(TypeVarChar, false, 0, 0, 0, getDictionaryKey(0), value, 0);
+	cond.rhsValue.data = value;
+	Filter *filter = new Filter(input, cond);
+	vector<string> attrNames;
+	attrNames.push_back(tableName + ".B");
+	Project *project = new Project(filter, attrNames);
+
+	RC rc = success;
+	if (input->getRecordFormat() != format || filter->getRecordFormat() != format || project->getRecordFormat() != format) {
+		cerr << "***** The iterators over " << tableName << " report another record format. *****" << endl;
+		rc = fail;
+	}
+
+	delete project;
+	delete filter;
+	delete input;
+	free(value);
+	return rc;
+}
+
+// SELECT * FROM left, right WHERE left.B = right.B, through a GHJoin whose partitions should be in format
+RC checkDictionaryJoin(const string &leftTableName, const string &rightTableName, const RecordFormat format) {
+	multiset<string> expected;
+	for (int i = 0; i < dictLeftTupleCount; i++) {
+		for (int j = 0; j < dictRightTupleCount; j++) {
+			if (i % 50 == j % 75) {
+				expected.insert(getDictionaryJoinRow(i % 29 != 3, i, getDictionaryKey(i % 50), getDictionaryKey(j % 75),
+						j % 31 != 2, j * 1.5));
+			}
+		}
+	}
+
+	RC rc = success;
+	TableScan *leftIn = new TableScan(*rm, leftTableName);
+	TableScan *rightIn = new TableScan(*rm, rightTableName);
+	Condition cond;
+	cond.lhsAttr = leftTableName + ".B";
+	cond.op = EQ_OP;
+	cond.bRhsIsAttr = true;
+	cond.rhsAttr = rightTableName + ".B";
+	GHJoin *ghJoin = new GHJoin(leftIn, rightIn, cond, 10);
+
+	multiset<string> joined;
+	void *data = malloc(bufSize);
+	while (ghJoin->getNextTuple(data) != QE_EOF) {
+		if (joined.empty() && (getPartitionRecordFormat(*ghJoin, leftTableName) != format ||
+				getPartitionRecordFormat(*ghJoin, rightTableName) != format)) {
+			cerr << "***** The partitions of " << leftTableName << " and " << rightTableName << " are in another format. *****" << endl;
+			rc = fail;
+		}
+		joined.insert(parseDictionaryJoinTuple(data));
+	}
+	if (joined != expected) {
+		cerr << "***** The join of " << leftTableName << " and " << rightTableName << " returned " << joined.size()
+				<< " tuples, not " << expected.size() << ". *****" << endl;
+		rc = fail;
+	}
+
+	delete ghJoin;
+	delete leftIn;
+	delete rightIn;
+	free(data);
+	return rc;
+}
+
+// SELECT left.B, SUM(left.A) FROM left GROUP BY left.B
+RC checkDictionaryGroupBy(const string &tableName) {
+	map<string, float> expected;
+	for (int i = 0; i < dictLeftTupleCount; i++) {
+		expected[getDictionaryKey(i % 50)] += i % 29 == 3 ? 0 : i;
+	}
+
+	TableScan *input = new TableScan(*rm, tableName);
+	Attribute aggAttr;
+	aggAttr.name = tableName + ".A";
+	aggAttr.type = TypeInt;
+	aggAttr.length = 4;
+	Attribute gAttr;
+	gAttr.name = tableName + ".B";
+	gAttr.type = TypeVarChar;
+	gAttr.length = 30;
+	Aggregate *agg = new Aggregate(input, aggAttr, gAttr, SUM);
+
+	// The groups come out in the order of their VarChars, whether they were kept by code or not.
+	RC rc = success;
+	map<string, float>::iterator it = expected.begin();
+	void *data = malloc(bufSize);
+	while (agg->getNextTuple(data) != QE_EOF) {
+		int length = 0;
+		memcpy(&length, (char *)data + 1, sizeof(int));
+		string key((char *)data + 1 + sizeof(int), length);
+		float sum = 0;
+		memcpy(&sum, (char *)data + 1 + sizeof(int) + length, sizeof(float));
+		if (it == expected.end() || it->first != key || it->second != sum) {
+			cerr << "***** The group " << key << " of " << tableName << " has SUM " << sum << ". *****" << endl;
+			rc = fail;
+			break;
+		}
+		it++;
+	}
+	if (rc == success && it != expected.end()) {
+		cerr << "***** The groups of " << tableName << " are not all returned. *****" << endl;
+		rc = fail;
+	}
+
+	delete agg;
+	delete input;
+	free(data);
+	return rc;
+}
+
+RC testCase_Dictionary() {
+	// GHJoin and Aggregate with GroupBy on a VarChar, for tables in DictionaryFormat and plain ones
+	cerr << endl << "***** In QE Test Case Dictionary *****" << endl;
+
+	if (createDictionaryLeftTable("dictleft", DictionaryFormat) != success ||
+			createDictionaryRightTable("dictright", DictionaryFormat) != success ||
+			populateDictionaryTables("dictleft", "dictright") != success ||
+			createDictionaryLeftTable("plainleft", VariableWidthFormat) != success ||
+			createDictionaryRightTable("plainright", VariableWidthFormat) != success ||
+			populateDictionaryTables("plainleft", "plainright") != success) {
+		cerr << "***** Creating the tables failed. *****" << endl;
+		return fail;
+	}
+
+	RC rc = success;
+	if (checkDictionaryRecordFormat("dictleft", DictionaryFormat) != success ||
+			checkDictionaryRecordFormat("plainleft", VariableWidthFormat) != success) {
+		rc = fail;
+	}
+
+	// Partitions are dictionary encoded when an input already is, and plain otherwise.
+	if (checkDictionaryJoin("dictleft", "dictright", DictionaryFormat) != success ||
+			checkDictionaryJoin("dictleft", "plainright", DictionaryFormat) != success ||
+			checkDictionaryJoin("plainleft", "dictright", DictionaryFormat) != success ||
+			checkDictionaryJoin("plainleft", "plainright", VariableWidthFormat) != success) {
+		rc = fail;
+	}
+
+	if (checkDictionaryGroupBy("dictleft") != success || checkDictionaryGroupBy("plainleft") != success) {
+		rc = fail;
+	}
+
+	rm->deleteTable("dictleft");
+	rm->deleteTable("dictright");
+	rm->deleteTable("plainleft");
+	rm->deleteTable("plainright");
+	return rc;
+}
+
+int main() {
+
+	if (testCase_Dictionary() != success) {
+		cerr << "***** [FAIL] QE Test Case Dictionary failed. *****" << endl;
+		return fail;
+	} else {
+		cerr << "***** QE Test Case Dictionary finished. The result will be examined. *****" << endl;
+		return success;
+	}
+}
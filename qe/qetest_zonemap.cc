@@ -0,0 +1,365 @@
+#include <fstream>
+#include <iostream>
+
+#include <vector>
+#include <set>
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "qe_test_util.h"
+
+// Tuples in blocks of zoneBlockSize, which fill pages of their own. The VarChars of a block share an 8 byte prefix,
+// longer than the ZONE_PREFIX_SIZE bytes a zone map keeps, and those of other blocks differ in their first byte.
+const int zoneTupleCount = 3000;
+const int zoneBlockSize = 500;
+
+int createZoneMapTable(const string &tableName) {
+	vector<Attribute> attrs;
+
+	Attribute attr;
+	attr.name = "A";
+	attr.type = TypeInt;
+	attr.length = 4;
+	attrs.push_back(attr);
+
+	attr.name = "B";
+	attr.type = TypeReal;
+	attr.length = 4;
+	attrs.push_back(attr);
+
+	attr.name = "C";
+	attr.type = TypeVarChar;
+	attr.length = 30;
+	attrs.push_back(attr);
+
+	rm->deleteTable(tableName);
+	return rm->createTable(tableName, attrs);
+}
+
+string getZoneMapVarChar(const int i) {
+	char value[bufSize];
+	sprintf(value, "%czonepfx%04d", 'a' + i / zoneBlockSize, i);
+	return string(value);
+}
+
+// A is i, B is i / 2, C is getZoneMapVarChar(i); now and then one of them is null
+int prepareZoneMapTuple(const int i, void *buf) {
+	unsigned char nullsIndicator = 0;
+	int offset = 1;
+	if (i % 41 == 7) {
+		nullsIndicator |= 1 << 7;
+	} else {
+		memcpy((char *)buf + offset, &i, sizeof(int));
+		offset += sizeof(int);
+	}
+	if (i % 43 == 11) {
+		nullsIndicator |= 1 << 6;
+	} else {
+		float b = i * 0.5;
+		memcpy((char *)buf + offset, &b, sizeof(float));
+		offset += sizeof(float);
+	}
+	if (i % 37 == 5) {
+		nullsIndicator |= 1 << 5;
+	} else {
+		string c = getZoneMapVarChar(i);
+		int length = c.size();
+		memcpy((char *)buf + offset, &length, sizeof(int));
+		offset += sizeof(int);
+		memcpy((char *)buf + offset, c.data(), length);
+		offset += length;
+	}
+	memcpy(buf, &nullsIndicator, 1);
+	return offset;
+}
+
+int populateZoneMapTable(const string &tableName, const int first, const int count) {
+	RID rid;
+	void *tuple = malloc(bufSize);
+	RC rc = success;
+	for (int i = first; i < first + count && rc == success; i++) {
+		prepareZoneMapTuple(i, tuple);
+		rc = rm->insertTuple(tableName, tuple, rid);
+	}
+	free(tuple);
+	return rc;
+}
+
+int getZoneMapTupleSize(const void *data) {
+	unsigned char nullsIndicator = *(unsigned char *)data;
+	int offset = 1;
+	offset += (nullsIndicator & (1 << 7)) ? 0 : sizeof(int);
+	offset += (nullsIndicator & (1 << 6)) ? 0 : sizeof(float);
+	if ((nullsIndicator & (1 << 5)) == 0) {
+		int length = 0;
+		memcpy(&length, (char *)data + offset, sizeof(int));
+		offset += sizeof(int) + length;
+	}
+	return offset;
+}
+
+// Whether a tuple satisfies the condition, as a scan that looks at every page decides it
+bool satisfiesZoneMapCondition(const void *data, const unsigned field, const CompOp op, const void *value) {
+	unsigned char nullsIndicator = *(unsigned char *)data;
+	if (nullsIndicator & (1 << (7 - field))) {
+		return false;
+	}
+	const char *fieldData = (const char *)data + 1;
+	for (unsigned i = 0; i < field; i++) {
+		fieldData += (nullsIndicator & (1 << (7 - i))) ? 0 : sizeof(int);
+	}
+
+	int comparison = 0;
+	if (field == 0) {
+		int a = 0, v = 0;
+		memcpy(&a, fieldData, sizeof(int));
+		memcpy(&v, value, sizeof(int));
+		comparison = a < v ? -1 : (a > v ? 1 : 0);
+	} else if (field == 1) {
+		float b = 0, v = 0;
+		memcpy(&b, fieldData, sizeof(float));
+		memcpy(&v, value, sizeof(float));
+		comparison = b < v ? -1 : (b > v ? 1 : 0);
+	} else {
+		int cLength = 0, vLength = 0;
+		memcpy(&cLength, fieldData, sizeof(int));
+		memcpy(&vLength, value, sizeof(int));
+		string c(fieldData + sizeof(int), cLength);
+		string v((const char *)value + sizeof(int), vLength);
+		comparison = c.compare(v);
+	}
+
+	switch (op) {
+	case EQ_OP: return comparison == 0;
+	case LT_OP: return comparison < 0;
+	case LE_OP: return comparison <= 0;
+	case GT_OP: return comparison > 0;
+	case GE_OP: return comparison >= 0;
+	case NE_OP: return comparison != 0;
+	default: return true;
+	}
+}
+
+// Runs a condition through an RBFM scan of the table's file and through Filter(TableScan), and checks that both
+// return what a scan without the zone map returns. skippedPages is the fewest pages either of them passed over.
+int checkZoneMapCondition(const string &tableName, const unsigned field, const CompOp op, const void *value,
+		unsigned &skippedPages) {
+	vector<Attribute> attrs;
+	RC rc = rm->getAttributes(tableName, attrs);
+	if (rc != success) {
+		return rc;
+	}
+	vector<string> attrNames;
+	for (unsigned i = 0; i < attrs.size(); i++) {
+		attrNames.push_back(attrs[i].name);
+	}
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(tableName + ".tbl", fileHandle);
+	if (rc != success) {
+		return rc;
+	}
+
+	RID rid;
+	void *data = malloc(bufSize);
+	multiset<string> expected;
+	RBFM_ScanIterator unpruned;
+	rbfm->scan(fileHandle, attrs, "", NO_OP, NULL, attrNames, unpruned);
+	while (unpruned.getNextRecord(rid, data) != RBFM_EOF) {
+		if (satisfiesZoneMapCondition(data, field, op, value)) {
+			expected.insert(string((char *)data, getZoneMapTupleSize(data)));
+		}
+	}
+	unpruned.close();
+
+	multiset<string> scanned;
+	RBFM_ScanIterator pruned;
+	rbfm->scan(fileHandle, attrs, attrs[field].name, op, value, attrNames, pruned);
+	while (pruned.getNextRecord(rid, data) != RBFM_EOF) {
+		scanned.insert(string((char *)data, getZoneMapTupleSize(data)));
+	}
+	skippedPages = pruned.getNumberOfSkippedPages();
+	pruned.close();
+	rbfm->closeFile(fileHandle);
+	if (scanned != expected) {
+		cerr << "***** The RBFM scan on " << attrs[field].name << " returned " << scanned.size() << " tuples, not "
+				<< expected.size() << ". *****" << endl;
+		rc = fail;
+	}
+
+	TableScan *ts = new TableScan(*rm, tableName);
+	Condition cond;
+	cond.lhsAttr = tableName + "." + attrs[field].name;
+	cond.op = op;
+	cond.bRhsIsAttr = false;
+	cond.rhsValue.type = attrs[field].type;
+	cond.rhsValue.data = (void *)value;
+	Filter *filter = new Filter(ts, cond);
+	scanned.clear();
+	while (filter->getNextTuple(data) != QE_EOF) {
+		scanned.insert(string((char *)data, getZoneMapTupleSize(data)));
+	}
+	skippedPages = min(skippedPages, filter->getNumberOfSkippedPages());
+	delete filter;
+	delete ts;
+	if (scanned != expected) {
+		cerr << "***** The filter on " << attrs[field].name << " returned " << scanned.size() << " tuples, not "
+				<< expected.size() << ". *****" << endl;
+		rc = fail;
+	}
+
+	free(data);
+	return rc;
+}
+
+// The conditions the test runs, on every field and with VarChars that agree with the ones stored beyond the prefix
+struct ZoneMapCondition {
+	unsigned field;
+	CompOp op;
+	char value[bufSize];
+};
+
+vector<ZoneMapCondition> getZoneMapConditions() {
+	vector<ZoneMapCondition> conditions;
+	int ints[][2] = { { EQ_OP, 1234 }, { GT_OP, 2500 }, { LT_OP, 200 }, { GE_OP, 1999 }, { LE_OP, 500 } };
+	for (unsigned i = 0; i < 5; i++) {
+		ZoneMapCondition condition;
+		condition.field = 0;
+		condition.op = (CompOp)ints[i][0];
+		memcpy(condition.value, &ints[i][1], sizeof(int));
+		conditions.push_back(condition);
+	}
+
+	float reals[] = { 617.0, 1350.5, 100.0 };
+	CompOp realOps[] = { EQ_OP, GT_OP, LT_OP };
+	for (unsigned i = 0; i < 3; i++) {
+		ZoneMapCondition condition;
+		condition.field = 1;
+		condition.op = realOps[i];
+		memcpy(condition.value, &reals[i], sizeof(float));
+		conditions.push_back(condition);
+	}
+
+	// An existing value, bounds in the middle of a block, a value no tuple has and the shared prefix on its own.
+	string varchars[] = { getZoneMapVarChar(1234), getZoneMapVarChar(2300), getZoneMapVarChar(700), "dzonepfx9999", "czonepfx",
+			getZoneMapVarChar(600) };
+	CompOp varcharOps[] = { EQ_OP, GT_OP, LT_OP, EQ_OP, LE_OP, GE_OP };
+	for (unsigned i = 0; i < 6; i++) {
+		ZoneMapCondition condition;
+		condition.field = 2;
+		condition.op = varcharOps[i];
+		int length = varchars[i].size();
+		memcpy(condition.value, &length, sizeof(int));
+		memcpy(condition.value + sizeof(int), varchars[i].data(), length);
+		conditions.push_back(condition);
+	}
+	return conditions;
+}
+
+// Loads a table and leaves its zone map up to date, then inserts more tuples under SyncCommit and is killed
+// before it closes the file, the way a process that crashed would.
+RC crashWhileLoadingZoneMapTable(const string &tableName) {
+	pid_t child = fork();
+	if (child == 0) {
+		if (createZoneMapTable(tableName) != success || populateZoneMapTable(tableName, 0, 2000) != success) {
+			_exit(1);
+		}
+
+		vector<Attribute> attrs;
+		rm->getAttributes(tableName, attrs);
+		PagedFileManager::instance()->setCommitMode(SyncCommit);
+		FileHandle fileHandle;
+		if (rbfm->openFile(tableName + ".tbl", fileHandle) != success) {
+			_exit(1);
+		}
+		RID rid;
+		void *tuple = malloc(bufSize);
+		for (int i = 2000; i < 2500; i++) {
+			prepareZoneMapTuple(i, tuple);
+			if (rbfm->insertRecord(fileHandle, attrs, tuple, rid) != success) {
+				_exit(1);
+			}
+		}
+		kill(getpid(), SIGKILL);
+	}
+
+	int status = 0;
+	waitpid(child, &status, 0);
+	return WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL ? success : fail;
+}
+
+RC testCase_ZoneMap() {
+	// Filter(TableScan) and an RBFM scan passing over pages by the zone map
+	// SELECT * FROM zonemap WHERE zonemap.A / zonemap.B / zonemap.C op value
+	cerr << endl << "***** In QE Test Case Zone Map *****" << endl;
+
+	RC rc = success;
+	vector<ZoneMapCondition> conditions = getZoneMapConditions();
+
+	// The children fork before this process opens any file.
+	if (crashWhileLoadingZoneMapTable("zonemap_crash") != success) {
+		cerr << "***** The loading process should be killed. *****" << endl;
+		return fail;
+	}
+
+	if (createZoneMapTable("zonemap") != success || populateZoneMapTable("zonemap", 0, zoneTupleCount) != success) {
+		cerr << "***** Creating the zonemap table failed. *****" << endl;
+		return fail;
+	}
+	for (unsigned i = 0; i < conditions.size(); i++) {
+		unsigned skippedPages = 0;
+		if (checkZoneMapCondition("zonemap", conditions[i].field, conditions[i].op, conditions[i].value, skippedPages) != success) {
+			rc = fail;
+		} else if (skippedPages == 0) {
+			cerr << "***** Condition " << i << " should pass over pages by the zone map. *****" << endl;
+			rc = fail;
+		}
+	}
+
+	// The crashed table's map was never written back, so it is not used: no page is passed over, and still
+	// every tuple the log brought back is found.
+	for (unsigned i = 0; i < conditions.size(); i++) {
+		unsigned skippedPages = 0;
+		if (checkZoneMapCondition("zonemap_crash", conditions[i].field, conditions[i].op, conditions[i].value, skippedPages) != success) {
+			rc = fail;
+		} else if (skippedPages != 0) {
+			cerr << "***** Condition " << i << " should not use the crashed table's zone map. *****" << endl;
+			rc = fail;
+		}
+	}
+	RM_ScanIterator rmsi;
+	vector<string> attrNames(1, "A");
+	RID rid;
+	void *data = malloc(bufSize);
+	int actualResultCnt = 0;
+	rm->scan("zonemap_crash", "", NO_OP, NULL, attrNames, rmsi);
+	while (rmsi.getNextTuple(rid, data) != RM_EOF) {
+		actualResultCnt++;
+	}
+	rmsi.close();
+	free(data);
+	if (actualResultCnt != 2500) {
+		cerr << "***** The crashed table returned " << actualResultCnt << " tuples, not 2500. *****" << endl;
+		rc = fail;
+	}
+
+	rm->deleteTable("zonemap");
+	rm->deleteTable("zonemap_crash");
+	return rc;
+}
+
+int main() {
+
+	if (testCase_ZoneMap() != success) {
+		cerr << "***** [FAIL] QE Test Case Zone Map failed. *****" << endl;
+		return fail;
+	} else {
+		cerr << "***** QE Test Case Zone Map finished. The result will be examined. *****" << endl;
+		return success;
+	}
+}
@@ -2,10 +2,18 @@
 
 PagedFileManager *PagedFileManager::_pf_manager = 0;
 
+static void flushAllFilesAtExit()
+{
+	PagedFileManager::instance()->flushAllFiles();
+}
+
 PagedFileManager *PagedFileManager::instance()
 {
 	if (!_pf_manager)
+	{
 		_pf_manager = new PagedFileManager();
+		atexit(flushAllFilesAtExit);
+	}
 
 	return _pf_manager;
 }
@@ -16,35 +24,2404 @@ inline bool doesFileExist(const string &fileName)
 	return f.good();
 }
 
-inline bool isFileOpen(FILE *file)
-{
-	return file != NULL;
+inline bool isFileOpen(PagedFile *pagedFile)
+{
+	return pagedFile != NULL && pagedFile->isOpen();
+}
+
+inline unsigned long long getPageKey(const unsigned &fileId, const PageNum &pageNum)
+{
+	return ((unsigned long long)fileId << 32) | pageNum;
+}
+
+// Data page pageNum sits behind the header page and the map page of every group up to its own.
+inline PageNum getPhysicalPageNum(const PageNum &pageNum)
+{
+	if (pageNum == (PageNum)-1)
+	{
+		return 0;
+	}
+
+	return pageNum + (pageNum / FSM_PAGES_PER_MAP_PAGE) + 2;
+}
+
+inline PageNum getMapPhysicalPageNum(const PageNum &pageNum)
+{
+	return (pageNum / FSM_PAGES_PER_MAP_PAGE) * (FSM_PAGES_PER_MAP_PAGE + 1) + 1;
+}
+
+inline unsigned getFreeSpaceClass(const void *map, const unsigned &index)
+{
+	unsigned char entry = *((unsigned char *)map + (index * FSM_BITS_PER_PAGE) / 8);
+	return (entry >> ((index * FSM_BITS_PER_PAGE) % 8)) & FSM_MAX_CLASS;
+}
+
+inline void setFreeSpaceClass(void *map, const unsigned &index, const unsigned &freeClass)
+{
+	unsigned char *entry = (unsigned char *)map + (index * FSM_BITS_PER_PAGE) / 8;
+	unsigned shift = (index * FSM_BITS_PER_PAGE) % 8;
+	*entry = (*entry & ~(FSM_MAX_CLASS << shift)) | (freeClass << shift);
+}
+
+// FNV-1a over the record with its checksum field zeroed, enough to spot a record a crash cut short.
+inline unsigned computeLogChecksum(LogRecordHeader header, const void *data)
+{
+	header.checksum = 0;
+	unsigned checksum = 2166136261u;
+	for (unsigned i = 0; i < sizeof(LogRecordHeader); i++)
+	{
+		checksum = (checksum ^ ((unsigned char *)&header)[i]) * 16777619u;
+	}
+	for (unsigned i = 0; i < header.length; i++)
+	{
+		checksum = (checksum ^ ((const unsigned char *)data)[i]) * 16777619u;
+	}
+
+	return checksum;
+}
+
+// The page codec is LZ77 in the style of LZ4. A sequence is a token byte holding the literal and match
+// lengths, the literals, a 2-byte offset back to the match, and then the rest of the match length. A
+// length of 15 in the token is continued by bytes up to 255. The last sequence has literals only.
+inline unsigned hashSequence(const unsigned char *data)
+{
+	unsigned sequence = 0;
+	memcpy(&sequence, data, sizeof(unsigned));
+	return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+inline bool putLength(unsigned char *&out, const unsigned char *outEnd, unsigned length)
+{
+	for (; length >= 255; length -= 255)
+	{
+		if (out >= outEnd)
+		{
+			return false;
+		}
+		*out++ = 255;
+	}
+
+	if (out >= outEnd)
+	{
+		return false;
+	}
+	*out++ = (unsigned char)length;
+	return true;
+}
+
+inline bool getLength(const unsigned char *&in, const unsigned char *inEnd, unsigned &length)
+{
+	unsigned char next = 255;
+	while (next == 255)
+	{
+		if (in >= inEnd)
+		{
+			return false;
+		}
+		next = *in++;
+		length += next;
+	}
+
+	return true;
+}
+
+static bool putSequence(unsigned char *&out, const unsigned char *outEnd, const unsigned char *literals,
+						const unsigned &literalLength, const unsigned &offset, const unsigned &matchLength)
+{
+	if (out >= outEnd)
+	{
+		return false;
+	}
+
+	unsigned char *token = out++;
+	*token = (unsigned char)(min(literalLength, 15u) << 4);
+	if (literalLength >= 15 && !putLength(out, outEnd, literalLength - 15))
+	{
+		return false;
+	}
+	if ((unsigned)(outEnd - out) < literalLength)
+	{
+		return false;
+	}
+	memcpy(out, literals, literalLength);
+	out += literalLength;
+
+	if (matchLength == 0)
+	{
+		return true;
+	}
+	if (outEnd - out < 2)
+	{
+		return false;
+	}
+	*out++ = (unsigned char)(offset & 0xFF);
+	*out++ = (unsigned char)(offset >> 8);
+	*token |= (unsigned char)min(matchLength - LZ_MIN_MATCH, 15u);
+	return matchLength - LZ_MIN_MATCH < 15 || putLength(out, outEnd, matchLength - LZ_MIN_MATCH - 15);
+}
+
+// Returns the compressed length, or 0 if it would not fit in capacity bytes. Pages are at most
+// MAX_PAGE_SIZE bytes, so every match is within reach of a 2-byte offset.
+static unsigned compressPage(const void *source, const unsigned &length, void *destination, const unsigned &capacity)
+{
+	const unsigned char *in = (const unsigned char *)source;
+	const unsigned char *inEnd = in + length;
+	unsigned char *out = (unsigned char *)destination;
+	const unsigned char *outEnd = out + capacity;
+
+	// Positions of the last sequence seen with each hash, -1 for none.
+	unsigned table[1 << LZ_HASH_BITS];
+	memset(table, 0xFF, sizeof(table));
+
+	const unsigned char *anchor = in;
+	const unsigned char *position = in;
+	while (length >= LZ_MIN_MATCH && position <= inEnd - LZ_MIN_MATCH)
+	{
+		unsigned hash = hashSequence(position);
+		unsigned candidate = table[hash];
+		table[hash] = position - in;
+		if (candidate == (unsigned)-1 || memcmp(in + candidate, position, LZ_MIN_MATCH) != 0)
+		{
+			position++;
+			continue;
+		}
+
+		const unsigned char *match = in + candidate;
+		unsigned matchLength = LZ_MIN_MATCH;
+		while (position + matchLength < inEnd && position[matchLength] == match[matchLength])
+		{
+			matchLength++;
+		}
+
+		if (!putSequence(out, outEnd, anchor, position - anchor, position - match, matchLength))
+		{
+			return 0;
+		}
+		position += matchLength;
+		anchor = position;
+	}
+
+	if (!putSequence(out, outEnd, anchor, inEnd - anchor, 0, 0))
+	{
+		return 0;
+	}
+	return out - (unsigned char *)destination;
+}
+
+// A slot that does not decode to exactly length bytes is rejected rather than trusted.
+static RC decompressPage(const void *source, const unsigned &sourceLength, void *destination, const unsigned &length)
+{
+	const unsigned char *in = (const unsigned char *)source;
+	const unsigned char *inEnd = in + sourceLength;
+	unsigned char *out = (unsigned char *)destination;
+	unsigned char *outEnd = out + length;
+
+	while (in < inEnd)
+	{
+		unsigned token = *in++;
+		unsigned literalLength = token >> 4;
+		if (literalLength == 15 && !getLength(in, inEnd, literalLength))
+		{
+			return -1;
+		}
+		if ((unsigned)(inEnd - in) < literalLength || (unsigned)(outEnd - out) < literalLength)
+		{
+			return -1;
+		}
+		memcpy(out, in, literalLength);
+		in += literalLength;
+		out += literalLength;
+
+		if (in == inEnd)
+		{
+			break;
+		}
+		if (inEnd - in < 2)
+		{
+			return -1;
+		}
+		unsigned offset = in[0] | (in[1] << 8);
+		in += 2;
+		unsigned matchLength = token & 15;
+		if (matchLength == 15 && !getLength(in, inEnd, matchLength))
+		{
+			return -1;
+		}
+		matchLength += LZ_MIN_MATCH;
+		if (offset == 0 || offset > (unsigned)(out - (unsigned char *)destination) || (unsigned)(outEnd - out) < matchLength)
+		{
+			return -1;
+		}
+
+		// A match may overlap the bytes it produces, a run of one byte repeated is the common case.
+		unsigned char *match = out - offset;
+		if (offset == 1)
+		{
+			memset(out, *match, matchLength);
+		}
+		else if (offset >= matchLength)
+		{
+			memcpy(out, match, matchLength);
+		}
+		else
+		{
+			for (unsigned i = 0; i < matchLength; i++)
+			{
+				out[i] = match[i];
+			}
+		}
+		out += matchLength;
+	}
+
+	return out == outEnd ? 0 : -1;
+}
+
+PagedFile::PagedFile(const string &fileName, const unsigned fileId)
+{
+	this->fileName = fileName;
+	this->fileId = fileId;
+	backend = DEFAULT_IO_BACKEND;
+	file = NULL;
+	fd = -1;
+	mapping = NULL;
+	openCount = 0;
+	numberOfPages = 0;
+	pageSize = PAGE_SIZE;
+	extentSize = DEFAULT_EXTENT_SIZE;
+	reservedSize = 0;
+	dirtyPageCounter = 0;
+	prefetchedPageCounter = 0;
+	prefetchHitCounter = 0;
+	commitMode = NoLogging;
+	log = NULL;
+	redoLSN = 0;
+	compressed = false;
+	recordFormat = 0;
+	pageMapDirty = false;
+	compressedEnd = 0;
+	decompressedPageCounter = 0;
+	decompressTime = 0;
+}
+
+RC PagedFile::open(const IOBackend backend)
+{
+	this->backend = backend;
+	prefetchedPageCounter = 0;
+	prefetchHitCounter = 0;
+	if (backend != StdioBackend)
+	{
+		fd = ::open(fileName.c_str(), O_RDWR);
+		if (fd >= 0 && backend == MappedBackend)
+		{
+			// The window is only address space: pages inside it become readable as the file grows into it.
+			void *window = mmap(NULL, MMAP_WINDOW_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			mapping = window != MAP_FAILED ? (char *)window : NULL;
+		}
+	}
+	else
+	{
+		file = fopen(fileName.c_str(), "r+b");
+	}
+
+	// Whatever an earlier open reserved past the end of the file is not known, the next extent starts at the end.
+	struct stat fileInfo;
+	if (!isOpen() || fstat(backend != StdioBackend ? fd : fileno(file), &fileInfo) != 0)
+	{
+		return -1;
+	}
+	reservedSize = fileInfo.st_size;
+	return 0;
+}
+
+RC PagedFile::close()
+{
+	int error = 0;
+	if (mapping != NULL)
+	{
+		error += syncMapping();
+		error += munmap(mapping, MMAP_WINDOW_SIZE);
+		mapping = NULL;
+	}
+
+	if (backend != StdioBackend)
+	{
+		error += ::close(fd);
+		fd = -1;
+	}
+	else
+	{
+		if (fclose(file) != 0)
+		{
+			error = -1;
+		}
+		file = NULL;
+	}
+
+	return error == 0 ? 0 : -1;
+}
+
+RC PagedFile::flush()
+{
+	// pwrite hands pages straight to the kernel, only the stdio buffer needs flushing. Pages changed in place in
+	// the mapping were never written at all, and are only on disk once the mapping is synced.
+	if (backend == StdioBackend)
+	{
+		return fflush(file) == 0 ? 0 : -1;
+	}
+
+	if (compressed)
+	{
+		return savePageMap(false);
+	}
+
+	return syncMapping();
+}
+
+RC PagedFile::syncMapping()
+{
+	if (mapping == NULL)
+	{
+		return 0;
+	}
+
+	PageNum numberOfPhysicalPages = numberOfPages == 0 ? 1 : getPhysicalPageNum(numberOfPages - 1) + 1;
+	size_t length = min((unsigned long long)numberOfPhysicalPages * pageSize, MMAP_WINDOW_SIZE);
+	return msync(mapping, length, MS_SYNC) == 0 ? 0 : -1;
+}
+
+RC PagedFile::sync()
+{
+	if (backend == StdioBackend)
+	{
+		return fflush(file) == 0 && fsync(fileno(file)) == 0 ? 0 : -1;
+	}
+
+	if (compressed && savePageMap(true) != 0)
+	{
+		return -1;
+	}
+
+	return fdatasync(fd) == 0 ? 0 : -1;
+}
+
+RC PagedFile::checkpoint()
+{
+	// Every change the log holds is in the file once it is synced, so recovery starts past all of it.
+	if (log == NULL)
+	{
+		return 0;
+	}
+
+	unsigned long long lsn = log->getAppendedLSN();
+	if (stampRedoLSN(lsn) != 0)
+	{
+		return -1;
+	}
+
+	return log->discard(lsn);
+}
+
+RC PagedFile::stampRedoLSN(const unsigned long long &lsn)
+{
+	// The stamp goes to disk after the pages it stands for and is synced on its own, so a crash
+	// never leaves one that skips a change the file lacks. Writes of the header page carry it from then on.
+	if (lsn == redoLSN)
+	{
+		return 0;
+	}
+
+	if (sync() != 0)
+	{
+		return -1;
+	}
+
+	redoLSN = lsn;
+	unsigned long long stamp = lsn;
+	int descriptor = backend == StdioBackend ? fileno(file) : fd;
+	if (pwrite(descriptor, &stamp, sizeof(stamp), HEADER_REDO_LSN_OFFSET) != sizeof(stamp))
+	{
+		return -1;
+	}
+
+	return fdatasync(descriptor) == 0 ? 0 : -1;
+}
+
+RC PagedFile::reserve(const PageNum &numberOfPhysicalPages)
+{
+	// A compressed file grows by slots of its own, not by whole pages.
+	unsigned long long size = (unsigned long long)numberOfPhysicalPages * pageSize;
+	if (extentSize == 0 || compressed || size <= reservedSize)
+	{
+		return 0;
+	}
+
+	// Growing by whole extents keeps the file in a few large runs of blocks. A small file only
+	// doubles, so the many small tables and catalogs do not each hold an extent they never fill.
+	unsigned long long newReservedSize = min(2 * size, (size + extentSize - 1) / extentSize * extentSize);
+
+	// The space is reserved without moving the end of the file, whose size keeps following the
+	// pages written. A file system without fallocate just grows as the pages are written.
+	fallocate(backend != StdioBackend ? fd : fileno(file), FALLOC_FL_KEEP_SIZE, reservedSize, newReservedSize - reservedSize);
+	reservedSize = newReservedSize;
+	return 0;
+}
+
+bool PagedFile::isOpen()
+{
+	return backend == StdioBackend ? file != NULL : fd >= 0;
+}
+
+void *PagedFile::getMappedPage(const PageNum &pageNum)
+{
+	if (mapping == NULL || ((unsigned long long)pageNum + 1) * pageSize > MMAP_WINDOW_SIZE)
+	{
+		return NULL;
+	}
+
+	return mapping + (size_t)pageNum * pageSize;
+}
+
+RC PagedFile::readPhysicalPage(const PageNum &pageNum, void *data)
+{
+	if (compressed && pageNum != 0)
+	{
+		return readCompressedPage(pageNum, data);
+	}
+
+	void *mappedPage = getMappedPage(pageNum);
+	if (mappedPage != NULL)
+	{
+		memcpy(data, mappedPage, pageSize);
+		return 0;
+	}
+
+	if (backend != StdioBackend)
+	{
+		return pread(fd, data, pageSize, (off_t)pageNum * pageSize) == (ssize_t)pageSize ? 0 : -1;
+	}
+
+	fseek(file, (long)pageNum * pageSize, SEEK_SET);
+	return fread(data, 1, pageSize, file) == pageSize ? 0 : -1;
+}
+
+RC PagedFile::writePhysicalPage(const PageNum &pageNum, const void *data)
+{
+	// Mapped files are written with pwrite too: the page may lie past the end of the file, where the
+	// mapping cannot be touched, and the shared mapping sees the write either way.
+	if (compressed && pageNum != 0)
+	{
+		return writeCompressedPage(pageNum, data);
+	}
+
+	if (backend != StdioBackend)
+	{
+		return pwrite(fd, data, pageSize, (off_t)pageNum * pageSize) == (ssize_t)pageSize ? 0 : -1;
+	}
+
+	fseek(file, (long)pageNum * pageSize, SEEK_SET);
+	return fwrite(data, 1, pageSize, file) == pageSize ? 0 : -1;
+}
+
+RC PagedFile::readPhysicalPages(const PageNum &pageNum, const unsigned &count, void **data)
+{
+	// Compressed slots are not the size of a page, so they are read one by one.
+	if (backend != PositionalBackend || compressed)
+	{
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (readPhysicalPage(pageNum + i, data[i]) != 0)
+			{
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	struct iovec iov[MAX_VECTORED_PAGES];
+	for (unsigned i = 0; i < count; i += MAX_VECTORED_PAGES)
+	{
+		unsigned n = min(count - i, (unsigned)MAX_VECTORED_PAGES);
+		for (unsigned j = 0; j < n; j++)
+		{
+			iov[j].iov_base = data[i + j];
+			iov[j].iov_len = pageSize;
+		}
+		if (preadv(fd, iov, n, (off_t)(pageNum + i) * pageSize) != (ssize_t)n * pageSize)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+RC PagedFile::writePhysicalPages(const PageNum &pageNum, const unsigned &count, const void **data)
+{
+	// As with single pages, mapped files are written through the descriptor.
+	if (backend == StdioBackend || compressed)
+	{
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (writePhysicalPage(pageNum + i, data[i]) != 0)
+			{
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	struct iovec iov[MAX_VECTORED_PAGES];
+	for (unsigned i = 0; i < count; i += MAX_VECTORED_PAGES)
+	{
+		unsigned n = min(count - i, (unsigned)MAX_VECTORED_PAGES);
+		for (unsigned j = 0; j < n; j++)
+		{
+			iov[j].iov_base = (void *)data[i + j];
+			iov[j].iov_len = pageSize;
+		}
+		if (pwritev(fd, iov, n, (off_t)(pageNum + i) * pageSize) != (ssize_t)n * pageSize)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+RC PagedFile::readCompressedPage(const PageNum &pageNum, void *data)
+{
+	PageMapEntry entry;
+	{
+		lock_guard<mutex> lock(pageMapMutex);
+		if (pageNum >= pageMap.size() || pageMap[pageNum].length == 0)
+		{
+			return -1;
+		}
+		entry = pageMap[pageNum];
+	}
+
+	if (entry.length == pageSize)
+	{
+		return pread(fd, data, pageSize, entry.offset) == (ssize_t)pageSize ? 0 : -1;
+	}
+
+	char slot[MAX_PAGE_SIZE];
+	if (pread(fd, slot, entry.length, entry.offset) != (ssize_t)entry.length)
+	{
+		return -1;
+	}
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	RC rc = decompressPage(slot, entry.length, data, pageSize);
+	unsigned long long elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+	lock_guard<mutex> lock(pageMapMutex);
+	decompressedPageCounter++;
+	decompressTime += elapsed;
+	return rc;
+}
+
+RC PagedFile::writeCompressedPage(const PageNum &pageNum, const void *data)
+{
+	// A page that does not shrink is stored as it is.
+	char slot[MAX_PAGE_SIZE];
+	const void *source = slot;
+	unsigned length = compressPage(data, pageSize, slot, pageSize - 1);
+	if (length == 0)
+	{
+		source = data;
+		length = pageSize;
+	}
+
+	unsigned long long offset = 0;
+	{
+		lock_guard<mutex> lock(pageMapMutex);
+		if (pageNum >= pageMap.size())
+		{
+			PageMapEntry unwritten = { 0, 0, 0 };
+			pageMap.resize(pageNum + 1, unwritten);
+		}
+
+		PageMapEntry &entry = pageMap[pageNum];
+		if (entry.capacity < length)
+		{
+			entry.offset = compressedEnd;
+			entry.capacity = (length + COMPRESSED_SLOT_ALIGNMENT - 1) / COMPRESSED_SLOT_ALIGNMENT * COMPRESSED_SLOT_ALIGNMENT;
+			compressedEnd += entry.capacity;
+		}
+		entry.length = length;
+		offset = entry.offset;
+		pageMapDirty = true;
+	}
+
+	return pwrite(fd, source, length, offset) == (ssize_t)length ? 0 : -1;
+}
+
+RC PagedFile::loadPageMap()
+{
+	pageMap.clear();
+	pageMapDirty = false;
+	compressedEnd = pageSize;
+	decompressedPageCounter = 0;
+	decompressTime = 0;
+
+	// A file with no map has had no page written besides its header.
+	int mapFd = ::open((fileName + PAGE_MAP_FILE_SUFFIX).c_str(), O_RDONLY);
+	if (mapFd < 0)
+	{
+		return 0;
+	}
+
+	struct stat mapInfo;
+	int error = fstat(mapFd, &mapInfo);
+	if (error == 0)
+	{
+		pageMap.resize(mapInfo.st_size / sizeof(PageMapEntry));
+		ssize_t size = pageMap.size() * sizeof(PageMapEntry);
+		error = pread(mapFd, pageMap.data(), size, 0) == size ? 0 : -1;
+	}
+	::close(mapFd);
+
+	// Slots written after the map was last saved are not in it, and their space is used again.
+	for (unsigned i = 0; i < pageMap.size(); i++)
+	{
+		compressedEnd = max(compressedEnd, pageMap[i].offset + pageMap[i].capacity);
+	}
+
+	return error;
+}
+
+RC PagedFile::savePageMap(const bool &sync)
+{
+	lock_guard<mutex> lock(pageMapMutex);
+	if (!pageMapDirty && !sync)
+	{
+		return 0;
+	}
+
+	int mapFd = ::open((fileName + PAGE_MAP_FILE_SUFFIX).c_str(), O_WRONLY | O_CREAT, 0644);
+	if (mapFd < 0)
+	{
+		return -1;
+	}
+
+	// The map only grows, so every entry is overwritten where it was.
+	ssize_t size = pageMap.size() * sizeof(PageMapEntry);
+	int error = pwrite(mapFd, pageMap.data(), size, 0) == size ? 0 : -1;
+	if (sync && fdatasync(mapFd) != 0)
+	{
+		error = -1;
+	}
+	if (::close(mapFd) != 0)
+	{
+		error = -1;
+	}
+
+	pageMapDirty = pageMapDirty && error != 0;
+	return error;
+}
+
+PagedFileManager::PagedFileManager()
+{
+	readAheadManager = new ReadAheadManager(READ_AHEAD_THREADS, READ_AHEAD_CAPACITY);
+	bufferManager = new BufferManager(BUFFER_POOL_SIZE, readAheadManager);
+	logWriter = new LogWriter();
+	pageWriter = new PageWriter(bufferManager);
+	nextFileId = 0;
+	ioBackend = DEFAULT_IO_BACKEND;
+	readAheadDepth = DEFAULT_READ_AHEAD_DEPTH;
+	commitMode = DEFAULT_COMMIT_MODE;
+	extentSize = DEFAULT_EXTENT_SIZE;
+	writeBackRate = DEFAULT_WRITE_BACK_RATE;
+	pageWriter->setRate(writeBackRate);
+	compression = false;
+}
+
+PagedFileManager::~PagedFileManager()
+{
+	flushAllFiles();
+	delete pageWriter;
+	delete bufferManager;
+	delete readAheadManager;
+	delete logWriter;
+}
+
+BufferManager *PagedFileManager::getBufferManager()
+{
+	return bufferManager;
+}
+
+ReadAheadManager *PagedFileManager::getReadAheadManager()
+{
+	return readAheadManager;
+}
+
+RC PagedFileManager::setReadAheadDepth(const unsigned depth)
+{
+	readAheadDepth = min(depth, (unsigned)READ_AHEAD_CAPACITY);
+	return 0;
+}
+
+unsigned PagedFileManager::getReadAheadDepth()
+{
+	return readAheadDepth;
+}
+
+RC PagedFileManager::setIOBackend(const IOBackend backend)
+{
+	ioBackend = backend;
+	return 0;
+}
+
+IOBackend PagedFileManager::getIOBackend()
+{
+	return ioBackend;
+}
+
+RC PagedFileManager::setCommitMode(const CommitMode commitMode)
+{
+	this->commitMode = commitMode;
+	return 0;
+}
+
+CommitMode PagedFileManager::getCommitMode()
+{
+	return commitMode;
+}
+
+RC PagedFileManager::setExtentSize(const unsigned extentSize)
+{
+	this->extentSize = extentSize;
+	return 0;
+}
+
+unsigned PagedFileManager::getExtentSize()
+{
+	return extentSize;
+}
+
+RC PagedFileManager::setWriteBackRate(const unsigned rate)
+{
+	writeBackRate = rate;
+	return pageWriter->setRate(rate);
+}
+
+unsigned PagedFileManager::getWriteBackRate()
+{
+	return writeBackRate;
+}
+
+RC PagedFileManager::setCompression(const bool compressed)
+{
+	compression = compressed;
+	return 0;
+}
+
+bool PagedFileManager::getCompression()
+{
+	return compression;
+}
+
+RC PagedFileManager::releasePagedFile(const string &fileName)
+{
+	map<string, PagedFile *>::iterator it = pagedFiles.find(fileName);
+	if (it != pagedFiles.end())
+	{
+		readAheadManager->discardFile(it->second);
+		bufferManager->discardFile(it->second);
+		if (it->second->openCount == 0)
+		{
+			delete it->second;
+		}
+		pagedFiles.erase(it);
+	}
+
+	return 0;
+}
+
+RC PagedFileManager::flushAllFiles()
+{
+	int error = 0;
+	map<string, PagedFile *>::iterator it;
+	for (it = pagedFiles.begin(); it != pagedFiles.end(); it++)
+	{
+		if (isFileOpen(it->second))
+		{
+			error += bufferManager->flushFile(it->second);
+			error += it->second->flush();
+		}
+	}
+
+	return error == 0 ? 0 : -1;
+}
+
+RC PagedFileManager::createFile(const string &fileName)
+{
+	return createFile(fileName, PAGE_SIZE);
+}
+
+RC PagedFileManager::createFile(const string &fileName, const unsigned pageSize)
+{
+	return createFile(fileName, pageSize, 0);
+}
+
+RC PagedFileManager::createFile(const string &fileName, const unsigned pageSize, const unsigned recordFormat)
+{
+	// Page sizes are powers of two from PAGE_SIZE up to what 2-byte page offsets can address.
+	if (pageSize < PAGE_SIZE || pageSize > MAX_PAGE_SIZE || (pageSize & (pageSize - 1)) != 0)
+	{
+		return -1;
+	}
+
+	if (!doesFileExist(fileName))
+	{
+		FILE *newFile;
+		newFile = fopen(fileName.c_str(), "wb");
+
+		if (newFile != NULL)
+		{
+			releasePagedFile(fileName);
+			remove((fileName + WAL_FILE_SUFFIX).c_str());
+			remove((fileName + PAGE_MAP_FILE_SUFFIX).c_str());
+
+			void *metaPage = malloc(pageSize);
+			memset(metaPage, 0, pageSize);
+			memcpy((char *)metaPage + HEADER_PAGE_SIZE_OFFSET, &pageSize, sizeof(unsigned));
+			unsigned compressed = compression ? 1 : 0;
+			memcpy((char *)metaPage + HEADER_COMPRESSION_OFFSET, &compressed, sizeof(unsigned));
+			memcpy((char *)metaPage + HEADER_RECORD_FORMAT_OFFSET, &recordFormat, sizeof(unsigned));
+			unsigned formatVersion = PAGED_FILE_FORMAT_VERSION;
+			memcpy((char *)metaPage + HEADER_FORMAT_VERSION_OFFSET, &formatVersion, sizeof(unsigned));
+			fseek(newFile, 0, SEEK_END);
+			fwrite(metaPage, 1, pageSize, newFile);
+			fflush(newFile);
+			// Recovery reads the page size from the header, so a logged file needs it on disk.
+			if (commitMode != NoLogging)
+			{
+				fsync(fileno(newFile));
+			}
+			fclose(newFile);
+			free(metaPage);
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+RC PagedFileManager::destroyFile(const string &fileName)
+{
+	if (doesFileExist(fileName))
+	{
+		releasePagedFile(fileName);
+		remove((fileName + WAL_FILE_SUFFIX).c_str());
+		remove((fileName + PAGE_MAP_FILE_SUFFIX).c_str());
+		return remove(fileName.c_str());
+	}
+
+	return -1;
+}
+
+RC PagedFileManager::openFile(const string &fileName, FileHandle &fileHandle)
+{
+	if (fileHandle.pagedFile != NULL)
+	{
+		return -1;
+	}
+
+	if (doesFileExist(fileName))
+	{
+		PagedFile *pagedFile;
+		map<string, PagedFile *>::iterator it = pagedFiles.find(fileName);
+		if (it != pagedFiles.end())
+		{
+			pagedFile = it->second;
+		}
+		else
+		{
+			// Before this process first opens the file, whatever a crash left in its log is redone.
+			if (recoverFile(fileName) != 0)
+			{
+				return -1;
+			}
+			pagedFile = new PagedFile(fileName, nextFileId++);
+			pagedFiles[fileName] = pagedFile;
+		}
+
+		// Handles opened while the file is already open share its descriptor, backend and page count.
+		if (!isFileOpen(pagedFile))
+		{
+			// The kernel writes a shared mapping back whenever it likes, out of the log's order, so logged files are not mapped.
+			IOBackend backend = ioBackend == MappedBackend && commitMode != NoLogging ? PositionalBackend : ioBackend;
+			pagedFile->extentSize = extentSize;
+			if (pagedFile->open(backend) != 0)
+			{
+				return -1;
+			}
+
+			// Nothing of this file can be dirty in the pool yet, so the header is read straight from disk.
+			// Its fields all sit in the first PAGE_SIZE bytes, which every file has whatever its page size.
+			void *metaPage = malloc(PAGE_SIZE);
+			pagedFile->pageSize = PAGE_SIZE;
+			if (pagedFile->readPhysicalPage(0, metaPage) != 0)
+			{
+				free(metaPage);
+				pagedFile->close();
+				return -1;
+			}
+			unsigned compressed = 0, formatVersion = 0;
+			memcpy(&pagedFile->numberOfPages, (char *)metaPage + HEADER_PAGE_COUNT_OFFSET, sizeof(unsigned));
+			memcpy(&pagedFile->pageSize, (char *)metaPage + HEADER_PAGE_SIZE_OFFSET, sizeof(unsigned));
+			memcpy(&compressed, (char *)metaPage + HEADER_COMPRESSION_OFFSET, sizeof(unsigned));
+			memcpy(&pagedFile->recordFormat, (char *)metaPage + HEADER_RECORD_FORMAT_OFFSET, sizeof(unsigned));
+			memcpy(&formatVersion, (char *)metaPage + HEADER_FORMAT_VERSION_OFFSET, sizeof(unsigned));
+			unsigned long long redoLSN = 0;
+			memcpy(&redoLSN, (char *)metaPage + HEADER_REDO_LSN_OFFSET, sizeof(redoLSN));
+			pagedFile->redoLSN = redoLSN;
+			free(metaPage);
+
+			// Files of another layout, such as those with a data page right after every other and 0 here,
+			// would be read at the wrong pages, so they are not opened.
+			if (formatVersion != PAGED_FILE_FORMAT_VERSION)
+			{
+				pagedFile->close();
+				return -1;
+			}
+
+			// Compressed slots are read and written with pread/pwrite, whatever the backend asked for.
+			pagedFile->compressed = compressed != 0;
+			if (pagedFile->compressed && backend != PositionalBackend &&
+				(pagedFile->close() != 0 || pagedFile->open(PositionalBackend) != 0))
+			{
+				return -1;
+			}
+			if (pagedFile->compressed && pagedFile->loadPageMap() != 0)
+			{
+				pagedFile->close();
+				return -1;
+			}
+
+			if (openLog(pagedFile) != 0)
+			{
+				pagedFile->close();
+				return -1;
+			}
+			pageWriter->addFile(pagedFile);
+		}
+		pagedFile->openCount++;
+
+		fileHandle.pagedFile = pagedFile;
+		fileHandle.bufferHitCounter = 0;
+		fileHandle.bufferMissCounter = 0;
+		return fileHandle.readMetadata();
+	}
+
+	return -1;
+}
+
+RC PagedFileManager::closeFile(FileHandle &fileHandle)
+{
+	PagedFile *pagedFile = fileHandle.pagedFile;
+	if (!isFileOpen(pagedFile))
+	{
+		return -1;
+	}
+
+	fileHandle.updateMetadata();
+	int error = bufferManager->flushFile(pagedFile);
+	fileHandle.pagedFile = NULL;
+
+	if (pagedFile->flush() != 0)
+	{
+		error = -1;
+	}
+
+	if (--pagedFile->openCount == 0)
+	{
+		pageWriter->removeFile(pagedFile);
+		readAheadManager->discardFile(pagedFile);
+		if (closeLog(pagedFile) != 0)
+		{
+			error = -1;
+		}
+
+		if (pagedFile->close() != 0)
+		{
+			error = -1;
+		}
+
+		map<string, PagedFile *>::iterator it = pagedFiles.find(pagedFile->fileName);
+		if (it == pagedFiles.end() || it->second != pagedFile)
+		{
+			delete pagedFile;
+		}
+	}
+
+	return error == 0 ? 0 : -1;
+}
+
+RC PagedFileManager::recoverFile(const string &fileName)
+{
+	string logFileName = fileName + WAL_FILE_SUFFIX;
+	int logFd = ::open(logFileName.c_str(), O_RDONLY);
+	if (logFd < 0)
+	{
+		return 0;
+	}
+
+	int fd = ::open(fileName.c_str(), O_RDWR);
+	unsigned pageSize = 0;
+	unsigned long long redoLSN = 0;
+	if (fd < 0 || pread(fd, &pageSize, sizeof(unsigned), HEADER_PAGE_SIZE_OFFSET) != sizeof(unsigned) ||
+		pread(fd, &redoLSN, sizeof(redoLSN), HEADER_REDO_LSN_OFFSET) != sizeof(redoLSN))
+	{
+		::close(logFd);
+		if (fd >= 0)
+		{
+			::close(fd);
+		}
+		return -1;
+	}
+	pageSize = pageSize == 0 ? PAGE_SIZE : pageSize;
+
+	// Records hold page bytes, not operations, so redoing one that already reached the disk changes
+	// nothing. Replay starts at the redo LSN, the records before it are in the file or punched out
+	// of the log, and stops at the first record a crash left incomplete.
+	int error = 0;
+	LogRecordHeader header;
+	vector<char> data;
+	unsigned long long position = redoLSN;
+	while (pread(logFd, &header, sizeof(LogRecordHeader), position) == sizeof(LogRecordHeader))
+	{
+		if (header.offset >= pageSize || header.length > pageSize - header.offset ||
+			header.lsn != position + sizeof(LogRecordHeader) + header.length)
+		{
+			break;
+		}
+
+		data.resize(header.length);
+		if (pread(logFd, data.data(), header.length, position + sizeof(LogRecordHeader)) != (ssize_t)header.length ||
+			computeLogChecksum(header, data.data()) != header.checksum)
+		{
+			break;
+		}
+
+		if (pwrite(fd, data.data(), header.length, (off_t)header.pageNum * pageSize + header.offset) != (ssize_t)header.length)
+		{
+			error = -1;
+			break;
+		}
+		position = header.lsn;
+	}
+
+	// The next log starts at LSN 0 again, so the stamp goes back to 0 before this one is removed.
+	// A header page redone from the log may have brought back an older stamp.
+	::close(logFd);
+	if (error == 0 && fdatasync(fd) != 0)
+	{
+		error = -1;
+	}
+	unsigned long long stamp = 0;
+	if (error == 0 && position != 0 &&
+		(pwrite(fd, &stamp, sizeof(stamp), HEADER_REDO_LSN_OFFSET) != sizeof(stamp) || fdatasync(fd) != 0))
+	{
+		error = -1;
+	}
+	::close(fd);
+
+	return error == 0 ? remove(logFileName.c_str()) : -1;
+}
+
+RC PagedFileManager::openLog(PagedFile *pagedFile)
+{
+	// Compressed files are never logged: a redo record could not be applied inside a compressed slot.
+	string logFileName = pagedFile->fileName + WAL_FILE_SUFFIX;
+	pagedFile->commitMode = pagedFile->compressed ? NoLogging : commitMode;
+	if (pagedFile->commitMode == NoLogging)
+	{
+		// A log left by an earlier open in this process would redo old page images over unlogged changes.
+		if (doesFileExist(logFileName) &&
+			(pagedFile->sync() != 0 || pagedFile->stampRedoLSN(0) != 0 || remove(logFileName.c_str()) != 0))
+		{
+			return -1;
+		}
+		return 0;
+	}
+
+	pagedFile->log = new WriteAheadLog(logFileName);
+	if (pagedFile->log->open() != 0)
+	{
+		delete pagedFile->log;
+		pagedFile->log = NULL;
+		return -1;
+	}
+
+	if (pagedFile->commitMode == GroupCommit)
+	{
+		logWriter->addLog(pagedFile->log);
+	}
+	return 0;
+}
+
+RC PagedFileManager::closeLog(PagedFile *pagedFile)
+{
+	// The file's dirty pages have been written back, which made every record durable.
+	WriteAheadLog *log = pagedFile->log;
+	if (log == NULL)
+	{
+		return 0;
+	}
+
+	logWriter->removeLog(log);
+	int error = 0;
+	if (log->getAppendedLSN() - pagedFile->redoLSN > WAL_CHECKPOINT_SIZE)
+	{
+		error += pagedFile->checkpoint();
+	}
+	error += log->close();
+
+	delete log;
+	pagedFile->log = NULL;
+	return error == 0 ? 0 : -1;
+}
+
+BufferManager::BufferManager(const unsigned numberOfFrames, ReadAheadManager *readAheadManager)
+{
+	this->readAheadManager = readAheadManager;
+	this->numberOfFrames = numberOfFrames;
+	clockHand = 0;
+	// calloc leaves the unused tail of frames holding small pages untouched.
+	pool = calloc(numberOfFrames, MAX_PAGE_SIZE);
+
+	frames.resize(numberOfFrames);
+	for (unsigned i = 0; i < numberOfFrames; i++)
+	{
+		frames[i].pagedFile = NULL;
+		frames[i].pageNum = 0;
+		frames[i].pinCount = 0;
+		frames[i].dirty = false;
+		frames[i].referenced = false;
+		frames[i].pageLSN = 0;
+		frames[i].recoveryLSN = ULLONG_MAX;
+		frames[i].data = (char *)pool + ((size_t)i * MAX_PAGE_SIZE);
+	}
+}
+
+BufferManager::~BufferManager()
+{
+	free(pool);
+}
+
+RC BufferManager::writeFrame(BufferFrame &frame)
+{
+	if (!frame.dirty)
+	{
+		return 0;
+	}
+
+	PagedFile *pagedFile = frame.pagedFile;
+	if (!isFileOpen(pagedFile))
+	{
+		return -1;
+	}
+
+	// Dirty neighbours nobody has pinned go out in the same write, so a run of
+	// appended or updated pages costs one pwritev instead of one pwrite per page.
+	PageNum firstPageNum = frame.pageNum;
+	while (firstPageNum > 0 && frame.pageNum - firstPageNum + 1 < MAX_VECTORED_PAGES)
+	{
+		BufferFrame *neighbour = lookupFrame(pagedFile, firstPageNum - 1);
+		if (neighbour == NULL || !neighbour->dirty || neighbour->pinCount > 0)
+		{
+			break;
+		}
+		firstPageNum--;
+	}
+
+	vector<BufferFrame *> run;
+	vector<const void *> data;
+	unsigned long long pageLSN = 0;
+	for (PageNum pageNum = firstPageNum; run.size() < MAX_VECTORED_PAGES; pageNum++)
+	{
+		BufferFrame *neighbour = pageNum == frame.pageNum ? &frame : lookupFrame(pagedFile, pageNum);
+		if (neighbour != &frame && (neighbour == NULL || !neighbour->dirty || neighbour->pinCount > 0))
+		{
+			break;
+		}
+		run.push_back(neighbour);
+		data.push_back(neighbour->data);
+		pageLSN = max(pageLSN, neighbour->pageLSN);
+	}
+
+	// Write-ahead: the records of the pages' changes reach the disk before the pages do.
+	if (pagedFile->log != NULL && pagedFile->log->flush(pageLSN) != 0)
+	{
+		return -1;
+	}
+
+	// The header page goes out with the latest redo LSN, whatever was copied over it since.
+	if (firstPageNum == 0)
+	{
+		unsigned long long redoLSN = pagedFile->redoLSN;
+		memcpy((char *)run[0]->data + HEADER_REDO_LSN_OFFSET, &redoLSN, sizeof(redoLSN));
+	}
+
+	if (pagedFile->writePhysicalPages(firstPageNum, run.size(), data.data()) != 0)
+	{
+		return -1;
+	}
+
+	for (unsigned i = 0; i < run.size(); i++)
+	{
+		readAheadManager->discardPage(pagedFile, run[i]->pageNum);
+		setDirty(*run[i], false);
+		run[i]->recoveryLSN = ULLONG_MAX;
+	}
+
+	return 0;
+}
+
+void BufferManager::setDirty(BufferFrame &frame, const bool &dirty)
+{
+	if (frame.dirty != dirty)
+	{
+		dirty ? frame.pagedFile->dirtyPageCounter++ : frame.pagedFile->dirtyPageCounter--;
+		frame.dirty = dirty;
+	}
+}
+
+RC BufferManager::findVictim(unsigned &frameNum)
+{
+	// Two full sweeps: the first clears reference bits, the second must find an unpinned frame.
+	for (unsigned i = 0; i < 2 * numberOfFrames; i++)
+	{
+		BufferFrame &frame = frames[clockHand];
+		unsigned current = clockHand;
+		clockHand = (clockHand + 1) % numberOfFrames;
+
+		if (frame.pinCount > 0)
+		{
+			continue;
+		}
+
+		if (frame.referenced)
+		{
+			frame.referenced = false;
+			continue;
+		}
+
+		if (frame.pagedFile != NULL)
+		{
+			if (writeFrame(frame) != 0)
+			{
+				continue;
+			}
+			pageTable.erase(getPageKey(frame.pagedFile->fileId, frame.pageNum));
+			frame.pagedFile = NULL;
+		}
+
+		frameNum = current;
+		return 0;
+	}
+
+	return -1;
+}
+
+BufferFrame *BufferManager::findFrame(PagedFile *pagedFile, const PageNum &pageNum)
+{
+	lock_guard<mutex> lock(poolMutex);
+	return lookupFrame(pagedFile, pageNum);
+}
+
+RC BufferManager::logPageChange(PagedFile *pagedFile, const PageNum &pageNum, const unsigned &offset, const void *data, const unsigned &length)
+{
+	// Appending with the pool locked keeps a checkpoint from seeing a record whose page does not list it yet.
+	lock_guard<mutex> lock(poolMutex);
+	BufferFrame *frame = lookupFrame(pagedFile, pageNum);
+	if (frame == NULL)
+	{
+		return -1;
+	}
+
+	if (frame->recoveryLSN == ULLONG_MAX)
+	{
+		frame->recoveryLSN = pagedFile->log->getAppendedLSN();
+	}
+	frame->pageLSN = pagedFile->log->append(pageNum, offset, data, length);
+	return 0;
+}
+
+BufferFrame *BufferManager::lookupFrame(PagedFile *pagedFile, const PageNum &pageNum)
+{
+	unordered_map<unsigned long long, unsigned>::iterator it = pageTable.find(getPageKey(pagedFile->fileId, pageNum));
+	return it != pageTable.end() ? &frames[it->second] : NULL;
+}
+
+RC BufferManager::pinPage(PagedFile *pagedFile, const PageNum &pageNum, const bool &readFromDisk, BufferFrame *&frame, bool &hit)
+{
+	lock_guard<mutex> lock(poolMutex);
+	frame = lookupFrame(pagedFile, pageNum);
+	if (frame != NULL)
+	{
+		hit = true;
+		frame->pinCount++;
+		frame->referenced = true;
+		return 0;
+	}
+
+	hit = false;
+	unsigned frameNum = 0;
+	if (findVictim(frameNum) != 0)
+	{
+		return -1;
+	}
+
+	// A page read ahead is current as long as it was not written since, writes discard it.
+	frame = &frames[frameNum];
+	if (!readFromDisk)
+	{
+		readAheadManager->discardPage(pagedFile, pageNum);
+	}
+	else if (!readAheadManager->takePage(pagedFile, pageNum, frame->data) && pagedFile->readPhysicalPage(pageNum, frame->data) != 0)
+	{
+		frame = NULL;
+		return -1;
+	}
+
+	frame->pagedFile = pagedFile;
+	frame->pageNum = pageNum;
+	frame->pinCount = 1;
+	frame->dirty = false;
+	frame->referenced = true;
+	frame->pageLSN = 0;
+	frame->recoveryLSN = ULLONG_MAX;
+	pageTable[getPageKey(pagedFile->fileId, pageNum)] = frameNum;
+	return 0;
+}
+
+RC BufferManager::unpinPage(BufferFrame *frame, const bool &isDirty)
+{
+	lock_guard<mutex> lock(poolMutex);
+	if (frame == NULL || frame->pinCount == 0)
+	{
+		return -1;
+	}
+
+	frame->pinCount--;
+	if (isDirty)
+	{
+		setDirty(*frame, true);
+	}
+	return 0;
+}
+
+RC BufferManager::readResidentPage(PagedFile *pagedFile, const PageNum &pageNum, void *data)
+{
+	lock_guard<mutex> lock(poolMutex);
+	BufferFrame *frame = lookupFrame(pagedFile, pageNum);
+	if (frame == NULL)
+	{
+		return -1;
+	}
+
+	memcpy(data, frame->data, pagedFile->pageSize);
+	frame->referenced = true;
+	return 0;
+}
+
+RC BufferManager::writeResidentPage(PagedFile *pagedFile, const PageNum &pageNum, const void *data)
+{
+	lock_guard<mutex> lock(poolMutex);
+	BufferFrame *frame = lookupFrame(pagedFile, pageNum);
+	if (frame == NULL)
+	{
+		return -1;
+	}
+
+	memcpy(frame->data, data, pagedFile->pageSize);
+	frame->referenced = true;
+	setDirty(*frame, true);
+	return 0;
+}
+
+RC BufferManager::flushFile(PagedFile *pagedFile)
+{
+	lock_guard<mutex> lock(poolMutex);
+	return writeFile(pagedFile);
+}
+
+RC BufferManager::writeFile(PagedFile *pagedFile)
+{
+	// Write back in page order so the file is written sequentially.
+	vector<pair<PageNum, unsigned>> dirtyFrames;
+	for (unsigned i = 0; i < numberOfFrames; i++)
+	{
+		if (frames[i].pagedFile == pagedFile && frames[i].dirty)
+		{
+			dirtyFrames.push_back(make_pair(frames[i].pageNum, i));
+		}
+	}
+	sort(dirtyFrames.begin(), dirtyFrames.end());
+
+	int error = 0;
+	for (unsigned i = 0; i < dirtyFrames.size(); i++)
+	{
+		error += writeFrame(frames[dirtyFrames[i].second]);
+	}
+
+	return error == 0 ? 0 : -1;
+}
+
+RC BufferManager::discardFile(PagedFile *pagedFile)
+{
+	lock_guard<mutex> lock(poolMutex);
+	for (unsigned i = 0; i < numberOfFrames; i++)
+	{
+		if (frames[i].pagedFile == pagedFile)
+		{
+			pageTable.erase(getPageKey(pagedFile->fileId, frames[i].pageNum));
+			frames[i].pagedFile = NULL;
+			frames[i].pinCount = 0;
+			frames[i].dirty = false;
+			frames[i].referenced = false;
+		}
+	}
+	pagedFile->dirtyPageCounter = 0;
+
+	return 0;
+}
+
+unsigned BufferManager::writeBack(const unsigned maxPages)
+{
+	vector<unsigned long long> keys;
+	{
+		lock_guard<mutex> lock(poolMutex);
+		for (unsigned i = 0; i < numberOfFrames; i++)
+		{
+			if (frames[i].pagedFile != NULL && frames[i].dirty && frames[i].pinCount == 0 && frames[i].pagedFile->backend != StdioBackend)
+			{
+				keys.push_back(getPageKey(frames[i].pagedFile->fileId, frames[i].pageNum));
+			}
+		}
+	}
+	sort(keys.begin(), keys.end());
+
+	// The pool is locked for one run of pages at a time, the foreground gets it back in between.
+	// A page may have been pinned, cleaned or evicted since it was picked, so it is looked up again.
+	unsigned numberOfPagesWritten = 0;
+	for (unsigned i = 0; i < keys.size() && numberOfPagesWritten < maxPages; i++)
+	{
+		lock_guard<mutex> lock(poolMutex);
+		unordered_map<unsigned long long, unsigned>::iterator it = pageTable.find(keys[i]);
+		if (it == pageTable.end())
+		{
+			continue;
+		}
+
+		BufferFrame &frame = frames[it->second];
+		if (!frame.dirty || frame.pinCount > 0)
+		{
+			continue;
+		}
+
+		unsigned dirtyPageCount = frame.pagedFile->dirtyPageCounter;
+		if (writeFrame(frame) == 0)
+		{
+			numberOfPagesWritten += dirtyPageCount - frame.pagedFile->dirtyPageCounter;
+		}
+	}
+
+	return numberOfPagesWritten;
+}
+
+RC BufferManager::checkpointFile(PagedFile *pagedFile)
+{
+	// Changes are logged while their page is pinned. With the pool locked and no page of the file
+	// pinned, nothing can be logged, so once the dirty pages are written the log holds nothing the file needs.
+	lock_guard<mutex> lock(poolMutex);
+	if (pagedFile->log == NULL || pagedFile->backend == StdioBackend || pagedFile->log->getAppendedLSN() == pagedFile->redoLSN)
+	{
+		return 0;
+	}
+
+	// A pinned page may be half way through a change, so it is not written. Once the file is synced,
+	// recovery can still skip every record before the first one a page in the pool has not written yet.
+	bool pinned = false;
+	unsigned long long redoLSN = pagedFile->log->getAppendedLSN();
+	for (unsigned i = 0; i < numberOfFrames; i++)
+	{
+		if (frames[i].pagedFile == pagedFile)
+		{
+			pinned = pinned || frames[i].pinCount > 0;
+			redoLSN = min(redoLSN, frames[i].recoveryLSN);
+		}
+	}
+
+	if (pinned)
+	{
+		return redoLSN > pagedFile->redoLSN ? pagedFile->stampRedoLSN(redoLSN) : 0;
+	}
+
+	if (writeFile(pagedFile) != 0)
+	{
+		return -1;
+	}
+	return pagedFile->checkpoint();
+}
+
+unsigned BufferManager::getNumberOfDirtyPages(PagedFile *pagedFile)
+{
+	lock_guard<mutex> lock(poolMutex);
+	return pagedFile->dirtyPageCounter;
+}
+
+ReadAheadManager::ReadAheadManager(const unsigned numberOfThreads, const unsigned capacity)
+{
+	this->numberOfThreads = numberOfThreads;
+	this->capacity = capacity;
+	stopping = false;
+}
+
+ReadAheadManager::~ReadAheadManager()
+{
+	{
+		unique_lock<mutex> lock(stateMutex);
+		stopping = true;
+		workAvailable.notify_all();
+	}
+
+	for (unsigned i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+
+	unordered_map<unsigned long long, ReadAheadPage *>::iterator it;
+	for (it = pages.begin(); it != pages.end(); it++)
+	{
+		free(it->second->data);
+		delete it->second;
+	}
+}
+
+RC ReadAheadManager::queueRun(shared_ptr<ReadAheadRun> readAheadRun)
+{
+	// Threads are started by the first scan that asks for them.
+	if (threads.empty())
+	{
+		for (unsigned i = 0; i < numberOfThreads; i++)
+		{
+			threads.push_back(thread(&ReadAheadManager::run, this));
+		}
+	}
+
+	runs.push_back(readAheadRun);
+	workAvailable.notify_one();
+	return 0;
+}
+
+RC ReadAheadManager::prefetchPages(PagedFile *pagedFile, const PageNum &pageNum, const unsigned count)
+{
+	unique_lock<mutex> lock(stateMutex);
+	shared_ptr<ReadAheadRun> readAheadRun(new ReadAheadRun());
+	readAheadRun->pagedFile = pagedFile;
+	readAheadRun->pageNum = pageNum;
+	readAheadRun->count = count;
+	readAheadRun->getNextPageNum = NULL;
+	readAheadRun->done = false;
+	readAheadRun->continueWhenDone = false;
+	readAheadRun->cancelled = false;
+	return queueRun(readAheadRun);
+}
+
+RC ReadAheadManager::prefetchChain(PagedFile *pagedFile, const PageNum &pageNum, const unsigned depth, NextPageFunction getNextPageNum)
+{
+	unique_lock<mutex> lock(stateMutex);
+	shared_ptr<ReadAheadRun> readAheadRun(new ReadAheadRun());
+	readAheadRun->pagedFile = pagedFile;
+	readAheadRun->pageNum = pageNum;
+	readAheadRun->count = depth;
+	readAheadRun->getNextPageNum = getNextPageNum;
+	readAheadRun->done = false;
+	readAheadRun->continueWhenDone = false;
+	readAheadRun->cancelled = false;
+	return queueRun(readAheadRun);
+}
+
+void ReadAheadManager::run()
+{
+	unique_lock<mutex> lock(stateMutex);
+	while (!stopping)
+	{
+		if (runs.empty())
+		{
+			workAvailable.wait(lock);
+			continue;
+		}
+
+		shared_ptr<ReadAheadRun> readAheadRun = runs.front();
+		runs.pop_front();
+		activeRuns.push_back(readAheadRun);
+		readRun(readAheadRun, lock);
+		activeRuns.erase(find(activeRuns.begin(), activeRuns.end(), readAheadRun));
+	}
+}
+
+void ReadAheadManager::readRun(shared_ptr<ReadAheadRun> readAheadRun, unique_lock<mutex> &lock)
+{
+	PagedFile *pagedFile = readAheadRun->pagedFile;
+	PageNum pageNum = readAheadRun->pageNum;
+	unsigned i = 0;
+	while (i < readAheadRun->count && pageNum != (PageNum)-1)
+	{
+		if (stopping || readAheadRun->cancelled)
+		{
+			return;
+		}
+
+		PageNum physicalPageNum = getPhysicalPageNum(pageNum);
+		unsigned long long key = getPageKey(pagedFile->fileId, physicalPageNum);
+		unordered_map<unsigned long long, ReadAheadPage *>::iterator it = pages.find(key);
+		if (it == pages.end())
+		{
+			// Consecutive pages not staged yet are read with one call. A chain only
+			// knows its next page once this one is read, so it goes a page at a time.
+			vector<unsigned long long> keys;
+			vector<void *> data;
+			while (i + keys.size() < readAheadRun->count && keys.size() < MAX_VECTORED_PAGES &&
+				   (keys.empty() || (readAheadRun->getNextPageNum == NULL &&
+				   getPhysicalPageNum(pageNum + keys.size()) == physicalPageNum + keys.size() &&
+				   pages.find(getPageKey(pagedFile->fileId, physicalPageNum + keys.size())) == pages.end())))
+			{
+				if (!makeRoom())
+				{
+					break;
+				}
+
+				ReadAheadPage *page = new ReadAheadPage();
+				page->pagedFile = pagedFile;
+				page->pageNum = physicalPageNum + keys.size();
+				page->ready = false;
+				page->data = malloc(pagedFile->pageSize);
+				if (readAheadRun->getNextPageNum != NULL && i == readAheadRun->count / 2)
+				{
+					page->run = readAheadRun;
+				}
+				keys.push_back(getPageKey(pagedFile->fileId, page->pageNum));
+				data.push_back(page->data);
+				pages.insert(make_pair(keys.back(), page));
+			}
+
+			if (keys.empty())
+			{
+				break;
+			}
+
+			// The read itself runs unlocked, the pages are marked as being read so nobody reads them twice.
+			lock.unlock();
+			RC rc = pagedFile->readPhysicalPages(physicalPageNum, keys.size(), data.data());
+			lock.lock();
+			for (unsigned j = 0; j < keys.size(); j++)
+			{
+				it = pages.find(keys[j]);
+				it->second->ready = true;
+				if (rc != 0 || readAheadRun->cancelled)
+				{
+					dropPage(it);
+				}
+				else
+				{
+					stagingOrder.push_back(keys[j]);
+				}
+			}
+			pageRead.notify_all();
+			if (rc != 0 || readAheadRun->cancelled)
+			{
+				break;
+			}
+			pagedFile->prefetchedPageCounter += keys.size();
+
+			if (readAheadRun->getNextPageNum == NULL)
+			{
+				i += keys.size();
+				pageNum += keys.size();
+				continue;
+			}
+			it = pages.find(key);
+		}
+		else if (readAheadRun->getNextPageNum != NULL)
+		{
+			while (it != pages.end() && !it->second->ready)
+			{
+				pageRead.wait(lock);
+				it = pages.find(key);
+			}
+			if (it == pages.end())
+			{
+				break;
+			}
+		}
+
+		pageNum = readAheadRun->getNextPageNum != NULL ? readAheadRun->getNextPageNum(it->second->data) : pageNum + 1;
+		i++;
+	}
+
+	readAheadRun->pageNum = pageNum;
+	readAheadRun->done = true;
+	if (readAheadRun->continueWhenDone && pageNum != (PageNum)-1 && !readAheadRun->cancelled)
+	{
+		readAheadRun->done = false;
+		readAheadRun->continueWhenDone = false;
+		runs.push_back(readAheadRun);
+	}
+}
+
+bool ReadAheadManager::makeRoom()
+{
+	// Pages no scan came back for are dropped oldest first.
+	while (pages.size() >= capacity && !stagingOrder.empty())
+	{
+		unordered_map<unsigned long long, ReadAheadPage *>::iterator it = pages.find(stagingOrder.front());
+		stagingOrder.pop_front();
+		if (it != pages.end() && it->second->ready)
+		{
+			dropPage(it);
+		}
+	}
+
+	return pages.size() < capacity;
+}
+
+void ReadAheadManager::dropPage(unordered_map<unsigned long long, ReadAheadPage *>::iterator it)
+{
+	free(it->second->data);
+	delete it->second;
+	pages.erase(it);
+}
+
+bool ReadAheadManager::takePage(PagedFile *pagedFile, const PageNum &pageNum, void *data)
+{
+	unique_lock<mutex> lock(stateMutex);
+	unsigned long long key = getPageKey(pagedFile->fileId, pageNum);
+	unordered_map<unsigned long long, ReadAheadPage *>::iterator it = pages.find(key);
+	while (it != pages.end() && !it->second->ready)
+	{
+		pageRead.wait(lock);
+		it = pages.find(key);
+	}
+
+	if (it == pages.end())
+	{
+		return false;
+	}
+
+	memcpy(data, it->second->data, pagedFile->pageSize);
+	pagedFile->prefetchHitCounter++;
+
+	// The scan has reached the middle of a chained run, time to read the next one.
+	shared_ptr<ReadAheadRun> readAheadRun = it->second->run;
+	if (readAheadRun && !readAheadRun->cancelled)
+	{
+		if (!readAheadRun->done)
+		{
+			readAheadRun->continueWhenDone = true;
+		}
+		else if (readAheadRun->pageNum != (PageNum)-1)
+		{
+			readAheadRun->done = false;
+			queueRun(readAheadRun);
+		}
+	}
+
+	dropPage(it);
+	return true;
+}
+
+RC ReadAheadManager::discardPage(PagedFile *pagedFile, const PageNum &pageNum)
+{
+	unique_lock<mutex> lock(stateMutex);
+	unsigned long long key = getPageKey(pagedFile->fileId, pageNum);
+	unordered_map<unsigned long long, ReadAheadPage *>::iterator it = pages.find(key);
+	while (it != pages.end() && !it->second->ready)
+	{
+		pageRead.wait(lock);
+		it = pages.find(key);
+	}
+
+	if (it != pages.end())
+	{
+		dropPage(it);
+	}
+
+	return 0;
+}
+
+RC ReadAheadManager::discardFile(PagedFile *pagedFile)
+{
+	unique_lock<mutex> lock(stateMutex);
+	for (unsigned i = 0; i < activeRuns.size(); i++)
+	{
+		if (activeRuns[i]->pagedFile == pagedFile)
+		{
+			activeRuns[i]->cancelled = true;
+		}
+	}
+
+	for (deque<shared_ptr<ReadAheadRun>>::iterator it = runs.begin(); it != runs.end();)
+	{
+		if ((*it)->pagedFile == pagedFile)
+		{
+			(*it)->cancelled = true;
+			it = runs.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+
+	// Reads still in flight use the file's descriptor, so they finish before the file can be closed.
+	bool reading = true;
+	while (reading)
+	{
+		reading = false;
+		unordered_map<unsigned long long, ReadAheadPage *>::iterator it;
+		for (it = pages.begin(); it != pages.end();)
+		{
+			if (it->second->pagedFile != pagedFile)
+			{
+				it++;
+			}
+			else if (!it->second->ready)
+			{
+				reading = true;
+				it++;
+			}
+			else
+			{
+				unordered_map<unsigned long long, ReadAheadPage *>::iterator next = it;
+				next++;
+				dropPage(it);
+				it = next;
+			}
+		}
+
+		if (reading)
+		{
+			pageRead.wait(lock);
+		}
+	}
+
+	return 0;
+}
+
+WriteAheadLog::WriteAheadLog(const string &fileName)
+{
+	this->fileName = fileName;
+	fd = -1;
+	bufferLSN = 0;
+	appendedLSN = 0;
+	durableLSN = 0;
+}
+
+WriteAheadLog::~WriteAheadLog()
+{
+}
+
+RC WriteAheadLog::open()
+{
+	fd = ::open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	// Records kept from an earlier open in this process were made durable when the file was closed.
+	off_t size = lseek(fd, 0, SEEK_END);
+	bufferLSN = size;
+	appendedLSN = size;
+	durableLSN = size;
+	return size >= 0 ? 0 : -1;
+}
+
+RC WriteAheadLog::close()
+{
+	int error = flush(getAppendedLSN());
+	if (::close(fd) != 0)
+	{
+		error = -1;
+	}
+	fd = -1;
+	return error;
+}
+
+unsigned long long WriteAheadLog::append(const PageNum &pageNum, const unsigned &offset, const void *data, const unsigned &length)
+{
+	LogRecordHeader header;
+	header.pageNum = pageNum;
+	header.offset = offset;
+	header.length = length;
+
+	unsigned long long lsn = 0;
+	size_t bufferSize = 0;
+	{
+		lock_guard<mutex> lock(bufferMutex);
+		lsn = appendedLSN + sizeof(LogRecordHeader) + length;
+		header.lsn = lsn;
+		header.checksum = computeLogChecksum(header, data);
+		buffer.insert(buffer.end(), (char *)&header, (char *)&header + sizeof(LogRecordHeader));
+		buffer.insert(buffer.end(), (const char *)data, (const char *)data + length);
+		appendedLSN = lsn;
+		bufferSize = buffer.size();
+	}
+
+	// A full buffer is handed to the kernel without waiting for the disk, the next flush syncs it.
+	if (bufferSize >= WAL_BUFFER_SIZE)
+	{
+		lock_guard<mutex> lock(flushMutex);
+		writeBuffer(false);
+	}
+
+	return lsn;
+}
+
+RC WriteAheadLog::flush(const unsigned long long &lsn)
+{
+	// Group commit: whoever gets the lock syncs everything appended so far, and the commits
+	// that queued up behind it find their records already durable.
+	lock_guard<mutex> lock(flushMutex);
+	if (lsn <= durableLSN)
+	{
+		return 0;
+	}
+
+	return writeBuffer(true);
+}
+
+RC WriteAheadLog::writeBuffer(const bool &sync)
+{
+	vector<char> data;
+	unsigned long long lsn = 0;
+	{
+		lock_guard<mutex> lock(bufferMutex);
+		data.swap(buffer);
+		lsn = bufferLSN;
+		bufferLSN = appendedLSN;
+	}
+
+	if (!data.empty() && pwrite(fd, data.data(), data.size(), lsn) != (ssize_t)data.size())
+	{
+		return -1;
+	}
+
+	if (sync)
+	{
+		if (fdatasync(fd) != 0)
+		{
+			return -1;
+		}
+		durableLSN = lsn + data.size();
+	}
+
+	return 0;
+}
+
+RC WriteAheadLog::discard(const unsigned long long &lsn)
+{
+	// Buffered records are written out first, so the log stays as long as its LSNs say. A file
+	// system that cannot punch holes keeps the records on disk, which only costs space.
+	if (flush(lsn) != 0)
+	{
+		return -1;
+	}
+
+	fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, lsn);
+	return 0;
+}
+
+unsigned long long WriteAheadLog::getAppendedLSN()
+{
+	lock_guard<mutex> lock(bufferMutex);
+	return appendedLSN;
+}
+
+LogWriter::LogWriter()
+{
+	stopping = false;
+}
+
+LogWriter::~LogWriter()
+{
+	{
+		unique_lock<mutex> lock(stateMutex);
+		stopping = true;
+		stopRequested.notify_all();
+	}
+
+	if (writerThread.joinable())
+	{
+		writerThread.join();
+	}
+}
+
+RC LogWriter::addLog(WriteAheadLog *log)
+{
+	// The thread is started by the first file opened with GroupCommit.
+	unique_lock<mutex> lock(stateMutex);
+	if (!writerThread.joinable())
+	{
+		writerThread = thread(&LogWriter::run, this);
+	}
+
+	logs.push_back(log);
+	return 0;
+}
+
+RC LogWriter::removeLog(WriteAheadLog *log)
+{
+	unique_lock<mutex> lock(stateMutex);
+	vector<WriteAheadLog *>::iterator it = find(logs.begin(), logs.end(), log);
+	if (it != logs.end())
+	{
+		logs.erase(it);
+	}
+
+	return 0;
+}
+
+void LogWriter::run()
+{
+	unique_lock<mutex> lock(stateMutex);
+	while (!stopping)
+	{
+		stopRequested.wait_for(lock, chrono::milliseconds(WAL_FLUSH_INTERVAL));
+		for (unsigned i = 0; i < logs.size(); i++)
+		{
+			logs[i]->flush(logs[i]->getAppendedLSN());
+		}
+	}
+}
+
+PageWriter::PageWriter(BufferManager *bufferManager)
+{
+	this->bufferManager = bufferManager;
+	rate = 0;
+	stopping = false;
+}
+
+PageWriter::~PageWriter()
+{
+	{
+		unique_lock<mutex> lock(stateMutex);
+		stopping = true;
+		stopRequested.notify_all();
+	}
+
+	if (writerThread.joinable())
+	{
+		writerThread.join();
+	}
+}
+
+RC PageWriter::addFile(PagedFile *pagedFile)
+{
+	// The thread is started by the first file opened.
+	unique_lock<mutex> lock(stateMutex);
+	if (!writerThread.joinable())
+	{
+		writerThread = thread(&PageWriter::run, this);
+	}
+
+	files.push_back(pagedFile);
+	return 0;
+}
+
+RC PageWriter::removeFile(PagedFile *pagedFile)
+{
+	unique_lock<mutex> lock(stateMutex);
+	vector<PagedFile *>::iterator it = find(files.begin(), files.end(), pagedFile);
+	if (it != files.end())
+	{
+		files.erase(it);
+	}
+
+	return 0;
+}
+
+RC PageWriter::setRate(const unsigned rate)
+{
+	unique_lock<mutex> lock(stateMutex);
+	this->rate = rate;
+	return 0;
+}
+
+void PageWriter::run()
+{
+	// Each round writes at most its share of the rate, so the pool lock and the disk are never held for long.
+	unique_lock<mutex> lock(stateMutex);
+	unsigned sinceCheckpoint = 0;
+	while (!stopping)
+	{
+		stopRequested.wait_for(lock, chrono::milliseconds(WRITE_BACK_INTERVAL));
+		if (stopping || rate == 0 || files.empty())
+		{
+			continue;
+		}
+
+		bufferManager->writeBack(max(rate * WRITE_BACK_INTERVAL / 1000, 1u));
+
+		sinceCheckpoint += WRITE_BACK_INTERVAL;
+		if (sinceCheckpoint >= CHECKPOINT_INTERVAL)
+		{
+			sinceCheckpoint = 0;
+			for (unsigned i = 0; i < files.size(); i++)
+			{
+				bufferManager->checkpointFile(files[i]);
+			}
+		}
+	}
+}
+
+FileHandle::FileHandle()
+{
+	pagedFile = NULL;
+	readPageCounter = 0;
+	writePageCounter = 0;
+	appendPageCounter = 0;
+	bufferHitCounter = 0;
+	bufferMissCounter = 0;
+	lastPinnedPageNum = (PageNum)-1;
+	sequentialPinCount = 0;
+	readAheadPageNum = 0;
+	persistedReadPageCounter = 0;
+	persistedWritePageCounter = 0;
+	persistedAppendPageCounter = 0;
+}
+
+FileHandle::~FileHandle()
+{
+}
+
+RC FileHandle::pinPhysicalPage(const PageNum &physicalPageNum, const bool &readFromDisk, void *&page)
+{
+	// Mapped pages are handed out in place, the kernel caches them instead of the pool.
+	page = pagedFile->getMappedPage(physicalPageNum);
+	if (page != NULL)
+	{
+		return 0;
+	}
+
+	BufferFrame *frame = NULL;
+	bool hit = false;
+	if (PagedFileManager::instance()->getBufferManager()->pinPage(pagedFile, physicalPageNum, readFromDisk, frame, hit) == 0)
+	{
+		hit ? bufferHitCounter++ : bufferMissCounter++;
+		page = frame->data;
+		return 0;
+	}
+
+	return -1;
+}
+
+RC FileHandle::unpinPhysicalPage(const PageNum &physicalPageNum, const bool &isDirty)
+{
+	if (pagedFile->getMappedPage(physicalPageNum) != NULL)
+	{
+		return 0;
+	}
+
+	BufferManager *bufferManager = PagedFileManager::instance()->getBufferManager();
+	return bufferManager->unpinPage(bufferManager->findFrame(pagedFile, physicalPageNum), isDirty);
+}
+
+RC FileHandle::pinPage(PageNum pageNum, void *&page)
+{
+	if (isFileOpen(pagedFile) && (pageNum == (PageNum)-1 || pageNum < getNumberOfPages()))
+	{
+		if (pageNum != (PageNum)-1)
+		{
+			detectSequentialScan(pageNum);
+		}
+
+		if (pinPhysicalPage(getPhysicalPageNum(pageNum), true, page) == 0)
+		{
+			if (pageNum != (PageNum)-1)
+			{
+				readPageCounter++;
+			}
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+RC FileHandle::unpinPage(PageNum pageNum, const bool isDirty)
+{
+	if (isFileOpen(pagedFile) && unpinPhysicalPage(getPhysicalPageNum(pageNum), isDirty) == 0)
+	{
+		if (isDirty && pageNum != (PageNum)-1)
+		{
+			writePageCounter++;
+		}
+		return 0;
+	}
+
+	return -1;
+}
+
+RC FileHandle::detectSequentialScan(const PageNum &pageNum)
+{
+	// A scan pins each page once per record, only moving to the next page counts.
+	if (pageNum == lastPinnedPageNum)
+	{
+		return 0;
+	}
+
+	sequentialPinCount = pageNum == lastPinnedPageNum + 1 ? sequentialPinCount + 1 : 0;
+	lastPinnedPageNum = pageNum;
+
+	unsigned depth = PagedFileManager::instance()->getReadAheadDepth();
+	if (sequentialPinCount < READ_AHEAD_TRIGGER || depth == 0)
+	{
+		return 0;
+	}
+
+	// Keep between half and all of the window in flight ahead of the scan.
+	PageNum endPageNum = min(pageNum + 1 + depth, getNumberOfPages());
+	readAheadPageNum = max(readAheadPageNum, pageNum + 1);
+	if (readAheadPageNum <= pageNum + depth / 2 && readAheadPageNum < endPageNum)
+	{
+		RC rc = prefetchPages(readAheadPageNum, endPageNum - readAheadPageNum);
+		readAheadPageNum = endPageNum;
+		return rc;
+	}
+
+	return 0;
+}
+
+RC FileHandle::prefetchPages(PageNum pageNum, const unsigned count)
+{
+	if (!isFileOpen(pagedFile) || count == 0 || pageNum + count > getNumberOfPages())
+	{
+		return -1;
+	}
+
+	// The kernel reads mapped pages ahead by itself once told about them.
+	void *firstPage = pagedFile->getMappedPage(getPhysicalPageNum(pageNum));
+	void *lastPage = pagedFile->getMappedPage(getPhysicalPageNum(pageNum + count - 1));
+	if (firstPage != NULL && lastPage != NULL)
+	{
+		return madvise(firstPage, (char *)lastPage - (char *)firstPage + pagedFile->pageSize, MADV_WILLNEED) == 0 ? 0 : -1;
+	}
+
+	// A stdio file shares its seek position and buffer with this thread, so it is not read ahead.
+	if (pagedFile->backend == StdioBackend)
+	{
+		return -1;
+	}
+
+	return PagedFileManager::instance()->getReadAheadManager()->prefetchPages(pagedFile, pageNum, count);
+}
+
+RC FileHandle::prefetchPageChain(PageNum pageNum, NextPageFunction getNextPageNum)
+{
+	unsigned depth = PagedFileManager::instance()->getReadAheadDepth();
+	if (!isFileOpen(pagedFile) || pageNum >= getNumberOfPages() || depth == 0 || pagedFile->backend == StdioBackend)
+	{
+		return -1;
+	}
+
+	if (pagedFile->getMappedPage(getPhysicalPageNum(pageNum)) != NULL)
+	{
+		return 0;
+	}
+
+	return PagedFileManager::instance()->getReadAheadManager()->prefetchChain(pagedFile, pageNum, depth, getNextPageNum);
+}
+
+RC FileHandle::readPage(PageNum pageNum, void *data)
+{
+	void *page = NULL;
+	if (pinPage(pageNum, page) == 0)
+	{
+		memcpy(data, page, pagedFile->pageSize);
+		return unpinPage(pageNum, false);
+	}
+
+	return -1;
 }
 
-PagedFileManager::PagedFileManager()
+RC FileHandle::writePage(PageNum pageNum, const void *data)
 {
-}
+	if (isFileOpen(pagedFile))
+	{
+		if (pageNum == (PageNum)-1 || pageNum < getNumberOfPages())
+		{
+			// The whole page is overwritten, so a miss does not need to read it first.
+			PageNum physicalPageNum = getPhysicalPageNum(pageNum);
+			bool resident = pagedFile->log != NULL && PagedFileManager::instance()->getBufferManager()->findFrame(pagedFile, physicalPageNum) != NULL;
+			void *page = NULL;
+			if (pinPhysicalPage(physicalPageNum, false, page) == 0)
+			{
+				// Only the changed bytes are logged when the old page is at hand.
+				unsigned first = 0, last = pagedFile->pageSize;
+				if (resident)
+				{
+					while (first < last && ((char *)page)[first] == ((const char *)data)[first])
+					{
+						first++;
+					}
+					while (last > first && ((char *)page)[last - 1] == ((const char *)data)[last - 1])
+					{
+						last--;
+					}
+				}
 
-PagedFileManager::~PagedFileManager()
-{
+				if (first < last && logPageChange(physicalPageNum, first, (const char *)data + first, last - first) != 0)
+				{
+					unpinPhysicalPage(physicalPageNum, false);
+					return -1;
+				}
+				memcpy(page, data, pagedFile->pageSize);
+				return unpinPage(pageNum, true);
+			}
+		}
+	}
+
+	return -1;
 }
 
-RC PagedFileManager::createFile(const string &fileName)
+RC FileHandle::appendPage(const void *data)
 {
-	if (!doesFileExist(fileName))
+	if (isFileOpen(pagedFile))
 	{
-		FILE *newFile;
-		newFile = fopen(fileName.c_str(), "wb");
+		PageNum pageNum = pagedFile->numberOfPages;
+		pagedFile->reserve(getPhysicalPageNum(pageNum) + 1);
+		if (pageNum % FSM_PAGES_PER_MAP_PAGE == 0)
+		{
+			// First page of a new group: its map page goes in front, with every entry marked full.
+			void *mapPage = malloc(pagedFile->pageSize);
+			memset(mapPage, 0, pagedFile->pageSize);
+			int error = writeNewPhysicalPage(getMapPhysicalPageNum(pageNum), mapPage);
+			free(mapPage);
+			if (error != 0)
+			{
+				return -1;
+			}
+		}
 
-		if (newFile != NULL)
+		if (writeNewPhysicalPage(getPhysicalPageNum(pageNum), data) == 0)
 		{
-			void *metaPage = malloc(PAGE_SIZE);
-			memset(metaPage, 0, PAGE_SIZE);
-			fseek(newFile, 0, SEEK_END);
-			fwrite(metaPage, 1, PAGE_SIZE, newFile);
-			fflush(newFile);
-			fclose(newFile);
-			free(metaPage);
+			appendPageCounter++;
+			pagedFile->numberOfPages++;
+
+			void *header = NULL;
+			if (pinMapPage(0, header) == 0)
+			{
+				memcpy((char *)header + HEADER_PAGE_COUNT_OFFSET, &pagedFile->numberOfPages, sizeof(unsigned));
+				logPageChange(0, HEADER_PAGE_COUNT_OFFSET, &pagedFile->numberOfPages, sizeof(unsigned));
+				unpinPhysicalPage(0, true);
+			}
 			return 0;
 		}
 	}
@@ -52,150 +2429,320 @@ RC PagedFileManager::createFile(const string &fileName)
 	return -1;
 }
 
-RC PagedFileManager::destroyFile(const string &fileName)
-{
-	return doesFileExist(fileName) ? remove(fileName.c_str()) : -1;
-}
-
-RC PagedFileManager::openFile(const string &fileName, FileHandle &fileHandle)
+RC FileHandle::readPages(PageNum pageNum, const unsigned count, void *data)
 {
-	if (fileHandle.file != NULL)
+	if (!isFileOpen(pagedFile) || count == 0 || pageNum + count > getNumberOfPages())
 	{
 		return -1;
 	}
 
-	if (doesFileExist(fileName))
+	// Pages in the pool or the mapping are copied, the others are read straight into data a run
+	// at a time. They stay out of the pool, so a large block does not push out the pages around it.
+	BufferManager *bufferManager = PagedFileManager::instance()->getBufferManager();
+	ReadAheadManager *readAheadManager = PagedFileManager::instance()->getReadAheadManager();
+	vector<void *> run;
+	PageNum runPageNum = 0;
+	for (unsigned i = 0; i <= count; i++)
 	{
-		FILE *openFile;
-		openFile = fopen(fileName.c_str(), "r+b");
+		char *page = (char *)data + (size_t)i * pagedFile->pageSize;
+		PageNum physicalPageNum = i < count ? getPhysicalPageNum(pageNum + i) : 0;
+		if (!run.empty() && (i == count || physicalPageNum != runPageNum + run.size()))
+		{
+			if (pagedFile->readPhysicalPages(runPageNum, run.size(), run.data()) != 0)
+			{
+				return -1;
+			}
+			run.clear();
+		}
+		if (i == count)
+		{
+			break;
+		}
 
-		fileHandle.file = openFile;
-		fileHandle.readPageCounter = 0;
-		fileHandle.writePageCounter = 0;
-		fileHandle.appendPageCounter = 0;
-		return 0;
+		void *mappedPage = pagedFile->getMappedPage(physicalPageNum);
+		if (mappedPage != NULL)
+		{
+			memcpy(page, mappedPage, pagedFile->pageSize);
+		}
+		else if (bufferManager->readResidentPage(pagedFile, physicalPageNum, page) == 0)
+		{
+			bufferHitCounter++;
+		}
+		else
+		{
+			bufferMissCounter++;
+			if (!readAheadManager->takePage(pagedFile, physicalPageNum, page))
+			{
+				runPageNum = run.empty() ? physicalPageNum : runPageNum;
+				run.push_back(page);
+			}
+		}
 	}
 
-	return -1;
-}
-
-RC PagedFileManager::closeFile(FileHandle &fileHandle)
-{
-	fileHandle.updateMetadata();
-	return (fflush(fileHandle.file) == 0 && fclose(fileHandle.file) == 0) ? 0 : -1;
+	readPageCounter += count;
+	return 0;
 }
 
-FileHandle::FileHandle()
+RC FileHandle::writePages(PageNum pageNum, const unsigned count, const void *data)
 {
-	file = NULL;
-	readPageCounter = 0;
-	writePageCounter = 0;
-	appendPageCounter = 0;
-}
+	if (!isFileOpen(pagedFile) || count == 0 || pageNum + count > getNumberOfPages())
+	{
+		return -1;
+	}
 
-FileHandle::~FileHandle()
-{
-}
+	// A logged page has to wait in the pool for its record, a mapped one is written in place.
+	if (pagedFile->log != NULL || pagedFile->mapping != NULL)
+	{
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (writePage(pageNum + i, (const char *)data + (size_t)i * pagedFile->pageSize) != 0)
+			{
+				return -1;
+			}
+		}
+		return 0;
+	}
 
-RC FileHandle::readPage(PageNum pageNum, void *data)
-{
-	if (isFileOpen(file))
+	// Resident pages are updated in the pool, the others are written through a run at a time.
+	BufferManager *bufferManager = PagedFileManager::instance()->getBufferManager();
+	ReadAheadManager *readAheadManager = PagedFileManager::instance()->getReadAheadManager();
+	vector<const void *> run;
+	PageNum runPageNum = 0;
+	for (unsigned i = 0; i <= count; i++)
 	{
-		if (pageNum >= 0 && pageNum < getNumberOfPages())
+		const char *page = (const char *)data + (size_t)i * pagedFile->pageSize;
+		PageNum physicalPageNum = i < count ? getPhysicalPageNum(pageNum + i) : 0;
+		if (!run.empty() && (i == count || physicalPageNum != runPageNum + run.size()))
 		{
-			fseek(file, PAGE_SIZE, SEEK_SET);
-			fseek(file, pageNum * PAGE_SIZE, SEEK_CUR);
-			if (fread(data, 1, PAGE_SIZE, file) == PAGE_SIZE)
+			if (pagedFile->writePhysicalPages(runPageNum, run.size(), run.data()) != 0)
 			{
-				readPageCounter++;
-				return 0;
+				return -1;
+			}
+			for (unsigned j = 0; j < run.size(); j++)
+			{
+				readAheadManager->discardPage(pagedFile, runPageNum + j);
 			}
+			run.clear();
+		}
+		if (i == count)
+		{
+			break;
 		}
-		else if (pageNum == -1)
+
+		if (bufferManager->writeResidentPage(pagedFile, physicalPageNum, page) != 0)
 		{
-			fseek(file, 0, SEEK_SET);
-			if (fread(data, PAGE_SIZE, 1, file) == 1)
-				return 0;
+			runPageNum = run.empty() ? physicalPageNum : runPageNum;
+			run.push_back(page);
 		}
 	}
 
-	return -1;
+	writePageCounter += count;
+	return 0;
 }
 
-RC FileHandle::writePage(PageNum pageNum, const void *data)
+RC FileHandle::appendPages(const unsigned count, const void *data)
 {
-	if (isFileOpen(file))
+	if (!isFileOpen(pagedFile) || count == 0)
+	{
+		return -1;
+	}
+
+	if (pagedFile->log != NULL)
 	{
-		if (pageNum >= 0 && pageNum < getNumberOfPages())
+		for (unsigned i = 0; i < count; i++)
 		{
-			fseek(file, PAGE_SIZE, SEEK_SET);
-			fseek(file, pageNum * PAGE_SIZE, SEEK_CUR);
-			if (fwrite(data, 1, PAGE_SIZE, file) == PAGE_SIZE)
+			if (appendPage((const char *)data + (size_t)i * pagedFile->pageSize) != 0)
 			{
-				writePageCounter++;
-				return 0;
+				return -1;
 			}
 		}
-		else if (pageNum == -1)
+		return 0;
+	}
+
+	// The pages, and the map page in front of every group they start, are physically
+	// consecutive and go out in one pwritev. New map pages mark every entry full.
+	PageNum pageNum = pagedFile->numberOfPages;
+	PageNum physicalPageNum = pageNum % FSM_PAGES_PER_MAP_PAGE == 0 ? getMapPhysicalPageNum(pageNum) : getPhysicalPageNum(pageNum);
+	void *mapPage = calloc(1, pagedFile->pageSize);
+	vector<const void *> pages;
+	for (unsigned i = 0; i < count; i++)
+	{
+		if ((pageNum + i) % FSM_PAGES_PER_MAP_PAGE == 0)
 		{
-			fseek(file, 0, SEEK_SET);
-			if (fwrite(data, PAGE_SIZE, 1, file) == 1)
-				return 0;
+			pages.push_back(mapPage);
 		}
+		pages.push_back((const char *)data + (size_t)i * pagedFile->pageSize);
+	}
+	pagedFile->reserve(physicalPageNum + pages.size());
+	RC rc = pagedFile->writePhysicalPages(physicalPageNum, pages.size(), pages.data());
+	free(mapPage);
+	if (rc != 0)
+	{
+		return -1;
 	}
 
-	return -1;
+	appendPageCounter += count;
+	pagedFile->numberOfPages += count;
+
+	void *header = NULL;
+	if (pinMapPage(0, header) == 0)
+	{
+		memcpy((char *)header + HEADER_PAGE_COUNT_OFFSET, &pagedFile->numberOfPages, sizeof(unsigned));
+		unpinPhysicalPage(0, true);
+	}
+	return 0;
 }
 
-RC FileHandle::appendPage(const void *data)
+RC FileHandle::truncate(const PageNum numberOfPages)
+{
+	if (!isFileOpen(pagedFile) || numberOfPages > pagedFile->numberOfPages)
+	{
+		return -1;
+	}
+
+	// The dropped pages are marked full in the free-space map before they go, and only the page count changes.
+	// Their frames and their disk space stay where they are, a page appended there later overwrites both.
+	for (PageNum pageNum = numberOfPages; pageNum < pagedFile->numberOfPages; pageNum++)
+	{
+		setPageFreeSpace(pageNum, 0);
+	}
+	pagedFile->numberOfPages = numberOfPages;
+
+	void *header = NULL;
+	if (pinMapPage(0, header) != 0)
+	{
+		return -1;
+	}
+	memcpy((char *)header + HEADER_PAGE_COUNT_OFFSET, &pagedFile->numberOfPages, sizeof(unsigned));
+	logPageChange(0, HEADER_PAGE_COUNT_OFFSET, &pagedFile->numberOfPages, sizeof(unsigned));
+	return unpinPhysicalPage(0, true);
+}
+
+RC FileHandle::writeNewPhysicalPage(const PageNum &physicalPageNum, const void *data)
+{
+	// New pages wait in the pool like any other write: written back with their neighbours, and a
+	// logged page only after its record. A mapped page cannot be touched past the end of the file.
+	if (pagedFile->log == NULL && pagedFile->getMappedPage(physicalPageNum) != NULL)
+	{
+		return pagedFile->writePhysicalPage(physicalPageNum, data);
+	}
+
+	void *page = NULL;
+	if (pinPhysicalPage(physicalPageNum, false, page) != 0)
+	{
+		return -1;
+	}
+	memcpy(page, data, pagedFile->pageSize);
+	logPageChange(physicalPageNum, 0, data, pagedFile->pageSize);
+	return unpinPhysicalPage(physicalPageNum, true);
+}
+
+RC FileHandle::logPageChange(const PageNum &physicalPageNum, const unsigned &offset, const void *data, const unsigned &length)
+{
+	// Logged files are never mapped, so the page is in a pinned pool frame.
+	if (pagedFile->log == NULL)
+	{
+		return 0;
+	}
+
+	return PagedFileManager::instance()->getBufferManager()->logPageChange(pagedFile, physicalPageNum, offset, data, length);
+}
+
+RC FileHandle::commit()
 {
-	if (isFileOpen(file))
+	if (!isFileOpen(pagedFile))
+	{
+		return -1;
+	}
+
+	WriteAheadLog *log = pagedFile->log;
+	if (log == NULL)
+	{
+		return 0;
+	}
+
+	// A long log is cut short by writing back the file's pages, after which none of it is needed.
+	if (log->getAppendedLSN() - pagedFile->redoLSN > WAL_CHECKPOINT_SIZE)
 	{
-		fseek(file, 0, SEEK_END);
-		if (fwrite(data, 1, PAGE_SIZE, file) <= PAGE_SIZE)
+		if (PagedFileManager::instance()->getBufferManager()->flushFile(pagedFile) != 0)
 		{
-			appendPageCounter++;
-			return 0;
+			return -1;
 		}
+		return pagedFile->checkpoint();
 	}
 
-	return -1;
+	return pagedFile->commitMode == SyncCommit ? log->flush(log->getAppendedLSN()) : 0;
 }
 
 unsigned FileHandle::getNumberOfPages()
 {
-	if (isFileOpen(file))
+	return isFileOpen(pagedFile) ? pagedFile->numberOfPages : 0;
+}
+
+unsigned FileHandle::getPageSize()
+{
+	return pagedFile != NULL ? pagedFile->pageSize : PAGE_SIZE;
+}
+
+unsigned FileHandle::getRecordFormat()
+{
+	return pagedFile != NULL ? pagedFile->recordFormat : 0;
+}
+
+unsigned FileHandle::getNumberOfDirtyPages()
+{
+	return isFileOpen(pagedFile) ? PagedFileManager::instance()->getBufferManager()->getNumberOfDirtyPages(pagedFile) : 0;
+}
+
+RC FileHandle::readMetadata()
+{
+	void *metaPage = malloc(getPageSize());
+	memset(metaPage, 0, getPageSize());
+	int pointer = 0;
+	if (readPage(-1, metaPage) == 0)
 	{
-		fseek(file, 0, SEEK_END);
-		unsigned size = ftell(file);
+		memcpy(&persistedReadPageCounter, (char *)metaPage + pointer, sizeof(int));
+		pointer += sizeof(int);
+		memcpy(&persistedWritePageCounter, (char *)metaPage + pointer, sizeof(int));
+		pointer += sizeof(int);
+		memcpy(&persistedAppendPageCounter, (char *)metaPage + pointer, sizeof(int));
 
-		return size >= PAGE_SIZE ? (ceil(size / PAGE_SIZE) - 1) : 0;
+		readPageCounter = persistedReadPageCounter;
+		writePageCounter = persistedWritePageCounter;
+		appendPageCounter = persistedAppendPageCounter;
+		free(metaPage);
+		return 0;
 	}
-
-	return 0;
+	free(metaPage);
+	return -1;
 }
 
 RC FileHandle::updateMetadata()
 {
-	void *metaPage = malloc(PAGE_SIZE);
-	memset(metaPage, 0, PAGE_SIZE);
+	// Only what this handle did since it last synced is added, other handles on the file add their own share.
+	void *metaPage = malloc(getPageSize());
+	memset(metaPage, 0, getPageSize());
 	int pointer = 0;
 	int counter = 0;
 	if (readPage(-1, metaPage) == 0)
 	{
 		memcpy(&counter, ((char *)metaPage + pointer), sizeof(int));
-		counter += readPageCounter;
+		counter += readPageCounter - persistedReadPageCounter;
 		memcpy((char *)metaPage + pointer, &counter, sizeof(int));
 		pointer += sizeof(int);
 		memcpy(&counter, ((char *)metaPage + pointer), sizeof(int));
-		counter += writePageCounter;
+		counter += writePageCounter - persistedWritePageCounter;
 		memcpy((char *)metaPage + pointer, &counter, sizeof(int));
 		pointer += sizeof(int);
 		memcpy(&counter, ((char *)metaPage + pointer), sizeof(int));
-		counter += appendPageCounter;
+		counter += appendPageCounter - persistedAppendPageCounter;
 		memcpy((char *)metaPage + pointer, &counter, sizeof(int));
 		int error = writePage(-1, metaPage);
 		free(metaPage);
+
+		persistedReadPageCounter = readPageCounter;
+		persistedWritePageCounter = writePageCounter;
+		persistedAppendPageCounter = appendPageCounter;
 		return error;
 	}
 	free(metaPage);
@@ -204,29 +2751,154 @@ RC FileHandle::updateMetadata()
 
 bool FileHandle::isPageFree(PageNum pageNum, const unsigned requiredSpace)
 {
-	void *page = malloc(PAGE_SIZE);
-	memset(page, 0, PAGE_SIZE);
+	void *page = NULL;
 
-	if (readPage(pageNum, page) == 0)
+	if (pinPage(pageNum, page) == 0)
 	{
 		unsigned numberOfSlots = 0, numberOfRecords = 0, freeSpace = 0;
 
-		memcpy(&numberOfSlots, (char *)page + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE, NUMBER_OF_SLOTS_SIZE);
-		memcpy(&numberOfRecords, (char *)page + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, PAGE_NUMBER_OF_RECORDS_SIZE);
-		memcpy(&freeSpace, (char *)page + PAGE_SIZE - PAGE_FREE_SPACE_SIZE, PAGE_FREE_SPACE_SIZE);
+		unsigned pageSize = getPageSize();
+		memcpy(&numberOfSlots, (char *)page + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE, NUMBER_OF_SLOTS_SIZE);
+		memcpy(&numberOfRecords, (char *)page + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, PAGE_NUMBER_OF_RECORDS_SIZE);
+		memcpy(&freeSpace, (char *)page + pageSize - PAGE_FREE_SPACE_SIZE, PAGE_FREE_SPACE_SIZE);
+		unpinPage(pageNum, false);
 
-		freeSpace = freeSpace + (numberOfSlots - numberOfRecords) * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE);
+		// A record reuses a single deleted slot, so only one slot's worth of the directory is free to it.
+		freeSpace = freeSpace + (numberOfSlots > numberOfRecords ? SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE : 0);
 		if (freeSpace >= requiredSpace)
 		{
-			free(page);
 			return true;
 		}
 	}
 
-	free(page);
 	return false;
 }
 
+RC FileHandle::pinMapPage(const PageNum &physicalPageNum, void *&page)
+{
+	// Header and map pages are bookkeeping, so they are not counted as page reads.
+	return pinPhysicalPage(physicalPageNum, true, page);
+}
+
+RC FileHandle::setPageFreeSpace(PageNum pageNum, const unsigned freeSpace)
+{
+	if (!isFileOpen(pagedFile) || pageNum >= getNumberOfPages())
+	{
+		return -1;
+	}
+
+	unsigned classSize = getPageSize() >> FSM_BITS_PER_PAGE;
+	unsigned freeClass = min(freeSpace / classSize, (unsigned)FSM_MAX_CLASS);
+	unsigned index = pageNum % FSM_PAGES_PER_MAP_PAGE;
+	unsigned group = pageNum / FSM_PAGES_PER_MAP_PAGE;
+
+	PageNum mapPageNum = getMapPhysicalPageNum(pageNum);
+	void *map = NULL;
+	if (pinMapPage(mapPageNum, map) != 0)
+	{
+		return -1;
+	}
+
+	unsigned oldClass = getFreeSpaceClass(map, index);
+	if (oldClass == freeClass)
+	{
+		return unpinPhysicalPage(mapPageNum, false);
+	}
+	setFreeSpaceClass(map, index, freeClass);
+	logPageChange(mapPageNum, (index * FSM_BITS_PER_PAGE) / 8, (char *)map + (index * FSM_BITS_PER_PAGE) / 8, 1);
+
+	// The header keeps the largest class of each map page, so searches only open map pages that can satisfy them.
+	int error = 0;
+	void *header = NULL;
+	if (group < FSM_DIRECTORY_SIZE)
+	{
+		if (pinMapPage(0, header) == 0)
+		{
+			void *directory = (char *)header + HEADER_FSM_DIRECTORY_OFFSET;
+			unsigned groupClass = getFreeSpaceClass(directory, group);
+			unsigned newGroupClass = groupClass;
+			if (freeClass > groupClass)
+			{
+				newGroupClass = freeClass;
+			}
+			else if (oldClass == groupClass)
+			{
+				newGroupClass = 0;
+				for (unsigned i = 0; i < FSM_PAGES_PER_MAP_PAGE && newGroupClass < groupClass; i++)
+				{
+					newGroupClass = max(newGroupClass, getFreeSpaceClass(map, i));
+				}
+			}
+
+			if (newGroupClass != groupClass)
+			{
+				setFreeSpaceClass(directory, group, newGroupClass);
+				unsigned entryOffset = (group * FSM_BITS_PER_PAGE) / 8;
+				logPageChange(0, HEADER_FSM_DIRECTORY_OFFSET + entryOffset, (char *)directory + entryOffset, 1);
+			}
+			error = unpinPhysicalPage(0, newGroupClass != groupClass);
+		}
+		else
+		{
+			error = -1;
+		}
+	}
+
+	unpinPhysicalPage(mapPageNum, true);
+	return error;
+}
+
+RC FileHandle::findFreePage(const unsigned requiredSpace, PageNum &pageNum)
+{
+	unsigned numberOfPages = getNumberOfPages();
+	if (!isFileOpen(pagedFile) || numberOfPages == 0)
+	{
+		return -1;
+	}
+
+	unsigned classSize = getPageSize() >> FSM_BITS_PER_PAGE;
+	unsigned requiredClass = min((requiredSpace + classSize - 1) / classSize, (unsigned)FSM_MAX_CLASS);
+	unsigned numberOfGroups = (numberOfPages + FSM_PAGES_PER_MAP_PAGE - 1) / FSM_PAGES_PER_MAP_PAGE;
+
+	void *header = NULL;
+	if (pinMapPage(0, header) != 0)
+	{
+		return -1;
+	}
+	void *directory = (char *)header + HEADER_FSM_DIRECTORY_OFFSET;
+
+	int error = -1;
+	for (unsigned group = 0; group < numberOfGroups && error != 0; group++)
+	{
+		// Groups beyond the directory's reach are always searched.
+		if (group < FSM_DIRECTORY_SIZE && getFreeSpaceClass(directory, group) < requiredClass)
+		{
+			continue;
+		}
+
+		PageNum firstPageNum = group * FSM_PAGES_PER_MAP_PAGE;
+		PageNum mapPageNum = getMapPhysicalPageNum(firstPageNum);
+		void *map = NULL;
+		if (pinMapPage(mapPageNum, map) == 0)
+		{
+			unsigned entries = min((unsigned)FSM_PAGES_PER_MAP_PAGE, numberOfPages - firstPageNum);
+			for (unsigned i = 0; i < entries; i++)
+			{
+				if (getFreeSpaceClass(map, i) >= requiredClass)
+				{
+					pageNum = firstPageNum + i;
+					error = 0;
+					break;
+				}
+			}
+			unpinPhysicalPage(mapPageNum, false);
+		}
+	}
+
+	unpinPhysicalPage(0, false);
+	return error;
+}
+
 RC FileHandle::decrementReadCounter()
 {
 	readPageCounter--;
@@ -241,3 +2913,50 @@ RC FileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePage
 
 	return 0;
 }
+
+RC FileHandle::collectBufferCounterValues(unsigned &hitCount, unsigned &missCount)
+{
+	hitCount = bufferHitCounter;
+	missCount = bufferMissCounter;
+
+	return 0;
+}
+
+RC FileHandle::collectCompressionCounterValues(double &compressionRatio, double &decompressThroughput)
+{
+	if (!isFileOpen(pagedFile))
+	{
+		return -1;
+	}
+
+	compressionRatio = 1;
+	decompressThroughput = 0;
+	if (!pagedFile->compressed)
+	{
+		return 0;
+	}
+
+	// The file's size counts the header, the slack at the end of each slot, and slots left behind by moved pages.
+	unsigned numberOfPhysicalPages = pagedFile->numberOfPages == 0 ? 1 : getPhysicalPageNum(pagedFile->numberOfPages - 1) + 1;
+	lock_guard<mutex> lock(pagedFile->pageMapMutex);
+	compressionRatio = (double)numberOfPhysicalPages * pagedFile->pageSize / pagedFile->compressedEnd;
+	if (pagedFile->decompressTime > 0)
+	{
+		decompressThroughput = (double)pagedFile->decompressedPageCounter * pagedFile->pageSize / (1 << 20) / (pagedFile->decompressTime / 1e9);
+	}
+
+	return 0;
+}
+
+RC FileHandle::collectReadAheadCounterValues(unsigned &prefetchCount, unsigned &hitCount)
+{
+	if (!isFileOpen(pagedFile))
+	{
+		return -1;
+	}
+
+	prefetchCount = pagedFile->prefetchedPageCounter;
+	hitCount = pagedFile->prefetchHitCounter;
+
+	return 0;
+}
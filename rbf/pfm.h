@@ -7,23 +7,177 @@ typedef char byte;
 
 #define PAGE_FREE_SPACE_SIZE 2
 #define PAGE_SIZE 4096
+#define MAX_PAGE_SIZE 65536
 #define NUMBER_OF_SLOTS_SIZE 2
 #define PAGE_NUMBER_OF_RECORDS_SIZE 2
 #define SLOT_OFFSET_SIZE 2
 #define SLOT_LENGTH_SIZE 2
+#define BUFFER_POOL_SIZE 1024
+#define DEFAULT_IO_BACKEND PositionalBackend
+#define MMAP_WINDOW_SIZE (1ULL << 36)
+#define DEFAULT_READ_AHEAD_DEPTH 32
+#define READ_AHEAD_THREADS 2
+#define READ_AHEAD_CAPACITY 512
+#define READ_AHEAD_TRIGGER 2
+#define MAX_VECTORED_PAGES 64
+#define DEFAULT_EXTENT_SIZE 0
+#define DEFAULT_WRITE_BACK_RATE 8192
+#define WRITE_BACK_INTERVAL 50
+#define CHECKPOINT_INTERVAL 1000
+#define DEFAULT_COMMIT_MODE GroupCommit
+#define WAL_FILE_SUFFIX ".wal"
+#define PAGE_MAP_FILE_SUFFIX ".pmap"
+#define COMPRESSED_SLOT_ALIGNMENT 64
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define WAL_BUFFER_SIZE (1 << 20)
+#define WAL_CHECKPOINT_SIZE (16 << 20)
+#define WAL_FLUSH_INTERVAL 10
+#define FSM_BITS_PER_PAGE 4
+#define FSM_MAX_CLASS ((1 << FSM_BITS_PER_PAGE) - 1)
+#define FSM_PAGES_PER_MAP_PAGE (PAGE_SIZE * 8 / FSM_BITS_PER_PAGE)
+#define HEADER_PAGE_COUNT_OFFSET 20
+#define HEADER_PAGE_SIZE_OFFSET 24
+#define HEADER_COMPRESSION_OFFSET 28
+#define HEADER_RECORD_FORMAT_OFFSET 32
+#define HEADER_FORMAT_VERSION_OFFSET 36
+#define HEADER_REDO_LSN_OFFSET 40
+#define PAGED_FILE_FORMAT_VERSION 1    // Layout of the header page and of the free-space map pages between the data pages
+#define HEADER_FSM_DIRECTORY_OFFSET 64
+#define FSM_DIRECTORY_SIZE ((PAGE_SIZE - HEADER_FSM_DIRECTORY_OFFSET) * 8 / FSM_BITS_PER_PAGE)
 #include <string>
 #include <climits>
 #include <fstream>
 #include <iostream>
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 #include <math.h>
 #include <memory.h>
 #include <cstring>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
 using namespace std;
 
 
 class FileHandle;
+class BufferManager;
+class ReadAheadManager;
+class WriteAheadLog;
+class LogWriter;
+class PageWriter;
+
+// How a file's pages are moved to and from disk. StdioBackend seeks a buffered FILE*,
+// PositionalBackend uses pread/pwrite on a file descriptor and keeps no seek position.
+// MappedBackend maps the first MMAP_WINDOW_SIZE bytes of the file and pins pages in place,
+// without copying them into the buffer pool. Pages past the window fall back to pread/pwrite.
+// Flushing or closing a mapped file syncs the mapping, so both wait for the disk.
+typedef enum { StdioBackend = 0, PositionalBackend, MappedBackend } IOBackend;
+
+// How page changes are made durable. NoLogging writes pages back with no log and never syncs them,
+// so a crash can leave a file with half its changes. The other modes log every change before its page
+// may reach the disk. GroupCommit, the default, leaves the log to a writer thread that syncs it every
+// WAL_FLUSH_INTERVAL ms, so a crash loses at most that window and commits never wait for the disk.
+// SyncCommit makes each commit wait for its records, commits arriving during a sync share the next.
+typedef enum { NoLogging = 0, GroupCommit, SyncCommit } CommitMode;
+
+// A compressed file keeps its header page as is at the start of the file. Every other page is compressed
+// on its way to disk and decompressed into the buffer on its way back, so the layers above only see plain pages.
+// Compressed files are meant for cold data written once: a page that outgrows its slot moves to the end of
+// the file and the old slot is not reused. They are never logged or mapped.
+//
+// Where a page of a compressed file is stored: length bytes at offset, in a slot of capacity bytes
+// that a rewrite fills again if it still fits. A length of the page size means the page did not compress.
+struct PageMapEntry
+{
+    unsigned long long offset;
+    unsigned length;
+    unsigned capacity;
+};
+
+// State shared by every FileHandle opened on the same file.
+class PagedFile
+{
+public:
+    string fileName;
+    unsigned fileId;
+    IOBackend backend;
+    FILE *file;
+    int fd;
+    char *mapping;
+    unsigned openCount;
+    unsigned numberOfPages;                                               // Data pages, kept in the header page
+    unsigned pageSize;                                                    // Kept in the header page, PAGE_SIZE for files that do not say
+    unsigned extentSize;                                                  // Disk space is reserved this many bytes at a time, 0 grows the file page by page
+    unsigned long long reservedSize;                                      // Bytes reserved on disk, the file size only covers the pages written
+    unsigned dirtyPageCounter;                                            // Pages of the file dirty in the buffer pool, kept by the pool
+    unsigned prefetchedPageCounter;                                       // Pages read ahead, and how many of them were used
+    unsigned prefetchHitCounter;
+    CommitMode commitMode;
+    WriteAheadLog *log;                                                   // NULL unless the file was opened with logging
+    atomic<unsigned long long> redoLSN;                                   // Kept in the header page, recovery redoes the log from here
+    bool compressed;                                                      // Kept in the header page, which is stored as is
+    unsigned recordFormat;                                                // Kept in the header page, how the record layer lays out its records
+    vector<PageMapEntry> pageMap;                                         // Slot of every physical page, kept in fileName + PAGE_MAP_FILE_SUFFIX
+    bool pageMapDirty;
+    unsigned long long compressedEnd;                                     // New slots go here
+    unsigned long long decompressedPageCounter;                           // Pages decompressed, and the time it took in nanoseconds
+    unsigned long long decompressTime;
+    mutex pageMapMutex;
+
+    PagedFile(const string &fileName, const unsigned fileId);
+
+    RC open(const IOBackend backend);
+    RC close();
+    RC flush();                                                           // Hand every page written to the kernel, and a mapped file's to the disk
+    RC sync();                                                            // Wait until every page written so far is on disk
+    RC checkpoint();                                                      // Sync and skip the whole log, once no logged page is dirty
+    RC stampRedoLSN(const unsigned long long &lsn);                       // Sync, then redo from lsn after a crash
+    RC reserve(const PageNum &numberOfPhysicalPages);                     // Make sure disk space is reserved for that many pages
+    bool isOpen();
+    void* getMappedPage(const PageNum &pageNum);                          // NULL unless the page is inside the mapping
+    RC readPhysicalPage(const PageNum &pageNum, void *data);              // Physical page 0 is the header page
+    RC writePhysicalPage(const PageNum &pageNum, const void *data);
+    RC readPhysicalPages(const PageNum &pageNum, const unsigned &count, void **data);  // Consecutive pages into separate buffers, one call per MAX_VECTORED_PAGES
+    RC writePhysicalPages(const PageNum &pageNum, const unsigned &count, const void **data);
+    RC loadPageMap();
+    RC savePageMap(const bool &sync);                                    // Write the map next to the file, and wait for the disk if sync
+
+private:
+    RC syncMapping();                                                     // Wait until the pages changed in the mapping are on disk
+    RC readCompressedPage(const PageNum &pageNum, void *data);
+    RC writeCompressedPage(const PageNum &pageNum, const void *data);
+};
+
+// A page frame of the buffer pool, addressed by physical page number.
+// Physical page 0 is the header page. After it the file is split into groups of
+// one free-space map page followed by FSM_PAGES_PER_MAP_PAGE data pages. Header and
+// map pages only use their first PAGE_SIZE bytes, so this holds for any page size.
+// Frames are MAX_PAGE_SIZE bytes, of which a file uses its own page size.
+struct BufferFrame
+{
+    PagedFile *pagedFile;
+    PageNum pageNum;
+    unsigned pinCount;
+    bool dirty;
+    bool referenced;
+    unsigned long long pageLSN;                                           // Log records up to here go to disk before the page
+    unsigned long long recoveryLSN;                                       // Start of the first record logged since the page was written, ULLONG_MAX if none
+    void *data;
+};
 
 class PagedFileManager
 {
@@ -31,16 +185,238 @@ public:
     static PagedFileManager* instance();                                  // Access to the _pf_manager instance
 
     RC createFile    (const string &fileName);                            // Create a new file
+    RC createFile    (const string &fileName, const unsigned pageSize);   // Create a new file with pages of pageSize bytes
+    RC createFile    (const string &fileName, const unsigned pageSize, const unsigned recordFormat);  // Same, with its record format in the header
     RC destroyFile   (const string &fileName);                            // Destroy a file
-    RC openFile      (const string &fileName, FileHandle &fileHandle);    // Open a file
+    RC openFile      (const string &fileName, FileHandle &fileHandle);    // Open a file, -1 if its header has another PAGED_FILE_FORMAT_VERSION
     RC closeFile     (FileHandle &fileHandle);                            // Close a file
 
+    BufferManager* getBufferManager();                                    // The buffer pool page frames are handed out from
+    ReadAheadManager* getReadAheadManager();
+    RC flushAllFiles();                                                   // Write back every dirty page of every open file
+    RC setIOBackend(const IOBackend backend);                             // Backend used by files opened from now on
+    IOBackend getIOBackend();
+    RC setReadAheadDepth(const unsigned depth);                           // Pages a scan keeps in flight ahead of itself, 0 turns read-ahead off
+    unsigned getReadAheadDepth();
+    RC setCommitMode(const CommitMode commitMode);                        // Commit mode of files opened from now on
+    CommitMode getCommitMode();
+    RC setExtentSize(const unsigned extentSize);                          // Growth step in bytes of files opened from now on, 0 turns preallocation off
+    unsigned getExtentSize();
+    RC setWriteBackRate(const unsigned rate);                             // Dirty pages per second the page writer may write, 0 turns it off
+    unsigned getWriteBackRate();
+    RC setCompression(const bool compressed);                             // Whether files created from now on store their pages compressed
+    bool getCompression();
+
 protected:
     PagedFileManager();                                                   // Constructor
     ~PagedFileManager();                                                  // Destructor
 
 private:
+    RC releasePagedFile(const string &fileName);
+    RC recoverFile(const string &fileName);                               // Redo what a crash left in the file's log
+    RC openLog(PagedFile *pagedFile);
+    RC closeLog(PagedFile *pagedFile);
+
     static PagedFileManager *_pf_manager;
+    BufferManager *bufferManager;
+    ReadAheadManager *readAheadManager;
+    LogWriter *logWriter;
+    PageWriter *pageWriter;
+    map<string, PagedFile *> pagedFiles;
+    unsigned nextFileId;
+    IOBackend ioBackend;
+    unsigned readAheadDepth;
+    CommitMode commitMode;
+    unsigned extentSize;
+    unsigned writeBackRate;
+    bool compression;
+};
+
+
+// Size-bounded page cache shared by all open files, with CLOCK replacement.
+// Dirty frames are written back on eviction, when their file is closed, and by the page writer.
+// Frames are only used under the pool lock or while pinned, and the page writer never takes a pinned one.
+class BufferManager
+{
+public:
+    BufferManager(const unsigned numberOfFrames, ReadAheadManager *readAheadManager);
+    ~BufferManager();
+
+    RC pinPage(PagedFile *pagedFile, const PageNum &pageNum, const bool &readFromDisk, BufferFrame *&frame, bool &hit);
+    RC unpinPage(BufferFrame *frame, const bool &isDirty);
+    BufferFrame* findFrame(PagedFile *pagedFile, const PageNum &pageNum);
+    RC logPageChange(PagedFile *pagedFile, const PageNum &pageNum, const unsigned &offset, const void *data, const unsigned &length);
+    RC readResidentPage(PagedFile *pagedFile, const PageNum &pageNum, void *data);  // Copy a page out of the pool, -1 if it is not there
+    RC writeResidentPage(PagedFile *pagedFile, const PageNum &pageNum, const void *data);  // Update a page in the pool, -1 if it is not there
+    RC flushFile(PagedFile *pagedFile);
+    RC discardFile(PagedFile *pagedFile);
+    unsigned writeBack(const unsigned maxPages);                          // Write about maxPages dirty unpinned pages in page order, returns how many
+    RC checkpointFile(PagedFile *pagedFile);                              // Write back a logged file and empty its log, or only move its redo LSN if one of its pages is pinned
+    unsigned getNumberOfDirtyPages(PagedFile *pagedFile);
+
+private:
+    BufferFrame* lookupFrame(PagedFile *pagedFile, const PageNum &pageNum);  // findFrame with the pool already locked
+    RC findVictim(unsigned &frameNum);
+    RC writeFrame(BufferFrame &frame);                                    // Also writes the dirty unpinned frames next to it in the file
+    RC writeFile(PagedFile *pagedFile);
+    void setDirty(BufferFrame &frame, const bool &dirty);
+
+    ReadAheadManager *readAheadManager;
+    unsigned numberOfFrames;
+    unsigned clockHand;
+    void *pool;
+    vector<BufferFrame> frames;
+    unordered_map<unsigned long long, unsigned> pageTable;
+    mutex poolMutex;
+};
+
+
+// Follows a chain of pages, e.g. index leaves linked by their next-page pointer.
+typedef PageNum (*NextPageFunction)(const void *page);
+
+// A run of pages read ahead for one scan. A chain keeps itself going: once the scan
+// uses the middle of the run, the next run starts where this one ended.
+struct ReadAheadRun
+{
+    PagedFile *pagedFile;
+    PageNum pageNum;
+    unsigned count;
+    NextPageFunction getNextPageNum;                                      // NULL for consecutive pages
+    bool done;
+    bool continueWhenDone;
+    bool cancelled;
+};
+
+// A page read by the I/O threads, waiting in a staging buffer until the buffer pool asks for it.
+struct ReadAheadPage
+{
+    PagedFile *pagedFile;
+    PageNum pageNum;
+    bool ready;
+    void *data;
+    shared_ptr<ReadAheadRun> run;
+};
+
+// Small pool of I/O threads reading pages ahead of sequential scans on pread files.
+// Pages are handed to the buffer pool on a miss and discarded whenever the page is written.
+class ReadAheadManager
+{
+public:
+    ReadAheadManager(const unsigned numberOfThreads, const unsigned capacity);
+    ~ReadAheadManager();
+
+    RC prefetchPages(PagedFile *pagedFile, const PageNum &pageNum, const unsigned count);
+    RC prefetchChain(PagedFile *pagedFile, const PageNum &pageNum, const unsigned depth, NextPageFunction getNextPageNum);
+    bool takePage(PagedFile *pagedFile, const PageNum &pageNum, void *data);  // Copy a prefetched page, waiting for it if it is being read
+    RC discardPage(PagedFile *pagedFile, const PageNum &pageNum);
+    RC discardFile(PagedFile *pagedFile);                                 // Wait for the file's reads and drop its pages
+
+private:
+    RC queueRun(shared_ptr<ReadAheadRun> readAheadRun);
+    void run();
+    void readRun(shared_ptr<ReadAheadRun> readAheadRun, unique_lock<mutex> &lock);
+    bool makeRoom();
+    void dropPage(unordered_map<unsigned long long, ReadAheadPage *>::iterator it);
+
+    unsigned numberOfThreads;
+    unsigned capacity;
+    bool stopping;
+    vector<thread> threads;
+    mutex stateMutex;
+    condition_variable workAvailable;
+    condition_variable pageRead;
+    deque<shared_ptr<ReadAheadRun>> runs;
+    vector<shared_ptr<ReadAheadRun>> activeRuns;
+    deque<unsigned long long> stagingOrder;
+    unordered_map<unsigned long long, ReadAheadPage *> pages;
+};
+
+
+// A redo record: the bytes at offset of a physical page, as a write left them. The LSN of a
+// record is the log offset just past it, so a record is only valid where it says it is.
+struct LogRecordHeader
+{
+    unsigned long long lsn;
+    PageNum pageNum;
+    unsigned offset;
+    unsigned length;
+    unsigned checksum;
+};
+
+// Redo log of one paged file, kept next to it in fileName + WAL_FILE_SUFFIX. Records are buffered
+// and every flush writes all of them with a single fdatasync, however many commits wait on it.
+// Records a checkpoint no longer needs are punched out of the file, so LSNs only ever grow
+// and a redo LSN stamped in the file's header page stays valid for as long as the log exists.
+class WriteAheadLog
+{
+public:
+    WriteAheadLog(const string &fileName);
+    ~WriteAheadLog();
+
+    RC open();
+    RC close();
+    unsigned long long append(const PageNum &pageNum, const unsigned &offset, const void *data, const unsigned &length);
+    RC flush(const unsigned long long &lsn);                              // Return once records up to lsn are durable
+    RC discard(const unsigned long long &lsn);                            // Give back the disk space of the records before lsn
+    unsigned long long getAppendedLSN();
+
+private:
+    RC writeBuffer(const bool &sync);
+
+    string fileName;
+    int fd;
+    vector<char> buffer;
+    unsigned long long bufferLSN;                                         // Log offset of the first buffered byte
+    unsigned long long appendedLSN;
+    unsigned long long durableLSN;
+    mutex bufferMutex;
+    mutex flushMutex;                                                     // Held by the one thread writing the log
+};
+
+// Writer thread syncing the logs of GroupCommit files every WAL_FLUSH_INTERVAL milliseconds.
+class LogWriter
+{
+public:
+    LogWriter();
+    ~LogWriter();
+
+    RC addLog(WriteAheadLog *log);
+    RC removeLog(WriteAheadLog *log);
+
+private:
+    void run();
+
+    bool stopping;
+    thread writerThread;
+    mutex stateMutex;
+    condition_variable stopRequested;
+    vector<WriteAheadLog *> logs;
+};
+
+// Writer thread trickling dirty pages to disk, so foreground threads rarely write on eviction or close.
+// Every WRITE_BACK_INTERVAL ms it writes its share of the rate in page order, which turns neighbouring
+// pages into one write. Every CHECKPOINT_INTERVAL ms it also checkpoints the open files that are logged.
+// Stdio files share a seek position with the foreground and are left to it.
+class PageWriter
+{
+public:
+    PageWriter(BufferManager *bufferManager);
+    ~PageWriter();
+
+    RC addFile(PagedFile *pagedFile);
+    RC removeFile(PagedFile *pagedFile);                                  // Once this returns the thread no longer uses the file
+    RC setRate(const unsigned rate);
+
+private:
+    void run();
+
+    BufferManager *bufferManager;
+    unsigned rate;
+    bool stopping;
+    thread writerThread;
+    mutex stateMutex;
+    condition_variable stopRequested;
+    vector<PagedFile *> files;
 };
 
 
@@ -48,10 +424,12 @@ class FileHandle
 {
 public:
     // variables to keep the counter for each operation
-	FILE* file;
+    PagedFile* pagedFile;
     unsigned readPageCounter;
     unsigned writePageCounter;
     unsigned appendPageCounter;
+    unsigned bufferHitCounter;
+    unsigned bufferMissCounter;
     
     FileHandle();                                                         // Default constructor
     ~FileHandle();                                                        // Destructor
@@ -59,13 +437,47 @@ public:
     RC readPage(PageNum pageNum, void *data);                             // Get a specific page
     RC writePage(PageNum pageNum, const void *data);                      // Write a specific page
     RC appendPage(const void *data);                                      // Append a specific page
+    RC readPages(PageNum pageNum, const unsigned count, void *data);      // Get count consecutive pages, bypassing the buffer pool on a miss
+    RC writePages(PageNum pageNum, const unsigned count, const void *data);  // Write count consecutive pages
+    RC appendPages(const unsigned count, const void *data);               // Append count pages with one write
+    RC truncate(const PageNum numberOfPages);                             // Drop the pages from numberOfPages on, appends reuse their space
+    RC pinPage(PageNum pageNum, void *&page);                             // Pin a page in the buffer pool and get its frame
+    RC unpinPage(PageNum pageNum, const bool isDirty);                    // Release a pinned page, marking it dirty if modified
     unsigned getNumberOfPages();
+    unsigned getPageSize();                                               // Size of this file's pages in bytes
+    unsigned getRecordFormat();                                           // Record format the file was created with, 0 for files that do not say
+    unsigned getNumberOfDirtyPages();                                     // Pages of this file waiting in the buffer pool to be written back
     // Get the number of pages in the file
-    RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount);  // Put the current counter values into variables
-    RC updateMetadata();
+    RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount);  // Put the current counter values into variables, totals over every session of the file
+    RC collectBufferCounterValues(unsigned &hitCount, unsigned &missCount);  // Put the buffer pool hit/miss counters into variables
+    RC collectReadAheadCounterValues(unsigned &prefetchCount, unsigned &hitCount);  // Pages read ahead for this file, and how many a scan used
+    RC collectCompressionCounterValues(double &compressionRatio, double &decompressThroughput);  // Page bytes per byte of file, and MB/s decompressed
+    RC prefetchPages(PageNum pageNum, const unsigned count);              // Start reading pages a scan is about to need
+    RC prefetchPageChain(PageNum pageNum, NextPageFunction getNextPageNum);  // Same, for pages linked to each other
+    RC commit();                                                          // Make the changes so far as durable as the commit mode promises
+    RC readMetadata();                                                    // Start the counters at the totals kept in the header page
+    RC updateMetadata();                                                  // Add what the counters gained since to those totals
     RC decrementReadCounter();
 
     bool isPageFree(PageNum pageNum, const unsigned requiredSpace);
+    RC setPageFreeSpace(PageNum pageNum, const unsigned freeSpace);      // Record a page's free space in the free-space map
+    RC findFreePage(const unsigned requiredSpace, PageNum &pageNum);     // Find a page whose free-space class fits requiredSpace
+
+private:
+    RC pinPhysicalPage(const PageNum &physicalPageNum, const bool &readFromDisk, void *&page);
+    RC unpinPhysicalPage(const PageNum &physicalPageNum, const bool &isDirty);
+    RC pinMapPage(const PageNum &physicalPageNum, void *&page);
+    RC writeNewPhysicalPage(const PageNum &physicalPageNum, const void *data);
+    RC logPageChange(const PageNum &physicalPageNum, const unsigned &offset, const void *data, const unsigned &length);
+
+    RC detectSequentialScan(const PageNum &pageNum);
+
+    PageNum lastPinnedPageNum;
+    unsigned sequentialPinCount;
+    PageNum readAheadPageNum;
+    unsigned persistedReadPageCounter;
+    unsigned persistedWritePageCounter;
+    unsigned persistedAppendPageCounter;
 }; 
 
 #endif
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line, few enough for the table to stay in the buffer pool.
+const unsigned defaultNumberOfRecords = 8000;
+// Every scan is repeated this many times and timed as a whole.
+const unsigned numberOfRuns = 5;
+// Records are read into a buffer of this size.
+const unsigned bufferSize = 1000;
+
+void RBFBench_Batch_Scan(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                         const string &description, const vector<string> &attributes, const unsigned numberOfRecords)
+{
+    // Functions Benchmarked:
+    // 1. Scan (every record, a record at a time and a batch at a time)
+    RC rc;
+    RID rid;
+    void *returnedData = malloc(bufferSize);
+    vector<RID> rids;
+    vector<string> records;
+
+    // The records a record at a time scan returns are kept, to check the batches against.
+    vector<Attribute> projectedDescriptor;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        if (find(attributes.begin(), attributes.end(), recordDescriptor[i].name) != attributes.end())
+        {
+            projectedDescriptor.push_back(recordDescriptor[i]);
+        }
+    }
+    RecordView recordView(projectedDescriptor);
+
+    double recordTime = 0;
+    for (unsigned k = 0; k < numberOfRuns; k++)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+
+        unsigned count = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            if (k == 0)
+            {
+                recordView.decodeData(returnedData);
+                rids.push_back(rid);
+                records.push_back(string((char *)returnedData, recordView.getDataSize()));
+            }
+            count++;
+        }
+        recordTime += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        rbfmScanIterator.close();
+        assert(count == numberOfRecords && "The scan should return every record.");
+    }
+
+    double batchTime = 0;
+    RecordBatch batch;
+    for (unsigned k = 0; k < numberOfRuns; k++)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+
+        unsigned count = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (rbfmScanIterator.getNextBatch(batch) != RBFM_EOF)
+        {
+            if (k == 0)
+            {
+                for (unsigned i = 0; i < batch.size(); i++)
+                {
+                    RID batchRID = batch.getRID(i);
+                    assert(batchRID.pageNum == rids[count + i].pageNum && batchRID.slotNum == rids[count + i].slotNum &&
+                           "A batch should hold the records a record at a time scan returns, in order.");
+                    assert(string((const char *)batch.getRecord(i), batch.getLength(i)) == records[count + i] &&
+                           "A record should come back the same from a batch.");
+                }
+            }
+            count += batch.size();
+        }
+        batchTime += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        rbfmScanIterator.close();
+        assert(count == numberOfRecords && "The scan should return every record.");
+    }
+
+    cout << description << ": getNextRecord() " << recordTime / numberOfRuns / numberOfRecords * 1000000 << " ns, getNextBatch() "
+         << batchTime / numberOfRuns / numberOfRecords * 1000000 << " ns per record, speedup " << recordTime / batchTime << "x" << endl;
+
+    free(returnedData);
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares scanning a table a record at a time with scanning it a batch of records at a time
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_batch";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Batch (" << numberOfRecords << " records, " << RECORD_BATCH_SIZE << " to a batch) *****" << endl;
+
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(bufferSize);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+    vector<string> projection(1, "Int3");
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    RBFBench_Batch_Scan(rbfm, fileHandle, recordDescriptor, "every field", attributes, numberOfRecords);
+    RBFBench_Batch_Scan(rbfm, fileHandle, recordDescriptor, "Int3 only  ", projection, numberOfRecords);
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    cout << "RBF Benchmark Batch Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line.
+const unsigned defaultNumberOfRecords = 50000;
+// Records are prepared in buffers of this size.
+const unsigned bufferSize = 1000;
+
+// How the records are loaded.
+typedef enum
+{
+    RowByRow = 0,
+    Batch,
+    Stream
+} LoadMode;
+
+double RBFBench_BulkLoad_Load(RecordBasedFileManager *rbfm, const string &fileName, const LoadMode mode,
+                              const vector<void *> &records, const vector<int> &recordSizes)
+{
+    // Functions Benchmarked:
+    // 1. Insert Record, Insert Records or an Insert Stream (every record into an empty file)
+    RC rc;
+    FileHandle fileHandle;
+    vector<RID> rids(records.size());
+    void *returnedData = malloc(bufferSize);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (mode == RowByRow)
+    {
+        for (unsigned i = 0; i < records.size(); i++)
+        {
+            rc = rbfm->insertRecord(fileHandle, recordDescriptor, records[i], rids[i]);
+            assert(rc == success && "Inserting a record should not fail.");
+        }
+    }
+    else if (mode == Batch)
+    {
+        vector<const void *> data(records.begin(), records.end());
+        rc = rbfm->insertRecords(fileHandle, recordDescriptor, data, rids);
+        assert(rc == success && "Inserting the records should not fail.");
+    }
+    else
+    {
+        RBFM_InsertStream rbfmInsertStream;
+        rc = rbfm->insertStream(fileHandle, recordDescriptor, rbfmInsertStream);
+        assert(rc == success && "Opening an insert stream should not fail.");
+        for (unsigned i = 0; i < records.size(); i++)
+        {
+            rc = rbfmInsertStream.insertRecord(records[i], rids[i]);
+            assert(rc == success && "Inserting a record should not fail.");
+        }
+        rc = rbfmInsertStream.close();
+        assert(rc == success && "Closing an insert stream should not fail.");
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+
+    // Every record has to come back as it went in, from the RID it was given.
+    for (unsigned i = 0; i < records.size(); i++)
+    {
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && "Reading a record should not fail.");
+        assert(memcmp(records[i], returnedData, recordSizes[i]) == 0 && "The record should read back as it was inserted.");
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    const char *names[] = {"insertRecord() per row", "insertRecords()       ", "insert stream         "};
+    cout << names[mode] << ": " << records.size() << " records onto " << numberOfPages << " pages in " << elapsed << " ms" << endl;
+
+    free(returnedData);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares loading a table a row at a time with loading it a page at a time
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_bulkload";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Bulk Load (" << numberOfRecords << " records) *****" << endl;
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    vector<void *> records(numberOfRecords);
+    vector<int> recordSizes(numberOfRecords);
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        records[i] = malloc(bufferSize);
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, i, records[i], &recordSizes[i]);
+    }
+
+    double rowTime = RBFBench_BulkLoad_Load(rbfm, fileName, RowByRow, records, recordSizes);
+    double batchTime = RBFBench_BulkLoad_Load(rbfm, fileName, Batch, records, recordSizes);
+    double streamTime = RBFBench_BulkLoad_Load(rbfm, fileName, Stream, records, recordSizes);
+
+    cout << "Load speedup: insertRecords() " << rowTime / batchTime << "x, insert stream " << rowTime / streamTime << "x" << endl;
+
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        free(records[i]);
+    }
+    free(nullsIndicator);
+    cout << "RBF Benchmark Bulk Load Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Table size in MB when none is given on the command line.
+const unsigned defaultTableSize = 64;
+// Records are checked in buffers of this size, zeroed past the record.
+const unsigned bufferSize = 1000;
+
+void dropFromPageCache(const string &fileName)
+{
+    // A cold scan has to come from the disk, so the kernel is told to forget the file.
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+unsigned long long checksumRecord(const void *record)
+{
+    // Summed over a table, so records may come back in any order.
+    unsigned long long checksum = 14695981039346656037ull;
+    for (unsigned i = 0; i < bufferSize; i++)
+    {
+        checksum = (checksum ^ ((const unsigned char *)record)[i]) * 1099511628211ull;
+    }
+    return checksum;
+}
+
+unsigned RBFBench_Compression_Build(RecordBasedFileManager *rbfm, const string &fileName, const bool compressed,
+                                    const unsigned tableSize, unsigned long long &checksum)
+{
+    // Functions Benchmarked:
+    // 1. Insert Record (until the table has tableSize MB of pages)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(bufferSize);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    remove(fileName.c_str());
+    PagedFileManager::instance()->setCompression(compressed);
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    PagedFileManager::instance()->setCompression(false);
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    unsigned numberOfPages = tableSize * (1024 * 1024 / PAGE_SIZE);
+    unsigned numberOfRecords = 0;
+    checksum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (fileHandle.getNumberOfPages() < numberOfPages)
+    {
+        memset(record, 0, bufferSize);
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, numberOfRecords, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        checksum += checksumRecord(record);
+        numberOfRecords++;
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << (compressed ? "compressed: " : "plain:      ") << "insert of " << numberOfRecords << " records " << elapsed
+         << " ms, file " << getFileSize(fileName) / 1024 << " KB" << endl;
+
+    free(record);
+    free(nullsIndicator);
+    return numberOfRecords;
+}
+
+double RBFBench_Compression_Scan(RecordBasedFileManager *rbfm, const string &fileName, const bool compressed,
+                                 const unsigned numberOfRecords, const unsigned long long checksum)
+{
+    // Functions Benchmarked:
+    // 1. Scan (full table, every attribute, from a cold OS page cache)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    void *returnedData = malloc(bufferSize);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+
+    dropFromPageCache(fileName);
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    unsigned count = 0;
+    unsigned long long scannedChecksum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    memset(returnedData, 0, bufferSize);
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        scannedChecksum += checksumRecord(returnedData);
+        memset(returnedData, 0, bufferSize);
+        count++;
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    rbfmScanIterator.close();
+    assert(count == numberOfRecords && "The scan should return every record.");
+    assert(scannedChecksum == checksum && "Every record should come back as it went in, whatever the pages were stored as.");
+
+    double compressionRatio = 0, decompressThroughput = 0;
+    rc = fileHandle.collectCompressionCounterValues(compressionRatio, decompressThroughput);
+    assert(rc == success && "Collecting the compression counters should not fail.");
+    assert((compressed || compressionRatio == 1) && "A plain file should store a page per page.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    cout << (compressed ? "compressed: " : "plain:      ") << "cold scan " << elapsed << " ms, compression ratio "
+         << compressionRatio << ", decompression " << decompressThroughput << " MB/s" << endl;
+
+    free(returnedData);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares the size and the cold scan time of the same table stored plain and compressed
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_compression";
+    unsigned tableSize = argc > 1 ? atoi(argv[1]) : defaultTableSize;
+    cout << endl << "***** In RBF Benchmark Compression (" << tableSize << " MB) *****" << endl;
+
+    double scanTimes[2];
+    for (unsigned i = 0; i < 2; i++)
+    {
+        unsigned long long checksum = 0;
+        unsigned numberOfRecords = RBFBench_Compression_Build(rbfm, fileName, i == 1, tableSize, checksum);
+        scanTimes[i] = RBFBench_Compression_Scan(rbfm, fileName, i == 1, numberOfRecords, checksum);
+
+        RC rc = rbfm->destroyFile(fileName);
+        assert(rc == success && "Destroying the file should not fail.");
+    }
+
+    cout << "Cold scan speedup: " << scanTimes[0] / scanTimes[1] << "x" << endl;
+    cout << "RBF Benchmark Compression Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Large pages hold a couple of thousand small records, so moving the rest of a page on every delete shows.
+const unsigned benchPageSize = 65536;
+// Records loaded when none are given on the command line.
+const unsigned defaultNumberOfRecords = 40000;
+// Records are read into a buffer of this size.
+const unsigned bufferSize = 100;
+
+void prepareDeleteRecord(const unsigned index, const int nameLength, unsigned char *nullsIndicator, void *buffer)
+{
+    int recordSize = 0;
+    string name(nameLength, (char)('a' + index % 26));
+    prepareRecord(4, nullsIndicator, nameLength, name, index, (float)index, index * 10, buffer, &recordSize);
+}
+
+int main(int argc, char *argv[])
+{
+    // Times deletes and shrinking updates that leave holes on full pages, then the inserts that fill them again
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_delete";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Delete (" << numberOfRecords << " records on " << benchPageSize / 1024 << " KB pages) *****" << endl;
+
+    RC rc;
+    FileHandle fileHandle;
+    void *record = malloc(bufferSize);
+    void *returnedData = malloc(bufferSize);
+    vector<RID> rids(numberOfRecords);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+    unsigned char nullsIndicator = 0;
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName, benchPageSize);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareDeleteRecord(i, 30, &nullsIndicator, record);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+
+    // Functions Benchmarked:
+    // 1. Delete Record (every other record, front of every page first)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i += 2)
+    {
+        rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+        assert(rc == success && "Deleting a record should not fail.");
+    }
+    double deleteTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // 2. Update Record (the others shrink)
+    start = chrono::steady_clock::now();
+    for (unsigned i = 1; i < numberOfRecords; i += 2)
+    {
+        prepareDeleteRecord(i, 10, &nullsIndicator, record);
+        rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+    }
+    double updateTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // 3. Insert Record (into the space the deletes and updates gave up)
+    start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i += 2)
+    {
+        prepareDeleteRecord(i, 30, &nullsIndicator, record);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    double insertTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    assert(fileHandle.getNumberOfPages() == numberOfPages && "The inserts should fit in the space that was freed.");
+
+    // Every record has to come back as it was last written, wherever compaction moved it.
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareDeleteRecord(i, i % 2 == 0 ? 30 : 10, &nullsIndicator, record);
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && "Reading a record should not fail.");
+        assert(memcmp(record, returnedData, 1 + 4 + (i % 2 == 0 ? 30 : 10) + 12) == 0 && "The record should read back as it was written.");
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    unsigned half = numberOfRecords / 2;
+    cout << "deleteRecord() " << deleteTime / half * 1000 << " us, shrinking updateRecord() " << updateTime / half * 1000
+         << " us, insertRecord() into the freed space " << insertTime / half * 1000 << " us per record" << endl;
+
+    free(record);
+    free(returnedData);
+    cout << "RBF Benchmark Delete Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line, few enough for the table to stay in the buffer pool.
+const unsigned defaultNumberOfRecords = 50000;
+// Every scan is repeated this many times and timed as a whole.
+const unsigned numberOfRuns = 5;
+// Records are prepared in buffers of this size.
+const unsigned bufferSize = 200;
+
+const char *departments[] = {"Engineering and Operations", "Human Resources", "Finance and Accounting", "Marketing",
+                             "Sales", "Customer Support", "Legal", "Research and Development"};
+const char *statuses[] = {"active", "on leave", "terminated", "retired"};
+
+void createDictionaryRecordDescriptor(vector<Attribute> &recordDescriptor)
+{
+    // Department and Status repeat a handful of values, Name is different in every record.
+    Attribute attr;
+    attr.name = "EmpId";
+    attr.type = TypeInt;
+    attr.length = (AttrLength)4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Name";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength)30;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Department";
+    attr.length = (AttrLength)50;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Status";
+    attr.length = (AttrLength)20;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Salary";
+    attr.type = TypeReal;
+    attr.length = (AttrLength)4;
+    recordDescriptor.push_back(attr);
+}
+
+unsigned prepareVarchar(const string &value, void *buffer)
+{
+    int length = value.size();
+    memcpy(buffer, &length, sizeof(int));
+    memcpy((char *)buffer + sizeof(int), value.c_str(), length);
+    return sizeof(int) + length;
+}
+
+unsigned prepareDictionaryRecord(const unsigned index, void *buffer)
+{
+    int empId = index;
+    float salary = 40000 + index % 1000 * 50;
+
+    unsigned offset = 0;
+    memset(buffer, 0, 1);
+    offset += 1;
+    memcpy((char *)buffer + offset, &empId, sizeof(int));
+    offset += sizeof(int);
+    offset += prepareVarchar("employee-" + to_string(index), (char *)buffer + offset);
+    offset += prepareVarchar(departments[index * 7 % 8], (char *)buffer + offset);
+    offset += prepareVarchar(statuses[index % 13 == 0 ? index % 4 : 0], (char *)buffer + offset);
+    memcpy((char *)buffer + offset, &salary, sizeof(float));
+    return offset + sizeof(float);
+}
+
+double RBFBench_Dictionary_Scan(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                                const string &conditionAttribute, const CompOp compOp, const void *value,
+                                const vector<string> &attributes, vector<string> &records)
+{
+    // Functions Benchmarked:
+    // 1. Scan (a batch at a time)
+    RC rc;
+    RecordBatch batch;
+    double elapsed = 0;
+    for (unsigned k = 0; k < numberOfRuns; k++)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (rbfmScanIterator.getNextBatch(batch) != RBFM_EOF)
+        {
+            for (unsigned i = 0; i < batch.size() && k == 0; i++)
+            {
+                records.push_back(string((const char *)batch.getRecord(i), batch.getLength(i)));
+            }
+        }
+        elapsed += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        rbfmScanIterator.close();
+    }
+
+    return elapsed / numberOfRuns;
+}
+
+void RBFBench_Dictionary_Run(RecordBasedFileManager *rbfm, const string &fileName, const RecordFormat format,
+                             const unsigned numberOfRecords, double times[], vector<string> results[])
+{
+    // Functions Benchmarked:
+    // 2. Insert Record
+    // 3. Read Record
+    RC rc;
+    FileHandle fileHandle;
+    void *record = malloc(bufferSize);
+    void *returnedData = malloc(bufferSize);
+    vector<RID> rids(numberOfRecords);
+    vector<Attribute> recordDescriptor;
+    createDictionaryRecordDescriptor(recordDescriptor);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName, PAGE_SIZE, format);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareDictionaryRecord(i, record);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    times[0] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && "Reading a record should not fail.");
+    }
+    times[1] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Every record has to come back as it went in, whole or a field at a time.
+    for (unsigned i = 0; i < numberOfRecords; i += 97)
+    {
+        unsigned recordSize = prepareDictionaryRecord(i, record);
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The record should read back as it was inserted.");
+
+        rc = rbfm->readAttribute(fileHandle, recordDescriptor, rids[i], "Department", returnedData);
+        string department = departments[i * 7 % 8];
+        int length = 0;
+        memcpy(&length, (char *)returnedData + 1, sizeof(int));
+        assert(rc == success && department == string((char *)returnedData + 1 + sizeof(int), length) && "The attribute should read back as it was inserted.");
+    }
+
+    vector<string> attributes;
+    attributes.push_back("EmpId");
+    attributes.push_back("Department");
+    char department[60] = {0};
+    char status[30] = {0};
+    char missing[30] = {0};
+    prepareVarchar(departments[3], department);
+    prepareVarchar(statuses[2], status);
+    prepareVarchar("unknown", missing);
+
+    times[2] = RBFBench_Dictionary_Scan(rbfm, fileHandle, recordDescriptor, "Department", EQ_OP, department, attributes, results[0]);
+    times[3] = RBFBench_Dictionary_Scan(rbfm, fileHandle, recordDescriptor, "Status", NE_OP, status, attributes, results[1]);
+    times[4] = RBFBench_Dictionary_Scan(rbfm, fileHandle, recordDescriptor, "Department", EQ_OP, missing, attributes, results[2]);
+    times[5] = RBFBench_Dictionary_Scan(rbfm, fileHandle, recordDescriptor, "Department", LT_OP, department, attributes, results[3]);
+
+    cout << (format == DictionaryFormat ? "dictionary    " : "variable width") << ": " << fileHandle.getNumberOfPages() << " pages, insertRecord() "
+         << times[0] / numberOfRecords * 1000000 << " ns, readRecord() " << times[1] / numberOfRecords * 1000000 << " ns, scan Department = "
+         << times[2] / numberOfRecords * 1000000 << " ns, Status != " << times[3] / numberOfRecords * 1000000 << " ns, Department = (absent) "
+         << times[4] / numberOfRecords * 1000000 << " ns, Department < " << times[5] / numberOfRecords * 1000000 << " ns per record" << endl;
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(returnedData);
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares a table with low cardinality VarChars stored dictionary encoded with the same table stored as it is
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_dictionary";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Dictionary (" << numberOfRecords << " records) *****" << endl;
+
+    double variableTimes[6];
+    double dictionaryTimes[6];
+    vector<string> variableResults[4];
+    vector<string> dictionaryResults[4];
+    RBFBench_Dictionary_Run(rbfm, fileName, VariableWidthFormat, numberOfRecords, variableTimes, variableResults);
+    RBFBench_Dictionary_Run(rbfm, fileName, DictionaryFormat, numberOfRecords, dictionaryTimes, dictionaryResults);
+
+    // Both files keep the records in insertion order, so the scans return the same records.
+    for (unsigned i = 0; i < 4; i++)
+    {
+        assert(variableResults[i] == dictionaryResults[i] && "A scan should return the same records from either format.");
+    }
+    assert(!variableResults[0].empty() && variableResults[2].empty() && "The scans should return every record that satisfies their condition.");
+
+    cout << "speedup: insertRecord() " << variableTimes[0] / dictionaryTimes[0] << "x, readRecord() " << variableTimes[1] / dictionaryTimes[1]
+         << "x, scan Department = " << variableTimes[2] / dictionaryTimes[2] << "x, Status != " << variableTimes[3] / dictionaryTimes[3]
+         << "x, Department = (absent) " << variableTimes[4] / dictionaryTimes[4] << "x, Department < " << variableTimes[5] / dictionaryTimes[5] << "x" << endl;
+
+    cout << "RBF Benchmark Dictionary Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <linux/fiemap.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Rows loaded when none are given on the command line. Pass 10000000 for the full 10M-row load.
+const unsigned defaultNumberOfRows = 1000000;
+
+// Growth step of the load that reserves space ahead, files grow page by page by default.
+const unsigned benchExtentSize = 1 << 20;
+
+int countExtents(const string &fileName)
+{
+    // With no room for extents, FIEMAP only counts them.
+    struct fiemap fileMap;
+    memset(&fileMap, 0, sizeof(fileMap));
+    fileMap.fm_length = FIEMAP_MAX_OFFSET;
+    fileMap.fm_flags = FIEMAP_FLAG_SYNC;
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    int rc = ioctl(fd, FS_IOC_FIEMAP, &fileMap);
+    close(fd);
+    return rc == 0 ? (int)fileMap.fm_mapped_extents : -1;
+}
+
+double RBFBench_Extent_Load(RecordBasedFileManager *rbfm, const string &fileName, const unsigned extentSize, const unsigned numberOfRows)
+{
+    // Functions Benchmarked:
+    // 1. Insert Record (numberOfRows rows, then close so every page is written)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(100);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    remove(fileName.c_str());
+    PagedFileManager::instance()->setExtentSize(extentSize);
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfRows; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i % 100, 177.8, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Preallocated space past the last page does not show in the file size.
+    assert((unsigned long long)getFileSize(fileName) == ((unsigned long long)numberOfPages + (numberOfPages - 1) / FSM_PAGES_PER_MAP_PAGE + 2) * PAGE_SIZE
+           && "The file size should only cover the pages written.");
+
+    cout << "extent " << extentSize / 1024 << " KB: " << numberOfRows << " rows into " << numberOfPages << " pages in "
+         << elapsed << " ms (" << numberOfRows / (elapsed / 1000) << " rows/s), " << countExtents(fileName) << " extents on disk" << endl;
+
+    PagedFileManager::instance()->setExtentSize(DEFAULT_EXTENT_SIZE);
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(nullsIndicator);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares a bulk load that grows the file page by page with one that grows it by extents
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_extent";
+    unsigned numberOfRows = argc > 1 ? atoi(argv[1]) : defaultNumberOfRows;
+    cout << endl << "***** In RBF Benchmark Extent (" << numberOfRows << " rows) *****" << endl;
+
+    double pageTime = RBFBench_Extent_Load(rbfm, fileName, 0, numberOfRows);
+    double extentTime = RBFBench_Extent_Load(rbfm, fileName, benchExtentSize, numberOfRows);
+
+    cout << "Extent speedup: " << pageTime / extentTime << "x" << endl;
+    cout << "RBF Benchmark Extent Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line, few enough for the table to stay in the buffer pool.
+const unsigned defaultNumberOfRecords = 20000;
+// Int fields, and as many Real fields after them.
+const unsigned numberOfIntFields = 8;
+// One record in this many has a null field.
+const unsigned nullRecordInterval = 10;
+// Records are prepared in buffers of this size.
+const unsigned bufferSize = 100;
+
+void createFixedWidthRecordDescriptor(vector<Attribute> &recordDescriptor)
+{
+    for (unsigned i = 0; i < numberOfIntFields * 2; i++)
+    {
+        Attribute attr;
+        attr.name = (i < numberOfIntFields ? "Int" : "Real") + to_string(i % numberOfIntFields);
+        attr.type = i < numberOfIntFields ? TypeInt : TypeReal;
+        attr.length = (AttrLength)4;
+        recordDescriptor.push_back(attr);
+    }
+}
+
+// Fills every field from the record number, leaving out the one that is null, and returns the size.
+int prepareFixedWidthRecord(const unsigned index, void *buffer)
+{
+    unsigned numberOfFields = numberOfIntFields * 2;
+    unsigned nullFlagSize = getActualByteForNullsIndicator(numberOfFields);
+    memset(buffer, 0, nullFlagSize);
+    int nullField = index % nullRecordInterval == 0 ? (int)(index / nullRecordInterval % numberOfFields) : -1;
+
+    unsigned offset = nullFlagSize;
+    for (unsigned i = 0; i < numberOfFields; i++)
+    {
+        if ((int)i == nullField)
+        {
+            ((unsigned char *)buffer)[i / 8] |= 1 << (7 - i % 8);
+            continue;
+        }
+
+        if (i < numberOfIntFields)
+        {
+            int value = index + i;
+            memcpy((char *)buffer + offset, &value, sizeof(int));
+        }
+        else
+        {
+            float value = index + i + 0.5;
+            memcpy((char *)buffer + offset, &value, sizeof(float));
+        }
+        offset += 4;
+    }
+
+    return offset;
+}
+
+void RBFBench_FixedWidth_Run(RecordBasedFileManager *rbfm, const string &fileName, const RecordFormat format,
+                             const unsigned numberOfRecords, double times[])
+{
+    // Functions Benchmarked:
+    // 1. Insert Record
+    // 2. Read Record
+    // 3. Read Attribute (a Real field)
+    // 4. Scan (every field)
+    // 5. Scan (Int3 > n-10, only Int0 projected)
+    RC rc;
+    FileHandle fileHandle;
+    void *record = malloc(bufferSize);
+    void *returnedData = malloc(bufferSize);
+    vector<RID> rids(numberOfRecords);
+
+    vector<Attribute> recordDescriptor;
+    createFixedWidthRecordDescriptor(recordDescriptor);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName, PAGE_SIZE, format);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareFixedWidthRecord(i, record);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    times[0] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && "Reading a record should not fail.");
+    }
+    times[1] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Every record has to come back as it went in.
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        int recordSize = prepareFixedWidthRecord(i, record);
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The record should read back as it was inserted.");
+    }
+
+    start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        rc = rbfm->readAttribute(fileHandle, recordDescriptor, rids[i], "Real5", returnedData);
+        assert(rc == success && "Reading an attribute should not fail.");
+    }
+    times[2] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+    RID rid;
+    unsigned count = 0;
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    start = chrono::steady_clock::now();
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        count++;
+    }
+    times[3] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    rbfmScanIterator.close();
+    assert(count == numberOfRecords && "The scan should return every record.");
+
+    // Int3 holds the record number plus 3, unless it is null.
+    int bound = numberOfRecords - 7;
+    vector<string> projection(1, "Int0");
+    count = 0;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "Int3", GT_OP, &bound, projection, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    start = chrono::steady_clock::now();
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        count++;
+    }
+    times[4] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    rbfmScanIterator.close();
+    assert(count == 9 && "The scan should return every record that satisfies the condition.");
+
+    cout << (format == FixedWidthFormat ? "fixed width   " : "variable width") << ": " << fileHandle.getNumberOfPages() << " pages, insertRecord() "
+         << times[0] / numberOfRecords * 1000000 << " ns, readRecord() " << times[1] / numberOfRecords * 1000000 << " ns, readAttribute() "
+         << times[2] / numberOfRecords * 1000000 << " ns, scan " << times[3] / numberOfRecords * 1000000 << " ns, filtered scan "
+         << times[4] / numberOfRecords * 1000000 << " ns per record" << endl;
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(returnedData);
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares the fixed width record format with the variable width one, on a table of Int and Real fields
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_fixedwidth";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Fixed Width (" << numberOfRecords << " records, "
+         << numberOfIntFields << " Int and " << numberOfIntFields << " Real fields) *****" << endl;
+
+    double variableTimes[5];
+    double fixedTimes[5];
+    RBFBench_FixedWidth_Run(rbfm, fileName, VariableWidthFormat, numberOfRecords, variableTimes);
+    RBFBench_FixedWidth_Run(rbfm, fileName, FixedWidthFormat, numberOfRecords, fixedTimes);
+
+    cout << "speedup: insertRecord() " << variableTimes[0] / fixedTimes[0] << "x, readRecord() " << variableTimes[1] / fixedTimes[1]
+         << "x, readAttribute() " << variableTimes[2] / fixedTimes[2] << "x, scan " << variableTimes[3] / fixedTimes[3]
+         << "x, filtered scan " << variableTimes[4] / fixedTimes[4] << "x" << endl;
+
+    cout << "RBF Benchmark Fixed Width Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Large enough that most random reads miss the buffer pool and reach the backend.
+const unsigned numberOfPages = 8 * BUFFER_POOL_SIZE;
+const unsigned numberOfReads = 100000;
+
+double RBFBench_IO(PagedFileManager *pfm, const IOBackend backend, const string &backendName)
+{
+    // Functions Benchmarked:
+    // 1. Append Page (to build the file)
+    // 2. Read Page at random page numbers
+    RC rc;
+    string fileName = "bench_io";
+    FileHandle fileHandle;
+    void *data = malloc(PAGE_SIZE);
+    void *buffer = malloc(PAGE_SIZE);
+
+    pfm->setIOBackend(backend);
+
+    rc = pfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    rc = pfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfPages; i++)
+    {
+        memset(data, 0, PAGE_SIZE);
+        memcpy(data, &i, sizeof(unsigned));
+        rc = fileHandle.appendPage(data);
+        assert(rc == success && "Appending a page should not fail.");
+    }
+
+    rc = pfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = pfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    srand(2222);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfReads; i++)
+    {
+        unsigned pageNum = rand() % numberOfPages;
+        rc = fileHandle.readPage(pageNum, buffer);
+        assert(rc == success && "Reading a page should not fail.");
+        assert(memcmp(buffer, &pageNum, sizeof(unsigned)) == 0 && "Page contents should match.");
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    double elapsed = chrono::duration<double, micro>(end - start).count();
+
+    unsigned hitCount = 0, missCount = 0;
+    fileHandle.collectBufferCounterValues(hitCount, missCount);
+
+    rc = pfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = pfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << backendName << ": " << numberOfReads << " random page reads over " << numberOfPages << " pages, "
+         << missCount << " buffer misses, " << elapsed / 1000 << " ms (" << elapsed / numberOfReads << " us/read)" << endl;
+
+    free(data);
+    free(buffer);
+    return elapsed;
+}
+
+int main()
+{
+    // Compares the stdio and pread/pwrite backends on random page reads
+    PagedFileManager *pfm = PagedFileManager::instance();
+    cout << endl << "***** In RBF Benchmark IO *****" << endl;
+
+    remove("bench_io");
+
+    double stdioTime = RBFBench_IO(pfm, StdioBackend, "stdio (fseek/fread)");
+    double positionalTime = RBFBench_IO(pfm, PositionalBackend, "positional (pread)");
+    pfm->setIOBackend(DEFAULT_IO_BACKEND);
+
+    cout << "Positional backend speedup: " << stdioTime / positionalTime << "x" << endl;
+    cout << "RBF Benchmark IO Finished!" << endl << endl;
+    return 0;
+}
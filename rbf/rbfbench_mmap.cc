@@ -0,0 +1,136 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Table size in MB when none is given on the command line. Pass e.g. 4096 for a multi-GB table.
+const unsigned defaultTableSize = 64;
+
+int RBFBench_MMap_Build(RecordBasedFileManager *rbfm, const string &fileName, const unsigned tableSize, unsigned &numberOfRecords)
+{
+    // Functions Benchmarked:
+    // 1. Insert Record (to build the table, not timed)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    unsigned numberOfPages = tableSize * (1024 * 1024 / PAGE_SIZE);
+    numberOfRecords = 0;
+    while (fileHandle.getNumberOfPages() < numberOfPages)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, numberOfRecords, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        numberOfRecords++;
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    free(record);
+    free(nullsIndicator);
+    return 0;
+}
+
+double RBFBench_MMap_Scan(RecordBasedFileManager *rbfm, const string &fileName, const IOBackend backend,
+                          const string &backendName, const unsigned numberOfRecords)
+{
+    // Functions Benchmarked:
+    // 1. Scan (full table, every attribute)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+
+    PagedFileManager::instance()->setIOBackend(backend);
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    // The first pass only warms the OS page cache, so both backends are timed on the same footing.
+    double elapsed = 0;
+    for (unsigned pass = 0; pass < 2; pass++)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+
+        unsigned count = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            count++;
+        }
+        elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        rbfmScanIterator.close();
+        assert(count == numberOfRecords && "The scan should return every record.");
+    }
+
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    cout << backendName << ": scan of " << numberOfRecords << " records over " << numberOfPages << " pages, "
+         << elapsed << " ms (" << (double)numberOfPages * PAGE_SIZE / 1024 / 1024 / (elapsed / 1000) << " MB/s)" << endl;
+
+    free(returnedData);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares full-table scans through the stdio backend and the memory-mapped backend
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_mmap";
+    unsigned tableSize = argc > 1 ? atoi(argv[1]) : defaultTableSize;
+    unsigned numberOfRecords = 0;
+    cout << endl << "***** In RBF Benchmark MMap (" << tableSize << " MB) *****" << endl;
+
+    remove(fileName.c_str());
+
+    // Logged files are never mapped, so both backends are timed without a log.
+    PagedFileManager::instance()->setCommitMode(NoLogging);
+    RBFBench_MMap_Build(rbfm, fileName, tableSize, numberOfRecords);
+    double stdioTime = RBFBench_MMap_Scan(rbfm, fileName, StdioBackend, "stdio (fseek/fread)", numberOfRecords);
+    double mappedTime = RBFBench_MMap_Scan(rbfm, fileName, MappedBackend, "mapped (mmap)", numberOfRecords);
+    PagedFileManager::instance()->setIOBackend(DEFAULT_IO_BACKEND);
+    PagedFileManager::instance()->setCommitMode(DEFAULT_COMMIT_MODE);
+
+    RC rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "Mapped backend speedup: " << stdioTime / mappedTime << "x" << endl;
+    cout << "RBF Benchmark MMap Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numberOfRecords = 100000;
+
+int RBFBench_PageCount(RecordBasedFileManager *rbfm)
+{
+    // Functions Benchmarked:
+    // 1. Scan (full table, every getNextRecord() asks for the page count)
+    // 2. Get Number Of Pages, cached versus one fstat per call
+    RC rc;
+    string fileName = "bench_pagecount";
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(100);
+    void *returnedData = malloc(100);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (int i = 0; i < numberOfRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i % 100, 177.8, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+
+    // Full-table scan, each getNextRecord() call reads the page count once.
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    unsigned numberOfCalls = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        numberOfCalls++;
+    }
+    numberOfCalls++;
+    double scanTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    rbfmScanIterator.close();
+    assert(numberOfCalls == (unsigned)numberOfRecords + 1 && "The scan should return every record.");
+
+    // The same number of page-count lookups, served from the handle and from the file size.
+    unsigned total = 0;
+    start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfCalls; i++)
+    {
+        total += fileHandle.getNumberOfPages();
+    }
+    double cachedTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    assert(total == numberOfCalls * numberOfPages && "The page count should not change during the scan.");
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat fileInfo;
+    start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfCalls; i++)
+    {
+        fstat(fd, &fileInfo);
+    }
+    double syscallTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    close(fd);
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "Full scan of " << numberOfRecords << " records over " << numberOfPages << " pages: " << scanTime << " ms" << endl;
+    cout << numberOfCalls << " getNumberOfPages() calls: 0 syscalls, " << cachedTime << " ms" << endl;
+    cout << "Same lookups from the file size: " << numberOfCalls << " fstat syscalls, " << syscallTime << " ms" << endl;
+
+    free(record);
+    free(returnedData);
+    free(nullsIndicator);
+    return 0;
+}
+
+int main()
+{
+    // Shows the syscalls a full-table scan saves now that the page count is cached
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    cout << endl << "***** In RBF Benchmark Page Count *****" << endl;
+
+    remove("bench_pagecount");
+
+    RC rcmain = RBFBench_PageCount(rbfm);
+    cout << "RBF Benchmark Page Count Finished!" << endl << endl;
+    return rcmain;
+}
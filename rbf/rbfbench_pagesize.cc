@@ -0,0 +1,147 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Table size in MB when none is given on the command line.
+const unsigned defaultTableSize = 64;
+
+double RBFBench_PageSize_Build(RecordBasedFileManager *rbfm, const string &fileName, const unsigned pageSize,
+                               const unsigned tableSize, unsigned &numberOfRecords)
+{
+    // Functions Benchmarked:
+    // 1. Insert Record
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    rc = rbfm->createFile(fileName, pageSize);
+    assert(rc == success && "Creating the file should not fail.");
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    assert(fileHandle.getPageSize() == pageSize && "The file should keep the page size it was created with.");
+
+    unsigned numberOfPages = tableSize * (1024 * 1024 / pageSize);
+    numberOfRecords = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (fileHandle.getNumberOfPages() < numberOfPages)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, numberOfRecords, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        numberOfRecords++;
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    free(record);
+    free(nullsIndicator);
+    return elapsed;
+}
+
+double RBFBench_PageSize_Scan(RecordBasedFileManager *rbfm, const string &fileName, const unsigned numberOfRecords)
+{
+    // Functions Benchmarked:
+    // 1. Scan (full table, every attribute)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *returnedData = malloc(1000);
+    void *record = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    unsigned count = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        count++;
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    rbfmScanIterator.close();
+    assert(count == numberOfRecords && "The scan should return every record.");
+
+    // The last record has to come back as it went in.
+    prepareLargeRecord(recordDescriptor.size(), nullsIndicator, numberOfRecords - 1, record, &recordSize);
+    assert(memcmp(record, returnedData, recordSize) == 0 && "The scanned record should match the inserted one.");
+
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+    unsigned pageSize = fileHandle.getPageSize();
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    cout << pageSize / 1024 << "K pages: scan of " << numberOfRecords << " records over " << numberOfPages << " pages, "
+         << elapsed << " ms" << endl;
+
+    free(record);
+    free(returnedData);
+    free(nullsIndicator);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares inserts and full-table scans of the same table stored with different page sizes
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_pagesize";
+    unsigned tableSize = argc > 1 ? atoi(argv[1]) : defaultTableSize;
+    cout << endl << "***** In RBF Benchmark Page Size (" << tableSize << " MB) *****" << endl;
+
+    unsigned pageSizes[] = {PAGE_SIZE, 4 * PAGE_SIZE, MAX_PAGE_SIZE};
+    double scanTimes[3];
+    for (unsigned i = 0; i < 3; i++)
+    {
+        unsigned numberOfRecords = 0;
+        remove(fileName.c_str());
+
+        double insertTime = RBFBench_PageSize_Build(rbfm, fileName, pageSizes[i], tableSize, numberOfRecords);
+        cout << pageSizes[i] / 1024 << "K pages: insert of " << numberOfRecords << " records " << insertTime << " ms" << endl;
+        scanTimes[i] = RBFBench_PageSize_Scan(rbfm, fileName, numberOfRecords);
+
+        RC rc = rbfm->destroyFile(fileName);
+        assert(rc == success && "Destroying the file should not fail.");
+    }
+
+    cout << "Scan speedup over 4K pages: 16K " << scanTimes[0] / scanTimes[1] << "x, 64K " << scanTimes[0] / scanTimes[2] << "x" << endl;
+    cout << "RBF Benchmark Page Size Finished!" << endl << endl;
+    return 0;
+}
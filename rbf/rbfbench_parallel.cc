@@ -0,0 +1,137 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line.
+const unsigned defaultNumberOfRecords = 100000;
+// One record in this many grows after the load, which moves it off its full page behind a tombstone.
+const unsigned movedRecordInterval = 100;
+// Records are read into a buffer of this size.
+const unsigned bufferSize = 100;
+
+bool lessRID(const RID &left, const RID &right)
+{
+    return left.pageNum < right.pageNum || (left.pageNum == right.pageNum && left.slotNum < right.slotNum);
+}
+
+double RBFBench_Parallel_Scan(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                              const void *value, const unsigned numberOfThreads, vector<RID> &rids)
+{
+    // Functions Benchmarked:
+    // 1. Scan or Parallel Scan (Age >= a quarter of the records, every field)
+    RC rc;
+    RID rid;
+    void *returnedData = malloc(bufferSize);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+
+    rids.clear();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (numberOfThreads == 0)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, "Age", GE_OP, value, attributes, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+        while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            rids.push_back(rid);
+        }
+        rbfmScanIterator.close();
+    }
+    else
+    {
+        RBFM_ParallelScanIterator rbfmParallelScanIterator;
+        rc = rbfm->parallelScan(fileHandle, recordDescriptor, "Age", GE_OP, value, attributes, numberOfThreads, rbfmParallelScanIterator);
+        assert(rc == success && "Scanning the file in parallel should not fail.");
+        while (rbfmParallelScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            rids.push_back(rid);
+        }
+        rbfmParallelScanIterator.close();
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Morsels finish in any order, the records they hold are compared sorted.
+    sort(rids.begin(), rids.end(), lessRID);
+    free(returnedData);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares a scan on one thread with scans that split the file between worker threads
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_parallel";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Parallel Scan (" << numberOfRecords << " records, "
+         << thread::hardware_concurrency() << " cores) *****" << endl;
+
+    RC rc;
+    FileHandle fileHandle;
+    int recordSize = 0;
+    void *record = malloc(bufferSize);
+    vector<RID> rids(numberOfRecords);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+    unsigned char nullsIndicator = 0;
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), &nullsIndicator, 10, string(10, 'a' + i % 26), i, (float)i, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    for (unsigned i = 0; i < numberOfRecords; i += movedRecordInterval)
+    {
+        prepareRecord(recordDescriptor.size(), &nullsIndicator, 30, string(30, 'a' + i % 26), i, (float)i, i, record, &recordSize);
+        rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+    }
+
+    int age = numberOfRecords / 4;
+    vector<RID> serialRIDs;
+    vector<RID> parallelRIDs;
+    double serialTime = RBFBench_Parallel_Scan(rbfm, fileHandle, recordDescriptor, &age, 0, serialRIDs);
+    cout << "scan on the calling thread: " << serialRIDs.size() << " records in " << serialTime << " ms" << endl;
+
+    for (unsigned numberOfThreads = 1; numberOfThreads <= 8; numberOfThreads *= 2)
+    {
+        double parallelTime = RBFBench_Parallel_Scan(rbfm, fileHandle, recordDescriptor, &age, numberOfThreads, parallelRIDs);
+        assert(parallelRIDs.size() == serialRIDs.size() && "A parallel scan should return as many records as a serial one.");
+        for (unsigned i = 0; i < serialRIDs.size(); i++)
+        {
+            assert(!lessRID(serialRIDs[i], parallelRIDs[i]) && !lessRID(parallelRIDs[i], serialRIDs[i]) &&
+                   "A parallel scan should return the records a serial one does.");
+        }
+        cout << "parallel scan, " << numberOfThreads << " workers: " << parallelTime << " ms, speedup " << serialTime / parallelTime << "x" << endl;
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    cout << "RBF Benchmark Parallel Scan Finished!" << endl << endl;
+    return 0;
+}
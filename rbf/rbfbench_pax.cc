@@ -0,0 +1,178 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line, few enough for the table to stay in the buffer pool.
+const unsigned defaultNumberOfRecords = 8000;
+// Pages large enough for a PAX page to hold a good number of the wide rows.
+const unsigned benchPageSize = 65536;
+// Every scan is repeated this many times and timed as a whole.
+const unsigned numberOfRuns = 5;
+// Records are read into a buffer of this size.
+const unsigned bufferSize = 1000;
+
+double RBFBench_Pax_Scan(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                         const string &conditionAttribute, const CompOp compOp, const void *value,
+                         const vector<string> &attributes, vector<string> &records)
+{
+    // Functions Benchmarked:
+    // 1. Scan (a batch at a time)
+    RC rc;
+    RecordBatch batch;
+    double elapsed = 0;
+    for (unsigned k = 0; k < numberOfRuns; k++)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (rbfmScanIterator.getNextBatch(batch) != RBFM_EOF)
+        {
+            for (unsigned i = 0; i < batch.size() && k == 0; i++)
+            {
+                records.push_back(string((const char *)batch.getRecord(i), batch.getLength(i)));
+            }
+        }
+        elapsed += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        rbfmScanIterator.close();
+    }
+
+    return elapsed / numberOfRuns;
+}
+
+void RBFBench_Pax_Run(RecordBasedFileManager *rbfm, const string &fileName, const RecordFormat format,
+                      const unsigned numberOfRecords, double times[], vector<string> results[])
+{
+    // Functions Benchmarked:
+    // 2. Insert Record
+    // 3. Read Record
+    RC rc;
+    FileHandle fileHandle;
+    int recordSize = 0;
+    void *record = malloc(bufferSize);
+    void *returnedData = malloc(bufferSize);
+    vector<RID> rids(numberOfRecords);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName, benchPageSize, format);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    times[0] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && "Reading a record should not fail.");
+    }
+    times[1] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Every record has to come back as it went in.
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, i, record, &recordSize);
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The record should read back as it was inserted.");
+    }
+
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+    vector<string> projection;
+    projection.push_back("Int4");
+    projection.push_back("Char7");
+    int bound = numberOfRecords - 10;
+
+    times[2] = RBFBench_Pax_Scan(rbfm, fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, results[0]);
+    times[3] = RBFBench_Pax_Scan(rbfm, fileHandle, recordDescriptor, "", NO_OP, NULL, projection, results[1]);
+    times[4] = RBFBench_Pax_Scan(rbfm, fileHandle, recordDescriptor, "Int9", GT_OP, &bound, projection, results[2]);
+
+    // Updates and deletes come after the scans, as a record that moves would be seen twice in a row by row file.
+    for (unsigned i = 0; i < numberOfRecords; i += 7)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, i + 3, record, &recordSize);
+        rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The record should read back as it was updated.");
+    }
+    for (unsigned i = 1; i < numberOfRecords; i += 7)
+    {
+        rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+        assert(rc == success && "Deleting a record should not fail.");
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc != success && "Reading a deleted record should fail.");
+    }
+
+    cout << (format == PaxFormat ? "PAX           " : "variable width") << ": " << fileHandle.getNumberOfPages() << " pages, insertRecord() "
+         << times[0] / numberOfRecords * 1000000 << " ns, readRecord() " << times[1] / numberOfRecords * 1000000 << " ns, scan "
+         << times[2] / numberOfRecords * 1000000 << " ns, 2 fields " << times[3] / numberOfRecords * 1000000 << " ns, 2 fields, Int9 > n-10 "
+         << times[4] / numberOfRecords * 1000000 << " ns per record" << endl;
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares scans of a wide table stored column by column within its pages with the same table stored row by row
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_pax";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark PAX (" << numberOfRecords << " records of 30 fields, " << benchPageSize << " byte pages) *****" << endl;
+
+    double variableTimes[5];
+    double paxTimes[5];
+    vector<string> variableResults[3];
+    vector<string> paxResults[3];
+    RBFBench_Pax_Run(rbfm, fileName, VariableWidthFormat, numberOfRecords, variableTimes, variableResults);
+    RBFBench_Pax_Run(rbfm, fileName, PaxFormat, numberOfRecords, paxTimes, paxResults);
+
+    // Both layouts keep the records in insertion order, so the scans return the same records.
+    for (unsigned i = 0; i < 3; i++)
+    {
+        assert(variableResults[i] == paxResults[i] && "A scan should return the same records from either layout.");
+    }
+    assert(variableResults[2].size() == 9 && "The filtered scan should return every record that satisfies the condition.");
+
+    cout << "speedup: insertRecord() " << variableTimes[0] / paxTimes[0] << "x, readRecord() " << variableTimes[1] / paxTimes[1]
+         << "x, scan " << variableTimes[2] / paxTimes[2] << "x, 2 fields " << variableTimes[3] / paxTimes[3]
+         << "x, 2 fields, Int9 > n-10 " << variableTimes[4] / paxTimes[4] << "x" << endl;
+
+    cout << "RBF Benchmark PAX Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line, few enough for the table to stay in the buffer pool.
+const unsigned defaultNumberOfRecords = 8000;
+// Every scan is repeated this many times and timed as a whole.
+const unsigned numberOfRuns = 5;
+// Records are read into a buffer of this size.
+const unsigned bufferSize = 1000;
+
+void RBFBench_Predicate_Scan(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                             const string &description, const string &conditionAttribute, const CompOp compOp, const void *value,
+                             const unsigned numberOfRecords, const unsigned expectedCount)
+{
+    // Functions Benchmarked:
+    // 1. Scan (a selective condition, every field of the few records that satisfy it)
+    RC rc;
+    RID rid;
+    void *returnedData = malloc(bufferSize);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+
+    double elapsed = 0;
+    for (unsigned k = 0; k < numberOfRuns; k++)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+
+        unsigned count = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            count++;
+        }
+        elapsed += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        rbfmScanIterator.close();
+        assert(count == expectedCount && "The scan should return every record that satisfies the condition.");
+    }
+
+    cout << description << ": " << expectedCount << " of " << numberOfRecords << " records, "
+         << elapsed / numberOfRuns / numberOfRecords * 1000000 << " ns per record examined" << endl;
+
+    free(returnedData);
+}
+
+int main(int argc, char *argv[])
+{
+    // Times scans whose condition rejects almost every record
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_predicate";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Predicate (" << numberOfRecords << " records) *****" << endl;
+
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(bufferSize);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    // prepareLargeRecord() stores the record number in every Int field, one more in every Real field,
+    // and fills every Char field with one letter, 'c' for the first record.
+    int intValue = numberOfRecords / 2;
+    int intBound = numberOfRecords - 10;
+    float realValue = 100;
+    char varcharValue[sizeof(int) + 3];
+    int varcharLength = 3;
+    memcpy(varcharValue, &varcharLength, sizeof(int));
+    memcpy(varcharValue + sizeof(int), "bbb", varcharLength);
+
+    RBFBench_Predicate_Scan(rbfm, fileHandle, recordDescriptor, "Int9 = n/2    ", "Int9", EQ_OP, &intValue, numberOfRecords, 1);
+    RBFBench_Predicate_Scan(rbfm, fileHandle, recordDescriptor, "Int9 > n-10   ", "Int9", GT_OP, &intBound, numberOfRecords, 9);
+    RBFBench_Predicate_Scan(rbfm, fileHandle, recordDescriptor, "Real9 < 100   ", "Real9", LT_OP, &realValue, numberOfRecords, 99);
+    RBFBench_Predicate_Scan(rbfm, fileHandle, recordDescriptor, "Char9 = 'bbb' ", "Char9", EQ_OP, varcharValue, numberOfRecords, 0);
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    cout << "RBF Benchmark Predicate Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line, few enough for the table to stay in the buffer pool.
+const unsigned defaultNumberOfRecords = 8000;
+// Fields of every record, one in five a VarChar.
+const unsigned numberOfFields = 50;
+// Records are read into a buffer of this size.
+const unsigned bufferSize = 1000;
+
+void createWideRecordDescriptor(vector<Attribute> &recordDescriptor)
+{
+    for (unsigned i = 0; i < numberOfFields; i++)
+    {
+        Attribute attr;
+        attr.name = "Field" + to_string(i);
+        attr.type = i % 5 == 0 ? TypeVarChar : TypeInt;
+        attr.length = i % 5 == 0 ? (AttrLength)20 : (AttrLength)4;
+        recordDescriptor.push_back(attr);
+    }
+}
+
+void prepareWideRecord(const unsigned index, void *buffer)
+{
+    // Every other record has its first field null, so the fields after it move.
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(numberOfFields);
+    memset(buffer, 0, nullFieldsIndicatorActualSize);
+    unsigned offset = nullFieldsIndicatorActualSize;
+    for (unsigned i = 0; i < numberOfFields; i++)
+    {
+        if (i == 0 && index % 2 == 1)
+        {
+            ((unsigned char *)buffer)[0] |= 1 << 7;
+            continue;
+        }
+
+        int value = index + i;
+        if (i % 5 == 0)
+        {
+            int length = (index + i) % 20 + 1;
+            memcpy((char *)buffer + offset, &length, sizeof(int));
+            offset += sizeof(int);
+            memset((char *)buffer + offset, 'a' + i % 26, length);
+            offset += length;
+        }
+        else
+        {
+            memcpy((char *)buffer + offset, &value, sizeof(int));
+            offset += sizeof(int);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // Times reading the last of 50 fields through a projected scan and through readAttribute()
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_projection";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Projection (" << numberOfRecords << " records of " << numberOfFields << " fields) *****" << endl;
+
+    RC rc;
+    FileHandle fileHandle;
+    void *record = malloc(bufferSize);
+    void *returnedData = malloc(bufferSize);
+    vector<RID> rids(numberOfRecords);
+
+    vector<Attribute> recordDescriptor;
+    createWideRecordDescriptor(recordDescriptor);
+    string lastField = recordDescriptor.back().name;
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+    vector<string> projection(1, lastField);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareWideRecord(i, record);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    // Functions Benchmarked:
+    // 1. Scan (every field, then only the last one)
+    double scanTimes[2];
+    for (unsigned k = 0; k < 2; k++)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, k == 0 ? attributes : projection, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+
+        RID rid;
+        unsigned count = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            if (k == 1)
+            {
+                int value = 0;
+                memcpy(&value, (char *)returnedData + sizeof(char), sizeof(int));
+                assert(value == (int)(count + numberOfFields - 1) && "The projected field should come back as it went in.");
+            }
+            count++;
+        }
+        scanTimes[k] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        rbfmScanIterator.close();
+        assert(count == numberOfRecords && "The scan should return every record.");
+    }
+
+    // 2. Read Attribute (the last field of every record)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        rc = rbfm->readAttribute(fileHandle, recordDescriptor, rids[i], lastField, returnedData);
+        assert(rc == success && "Reading an attribute should not fail.");
+        int value = 0;
+        memcpy(&value, (char *)returnedData + sizeof(char), sizeof(int));
+        assert(value == (int)(i + numberOfFields - 1) && "The attribute should come back as it went in.");
+    }
+    double readAttributeTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "scan of every field " << scanTimes[0] << " ms, of the last field " << scanTimes[1] << " ms" << endl;
+    cout << "readAttribute() of the last field " << readAttributeTime / numberOfRecords * 1000 << " us per record" << endl;
+
+    free(record);
+    free(returnedData);
+    cout << "RBF Benchmark Projection Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Table size in MB when none is given on the command line.
+const unsigned defaultTableSize = 64;
+
+int RBFBench_ReadAhead_Build(RecordBasedFileManager *rbfm, const string &fileName, const unsigned tableSize, unsigned &numberOfRecords)
+{
+    // Functions Benchmarked:
+    // 1. Insert Record (to build the table, not timed)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    unsigned numberOfPages = tableSize * (1024 * 1024 / PAGE_SIZE);
+    numberOfRecords = 0;
+    while (fileHandle.getNumberOfPages() < numberOfPages)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, numberOfRecords, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        numberOfRecords++;
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    free(record);
+    free(nullsIndicator);
+    return 0;
+}
+
+void dropFromPageCache(const string &fileName)
+{
+    // Written pages have to reach the disk before the kernel lets go of them.
+    int fd = open(fileName.c_str(), O_RDONLY);
+    fsync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+double RBFBench_ReadAhead_Scan(RecordBasedFileManager *rbfm, const string &fileName, const unsigned depth, const unsigned numberOfRecords)
+{
+    // Functions Benchmarked:
+    // 1. Scan (full table, every attribute, cold page cache)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+
+    dropFromPageCache(fileName);
+    PagedFileManager::instance()->setReadAheadDepth(depth);
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    unsigned count = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        count++;
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    rbfmScanIterator.close();
+    assert(count == numberOfRecords && "The scan should return every record.");
+
+    unsigned prefetchCount = 0, hitCount = 0;
+    fileHandle.collectReadAheadCounterValues(prefetchCount, hitCount);
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    cout << "depth " << depth << ": scan of " << numberOfPages << " pages " << elapsed << " ms, "
+         << prefetchCount << " pages read ahead, " << hitCount << " of the scan's page reads served by them" << endl;
+
+    free(returnedData);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares cold full-table scans with and without read-ahead
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_readahead";
+    unsigned tableSize = argc > 1 ? atoi(argv[1]) : defaultTableSize;
+    unsigned numberOfRecords = 0;
+    cout << endl << "***** In RBF Benchmark Read-Ahead (" << tableSize << " MB) *****" << endl;
+
+    remove(fileName.c_str());
+
+    RBFBench_ReadAhead_Build(rbfm, fileName, tableSize, numberOfRecords);
+    double plainTime = RBFBench_ReadAhead_Scan(rbfm, fileName, 0, numberOfRecords);
+    double readAheadTime = RBFBench_ReadAhead_Scan(rbfm, fileName, DEFAULT_READ_AHEAD_DEPTH, numberOfRecords);
+    PagedFileManager::instance()->setReadAheadDepth(DEFAULT_READ_AHEAD_DEPTH);
+
+    RC rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "Read-ahead speedup: " << plainTime / readAheadTime << "x" << endl;
+    cout << "RBF Benchmark Read-Ahead Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line, few enough for the table to stay in the buffer pool.
+const unsigned defaultNumberOfRecords = 8000;
+// Records are read into a buffer of this size.
+const unsigned bufferSize = 1000;
+
+// Allocations are counted on the scanning thread only, the page writer and read-ahead threads allocate on their own.
+static __thread bool countAllocations = false;
+static __thread unsigned long long numberOfAllocations = 0;
+
+extern "C" void *__libc_malloc(size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    if (countAllocations)
+    {
+        numberOfAllocations++;
+    }
+    return __libc_malloc(size);
+}
+
+void RBFBench_RecordView_Scan(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                              const string &description, const string &conditionAttribute, const CompOp compOp, const void *value,
+                              const vector<string> &attributes, const unsigned numberOfRecords, const unsigned expectedCount)
+{
+    // Functions Benchmarked:
+    // 1. Scan (every record returned is decoded and projected)
+    RC rc;
+    RID rid;
+    void *returnedData = malloc(bufferSize);
+
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    unsigned count = 0;
+    numberOfAllocations = 0;
+    countAllocations = true;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        count++;
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    countAllocations = false;
+    rbfmScanIterator.close();
+    assert(count == expectedCount && "The scan should return every matching record.");
+
+    cout << description << ": " << count << " records in " << elapsed << " ms, "
+         << (double)numberOfAllocations / numberOfRecords << " allocations per scanned record" << endl;
+
+    free(returnedData);
+}
+
+int main(int argc, char *argv[])
+{
+    // Counts the allocations a warm scan makes for every record it looks at
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_recordview";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Record View (" << numberOfRecords << " records) *****" << endl;
+
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(bufferSize);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+    vector<string> projection;
+    projection.push_back("Int3");
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    // prepareLargeRecord() stores the record number in every Int field and fills Char0 with one letter.
+    int intValue = numberOfRecords / 2;
+    char *varcharValue = (char *)malloc(sizeof(int) + 1);
+    int varcharLength = 1;
+    memcpy(varcharValue, &varcharLength, sizeof(int));
+    varcharValue[sizeof(int)] = 'n';
+    unsigned varcharCount = 0;
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        varcharCount += (char)((i + 2) % 26 + 97) >= 'n';
+    }
+
+    // The table was just loaded, so every scan finds its pages in the buffer pool.
+    RBFBench_RecordView_Scan(rbfm, fileHandle, recordDescriptor, "warm, every field  ", "", NO_OP, NULL, attributes, numberOfRecords, numberOfRecords);
+    RBFBench_RecordView_Scan(rbfm, fileHandle, recordDescriptor, "warm, one field    ", "", NO_OP, NULL, projection, numberOfRecords, numberOfRecords);
+    RBFBench_RecordView_Scan(rbfm, fileHandle, recordDescriptor, "warm, Int3 = n/2   ", "Int3", EQ_OP, &intValue, projection, numberOfRecords, 1);
+    RBFBench_RecordView_Scan(rbfm, fileHandle, recordDescriptor, "warm, Char0 >= 'n' ", "Char0", GE_OP, varcharValue, projection, numberOfRecords, varcharCount);
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(varcharValue);
+    free(nullsIndicator);
+    free(record);
+    cout << "RBF Benchmark Record View Finished!" << endl << endl;
+    return 0;
+}
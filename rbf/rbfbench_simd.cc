@@ -0,0 +1,89 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Values in the column when none are given on the command line, enough to leave the caches behind.
+const unsigned defaultNumberOfValues = 1 << 22;
+// Every kernel goes over the column this many times.
+const unsigned numberOfRuns = 10;
+
+const CompOp compOps[] = {EQ_OP, LT_OP, LE_OP, GT_OP, GE_OP, NE_OP};
+const char *compOpNames[] = {"=", "<", "<=", ">", ">=", "!="};
+const char *instructionSetNames[] = {"scalar", "SSE", "AVX2"};
+
+double RBFBench_Simd_Select(const AttrType type, const CompOp compOp, const InstructionSet instructionSet,
+                            const void *values, const unsigned numberOfValues, const void *value, unsigned char *selection)
+{
+    // Functions Benchmarked:
+    // 1. Selection kernel, on one core
+    SelectionKernel selectionKernel = getSelectionKernel(type, compOp, instructionSet);
+    assert(selectionKernel != NULL && "There should be a kernel for every operator on an Int or Real column.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned k = 0; k < numberOfRuns; k++)
+    {
+        selectionKernel(values, numberOfValues, value, selection);
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return (double)numberOfValues * numberOfRuns / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares the scalar and vector selection kernels over a column of Int and one of Real values
+    unsigned numberOfValues = argc > 1 ? atoi(argv[1]) : defaultNumberOfValues;
+    InstructionSet instructionSet = getInstructionSet();
+    cout << endl << "***** In RBF Benchmark SIMD (" << numberOfValues << " values, up to "
+         << instructionSetNames[instructionSet] << " instructions) *****" << endl;
+
+    // The column length is not a multiple of eight, so the kernels finish on their scalar loop.
+    numberOfValues |= 5;
+    vector<int> ints(numberOfValues);
+    vector<float> reals(numberOfValues);
+    srand(0);
+    for (unsigned i = 0; i < numberOfValues; i++)
+    {
+        ints[i] = rand() % 1000 - 500;
+        reals[i] = ints[i] + 0.5;
+    }
+    int intValue = 0;
+    float realValue = 0.5;
+
+    unsigned selectionSize = (numberOfValues + BYTE_SIZE - 1) / BYTE_SIZE;
+    vector<unsigned char> scalarSelection(selectionSize);
+    vector<unsigned char> selection(selectionSize);
+    for (unsigned t = 0; t < 2; t++)
+    {
+        AttrType type = t == 0 ? TypeInt : TypeReal;
+        const void *values = t == 0 ? (const void *)ints.data() : (const void *)reals.data();
+        const void *value = t == 0 ? (const void *)&intValue : (const void *)&realValue;
+        for (unsigned o = 0; o < sizeof(compOps) / sizeof(compOps[0]); o++)
+        {
+            double scalarRate = RBFBench_Simd_Select(type, compOps[o], ScalarInstructions, values, numberOfValues, value, scalarSelection.data());
+            cout << (type == TypeInt ? "Int " : "Real") << " " << compOpNames[o] << "\t" << instructionSetNames[ScalarInstructions]
+                 << " " << scalarRate / 1000000 << " M rows/s";
+
+            for (unsigned s = SseInstructions; s <= (unsigned)instructionSet; s++)
+            {
+                memset(selection.data(), 0xFF, selectionSize);
+                double rate = RBFBench_Simd_Select(type, compOps[o], (InstructionSet)s, values, numberOfValues, value, selection.data());
+                assert(selection == scalarSelection && "Every kernel should select the same values.");
+                cout << ", " << instructionSetNames[s] << " " << rate / 1000000 << " M rows/s (" << rate / scalarRate << "x)";
+            }
+            cout << endl;
+        }
+    }
+
+    cout << "RBF Benchmark SIMD Finished!" << endl << endl;
+    return 0;
+}
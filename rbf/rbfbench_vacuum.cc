@@ -0,0 +1,168 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line.
+const unsigned defaultNumberOfRecords = 20000;
+// One record in this many grows once the pages are full, which moves it behind a tombstone.
+const unsigned movedRecordInterval = 5;
+// Records are read into a buffer of this size.
+const unsigned bufferSize = 100;
+
+void prepareVacuumRecord(const unsigned index, const int nameLength, void *buffer)
+{
+    int recordSize = 0;
+    unsigned char nullsIndicator = 0;
+    string name(nameLength, (char)('a' + index % 26));
+    prepareRecord(4, &nullsIndicator, nameLength, name, index, (float)index, index * 10, buffer, &recordSize);
+}
+
+void RBFBench_Vacuum_Read(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                          const string &description, const vector<RID> &rids, const vector<int> &nameLengths)
+{
+    // Functions Benchmarked:
+    // 1. Read Record (every record that is left)
+    // 2. Scan (every record)
+    RC rc;
+    void *record = malloc(bufferSize);
+    void *returnedData = malloc(bufferSize);
+    unsigned numberOfRecords = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < rids.size(); i++)
+    {
+        if (nameLengths[i] == 0)
+        {
+            rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+            assert(rc != success && "Reading a deleted record should fail.");
+            continue;
+        }
+
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && "Reading a record should not fail.");
+        prepareVacuumRecord(i, nameLengths[i], record);
+        assert(memcmp(record, returnedData, 1 + 4 + nameLengths[i] + 12) == 0 && "The record should read back as it was last written.");
+        numberOfRecords++;
+    }
+    double readTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    RID rid;
+    unsigned count = 0;
+    start = chrono::steady_clock::now();
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        count++;
+    }
+    double scanTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    rbfmScanIterator.close();
+
+    // A record that moved is seen through its tombstone and again where it lies, until it goes home.
+    cout << description << ": " << fileHandle.getNumberOfPages() << " pages, readRecord() " << readTime / numberOfRecords * 1000
+         << " us per record, scan " << scanTime << " ms returning " << count << " of " << numberOfRecords << " records" << endl;
+
+    free(record);
+    free(returnedData);
+}
+
+int main(int argc, char *argv[])
+{
+    // Times reads and scans of a file full of tombstones and holes, before and after it is vacuumed
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_vacuum";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Vacuum (" << numberOfRecords << " records) *****" << endl;
+
+    RC rc;
+    FileHandle fileHandle;
+    void *record = malloc(bufferSize);
+    vector<RID> rids(numberOfRecords);
+    vector<int> nameLengths(numberOfRecords, 10); // 0 once deleted
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareVacuumRecord(i, nameLengths[i], record);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    // Grown records move to the end of the file, then the records around them are deleted, which makes
+    // room for them at home again. The last fifth of the table goes too, apart from what moved there.
+    for (unsigned i = 0; i < numberOfRecords; i += movedRecordInterval)
+    {
+        nameLengths[i] = 30;
+        prepareVacuumRecord(i, nameLengths[i], record);
+        rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+    }
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        if ((i % movedRecordInterval != 0 && i % 2 == 1) || i >= numberOfRecords / 5 * 4)
+        {
+            rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+            assert(rc == success && "Deleting a record should not fail.");
+            nameLengths[i] = 0;
+        }
+    }
+
+    RBFBench_Vacuum_Read(rbfm, fileHandle, recordDescriptor, "before vacuum", rids, nameLengths);
+
+    // Functions Benchmarked:
+    // 3. Vacuum
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    rc = rbfm->vacuum(fileHandle);
+    assert(rc == success && "Vacuuming the file should not fail.");
+    double vacuumTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "vacuum() " << vacuumTime << " ms" << endl;
+
+    RBFBench_Vacuum_Read(rbfm, fileHandle, recordDescriptor, "after vacuum ", rids, nameLengths);
+
+    // A vacuumed file takes inserts as usual, into the space it gave back.
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        if (nameLengths[i] == 0)
+        {
+            nameLengths[i] = 10;
+            prepareVacuumRecord(i, nameLengths[i], record);
+            rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+            assert(rc == success && "Inserting a record should not fail.");
+        }
+    }
+    RBFBench_Vacuum_Read(rbfm, fileHandle, recordDescriptor, "refilled     ", rids, nameLengths);
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    cout << "RBF Benchmark Vacuum Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// File size in MB when none is given on the command line.
+const unsigned defaultFileSize = 64;
+const unsigned pagesPerCall = 32;
+
+double RBFBench_Vectored_Append(PagedFileManager *pfm, const string &fileName, const unsigned numberOfPages, const bool vectored)
+{
+    // Functions Benchmarked:
+    // 1. Append Page, one call per page versus appendPages() with pagesPerCall pages
+    RC rc;
+    FileHandle fileHandle;
+    char *data = (char *)malloc(pagesPerCall * PAGE_SIZE);
+
+    remove(fileName.c_str());
+    rc = pfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    rc = pfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfPages; i += pagesPerCall)
+    {
+        for (unsigned j = 0; j < pagesPerCall; j++)
+        {
+            memset(data + j * PAGE_SIZE, (i + j) % 94 + 32, PAGE_SIZE);
+        }
+
+        if (vectored)
+        {
+            rc = fileHandle.appendPages(pagesPerCall, data);
+            assert(rc == success && "Appending pages should not fail.");
+            continue;
+        }
+
+        for (unsigned j = 0; j < pagesPerCall; j++)
+        {
+            rc = fileHandle.appendPage(data + j * PAGE_SIZE);
+            assert(rc == success && "Appending a page should not fail.");
+        }
+    }
+
+    rc = pfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    rc = pfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    assert(fileHandle.getNumberOfPages() == numberOfPages && "Every page should have been appended.");
+
+    unsigned readPageCount = 0, writePageCount = 0, appendPageCount = 0;
+    fileHandle.collectCounterValues(readPageCount, writePageCount, appendPageCount);
+    assert(appendPageCount == numberOfPages && "Appends should be counted per page.");
+
+    rc = pfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    cout << (vectored ? "appendPages(): " : "appendPage():  ") << numberOfPages << " pages in " << elapsed << " ms" << endl;
+
+    free(data);
+    return elapsed;
+}
+
+double RBFBench_Vectored_Read(PagedFileManager *pfm, const string &fileName, const unsigned numberOfPages, const bool vectored)
+{
+    // Functions Benchmarked:
+    // 1. Read Page, one call per page versus readPages() with pagesPerCall pages
+    RC rc;
+    FileHandle fileHandle;
+    char *data = (char *)malloc(pagesPerCall * PAGE_SIZE);
+
+    // Read-ahead would hide the page-at-a-time reads behind its own threads.
+    pfm->setReadAheadDepth(0);
+    rc = pfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    // The counters are kept in the file, so only this run's reads are compared.
+    unsigned readPageCount = 0, writePageCount = 0, appendPageCount = 0;
+    fileHandle.collectCounterValues(readPageCount, writePageCount, appendPageCount);
+    unsigned initialReadPageCount = readPageCount;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfPages; i += pagesPerCall)
+    {
+        if (vectored)
+        {
+            rc = fileHandle.readPages(i, pagesPerCall, data);
+            assert(rc == success && "Reading pages should not fail.");
+        }
+        else
+        {
+            for (unsigned j = 0; j < pagesPerCall; j++)
+            {
+                rc = fileHandle.readPage(i + j, data + j * PAGE_SIZE);
+                assert(rc == success && "Reading a page should not fail.");
+            }
+        }
+
+        for (unsigned j = 0; j < pagesPerCall; j++)
+        {
+            assert(data[j * PAGE_SIZE] == (char)((i + j) % 94 + 32) && "The page should read back as it was appended.");
+        }
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    fileHandle.collectCounterValues(readPageCount, writePageCount, appendPageCount);
+    assert(readPageCount - initialReadPageCount == numberOfPages && "Reads should be counted per page.");
+
+    rc = pfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    pfm->setReadAheadDepth(DEFAULT_READ_AHEAD_DEPTH);
+
+    cout << (vectored ? "readPages():   " : "readPage():    ") << numberOfPages << " pages in " << elapsed << " ms" << endl;
+
+    free(data);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares page-at-a-time appends and reads with the vectored calls, on a warm OS page cache
+    PagedFileManager *pfm = PagedFileManager::instance();
+    string fileName = "bench_vectored";
+    unsigned fileSize = argc > 1 ? atoi(argv[1]) : defaultFileSize;
+    unsigned numberOfPages = fileSize * (1024 * 1024 / PAGE_SIZE) / pagesPerCall * pagesPerCall;
+    cout << endl << "***** In RBF Benchmark Vectored I/O (" << fileSize << " MB) *****" << endl;
+
+    double appendTime = RBFBench_Vectored_Append(pfm, fileName, numberOfPages, false);
+    double appendPagesTime = RBFBench_Vectored_Append(pfm, fileName, numberOfPages, true);
+    // The first read only warms the OS page cache.
+    RBFBench_Vectored_Read(pfm, fileName, numberOfPages, false);
+    double readTime = RBFBench_Vectored_Read(pfm, fileName, numberOfPages, false);
+    double readPagesTime = RBFBench_Vectored_Read(pfm, fileName, numberOfPages, true);
+
+    RC rc = pfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "appendPages() speedup: " << appendTime / appendPagesTime << "x" << endl;
+    cout << "readPages() speedup: " << readTime / readPagesTime << "x" << endl;
+    cout << "RBF Benchmark Vectored I/O Finished!" << endl << endl;
+    return 0;
+}
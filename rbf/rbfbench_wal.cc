@@ -0,0 +1,164 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records inserted per commit mode when none is given on the command line. SyncCommit waits for
+// the disk on every insert, so it gets a tenth of them.
+const unsigned defaultNumberOfRecords = 20000;
+
+double RBFBench_WAL_Insert(RecordBasedFileManager *rbfm, const string &fileName, const CommitMode commitMode,
+                           const unsigned numberOfRecords, const bool closeFile)
+{
+    // Functions Benchmarked:
+    // 1. Insert Record (each one committed as the commit mode says)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    PagedFileManager::instance()->setCommitMode(commitMode);
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    if (closeFile)
+    {
+        rc = rbfm->closeFile(fileHandle);
+        assert(rc == success && "Closing the file should not fail.");
+    }
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    free(record);
+    free(nullsIndicator);
+    return elapsed;
+}
+
+unsigned RBFBench_WAL_Count(RecordBasedFileManager *rbfm, const string &fileName, const unsigned numberOfRecords)
+{
+    // Functions Benchmarked:
+    // 1. Scan (full table, checking every record against what was inserted)
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createLargeRecordDescriptor(recordDescriptor);
+    vector<string> attributes;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        attributes.push_back(recordDescriptor[i].name);
+    }
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    // Free-space search puts records on earlier pages, so they are matched by the index they carry.
+    unsigned count = 0;
+    vector<bool> seen(numberOfRecords, false);
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        int length = 0, index = 0;
+        memcpy(&length, (char *)returnedData + nullFieldsIndicatorActualSize, sizeof(int));
+        memcpy(&index, (char *)returnedData + nullFieldsIndicatorActualSize + sizeof(int) + length, sizeof(int));
+        assert(index >= 0 && (unsigned)index < numberOfRecords && !seen[index] && "Every record should be there once.");
+        seen[index] = true;
+
+        prepareLargeRecord(recordDescriptor.size(), nullsIndicator, index, record, &recordSize);
+        assert(memcmp(record, returnedData, recordSize) == 0 && "Every record should come back as it was inserted.");
+        count++;
+    }
+    rbfmScanIterator.close();
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    free(record);
+    free(returnedData);
+    free(nullsIndicator);
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares insert throughput under each commit mode, and checks that a crash loses no committed insert
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_wal";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark WAL (" << numberOfRecords << " records) *****" << endl;
+
+    // The child dies without closing the file, so its dirty pages never leave the buffer pool.
+    // Only the log can bring back what it committed. This runs first, before any writer thread exists.
+    unsigned crashRecords = numberOfRecords / 10;
+    pid_t child = fork();
+    if (child == 0)
+    {
+        RBFBench_WAL_Insert(rbfm, fileName, SyncCommit, crashRecords, false);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    assert(WIFEXITED(status) && "The loading process should finish its inserts.");
+
+    PagedFileManager::instance()->setCommitMode(NoLogging);
+    unsigned recovered = RBFBench_WAL_Count(rbfm, fileName, crashRecords);
+    cout << "Crash after " << crashRecords << " committed inserts: " << recovered << " recovered from the log" << endl;
+    assert(recovered == crashRecords && "Recovery should bring back every committed insert.");
+
+    double plainTime = RBFBench_WAL_Insert(rbfm, fileName, NoLogging, numberOfRecords, true);
+    double groupTime = RBFBench_WAL_Insert(rbfm, fileName, GroupCommit, numberOfRecords, true);
+    assert(RBFBench_WAL_Count(rbfm, fileName, numberOfRecords) == numberOfRecords && "Every insert should be in the file.");
+    double syncTime = RBFBench_WAL_Insert(rbfm, fileName, SyncCommit, crashRecords, true);
+    PagedFileManager::instance()->setCommitMode(DEFAULT_COMMIT_MODE);
+
+    cout << "no logging:   " << numberOfRecords / (plainTime / 1000) << " inserts/s" << endl;
+    cout << "group commit: " << numberOfRecords / (groupTime / 1000) << " inserts/s" << endl;
+    cout << "sync commit:  " << crashRecords / (syncTime / 1000) << " inserts/s (one fdatasync per insert)" << endl;
+
+    RC rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Benchmark WAL Finished!" << endl << endl;
+    return 0;
+}
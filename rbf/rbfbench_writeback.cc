@@ -0,0 +1,100 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Large pages so the pages left dirty in the pool add up to a close worth measuring.
+const unsigned benchPageSize = 65536;
+// Pages written when none are given on the command line, kept below the pool size so none are evicted.
+const unsigned defaultNumberOfPages = 1000;
+// Time the foreground spends on other work between writing the pages and closing the file.
+const unsigned idleTime = 500;
+
+double RBFBench_WriteBack_Close(PagedFileManager *pfm, const string &fileName, const unsigned numberOfPages, const unsigned rate)
+{
+    // Functions Benchmarked:
+    // 1. Append Page, then Write Page (every page left dirty in the pool)
+    // 2. Close File (writes back whatever the page writer has not)
+    RC rc;
+    FileHandle fileHandle;
+    char *data = (char *)malloc(benchPageSize);
+    memset(data, 0, benchPageSize);
+
+    pfm->setWriteBackRate(rate);
+    remove(fileName.c_str());
+    rc = pfm->createFile(fileName, benchPageSize);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = pfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned i = 0; i < numberOfPages; i++)
+    {
+        data[0] = (char)(i % 94 + 32);
+        rc = fileHandle.appendPage(data);
+        assert(rc == success && "Appending a page should not fail.");
+    }
+    for (unsigned i = 0; i < numberOfPages; i++)
+    {
+        data[0] = (char)(i % 94 + 33);
+        rc = fileHandle.writePage(i, data);
+        assert(rc == success && "Writing a page should not fail.");
+    }
+    double writeTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    unsigned dirtyAfterWrite = fileHandle.getNumberOfDirtyPages();
+
+    this_thread::sleep_for(chrono::milliseconds(idleTime));
+    unsigned dirtyBeforeClose = fileHandle.getNumberOfDirtyPages();
+
+    start = chrono::steady_clock::now();
+    rc = pfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    double closeTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Every page reaches the file, whoever wrote it.
+    rc = pfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    for (unsigned i = 0; i < numberOfPages; i++)
+    {
+        rc = fileHandle.readPage(i, data);
+        assert(rc == success && "Reading a page should not fail.");
+        assert(data[0] == (char)(i % 94 + 33) && "The page should read back as it was last written.");
+    }
+    rc = pfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = pfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "write-back " << rate << " pages/s: writes " << writeTime << " ms, dirty pages " << dirtyAfterWrite
+         << " -> " << dirtyBeforeClose << " after " << idleTime << " ms, closeFile() " << closeTime << " ms" << endl;
+
+    pfm->setWriteBackRate(DEFAULT_WRITE_BACK_RATE);
+    free(data);
+    return closeTime;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares the cost of closing a file whose pages are all dirty, with and without the page writer
+    PagedFileManager *pfm = PagedFileManager::instance();
+    string fileName = "bench_writeback";
+    unsigned numberOfPages = argc > 1 ? atoi(argv[1]) : defaultNumberOfPages;
+    cout << endl << "***** In RBF Benchmark Write-Back (" << numberOfPages << " pages of " << benchPageSize / 1024 << " KB) *****" << endl;
+
+    double closeTime = RBFBench_WriteBack_Close(pfm, fileName, numberOfPages, 0);
+    double writerCloseTime = RBFBench_WriteBack_Close(pfm, fileName, numberOfPages, DEFAULT_WRITE_BACK_RATE);
+
+    cout << "closeFile() speedup: " << closeTime / writerCloseTime << "x" << endl;
+    cout << "RBF Benchmark Write-Back Finished!" << endl << endl;
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Records loaded when none are given on the command line, few enough for the table to stay in the buffer pool.
+const unsigned defaultNumberOfRecords = 50000;
+// Every scan is repeated this many times and timed as a whole.
+const unsigned numberOfRuns = 5;
+// Records are prepared in buffers of this size.
+const unsigned bufferSize = 100;
+
+void createZoneMapRecordDescriptor(vector<Attribute> &recordDescriptor)
+{
+    // Timestamp grows with every record, as it would in a log, Reading is random.
+    Attribute attr;
+    attr.name = "Timestamp";
+    attr.type = TypeInt;
+    attr.length = (AttrLength)4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Reading";
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Sensor";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength)30;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Value";
+    attr.type = TypeReal;
+    attr.length = (AttrLength)4;
+    recordDescriptor.push_back(attr);
+}
+
+void prepareZoneMapRecord(const unsigned index, void *buffer)
+{
+    int timestamp = index;
+    int reading = rand() % 1000;
+    string sensor = "sensor-" + to_string(index % 16);
+    int sensorLength = sensor.size();
+    float value = index * 0.5;
+
+    unsigned offset = 0;
+    memset(buffer, 0, 1);
+    offset += 1;
+    memcpy((char *)buffer + offset, &timestamp, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *)buffer + offset, &reading, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *)buffer + offset, &sensorLength, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *)buffer + offset, sensor.c_str(), sensorLength);
+    offset += sensorLength;
+    memcpy((char *)buffer + offset, &value, sizeof(float));
+}
+
+double RBFBench_ZoneMap_Scan(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                             const string &conditionAttribute, const CompOp compOp, const void *value,
+                             vector<pair<PageNum, unsigned> > &rids, unsigned &skippedPages)
+{
+    // Functions Benchmarked:
+    // 1. Scan (a batch at a time)
+    RC rc;
+    RecordBatch batch;
+    vector<string> projection(1, "Value");
+    double elapsed = 0;
+    for (unsigned k = 0; k < numberOfRuns; k++)
+    {
+        RBFM_ScanIterator rbfmScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, conditionAttribute, compOp, value, projection, rbfmScanIterator);
+        assert(rc == success && "Scanning the file should not fail.");
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (rbfmScanIterator.getNextBatch(batch) != RBFM_EOF)
+        {
+            for (unsigned i = 0; i < batch.size() && k == 0; i++)
+            {
+                rids.push_back(make_pair(batch.getRID(i).pageNum, batch.getRID(i).slotNum));
+            }
+        }
+        elapsed += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        skippedPages = rbfmScanIterator.getNumberOfSkippedPages();
+        rbfmScanIterator.close();
+    }
+
+    return elapsed / numberOfRuns;
+}
+
+int main(int argc, char *argv[])
+{
+    // Compares scans with a condition over a file with and without its zone map
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    string fileName = "bench_zonemap";
+    unsigned numberOfRecords = argc > 1 ? atoi(argv[1]) : defaultNumberOfRecords;
+    cout << endl << "***** In RBF Benchmark Zone Map (" << numberOfRecords << " records) *****" << endl;
+
+    RC rc;
+    FileHandle fileHandle;
+    RID rid;
+    void *record = malloc(bufferSize);
+    vector<Attribute> recordDescriptor;
+    createZoneMapRecordDescriptor(recordDescriptor);
+
+    remove(fileName.c_str());
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    srand(0);
+    for (unsigned i = 0; i < numberOfRecords; i++)
+    {
+        prepareZoneMapRecord(i, record);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    // The map is written back, and read again, when the file is closed and opened.
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    ZoneMap *zoneMap = rbfm->getZoneMap(fileHandle);
+    assert(zoneMap->isUsable(recordDescriptor) && "The zone map of a file written through the RBFM should be up to date.");
+
+    int recentTimestamp = numberOfRecords - numberOfRecords / 100;
+    int timestamp = numberOfRecords / 2;
+    int reading = 990;
+    int sensorLength = 8;
+    char sensor[12] = {0};
+    memcpy(sensor, &sensorLength, sizeof(int));
+    memcpy(sensor + sizeof(int), "sensor-9", sensorLength);
+    const char *conditionAttributes[] = {"Timestamp", "Timestamp", "Reading", "Sensor"};
+    const CompOp compOps[] = {GE_OP, EQ_OP, GT_OP, EQ_OP};
+    const void *values[] = {&recentTimestamp, &timestamp, &reading, sensor};
+    const char *conditionNames[] = {"Timestamp >= n-n/100", "Timestamp = n/2", "Reading > 990 (random)", "Sensor = sensor-9"};
+
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+    cout << numberOfPages << " pages" << endl;
+    for (unsigned c = 0; c < sizeof(compOps) / sizeof(compOps[0]); c++)
+    {
+        // Without the map: it is left out of date, as a file written before maps were kept would have it.
+        vector<pair<PageNum, unsigned> > rids;
+        vector<pair<PageNum, unsigned> > zoneMapRids;
+        unsigned skippedPages = 0;
+        zoneMap->upToDate = false;
+        double time = RBFBench_ZoneMap_Scan(rbfm, fileHandle, recordDescriptor, conditionAttributes[c], compOps[c], values[c], rids, skippedPages);
+        assert(skippedPages == 0 && "A scan should read every page without an up to date zone map.");
+
+        rc = rbfm->buildZoneMap(fileHandle, recordDescriptor);
+        assert(rc == success && "Building the zone map should not fail.");
+        double zoneMapTime = RBFBench_ZoneMap_Scan(rbfm, fileHandle, recordDescriptor, conditionAttributes[c], compOps[c], values[c], zoneMapRids, skippedPages);
+        assert(zoneMapRids == rids && "A scan should return the same records with or without the zone map.");
+
+        cout << conditionNames[c] << ": " << rids.size() << " records, " << skippedPages << " of " << numberOfPages << " pages skipped, "
+             << time << " ms without the zone map, " << zoneMapTime << " ms with it (" << time / zoneMapTime << "x)" << endl;
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+    free(record);
+
+    cout << "RBF Benchmark Zone Map Finished!" << endl << endl;
+    return 0;
+}
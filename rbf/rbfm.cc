@@ -1,5 +1,10 @@
 #include "rbfm.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SELECTION_KERNELS_X86
+#endif
+
 RecordBasedFileManager *RecordBasedFileManager::_rbf_manager = 0;
 PagedFileManager *RecordBasedFileManager::pfm = PagedFileManager::instance();
 
@@ -17,16 +22,51 @@ RecordBasedFileManager::RecordBasedFileManager()
 
 RecordBasedFileManager::~RecordBasedFileManager()
 {
+	for (unordered_map<string, ZoneMap *>::iterator it = zoneMaps.begin(); it != zoneMaps.end(); it++)
+	{
+		delete it->second;
+	}
+	for (unordered_map<string, Dictionary *>::iterator it = dictionaries.begin(); it != dictionaries.end(); it++)
+	{
+		delete it->second;
+	}
 }
 
 RC RecordBasedFileManager::createFile(const string &fileName)
 {
-	return pfm->createFile(fileName);
+	return createFile(fileName, PAGE_SIZE, VariableWidthFormat);
+}
+
+RC RecordBasedFileManager::createFile(const string &fileName, const unsigned pageSize)
+{
+	return createFile(fileName, pageSize, VariableWidthFormat);
+}
+
+RC RecordBasedFileManager::createFile(const string &fileName, const unsigned pageSize, const RecordFormat format)
+{
+	// A zone map or dictionary left behind by a file of the same name, removed without destroyFile(), is not this
+	// file's. The new file starts with an empty map, up to date, so every record written to it is in its map.
+	RC rc = pfm->createFile(fileName, pageSize, format);
+	if (rc == 0)
+	{
+		dropZoneMap(fileName);
+		dropDictionary(fileName);
+		ZoneMap zoneMap(fileName);
+		zoneMap.clear();
+		zoneMap.save();
+	}
+	return rc;
 }
 
 RC RecordBasedFileManager::destroyFile(const string &fileName)
 {
-	return pfm->destroyFile(fileName);
+	RC rc = pfm->destroyFile(fileName);
+	if (rc == 0)
+	{
+		dropZoneMap(fileName);
+		dropDictionary(fileName);
+	}
+	return rc;
 }
 
 RC RecordBasedFileManager::openFile(const string &fileName,
@@ -37,16 +77,36 @@ RC RecordBasedFileManager::openFile(const string &fileName,
 
 RC RecordBasedFileManager::closeFile(FileHandle &fileHandle)
 {
-	return pfm->closeFile(fileHandle);
+	ZoneMap *zoneMap = NULL;
+	Dictionary *dictionary = NULL;
+	if (fileHandle.pagedFile != NULL)
+	{
+		lock_guard<mutex> lock(zoneMapsMutex);
+		unordered_map<string, ZoneMap *>::iterator it = zoneMaps.find(fileHandle.pagedFile->fileName);
+		zoneMap = it != zoneMaps.end() ? it->second : NULL;
+	}
+	if (fileHandle.pagedFile != NULL)
+	{
+		lock_guard<mutex> lock(dictionariesMutex);
+		unordered_map<string, Dictionary *>::iterator it = dictionaries.find(fileHandle.pagedFile->fileName);
+		dictionary = it != dictionaries.end() ? it->second : NULL;
+	}
+
+	RC rc = pfm->closeFile(fileHandle);
+	if ((zoneMap != NULL && zoneMap->save() != 0) || (dictionary != NULL && dictionary->close() != 0))
+	{
+		rc = -1;
+	}
+	return rc;
 }
 
-RC RecordBasedFileManager::getSlotDirectoryEntry(const unsigned &slotNum, const void *pageBuffer, unsigned &slotOffset, unsigned &slotLen)
+RC RecordBasedFileManager::getSlotDirectoryEntry(const unsigned &slotNum, const void *pageBuffer, unsigned &slotOffset, unsigned &slotLen, const unsigned &pageSize)
 {
 	slotOffset = 0;
 	slotLen = 0;
 
 	unsigned slotOffsetStartsFrom = 0;
-	slotOffsetStartsFrom = PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE - ((slotNum + 1) * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
+	slotOffsetStartsFrom = pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE - ((slotNum + 1) * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
 
 	memcpy(&slotOffset, (char *)pageBuffer + slotOffsetStartsFrom, SLOT_OFFSET_SIZE);
 	memcpy(&slotLen, (char *)pageBuffer + (slotOffsetStartsFrom + SLOT_OFFSET_SIZE), SLOT_LENGTH_SIZE);
@@ -54,128 +114,159 @@ RC RecordBasedFileManager::getSlotDirectoryEntry(const unsigned &slotNum, const
 	return 0;
 }
 
-RC RecordBasedFileManager::reducePageFreeSpace(const void *pageBuffer, const unsigned &freeSpace)
+RC RecordBasedFileManager::reducePageFreeSpace(const void *pageBuffer, const unsigned &freeSpace, const unsigned &pageSize)
 {
 	unsigned currentSpace;
-	getPageFreeSpace(pageBuffer, currentSpace);
+	getPageFreeSpace(pageBuffer, currentSpace, pageSize);
 	currentSpace -= freeSpace;
-	memcpy((char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE, &currentSpace, PAGE_FREE_SPACE_SIZE);
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE, &currentSpace, PAGE_FREE_SPACE_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::increasePageFreeSpace(const void *pageBuffer, const unsigned &freeSpace)
+RC RecordBasedFileManager::increasePageFreeSpace(const void *pageBuffer, const unsigned &freeSpace, const unsigned &pageSize)
 {
 	unsigned currentSpace;
-	getPageFreeSpace(pageBuffer, currentSpace);
+	getPageFreeSpace(pageBuffer, currentSpace, pageSize);
 	currentSpace += freeSpace;
-	memcpy((char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE, &currentSpace, PAGE_FREE_SPACE_SIZE);
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE, &currentSpace, PAGE_FREE_SPACE_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::reduceNumberOfRecords(const void *pageBuffer)
+RC RecordBasedFileManager::reduceNumberOfRecords(const void *pageBuffer, const unsigned &pageSize)
 {
 	unsigned numberOfRecords = 0;
-	getNumberOfRecords(pageBuffer, numberOfRecords);
+	getNumberOfRecords(pageBuffer, numberOfRecords, pageSize);
 	numberOfRecords--;
-	memcpy((char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, &numberOfRecords, PAGE_NUMBER_OF_RECORDS_SIZE);
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, &numberOfRecords, PAGE_NUMBER_OF_RECORDS_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::increaseNumberOfRecords(const void *pageBuffer)
+RC RecordBasedFileManager::increaseNumberOfRecords(const void *pageBuffer, const unsigned &pageSize)
 {
 	unsigned numberOfRecords = 0;
-	getNumberOfRecords(pageBuffer, numberOfRecords);
+	getNumberOfRecords(pageBuffer, numberOfRecords, pageSize);
 	numberOfRecords++;
-	memcpy((char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, &numberOfRecords, PAGE_NUMBER_OF_RECORDS_SIZE);
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, &numberOfRecords, PAGE_NUMBER_OF_RECORDS_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::increaseNumberOfSlots(const void *pageBuffer)
+RC RecordBasedFileManager::increaseNumberOfSlots(const void *pageBuffer, const unsigned &pageSize)
 {
 	unsigned numberOfSlots = 0;
-	getNumberOfSlots(pageBuffer, numberOfSlots);
+	getNumberOfSlots(pageBuffer, numberOfSlots, pageSize);
 	numberOfSlots++;
-	memcpy((char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE, &numberOfSlots, NUMBER_OF_SLOTS_SIZE);
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE, &numberOfSlots, NUMBER_OF_SLOTS_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::getPageFreeSpace(const void *pageBuffer, unsigned &freeSpace)
+RC RecordBasedFileManager::getPageFreeSpace(const void *pageBuffer, unsigned &freeSpace, const unsigned &pageSize)
 {
-	memcpy(&freeSpace, (char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE, PAGE_FREE_SPACE_SIZE);
+	memcpy(&freeSpace, (char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE, PAGE_FREE_SPACE_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::getNumberOfRecords(const void *pageBuffer, unsigned &numberOfRecords)
+RC RecordBasedFileManager::getNumberOfRecords(const void *pageBuffer, unsigned &numberOfRecords, const unsigned &pageSize)
 {
-	memcpy(&numberOfRecords, (char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, PAGE_NUMBER_OF_RECORDS_SIZE);
+	memcpy(&numberOfRecords, (char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, PAGE_NUMBER_OF_RECORDS_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::getNumberOfSlots(const void *pageBuffer, unsigned &numberOfSlots)
+RC RecordBasedFileManager::getNumberOfSlots(const void *pageBuffer, unsigned &numberOfSlots, const unsigned &pageSize)
 {
-	memcpy(&numberOfSlots, (char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE, NUMBER_OF_SLOTS_SIZE);
+	memcpy(&numberOfSlots, (char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE, NUMBER_OF_SLOTS_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::updateSlotDirectory(const unsigned &slotNum, const unsigned &slotOffset, const unsigned &slotLen, void *pageBuffer)
+RC RecordBasedFileManager::updateSlotDirectory(const unsigned &slotNum, const unsigned &slotOffset, const unsigned &slotLen, void *pageBuffer, const unsigned &pageSize)
 {
-	unsigned slot = PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE - ((slotNum + 1) * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
+	unsigned slot = pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE - ((slotNum + 1) * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
 	memcpy((char *)pageBuffer + slot, &slotOffset, SLOT_OFFSET_SIZE);
 	memcpy((char *)pageBuffer + slot + SLOT_OFFSET_SIZE, &slotLen, SLOT_LENGTH_SIZE);
 	return 0;
 }
 
-RC RecordBasedFileManager::initializePageWithMetadata(void *pageBuffer)
+RC RecordBasedFileManager::initializePageWithMetadata(void *pageBuffer, const unsigned &pageSize)
 {
-	unsigned freeSpace = PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE;
-	memcpy((char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE, &freeSpace, PAGE_FREE_SPACE_SIZE);
+	unsigned freeSpace = pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE;
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE, &freeSpace, PAGE_FREE_SPACE_SIZE);
 
 	unsigned numberOfRecords = 0;
-	memcpy((char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, &numberOfRecords, PAGE_NUMBER_OF_RECORDS_SIZE);
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE, &numberOfRecords, PAGE_NUMBER_OF_RECORDS_SIZE);
 
 	unsigned numberOfSlots = 0;
-	memcpy((char *)pageBuffer + PAGE_SIZE - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE,
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE,
 		   &numberOfSlots, NUMBER_OF_SLOTS_SIZE);
 
 	return 0;
 }
 
-RC RecordBasedFileManager::getAvailableSlot(void *pageBuffer, unsigned &availableSlotNum)
+RC RecordBasedFileManager::getAvailableSlot(void *pageBuffer, unsigned &availableSlotNum, const unsigned &pageSize)
 {
 	unsigned nos = 0;
-	getNumberOfSlots(pageBuffer, nos);
+	getNumberOfSlots(pageBuffer, nos, pageSize);
 
-	int available = -1;
+	// The last deleted slot is reused, and the directory grows down, so it is walked from the last slot.
+	const char *directory = (const char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - NUMBER_OF_SLOTS_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - (nos * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
 	for (unsigned slot = 0; slot < nos; slot++)
 	{
-		if (checkIfDeleted(pageBuffer, slot))
+		unsigned short slotOffset = 0;
+		memcpy(&slotOffset, directory + slot * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE), SLOT_OFFSET_SIZE);
+		if (slotOffset == MAXXOUT_INDICATOR)
 		{
-			availableSlotNum = slot;
-			available = 0;
+			availableSlotNum = nos - 1 - slot;
+			return 0;
 		}
 	}
 
-	return available;
+	return -1;
 }
 
-RC RecordBasedFileManager::getPageEndPointer(const void *page, unsigned &endPointer)
+RC RecordBasedFileManager::getPageEndPointer(const void *page, unsigned &endPointer, const unsigned &pageSize)
 {
-	unsigned nos = 0, fs = 0;
-	getNumberOfSlots(page, nos);
-	getPageFreeSpace(page, fs);
+	// Deletes leave holes behind, so the end of the records is wherever the last live one ends.
+	unsigned nos = 0;
+	getNumberOfSlots(page, nos, pageSize);
 
-	endPointer = PAGE_SIZE - PAGE_FREE_SPACE_SIZE - NUMBER_OF_SLOTS_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - (nos * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE)) - fs;
+	// The directory is walked as it lies, the order of the slots does not matter here.
+	const char *directory = (const char *)page + pageSize - PAGE_FREE_SPACE_SIZE - NUMBER_OF_SLOTS_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - (nos * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
+	endPointer = 0;
+	for (unsigned slot = 0; slot < nos; slot++)
+	{
+		unsigned short slotOffset = 0, slotLen = 0;
+		memcpy(&slotOffset, directory + slot * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE), SLOT_OFFSET_SIZE);
+		memcpy(&slotLen, directory + slot * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE) + SLOT_OFFSET_SIZE, SLOT_LENGTH_SIZE);
+		if (slotOffset != MAXXOUT_INDICATOR && slotOffset + slotLen > endPointer)
+		{
+			endPointer = slotOffset + slotLen;
+		}
+	}
 
 	return 0;
 }
 
+RC RecordBasedFileManager::updateFreeSpaceMap(FileHandle &fileHandle, const PageNum &pageNum, const void *pageBuffer)
+{
+	unsigned pageSize = fileHandle.getPageSize();
+	unsigned freeSpace = 0;
+	getPageFreeSpace(pageBuffer, freeSpace, pageSize);
+	return fileHandle.setPageFreeSpace(pageNum, freeSpace);
+}
+
 RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid)
 {
-	RecordManager recordManager(recordDescriptor.size());
+	if (fileHandle.getRecordFormat() == PaxFormat)
+	{
+		return insertPaxRecord(fileHandle, recordDescriptor, data, rid);
+	}
 
-	if (recordManager.understandData(recordDescriptor, data) == 0 && recordManager.createRecord() == 0)
+	unsigned pageSize = fileHandle.getPageSize();
+	RecordView recordView;
+
+	// The record is encoded straight onto the page, in the format the file was created with.
+	if (recordView.initialize(recordDescriptor, (RecordFormat)fileHandle.getRecordFormat(), getDictionary(fileHandle)) == 0 &&
+		recordView.decodeData(data) == 0)
 	{
-		unsigned recordLength = recordManager.recordSize;
+		unsigned recordLength = recordView.getRecordSize();
 		unsigned requiredSpace = recordLength + (SLOT_LENGTH_SIZE + SLOT_OFFSET_SIZE);
 		int lastPageNum = (int)fileHandle.getNumberOfPages() - 1;
 		int freePageNum = -1;
@@ -189,20 +280,16 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
 			}
 			else
 			{
-				for (int i = 0; i <= lastPageNum - 1; i++)
+				PageNum candidatePageNum = 0;
+				if (fileHandle.findFreePage(requiredSpace, candidatePageNum) == 0 && fileHandle.isPageFree(candidatePageNum, requiredSpace))
 				{
-					if (fileHandle.isPageFree(i, requiredSpace))
-					{
-						freePageNum = i;
-						//fileHandle.decrementReadCounter();
-						break;
-					}
+					freePageNum = candidatePageNum;
 				}
 			}
 		}
 
-		void *page = malloc(PAGE_SIZE);
-		memset(page, 0, PAGE_SIZE);
+		void *page = malloc(pageSize);
+		memset(page, 0, pageSize);
 		int error = -1;
 
 		if (freePageNum >= 0)
@@ -210,101 +297,144 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
 			if (fileHandle.readPage(freePageNum, page) == 0)
 			{
 				unsigned numberOfRecords = 0;
-				getNumberOfRecords(page, numberOfRecords);
+				getNumberOfRecords(page, numberOfRecords, pageSize);
 
 				unsigned numberOfSlots = 0;
-				getNumberOfSlots(page, numberOfSlots);
-
-				unsigned endPointer = 0;
-				getPageEndPointer(page, endPointer);
-				memcpy((char *)page + endPointer, recordManager.record, recordManager.recordSize);
-				increaseNumberOfRecords(page);
+				getNumberOfSlots(page, numberOfSlots, pageSize);
 
 				unsigned availableSlotNum = 0;
-				if (getAvailableSlot(page, availableSlotNum) == 0)
+				bool slotAvailable = getAvailableSlot(page, availableSlotNum, pageSize) == 0;
+
+				// The holes deletes left are only closed up once the record does not fit after the last one.
+				unsigned endPointer = 0, contiguousFreeSpace = 0;
+				getContiguousFreeSpace(page, endPointer, contiguousFreeSpace, pageSize);
+				if (contiguousFreeSpace < recordLength + (slotAvailable ? 0 : SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE))
+				{
+					compactPage(page, endPointer, pageSize);
+				}
+				recordView.createRecord((char *)page + endPointer);
+				increaseNumberOfRecords(page, pageSize);
+
+				if (slotAvailable)
 				{
-					updateSlotDirectory(availableSlotNum, endPointer, recordManager.recordSize, page);
-					reducePageFreeSpace(page, recordManager.recordSize);
+					updateSlotDirectory(availableSlotNum, endPointer, recordLength, page, pageSize);
+					reducePageFreeSpace(page, recordLength, pageSize);
 					rid.slotNum = availableSlotNum;
 				}
 				else
 				{
-					updateSlotDirectory(numberOfSlots, endPointer, recordManager.recordSize, page);
-					increaseNumberOfSlots(page);
-					reducePageFreeSpace(page, recordManager.recordSize + (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
+					updateSlotDirectory(numberOfSlots, endPointer, recordLength, page, pageSize);
+					increaseNumberOfSlots(page, pageSize);
+					reducePageFreeSpace(page, recordLength + (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE), pageSize);
 					rid.slotNum = numberOfSlots;
 				}
 
 				fileHandle.writePage((unsigned)freePageNum, page);
+				updateFreeSpaceMap(fileHandle, freePageNum, page);
+				widenZoneMap(fileHandle, freePageNum, recordView);
 				rid.pageNum = freePageNum;
 				error = 0;
 			}
 		}
 		else
 		{
-			initializePageWithMetadata(page);
+			initializePageWithMetadata(page, pageSize);
 
-			memcpy((char *)page, (char *)recordManager.record, recordManager.recordSize);
+			recordView.createRecord(page);
 
-			updateSlotDirectory(0, 0, recordManager.recordSize, page);
-			increaseNumberOfSlots(page);
-			increaseNumberOfRecords(page);
-			reducePageFreeSpace(page, recordManager.recordSize + (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
+			updateSlotDirectory(0, 0, recordLength, page, pageSize);
+			increaseNumberOfSlots(page, pageSize);
+			increaseNumberOfRecords(page, pageSize);
+			reducePageFreeSpace(page, recordLength + (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE), pageSize);
 
 			fileHandle.appendPage(page);
+			updateFreeSpaceMap(fileHandle, lastPageNum + 1, page);
+			widenZoneMap(fileHandle, lastPageNum + 1, recordView);
 			rid.pageNum = lastPageNum + 1;
 			rid.slotNum = 0;
 			error = 0;
 		}
 
 		free(page);
-		free(recordManager.record);
-		return error;
+		return error == 0 ? fileHandle.commit() : error;
 	}
 
 	return -1;
 }
 
+RC RecordBasedFileManager::insertRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<const void *> &data, vector<RID> &rids)
+{
+	RBFM_InsertStream rbfmInsertStream;
+	if (insertStream(fileHandle, recordDescriptor, rbfmInsertStream) != 0)
+	{
+		return -1;
+	}
+
+	rids.resize(data.size());
+	for (unsigned i = 0; i < data.size(); i++)
+	{
+		if (rbfmInsertStream.insertRecord(data[i], rids[i]) != 0)
+		{
+			rbfmInsertStream.close();
+			return -1;
+		}
+	}
+
+	return rbfmInsertStream.close();
+}
+
+RC RecordBasedFileManager::insertStream(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, RBFM_InsertStream &rbfm_InsertStream)
+{
+	return rbfm_InsertStream.initialize(fileHandle, recordDescriptor);
+}
+
 RC RecordBasedFileManager::readRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data)
 {
-	void *page = malloc(PAGE_SIZE);
-	memset(page, 0, PAGE_SIZE);
+	if (fileHandle.getRecordFormat() == PaxFormat)
+	{
+		vector<int> attributes;
+		for (unsigned i = 0; i < recordDescriptor.size(); i++)
+		{
+			attributes.push_back(i);
+		}
+		return readPaxRecord(fileHandle, recordDescriptor, rid, attributes, data);
+	}
+
+	unsigned pageSize = fileHandle.getPageSize();
+	// The page stays pinned while the record is decoded straight out of it.
+	void *page = NULL;
 	int error = -1;
 
-	if (rid.pageNum >= 0 && rid.slotNum >= 0 && fileHandle.readPage(rid.pageNum, page) == 0)
+	if (rid.pageNum >= 0 && rid.slotNum >= 0 && fileHandle.pinPage(rid.pageNum, page) == 0)
 	{
-		if (checkIfDeleted(page, rid.slotNum))
+		if (checkIfDeleted(page, rid.slotNum, pageSize))
 		{
+			fileHandle.unpinPage(rid.pageNum, false);
 			return -1;
 		}
 
 		RID updatedRid;
-		if (checkIfTombStone(page, rid.slotNum, updatedRid))
+		if (checkIfTombStone(page, rid.slotNum, updatedRid, pageSize))
 		{
+			fileHandle.unpinPage(rid.pageNum, false);
 			return readRecord(fileHandle, recordDescriptor, updatedRid, data);
 		}
 
 		unsigned slotOffset = 0;
 		unsigned slotLen = 0;
-		if (getSlotDirectoryEntry(rid.slotNum, page, slotOffset, slotLen) == 0)
+		if (getSlotDirectoryEntry(rid.slotNum, page, slotOffset, slotLen, pageSize) == 0)
 		{
-			void *record = malloc(slotLen);
-			memset(record, 0, slotLen);
-			memcpy(record, (char *)page + slotOffset, slotLen);
-
-			RecordManager recordManager(recordDescriptor.size());
+			RecordView recordView;
 
-			if (recordManager.understandRecord(recordDescriptor, record) == 0 && recordManager.createData() == 0)
+			if (recordView.initialize(recordDescriptor, (RecordFormat)fileHandle.getRecordFormat(), getDictionary(fileHandle)) == 0 &&
+				recordView.decodeRecord((char *)page + slotOffset) == 0 && recordView.createData(data) == 0)
 			{
-				memcpy((char *)data, (char *)recordManager.rawData, recordManager.rawDataSize);
-				free(recordManager.rawData);
 				error = 0;
 			}
-			free(record);
 		}
+		fileHandle.unpinPage(rid.pageNum, false);
 	}
 
-	free(page);
 	return error;
 }
 
@@ -342,6 +472,7 @@ RC RecordManager::copyTo(RecordManager &recordManager)
 	recordManager.recordSize = recordSize;
 	recordManager.rawDataSize = rawDataSize;
 	recordManager.fieldValues = fieldValues;
+	return 0;
 }
 
 RC RecordManager::understandData(const vector<Attribute> &recordDescriptor, const void *data)
@@ -615,781 +746,3076 @@ RC RecordManager::print()
 	return -1;
 }
 
-RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid)
+RecordView::RecordView(const vector<Attribute> &recordDescriptor, const RecordFormat format, Dictionary *dictionary)
 {
-	void *page = malloc(PAGE_SIZE);
-	memset(page, 0, PAGE_SIZE);
-	int error = -1;
+	initialize(recordDescriptor, format, dictionary);
+}
 
-	if (rid.pageNum >= 0 && rid.slotNum >= 0 && fileHandle.readPage(rid.pageNum, page) == 0)
+RC RecordView::initialize(const vector<Attribute> &recordDescriptor, const RecordFormat format, Dictionary *dictionary)
+{
+	this->format = format;
+	this->dictionary = dictionary;
+	numberOfFields = recordDescriptor.size();
+	types.resize(numberOfFields);
+	widths.resize(numberOfFields);
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		types[i] = recordDescriptor[i].type;
+		// An Int or a Real takes its declared length in the data format, such as the 1 byte of the catalog's IsIndexed.
+		widths[i] = types[i] != TypeVarChar && recordDescriptor[i].length > 0 && recordDescriptor[i].length < sizeof(int)
+				? recordDescriptor[i].length : sizeof(int);
+	}
+
+	// The offset table is sized once here, decoding a record only overwrites it.
+	offset.assign(numberOfFields, 0);
+	length.assign(numberOfFields, 0);
+	codes.assign(numberOfFields, 0);
+	values.assign(numberOfFields, VarcharView());
+	nullFlag = NULL;
+	fields = NULL;
+	if (format == DictionaryFormat)
+	{
+		return dictionary != NULL ? 0 : -1;
+	}
+	return format != FixedWidthFormat || isFixedWidth(recordDescriptor) ? 0 : -1;
+}
+
+RC RecordView::decodeRecord(const void *record)
+{
+	RC rc = locateFields(record);
+	return rc == 0 && format == DictionaryFormat ? lookUpVarchars(NULL) : rc;
+}
+
+RC RecordView::locateFields(const void *record)
+{
+	unsigned storedNumberOfFields = 0;
+	memcpy(&storedNumberOfFields, (char *)record, RECORD_NUMBER_OF_FIELD_SIZE);
+	if (storedNumberOfFields != numberOfFields)
+	{
+		return -1;
+	}
+
+	unsigned nullFlagSize = (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+	fields = (const char *)record;
+	nullFlag = (const unsigned char *)fields + RECORD_NUMBER_OF_FIELD_SIZE;
+
+	// A fixed width record has no pointers to follow, every field is where the descriptor puts it.
+	if (format == FixedWidthFormat)
 	{
-		if (checkIfDeleted(page, rid.slotNum))
+		unsigned fieldStartPointer = RECORD_NUMBER_OF_FIELD_SIZE + nullFlagSize;
+		for (unsigned i = 0; i < numberOfFields; i++)
 		{
-			return -1;
+			offset[i] = fieldStartPointer + i * sizeof(int);
+			length[i] = isNull(i) ? 0 : sizeof(int);
 		}
+		return 0;
+	}
 
-		RID updatedRid;
-		if (checkIfTombStone(page, rid.slotNum, updatedRid))
+	unsigned actualNumberOfFields = 0;
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		if (!isNull(i))
 		{
-			return deleteRecord(fileHandle, recordDescriptor, updatedRid);
+			actualNumberOfFields++;
 		}
+	}
 
-		unsigned slotOffset = 0;
-		unsigned slotLen = 0;
-		if (getSlotDirectoryEntry(rid.slotNum, page, slotOffset, slotLen) == 0)
+	// Every field that is not null has the offset of its last byte in the pointer array.
+	unsigned pointer = RECORD_NUMBER_OF_FIELD_SIZE + nullFlagSize;
+	unsigned fieldStartPointer = pointer + (actualNumberOfFields * RECORD_FIELD_POINTER_SIZE);
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		offset[i] = fieldStartPointer;
+		length[i] = 0;
+		if (!isNull(i))
 		{
-			shiftRecordsToLeft(rid.slotNum, slotLen, page);
-			reduceNumberOfRecords(page);
-			increasePageFreeSpace(page, slotLen);
+			unsigned fieldEndPointer = 0;
+			memcpy(&fieldEndPointer, fields + pointer, RECORD_FIELD_POINTER_SIZE);
+			pointer += RECORD_FIELD_POINTER_SIZE;
 
-			fileHandle.writePage(rid.pageNum, page);
-			error = 0;
+			length[i] = fieldEndPointer - fieldStartPointer + 1;
+			fieldStartPointer += length[i];
 		}
 	}
 
-	free(page);
-	return error;
+	return 0;
 }
 
-RC RecordBasedFileManager::shiftRecordsToLeft(const unsigned &modifyingSlotNum, const unsigned &delta, void *page)
+RC RecordView::decodeRecord(const void *record, const vector<int> &attributes)
 {
-	if (delta == 0)
+	// Every field located on its own walks the null bytes again, so for many fields one pass over the record is cheaper.
+	if (format == DictionaryFormat)
 	{
-		return 0;
+		RC rc = locateFields(record);
+		return rc == 0 ? lookUpVarchars(&attributes) : rc;
+	}
+	if (attributes.size() * 4 >= numberOfFields)
+	{
+		return decodeRecord(record);
 	}
 
-	unsigned nos = 0, nor = 0, fs = 0;
-	getNumberOfSlots(page, nos);
-	getPageFreeSpace(page, fs);
-	getNumberOfRecords(page, nor);
+	unsigned storedNumberOfFields = 0;
+	memcpy(&storedNumberOfFields, (char *)record, RECORD_NUMBER_OF_FIELD_SIZE);
+	if (storedNumberOfFields != numberOfFields)
+	{
+		return -1;
+	}
+
+	fields = (const char *)record;
+	nullFlag = (const unsigned char *)fields + RECORD_NUMBER_OF_FIELD_SIZE;
+	for (unsigned k = 0; k < attributes.size(); k++)
+	{
+		locateField(record, attributes[k], offset[attributes[k]], length[attributes[k]], format);
+	}
 
-	unsigned endPointer = 0;
-	getPageEndPointer(page, endPointer);
+	return 0;
+}
 
-	unsigned slotOffset = 0;
-	unsigned slotLen = 0;
-	if (getSlotDirectoryEntry(modifyingSlotNum, page, slotOffset, slotLen) == 0)
+// A dictionary encoded record is copied out in the data format, with its VarChars looked up by their codes.
+// Only the given fields are copied, or all of them, and only their codes are kept.
+RC RecordView::lookUpVarchars(const vector<int> *attributes)
+{
+	unsigned nullFlagSize = (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+	unsigned numberOfCopies = attributes != NULL ? attributes->size() : numberOfFields;
+	unsigned dataSize = nullFlagSize;
+	for (unsigned k = 0; k < numberOfCopies; k++)
 	{
-		unsigned startPointer = 0;
-		startPointer = slotOffset + slotLen;
-		if (startPointer <= endPointer && delta <= slotLen)
+		unsigned i = attributes != NULL ? (*attributes)[k] : k;
+		if (!isNull(i) && types[i] == TypeVarChar)
 		{
-			memmove((char *)page + (startPointer - delta), (char *)page + startPointer, endPointer - startPointer);
-
-			if (updateFullSlotDirectory(modifyingSlotNum, page, delta, true) == 0)
+			memcpy(&codes[i], fields + offset[i], sizeof(unsigned));
+			if (length[i] != sizeof(unsigned) || codes[i] >= dictionary->getNumberOfCodes(i))
 			{
-				return 0;
+				return -1;
 			}
+			values[i] = dictionary->getValue(i, codes[i]);
+			dataSize += sizeof(int) + values[i].length;
+		}
+		else
+		{
+			dataSize += length[i];
 		}
 	}
 
-	return -1;
-}
-
-RC RecordBasedFileManager::shiftRecordsToRight(const unsigned &modifyingSlotNum, const unsigned &delta, void *page)
-{
-	if (delta == 0)
+	decoded.resize(dataSize);
+	char *data = decoded.data();
+	memcpy(data, nullFlag, nullFlagSize);
+	unsigned pointer = nullFlagSize;
+	for (unsigned k = 0; k < numberOfCopies; k++)
 	{
-		return 0;
+		unsigned i = attributes != NULL ? (*attributes)[k] : k;
+		const char *field = fields + offset[i];
+		if (!isNull(i) && types[i] == TypeVarChar)
+		{
+			memcpy(data + pointer, &values[i].length, sizeof(int));
+			pointer += sizeof(int);
+			field = values[i].data;
+			length[i] = values[i].length;
+		}
+		memcpy(data + pointer, field, length[i]);
+		offset[i] = pointer;
+		pointer += length[i];
 	}
+	fields = data;
+	nullFlag = (const unsigned char *)data;
+	return 0;
+}
 
-	unsigned nos = 0, nor = 0, fs = 0;
-	getNumberOfSlots(page, nos);
-	getPageFreeSpace(page, fs);
-	getNumberOfRecords(page, nor);
-
-	unsigned endPointer = 0;
-	getPageEndPointer(page, endPointer);
+RC RecordView::decodeData(const void *data)
+{
+	unsigned nullFlagSize = (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+	fields = (const char *)data;
+	nullFlag = (const unsigned char *)fields;
 
-	unsigned slotOffset = 0;
-	unsigned slotLen = 0;
-	if (getSlotDirectoryEntry(modifyingSlotNum, page, slotOffset, slotLen) == 0)
+	unsigned pointer = nullFlagSize;
+	for (unsigned i = 0; i < numberOfFields; i++)
 	{
-		unsigned startPointer = 0;
-		startPointer = slotOffset + slotLen;
-		if (startPointer <= endPointer && delta <= fs)
+		length[i] = 0;
+		if (!isNull(i))
 		{
-			memmove((char *)page + (startPointer + delta), (char *)page + startPointer, endPointer - startPointer);
-
-			if (updateFullSlotDirectory(modifyingSlotNum, page, delta, false) == 0)
+			if (types[i] == TypeVarChar)
 			{
-				return 0;
+				memcpy(&length[i], fields + pointer, sizeof(int));
+				pointer += sizeof(int);
+			}
+			else
+			{
+				length[i] = widths[i];
+			}
+		}
+		offset[i] = pointer;
+		pointer += length[i];
+		if (format == DictionaryFormat && types[i] == TypeVarChar && !isNull(i))
+		{
+			// Coded here, so the dictionary is on disk with the value before a record holding its code is.
+			if (dictionary->getCode(i, getVarchar(i), codes[i]) != 0)
+			{
+				return -1;
 			}
 		}
 	}
 
-	return -1;
+	return 0;
 }
 
-RC RecordBasedFileManager::updateFullSlotDirectory(const unsigned &modifyingSlotNum, void *page, const unsigned &delta, const bool &negative)
+RC RecordView::createData(void *data) const
 {
-	if (delta == 0)
+	unsigned nullFlagSize = (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+
+	// Without nulls the null bytes and the fields of a fixed width record are already in the data format.
+	if (format == FixedWidthFormat && !hasNulls())
 	{
+		memcpy((char *)data, nullFlag, nullFlagSize + numberOfFields * sizeof(int));
 		return 0;
 	}
 
-	unsigned nos = 0, nor = 0, fs = 0;
-	getNumberOfSlots(page, nos);
-	getPageFreeSpace(page, fs);
-	getNumberOfRecords(page, nor);
+	memcpy((char *)data, nullFlag, nullFlagSize);
 
-	unsigned currentSlotOffset = 0;
-	unsigned currentSlotLen = 0;
-	if (getSlotDirectoryEntry(modifyingSlotNum, page, currentSlotOffset, currentSlotLen) == 0)
+	unsigned pointer = nullFlagSize;
+	for (unsigned i = 0; i < numberOfFields; i++)
 	{
-		unsigned slotOffset = 0;
-		unsigned slotLen = 0;
-		for (unsigned slot = 0; slot < nos; slot++)
+		if (!isNull(i))
 		{
-			if (getSlotDirectoryEntry(slot, page, slotOffset, slotLen) == 0 && !checkIfDeleted(page, slot))
+			if (types[i] == TypeVarChar)
 			{
-				if (slotOffset > currentSlotOffset)
-				{
-					if (negative)
-					{
-						updateSlotDirectory(slot, slotOffset - delta, slotLen, page);
-					}
-					else
-					{
-						updateSlotDirectory(slot, slotOffset + delta, slotLen, page);
-					}
-				}
-				else if (slotOffset == currentSlotOffset && slot == modifyingSlotNum)
-				{
-					if (negative)
-					{
-						if (slotLen - delta == 0)
-						{
-							updateSlotDirectory(slot, MAXXOUT_INDICATOR, 0, page);
-						}
-						else
-						{
-							updateSlotDirectory(slot, slotOffset, slotLen - delta, page);
-						}
-					}
-					else
-					{
-						updateSlotDirectory(slot, slotOffset, slotLen + delta, page);
-					}
-				}
+				memcpy((char *)data + pointer, &length[i], sizeof(int));
+				pointer += sizeof(int);
 			}
-		}
 
-		return 0;
+			memcpy((char *)data + pointer, fields + offset[i], length[i]);
+			pointer += length[i];
+		}
 	}
 
-	return -1;
+	return 0;
 }
 
-bool RecordBasedFileManager::checkIfDeleted(const void *pageBuffer, const unsigned &slotNum)
+RC RecordView::createData(const vector<int> &attributes, void *data) const
 {
-	unsigned slotOffset = 0;
-	unsigned slotLen = 0;
-	if (getSlotDirectoryEntry(slotNum, pageBuffer, slotOffset, slotLen) == 0)
+	unsigned nullIndicatorSize = (attributes.size() + BYTE_SIZE - 1) / BYTE_SIZE;
+	memset(data, 0, nullIndicatorSize);
+
+	unsigned pointer = nullIndicatorSize;
+	for (unsigned k = 0; k < attributes.size(); k++)
 	{
-		if (slotOffset == MAXXOUT_INDICATOR)
+		unsigned i = attributes[k];
+		if (isNull(i))
 		{
-			return true;
+			*((unsigned char *)data + (k / BYTE_SIZE)) |= (1 << (BYTE_SIZE - 1 - (k % BYTE_SIZE)));
+			continue;
 		}
-	}
-
-	return false;
-}
 
-bool RecordBasedFileManager::checkIfTombStone(const void *pageBuffer, const unsigned &slotNum, RID &updatedRid)
-{
-	unsigned slotOffset = 0;
-	unsigned slotLen = 0;
-	if (getSlotDirectoryEntry(slotNum, pageBuffer, slotOffset, slotLen) == 0)
-	{
-		int numberOfFields = 0;
-		memcpy(&numberOfFields, (char *)pageBuffer + slotOffset, RECORD_NUMBER_OF_FIELD_SIZE);
-
-		if (numberOfFields == MAXXOUT_INDICATOR)
+		if (types[i] == TypeVarChar)
 		{
-			updatedRid.pageNum = 0;
-			updatedRid.slotNum = 0;
-			memcpy(&updatedRid.pageNum, (char *)pageBuffer + (slotOffset + RECORD_NUMBER_OF_FIELD_SIZE), PAGE_NUMBER_POINTER);
-			memcpy(&updatedRid.slotNum, (char *)pageBuffer + (slotOffset + RECORD_NUMBER_OF_FIELD_SIZE + PAGE_NUMBER_POINTER), SLOT_NUMBER_POINTER);
-			return true;
+			memcpy((char *)data + pointer, &length[i], sizeof(int));
+			pointer += sizeof(int);
 		}
+
+		memcpy((char *)data + pointer, fields + offset[i], length[i]);
+		pointer += length[i];
 	}
 
-	return false;
+	return 0;
 }
 
-RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid)
+bool RecordView::locateField(const void *record, const unsigned i, unsigned &offset, unsigned &length, const RecordFormat format)
 {
-	void *page = malloc(PAGE_SIZE);
-	memset(page, 0, PAGE_SIZE);
-	int error = -1;
+	unsigned numberOfFields = 0;
+	memcpy(&numberOfFields, (char *)record, RECORD_NUMBER_OF_FIELD_SIZE);
+	unsigned nullFlagSize = (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+	const unsigned char *nullFlag = (const unsigned char *)record + RECORD_NUMBER_OF_FIELD_SIZE;
+	offset = 0;
+	length = 0;
+	if (nullFlag[i / BYTE_SIZE] & (1 << (BYTE_SIZE - 1 - (i % BYTE_SIZE))))
+	{
+		return false;
+	}
 
-	if (rid.pageNum >= 0 && rid.slotNum >= 0 && fileHandle.readPage(rid.pageNum, page) == 0)
+	if (format == FixedWidthFormat)
+	{
+		offset = RECORD_NUMBER_OF_FIELD_SIZE + nullFlagSize + i * sizeof(int);
+		length = sizeof(int);
+		return true;
+	}
+
+	// Only fields that are not null have an end pointer, so counting the nulls gives the position of i's.
+	unsigned numberOfNulls = 0;
+	unsigned nullsBefore = 0;
+	for (unsigned b = 0; b < nullFlagSize; b++)
 	{
-		if (checkIfDeleted(page, rid.slotNum))
+		unsigned char flags = nullFlag[b];
+		if (b == nullFlagSize - 1 && numberOfFields % BYTE_SIZE != 0)
 		{
-			return -1;
+			flags &= 0xFF << (BYTE_SIZE - numberOfFields % BYTE_SIZE);
 		}
 
-		RID updatedRid;
-		if (checkIfTombStone(page, rid.slotNum, updatedRid))
+		numberOfNulls += __builtin_popcount(flags);
+		if (b < i / BYTE_SIZE)
+		{
+			nullsBefore += __builtin_popcount(flags);
+		}
+		else if (b == i / BYTE_SIZE)
 		{
-			return updateRecord(fileHandle, recordDescriptor, data, updatedRid);
+			nullsBefore += __builtin_popcount(flags >> (BYTE_SIZE - i % BYTE_SIZE));
 		}
+	}
 
-		RecordManager recordManager(recordDescriptor.size());
+	unsigned pointer = RECORD_NUMBER_OF_FIELD_SIZE + nullFlagSize + (i - nullsBefore) * RECORD_FIELD_POINTER_SIZE;
+	unsigned fieldStartPointer = RECORD_NUMBER_OF_FIELD_SIZE + nullFlagSize + (numberOfFields - numberOfNulls) * RECORD_FIELD_POINTER_SIZE;
+	if (i > nullsBefore)
+	{
+		unsigned previousEndPointer = 0;
+		memcpy(&previousEndPointer, (char *)record + pointer - RECORD_FIELD_POINTER_SIZE, RECORD_FIELD_POINTER_SIZE);
+		fieldStartPointer = previousEndPointer + 1;
+	}
 
-		if (recordManager.understandData(recordDescriptor, data) == 0 && recordManager.createRecord() == 0)
-		{
-			unsigned slotOffset = 0;
-			unsigned slotLen = 0;
-			if (getSlotDirectoryEntry(rid.slotNum, page, slotOffset, slotLen) == 0)
-			{
-				if (recordManager.recordSize > slotLen)
-				{
-					if (fileHandle.isPageFree(rid.pageNum, recordManager.recordSize - slotLen))
-					{
-						shiftRecordsToRight(rid.slotNum, recordManager.recordSize - slotLen, page);
-						memcpy((char *)page + slotOffset, recordManager.record, recordManager.recordSize);
-						reducePageFreeSpace(page, recordManager.recordSize - slotLen);
-						error = 0;
-					}
-					else
-					{
-						RID newRid;
-						if (insertRecord(fileHandle, recordDescriptor, data, newRid) == 0)
-						{
-							void *tombStone = malloc(TOMBSTONE_SIZE);
-							memset(tombStone, 0, TOMBSTONE_SIZE);
-							unsigned tSIndicator = MAXXOUT_INDICATOR;
-							memcpy((char *)tombStone, &tSIndicator, RECORD_NUMBER_OF_FIELD_SIZE);
-							memcpy((char *)tombStone + RECORD_NUMBER_OF_FIELD_SIZE, &newRid.pageNum, PAGE_NUMBER_POINTER);
-							memcpy((char *)tombStone + (RECORD_NUMBER_OF_FIELD_SIZE + PAGE_NUMBER_POINTER), &newRid.slotNum, SLOT_NUMBER_POINTER);
-
-							if (slotLen >= TOMBSTONE_SIZE)
-							{
-								shiftRecordsToLeft(rid.slotNum, slotLen - TOMBSTONE_SIZE, page);
-								increasePageFreeSpace(page, slotLen - TOMBSTONE_SIZE);
-								memcpy((char *)page + slotOffset, tombStone, TOMBSTONE_SIZE);
-								error = 0;
-							}
+	unsigned fieldEndPointer = 0;
+	memcpy(&fieldEndPointer, (char *)record + pointer, RECORD_FIELD_POINTER_SIZE);
+	offset = fieldStartPointer;
+	length = fieldEndPointer - fieldStartPointer + 1;
+	return true;
+}
 
-							char *temp = (char *)malloc(6);
-							memcpy(temp, (char *)tombStone, 6);
+unsigned RecordView::getDataSize() const
+{
+	unsigned dataSize = (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		if (!isNull(i))
+		{
+			dataSize += length[i] + (types[i] == TypeVarChar ? sizeof(int) : 0);
+		}
+	}
 
-							free(tombStone);
-						}
-					}
-				}
-				else if (recordManager.recordSize < slotLen)
-				{
-					shiftRecordsToLeft(rid.slotNum, slotLen - recordManager.recordSize, page);
-					memcpy((char *)page + slotOffset, recordManager.record, recordManager.recordSize);
-					increasePageFreeSpace(page, slotLen - recordManager.recordSize);
-					error = 0;
-				}
-				else
-				{
-					memcpy((char *)page + slotOffset, recordManager.record, recordManager.recordSize);
-					error = 0;
-				}
-			}
+	return dataSize;
+}
 
-			fileHandle.writePage(rid.pageNum, page);
-			free(recordManager.record);
+unsigned RecordView::getDataSize(const vector<int> &attributes) const
+{
+	unsigned dataSize = (attributes.size() + BYTE_SIZE - 1) / BYTE_SIZE;
+	for (unsigned k = 0; k < attributes.size(); k++)
+	{
+		unsigned i = attributes[k];
+		if (!isNull(i))
+		{
+			dataSize += length[i] + (types[i] == TypeVarChar ? sizeof(int) : 0);
 		}
 	}
 
-	free(page);
-	return error;
+	return dataSize;
 }
 
-RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const string &attributeName, void *data)
+RC RecordView::createRecord(void *record) const
 {
-	void *page = malloc(PAGE_SIZE);
-	memset(page, 0, PAGE_SIZE);
+	unsigned nullFlagSize = (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+	memcpy((char *)record, &numberOfFields, RECORD_NUMBER_OF_FIELD_SIZE);
 
-	if (rid.pageNum >= 0 && rid.slotNum >= 0 && fileHandle.readPage(rid.pageNum, page) == 0)
+	// Data without nulls is a fixed width record once the field count is put before it.
+	// A null field keeps its 4 bytes, zeroed.
+	if (format == FixedWidthFormat)
 	{
-		if (checkIfDeleted(page, rid.slotNum))
+		if (!hasNulls())
 		{
-			return -1;
+			memcpy((char *)record + RECORD_NUMBER_OF_FIELD_SIZE, nullFlag, nullFlagSize + numberOfFields * sizeof(int));
+			return 0;
 		}
 
-		RID updatedRid;
-		if (checkIfTombStone(page, rid.slotNum, updatedRid))
+		char *fieldStart = (char *)record + RECORD_NUMBER_OF_FIELD_SIZE + nullFlagSize;
+		memcpy((char *)record + RECORD_NUMBER_OF_FIELD_SIZE, nullFlag, nullFlagSize);
+		for (unsigned i = 0; i < numberOfFields; i++)
 		{
-			return readAttribute(fileHandle, recordDescriptor, updatedRid, attributeName, data);
+			if (isNull(i))
+			{
+				memset(fieldStart + i * sizeof(int), 0, sizeof(int));
+			}
+			else
+			{
+				memcpy(fieldStart + i * sizeof(int), fields + offset[i], sizeof(int));
+			}
 		}
+		return 0;
+	}
 
-		unsigned slotOffset = 0;
-		unsigned slotLen = 0;
-		if (getSlotDirectoryEntry(rid.slotNum, page, slotOffset, slotLen) == 0)
+	memcpy((char *)record + RECORD_NUMBER_OF_FIELD_SIZE, nullFlag, nullFlagSize);
+
+	unsigned actualNumberOfFields = 0;
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		if (!isNull(i))
 		{
-			void *record = malloc(slotLen);
-			memset(record, 0, slotLen);
-			memcpy(record, (char *)page + slotOffset, slotLen);
+			actualNumberOfFields++;
+		}
+	}
 
-			RecordManager recordManager(recordDescriptor.size());
-			if (recordManager.understandRecord(recordDescriptor, record) == 0)
+	// Every field that is not null gets the offset of its last byte in the pointer array.
+	unsigned pointer = RECORD_NUMBER_OF_FIELD_SIZE + nullFlagSize;
+	unsigned fieldStartPointer = pointer + (actualNumberOfFields * RECORD_FIELD_POINTER_SIZE);
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		if (!isNull(i))
+		{
+			// A dictionary encoded VarChar is stored as its code.
+			const char *field = fields + offset[i];
+			unsigned fieldLength = length[i];
+			if (format == DictionaryFormat && types[i] == TypeVarChar)
 			{
-				for (int i = 0; i < recordDescriptor.size(); i++)
-				{
-					if ((recordDescriptor[i].name.compare(attributeName)) == 0)
-					{
-						unsigned char *nullIndicator = (unsigned char *)malloc(sizeof(char));
-						memset(nullIndicator, 0, sizeof(char));
-						int pointer = 0;
-						if (recordManager.fieldValues[i].length == -1)
-						{
-							nullIndicator[0] = 128; //10000000
-							memcpy(data, (char *)nullIndicator, sizeof(char));
-							free(record);
-							free(page);
-							recordManager.createData();
-							free(recordManager.rawData);
-							free(nullIndicator);
-							return 0;
-						}
+				field = (const char *)&codes[i];
+				fieldLength = sizeof(unsigned);
+			}
 
-						memcpy(data, (char *)nullIndicator, sizeof(char));
-						pointer += sizeof(char);
-						if (recordManager.fieldValues[i].type == TypeVarChar)
-						{
-							memcpy((char *)data + pointer, &recordManager.fieldValues[i].length, sizeof(int));
-							pointer += sizeof(int);
-						}
+			unsigned fieldEndPointer = fieldStartPointer + fieldLength - 1;
+			memcpy((char *)record + pointer, &fieldEndPointer, RECORD_FIELD_POINTER_SIZE);
+			pointer += RECORD_FIELD_POINTER_SIZE;
 
-						memcpy((char *)data + pointer, recordManager.fieldValues[i].value, recordManager.fieldValues[i].length);
-						free(record);
-						free(page);
-						free(nullIndicator);
-						recordManager.createData();
-						free(recordManager.rawData);
-						return 0;
-					}
-				}
-			}
-			free(record);
+			memcpy((char *)record + fieldStartPointer, field, fieldLength);
+			fieldStartPointer += fieldLength;
 		}
 	}
-	free(page);
-	return -1;
+
+	return 0;
 }
 
-RC RecordBasedFileManager::scan(FileHandle &fileHandle,
-								const vector<Attribute> &recordDescriptor,
-								const string &conditionAttribute,
-								const CompOp compOp,
-								const void *value,
-								const vector<string> &attributeNames,
-								RBFM_ScanIterator &rbfm_ScanIterator)
+unsigned RecordView::getRecordSize() const
 {
-	vector<int> attributes;
-	for (int i = 0; i < recordDescriptor.size(); i++)
+	unsigned recordSize = RECORD_NUMBER_OF_FIELD_SIZE + (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+	if (format == FixedWidthFormat)
 	{
-		if (find(attributeNames.begin(), attributeNames.end(), recordDescriptor[i].name) != attributeNames.end())
+		return recordSize + numberOfFields * sizeof(int);
+	}
+
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		if (!isNull(i))
 		{
-			attributes.push_back(i);
+			recordSize += RECORD_FIELD_POINTER_SIZE + (format == DictionaryFormat && types[i] == TypeVarChar ? sizeof(unsigned) : length[i]);
 		}
 	}
-	rbfm_ScanIterator.initialize(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes);
-	return 0;
+
+	return recordSize;
 }
 
-RC RBFM_ScanIterator::initialize(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
-								 const string &conditionedField,
-								 const CompOp compOp, const void *value, const vector<int> &attributes)
+bool RecordView::isNull(const unsigned i) const
 {
-	this->rbfm = RecordBasedFileManager::instance();
-	this->fileHandle = fileHandle;
-	this->recordDescriptor = recordDescriptor;
-	this->conditionedField = conditionedField;
-	this->compOp = compOp;
-	this->value = (char *)value;
-	this->attributes = attributes;
-	this->currentRID.pageNum = 0;
-	this->currentRID.slotNum = 0;
-	return 0;
+	return nullFlag[i / BYTE_SIZE] & (1 << (BYTE_SIZE - 1 - (i % BYTE_SIZE)));
 }
 
-RC RBFM_ScanIterator::getNextRecord(RID &rid, void *data)
+bool RecordView::hasNulls() const
 {
-	unsigned numberOfPages = this->fileHandle.getNumberOfPages();
-	for (unsigned i = currentRID.pageNum; i < numberOfPages; i++)
+	unsigned nullFlagSize = (numberOfFields + BYTE_SIZE - 1) / BYTE_SIZE;
+	for (unsigned b = 0; b < nullFlagSize; b++)
 	{
-		void *page = malloc(PAGE_SIZE);
-		memset(page, 0, PAGE_SIZE);
-		if (fileHandle.readPage(i, page) == 0)
+		if (nullFlag[b] != 0)
 		{
-			unsigned numberOfSlots = 0;
-			rbfm->getNumberOfSlots(page, numberOfSlots);
-			for (unsigned j = currentRID.slotNum; j < numberOfSlots; j++)
-			{
-				unsigned slotOffset = 0;
-				unsigned slotLen = 0;
-				if (rbfm->getSlotDirectoryEntry(j, page, slotOffset, slotLen) == 0)
-				{
-					if (slotOffset != 65535)
-					{
-						void *record = malloc(slotLen);
-						memset(record, 0, slotLen);
-						memcpy(record, (char *)page + slotOffset, slotLen);
-						unsigned numberOfFields = 0;
-						memcpy(&numberOfFields, (char *)record, RECORD_NUMBER_OF_FIELD_SIZE);
-						if (numberOfFields == 65535)
-						{
-							RID updatedRecordRID;
-							unsigned pageNum = 0;
-							unsigned slotNum = 0;
-							int pointer = RECORD_NUMBER_OF_FIELD_SIZE;
-							memcpy(&pageNum, (char *)record + pointer, PAGE_NUMBER_POINTER);
-							pointer += SLOT_NUMBER_POINTER;
-							memcpy(&slotNum, (char *)record + pointer, SLOT_NUMBER_POINTER);
-							updatedRecordRID.pageNum = pageNum;
-							updatedRecordRID.slotNum = slotNum;
-							if (fileHandle.readPage(updatedRecordRID.pageNum, page) == 0)
-							{
-								if (rbfm->getSlotDirectoryEntry(updatedRecordRID.slotNum, page, slotOffset, slotLen) == 0)
-								{
-									free(record);
-									record = malloc(slotLen);
-									memcpy(record, (char *)page + slotOffset, slotLen);
-								}
-							}
-						}
+			return true;
+		}
+	}
 
-						RecordManager recordManager(recordDescriptor.size());
+	return false;
+}
 
-						if (recordManager.understandRecord(recordDescriptor, record) == 0)
-						{
-							char *stringAgainst, *stringCompare;
-							unsigned valLength = 0;
+bool RecordView::isFixedWidth(const vector<Attribute> &recordDescriptor)
+{
+	for (unsigned i = 0; i < recordDescriptor.size(); i++)
+	{
+		if (recordDescriptor[i].type == TypeVarChar || recordDescriptor[i].length != sizeof(int))
+		{
+			return false;
+		}
+	}
 
-							unsigned index = 0;
-							bool found = false;
-							for (unsigned i = 0; i < recordDescriptor.size(); i++)
-							{
-								if (recordDescriptor[i].name.compare(conditionedField) == 0)
-								{
-									index = i;
-									found = true;
-								}
-							}
+	return !recordDescriptor.empty();
+}
 
-							if (compOp == NO_OP)
-							{
-								createData(recordManager, rid, data, i, j);
-								recordManager.createData();
-								free(recordManager.rawData);
-								free(record);
-								free(page);
-								return 0;
-							}
-							else if (!found)
-							{
-								recordManager.createData();
-								free(recordManager.rawData);
-								free(record);
-								free(page);
-								return RBFM_EOF;
-							}
-							else if (value == NULL)
-							{
-								recordManager.createData();
-								free(recordManager.rawData);
-								free(record);
-								free(page);
-								return RBFM_EOF;
-							}
-							else if (recordManager.fieldValues[index].length == -1)
-							{
-								continue;
-							}
-							else
-							{
-								if (recordManager.fieldValues[index].type == TypeVarChar)
-								{
-									memcpy(&valLength, (char *)value, sizeof(int));
-									unsigned compareValLen = recordManager.fieldValues[index].length;
-									unsigned compareLen = max(valLength, compareValLen);
-									stringAgainst = (char *)malloc(compareLen + 1);
-									stringCompare = (char *)malloc(compareLen + 1);
-									memset(stringAgainst, '\0', compareLen + 1);
-									memset(stringCompare, '\0', compareLen + 1);
-									memcpy(stringAgainst, (char *)value + sizeof(int), valLength);
-									memcpy(stringCompare, (char *)recordManager.fieldValues[index].value, compareValLen);
-								}
-								else
-								{
-									valLength = sizeof(int);
-								}
-
-								switch (compOp)
-								{
-								case EQ_OP:
-									if (recordManager.fieldValues[index].type == TypeVarChar)
-									{
-										if (strcmp((char *)stringCompare, (char *)stringAgainst) == 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											free(stringAgainst);
-											free(stringCompare);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-										else
-										{
-											free(stringAgainst);
-											free(stringCompare);
-										}
-									}
-									else
-									{
-										if (memcmp(recordManager.fieldValues[index].value, (ByteValue *)value, valLength) == 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-									}
-
-									break;
-
-								case LT_OP:
-									if (recordManager.fieldValues[index].type == TypeVarChar)
-									{
-										if (strcmp((char *)stringCompare, (char *)stringAgainst) < 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											free(stringAgainst);
-											free(stringCompare);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-										else
-										{
-											free(stringAgainst);
-											free(stringCompare);
-										}
-									}
-									else
-									{
-										if (memcmp(recordManager.fieldValues[index].value, (ByteValue *)value, valLength) < 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-									}
-
-									break;
-
-								case LE_OP:
-									if (recordManager.fieldValues[index].type == TypeVarChar)
-									{
-										if (strcmp((char *)stringCompare, (char *)stringAgainst) <= 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											free(stringAgainst);
-											free(stringCompare);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-										else
-										{
-											free(stringAgainst);
-											free(stringCompare);
-										}
-									}
-									else
-									{
-										if (memcmp(recordManager.fieldValues[index].value, (ByteValue *)value, valLength) <= 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-									}
-
-									break;
-
-								case GT_OP:
-									if (recordManager.fieldValues[index].type == TypeVarChar)
-									{
-										if (strcmp((char *)stringCompare, (char *)stringAgainst) > 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											free(stringAgainst);
-											free(stringCompare);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-										else
-										{
-											free(stringAgainst);
-											free(stringCompare);
-										}
-									}
-									else
-									{
-										if (memcmp(recordManager.fieldValues[index].value, (ByteValue *)value, valLength) > 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-									}
-
-									break;
-
-								case GE_OP:
-									if (recordManager.fieldValues[index].type == TypeVarChar)
-									{
-										if (strcmp((char *)stringCompare, (char *)stringAgainst) >= 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											free(stringAgainst);
-											free(stringCompare);
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-										else
-										{
-											free(stringAgainst);
-											free(stringCompare);
-										}
-									}
-									else
-									{
-										if (memcmp(recordManager.fieldValues[index].value, (ByteValue *)value, valLength) >= 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-									}
-
-									break;
-
-								case NE_OP:
-									if (recordManager.fieldValues[index].type == TypeVarChar)
-									{
-										if (strcmp((char *)stringCompare, (char *)stringAgainst) != 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											free(stringAgainst);
-											free(stringCompare);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-										else
-										{
-											free(stringAgainst);
-											free(stringCompare);
-										}
-									}
-									else
-									{
-										if (memcmp(recordManager.fieldValues[index].value, (ByteValue *)value, valLength) != 0)
-										{
-											createData(recordManager, rid, data, i, j);
-											recordManager.createData();
-											free(recordManager.rawData);
-											free(record);
-											free(page);
-											return 0;
-										}
-									}
-
-									break;
-
-								case NO_OP:
-									break;
-								}
-							}
-							recordManager.createData();
-							free(recordManager.rawData);
-						}
-						free(record);
-					}
-				}
-			}
+const char *RecordView::getField(const unsigned i) const
+{
+	return fields + offset[i];
+}
+
+unsigned RecordView::getLength(const unsigned i) const
+{
+	return length[i];
+}
+
+int RecordView::getInt(const unsigned i) const
+{
+	int value = 0;
+	memcpy(&value, fields + offset[i], min(length[i], (unsigned)sizeof(int)));
+	return value;
+}
+
+float RecordView::getFloat(const unsigned i) const
+{
+	float value = 0;
+	memcpy(&value, fields + offset[i], min(length[i], (unsigned)sizeof(float)));
+	return value;
+}
+
+VarcharView RecordView::getVarchar(const unsigned i) const
+{
+	VarcharView value;
+	value.data = fields + offset[i];
+	value.length = length[i];
+	return value;
+}
+
+bool RecordView::getCode(const unsigned i, unsigned &code) const
+{
+	if (format != DictionaryFormat || types[i] != TypeVarChar || isNull(i))
+	{
+		return false;
+	}
+
+	code = codes[i];
+	return true;
+}
+
+RC PaxLayout::initialize(const vector<Attribute> &recordDescriptor, const unsigned pageSize)
+{
+	this->pageSize = pageSize;
+	numberOfFields = recordDescriptor.size();
+	types.resize(numberOfFields);
+	widths.resize(numberOfFields);
+	minipages.resize(numberOfFields);
+	rowSize = 0;
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		types[i] = recordDescriptor[i].type;
+		if (types[i] != TypeVarChar && recordDescriptor[i].length != sizeof(int))
+		{
+			return -1;
 		}
-		free(page);
-		currentRID.slotNum = 0;
+		widths[i] = sizeof(int) + (types[i] == TypeVarChar ? recordDescriptor[i].length : 0);
+		rowSize += widths[i];
 	}
-	return RBFM_EOF;
+
+	// Besides its minipage bytes a row takes a null bit for every field and its used bit.
+	unsigned usableSpace = pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE;
+	numberOfRows = numberOfFields == 0 ? 0 : usableSpace * BYTE_SIZE / (rowSize * BYTE_SIZE + numberOfFields + 1);
+	while (numberOfRows > 0 && numberOfRows * rowSize + (numberOfFields + 1) * ((numberOfRows + BYTE_SIZE - 1) / BYTE_SIZE) > usableSpace)
+	{
+		numberOfRows--;
+	}
+	if (numberOfRows == 0)
+	{
+		return -1;
+	}
+
+	unsigned pointer = 0;
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		minipages[i] = pointer;
+		pointer += widths[i] * numberOfRows;
+	}
+	bitmapSize = (numberOfRows + BYTE_SIZE - 1) / BYTE_SIZE;
+	nullBitmaps = pointer;
+	usedBitmap = nullBitmaps + numberOfFields * bitmapSize;
+	return 0;
+}
+
+RC PaxLayout::initializePage(void *page) const
+{
+	memset(page, 0, pageSize);
+	unsigned freeSpace = numberOfRows * rowSize;
+	memcpy((char *)page + pageSize - PAGE_FREE_SPACE_SIZE, &freeSpace, PAGE_FREE_SPACE_SIZE);
+	return 0;
+}
+
+bool PaxLayout::isUsed(const void *page, const unsigned row) const
+{
+	return row < numberOfRows && (((const unsigned char *)page)[usedBitmap + row / BYTE_SIZE] & (1 << (BYTE_SIZE - 1 - (row % BYTE_SIZE))));
+}
+
+void PaxLayout::setUsed(void *page, const unsigned row, const bool used) const
+{
+	unsigned char &flags = ((unsigned char *)page)[usedBitmap + row / BYTE_SIZE];
+	flags = used ? flags | (1 << (BYTE_SIZE - 1 - (row % BYTE_SIZE))) : flags & ~(1 << (BYTE_SIZE - 1 - (row % BYTE_SIZE)));
+}
+
+const char *PaxLayout::getField(const void *page, const unsigned field, const unsigned row, unsigned &length) const
+{
+	length = 0;
+	if (((const unsigned char *)page)[nullBitmaps + field * bitmapSize + row / BYTE_SIZE] & (1 << (BYTE_SIZE - 1 - (row % BYTE_SIZE))))
+	{
+		return NULL;
+	}
+
+	const char *value = (const char *)page + minipages[field] + row * widths[field];
+	if (types[field] != TypeVarChar)
+	{
+		length = sizeof(int);
+		return value;
+	}
+	memcpy(&length, value, sizeof(int));
+	return value + sizeof(int);
 }
 
-RC RBFM_ScanIterator::createData(const RecordManager recordManager, RID &rid, void *data, const int i, const int j)
+RC PaxLayout::writeRow(void *page, const unsigned row, const RecordView &recordView) const
 {
-	int nullIndicatorSize = ceil((double)attributes.size() / CHAR_BIT);
-	unsigned char *nullIndicator = (unsigned char *)malloc(nullIndicatorSize);
-	memset(nullIndicator, 0, nullIndicatorSize);
-	int pointer = nullIndicatorSize;
-	for (int k = 0; k < attributes.size(); k++)
+	// A VarChar longer than it was declared has no room in its minipage, and the row is left as it was.
+	if (row >= numberOfRows || recordView.numberOfFields != numberOfFields)
+	{
+		return -1;
+	}
+	for (unsigned i = 0; i < numberOfFields; i++)
 	{
-		if (recordManager.fieldValues[attributes[k]].length < -1)
+		if (!recordView.isNull(i) && types[i] == TypeVarChar && sizeof(int) + recordView.getLength(i) > widths[i])
 		{
-			if (recordManager.fieldValues[attributes[k]].type == TypeVarChar)
-			{
-				memcpy((char *)data + pointer, &recordManager.fieldValues[attributes[k]].length, sizeof(int));
-				pointer += sizeof(int);
-			}
+			return -1;
+		}
+	}
 
-			memcpy((char *)data + pointer, recordManager.fieldValues[attributes[k]].value, recordManager.fieldValues[attributes[k]].length);
-			pointer += recordManager.fieldValues[attributes[k]].length;
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		unsigned char &nullFlags = ((unsigned char *)page)[nullBitmaps + i * bitmapSize + row / BYTE_SIZE];
+		char *value = (char *)page + minipages[i] + row * widths[i];
+		if (recordView.isNull(i))
+		{
+			nullFlags |= 1 << (BYTE_SIZE - 1 - (row % BYTE_SIZE));
+			memset(value, 0, widths[i]);
+			continue;
 		}
-		else
+
+		nullFlags &= ~(1 << (BYTE_SIZE - 1 - (row % BYTE_SIZE)));
+		unsigned length = recordView.getLength(i);
+		if (types[i] == TypeVarChar)
 		{
-			nullIndicator[k / 8] = (1 << (BYTE_SIZE - 1 - (k % BYTE_SIZE)));
+			memcpy(value, &length, sizeof(int));
+			value += sizeof(int);
 		}
+		memcpy(value, recordView.getField(i), length);
 	}
 
-	memcpy((char *)data, nullIndicator, nullIndicatorSize);
-	currentRID.pageNum = i;
-	currentRID.slotNum = j;
-	rid = currentRID;
-	currentRID.slotNum++;
-	free(nullIndicator);
 	return 0;
 }
-RC RBFM_ScanIterator::close()
+
+RC PaxLayout::createData(const void *page, const unsigned row, const vector<int> &attributes, void *data) const
 {
-	currentRID.pageNum = -1;
-	currentRID.slotNum = -1;
+	unsigned nullIndicatorSize = (attributes.size() + BYTE_SIZE - 1) / BYTE_SIZE;
+	memset(data, 0, nullIndicatorSize);
+
+	unsigned pointer = nullIndicatorSize;
+	for (unsigned k = 0; k < attributes.size(); k++)
+	{
+		unsigned length = 0;
+		const char *value = getField(page, attributes[k], row, length);
+		if (value == NULL)
+		{
+			*((unsigned char *)data + (k / BYTE_SIZE)) |= (1 << (BYTE_SIZE - 1 - (k % BYTE_SIZE)));
+			continue;
+		}
+
+		// A VarChar's length is stored right before it, as the data format has it.
+		if (types[attributes[k]] == TypeVarChar)
+		{
+			value -= sizeof(int);
+			length += sizeof(int);
+		}
+		memcpy((char *)data + pointer, value, length);
+		pointer += length;
+	}
+
 	return 0;
 }
+
+unsigned PaxLayout::getDataSize(const void *page, const unsigned row, const vector<int> &attributes) const
+{
+	unsigned dataSize = (attributes.size() + BYTE_SIZE - 1) / BYTE_SIZE;
+	for (unsigned k = 0; k < attributes.size(); k++)
+	{
+		unsigned length = 0;
+		if (getField(page, attributes[k], row, length) != NULL)
+		{
+			dataSize += length + (types[attributes[k]] == TypeVarChar ? sizeof(int) : 0);
+		}
+	}
+
+	return dataSize;
+}
+
+RC RecordBasedFileManager::insertPaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid)
+{
+	unsigned pageSize = fileHandle.getPageSize();
+	PaxLayout paxLayout;
+	RecordView recordView(recordDescriptor, PaxFormat);
+	if (paxLayout.initialize(recordDescriptor, pageSize) != 0 || recordView.decodeData(data) != 0)
+	{
+		return -1;
+	}
+
+	// Every row takes the same space, so any page with room for one more takes it, the last page first.
+	PageNum numberOfPages = fileHandle.getNumberOfPages();
+	PageNum pageNum = numberOfPages;
+	PageNum candidatePageNum = 0;
+	if (numberOfPages > 0 && fileHandle.isPageFree(numberOfPages - 1, paxLayout.rowSize))
+	{
+		pageNum = numberOfPages - 1;
+	}
+	else if (numberOfPages > 0 && fileHandle.findFreePage(paxLayout.rowSize, candidatePageNum) == 0 &&
+			 fileHandle.isPageFree(candidatePageNum, paxLayout.rowSize))
+	{
+		pageNum = candidatePageNum;
+	}
+
+	void *page = malloc(pageSize);
+	if (pageNum == numberOfPages)
+	{
+		paxLayout.initializePage(page);
+	}
+	else if (fileHandle.readPage(pageNum, page) != 0)
+	{
+		free(page);
+		return -1;
+	}
+
+	unsigned row = 0;
+	while (row < paxLayout.numberOfRows && paxLayout.isUsed(page, row))
+	{
+		row++;
+	}
+	if (paxLayout.writeRow(page, row, recordView) != 0)
+	{
+		free(page);
+		return -1;
+	}
+	paxLayout.setUsed(page, row, true);
+	increaseNumberOfRecords(page, pageSize);
+	reducePageFreeSpace(page, paxLayout.rowSize, pageSize);
+	unsigned numberOfSlots = 0;
+	getNumberOfSlots(page, numberOfSlots, pageSize);
+	for (; numberOfSlots <= row; numberOfSlots++)
+	{
+		increaseNumberOfSlots(page, pageSize);
+	}
+
+	RC rc = pageNum == numberOfPages ? fileHandle.appendPage(page) : fileHandle.writePage(pageNum, page);
+	if (rc == 0)
+	{
+		updateFreeSpaceMap(fileHandle, pageNum, page);
+		widenZoneMap(fileHandle, pageNum, recordView);
+		rid.pageNum = pageNum;
+		rid.slotNum = row;
+	}
+	free(page);
+	return rc == 0 ? fileHandle.commit() : -1;
+}
+
+RC RecordBasedFileManager::readPaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const vector<int> &attributes, void *data)
+{
+	PaxLayout paxLayout;
+	void *page = NULL;
+	if (paxLayout.initialize(recordDescriptor, fileHandle.getPageSize()) != 0 || fileHandle.pinPage(rid.pageNum, page) != 0)
+	{
+		return -1;
+	}
+
+	RC rc = paxLayout.isUsed(page, rid.slotNum) ? paxLayout.createData(page, rid.slotNum, attributes, data) : -1;
+	fileHandle.unpinPage(rid.pageNum, false);
+	return rc;
+}
+
+RC RecordBasedFileManager::updatePaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid)
+{
+	// A row has the same room whatever it holds, so it is always updated where it is.
+	unsigned pageSize = fileHandle.getPageSize();
+	PaxLayout paxLayout;
+	RecordView recordView(recordDescriptor, PaxFormat);
+	if (paxLayout.initialize(recordDescriptor, pageSize) != 0 || recordView.decodeData(data) != 0)
+	{
+		return -1;
+	}
+
+	void *page = malloc(pageSize);
+	RC rc = -1;
+	if (fileHandle.readPage(rid.pageNum, page) == 0 && paxLayout.isUsed(page, rid.slotNum) &&
+		paxLayout.writeRow(page, rid.slotNum, recordView) == 0 && fileHandle.writePage(rid.pageNum, page) == 0)
+	{
+		widenZoneMap(fileHandle, rid.pageNum, recordView);
+		rc = fileHandle.commit();
+	}
+	free(page);
+	return rc;
+}
+
+RC RecordBasedFileManager::deletePaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid)
+{
+	unsigned pageSize = fileHandle.getPageSize();
+	PaxLayout paxLayout;
+	if (paxLayout.initialize(recordDescriptor, pageSize) != 0)
+	{
+		return -1;
+	}
+
+	void *page = malloc(pageSize);
+	RC rc = -1;
+	if (fileHandle.readPage(rid.pageNum, page) == 0 && paxLayout.isUsed(page, rid.slotNum))
+	{
+		paxLayout.setUsed(page, rid.slotNum, false);
+		reduceNumberOfRecords(page, pageSize);
+		increasePageFreeSpace(page, paxLayout.rowSize, pageSize);
+		if (fileHandle.writePage(rid.pageNum, page) == 0)
+		{
+			updateFreeSpaceMap(fileHandle, rid.pageNum, page);
+			rc = fileHandle.commit();
+		}
+	}
+	free(page);
+	return rc;
+}
+
+RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid)
+{
+	if (fileHandle.getRecordFormat() == PaxFormat)
+	{
+		return deletePaxRecord(fileHandle, recordDescriptor, rid);
+	}
+
+	unsigned pageSize = fileHandle.getPageSize();
+	void *page = malloc(pageSize);
+	memset(page, 0, pageSize);
+	int error = -1;
+
+	if (rid.pageNum >= 0 && rid.slotNum >= 0 && fileHandle.readPage(rid.pageNum, page) == 0)
+	{
+		if (checkIfDeleted(page, rid.slotNum, pageSize))
+		{
+			return -1;
+		}
+
+		RID updatedRid;
+		if (checkIfTombStone(page, rid.slotNum, updatedRid, pageSize))
+		{
+			return deleteRecord(fileHandle, recordDescriptor, updatedRid);
+		}
+
+		unsigned slotOffset = 0;
+		unsigned slotLen = 0;
+		if (getSlotDirectoryEntry(rid.slotNum, page, slotOffset, slotLen, pageSize) == 0)
+		{
+			// The record's bytes become a hole, they are reclaimed when the page is next compacted.
+			updateSlotDirectory(rid.slotNum, MAXXOUT_INDICATOR, 0, page, pageSize);
+			reduceNumberOfRecords(page, pageSize);
+			increasePageFreeSpace(page, slotLen, pageSize);
+
+			fileHandle.writePage(rid.pageNum, page);
+			updateFreeSpaceMap(fileHandle, rid.pageNum, page);
+			error = 0;
+		}
+	}
+
+	free(page);
+	return error == 0 ? fileHandle.commit() : error;
+}
+
+RC RecordBasedFileManager::compactPage(void *page, unsigned &endPointer, const unsigned &pageSize)
+{
+	// Slides every live record down over the holes in one pass, in the order they lie on the page.
+	unsigned nos = 0;
+	getNumberOfSlots(page, nos, pageSize);
+
+	vector<pair<unsigned, unsigned> > records;
+	unsigned slotOffset = 0;
+	unsigned slotLen = 0;
+	for (unsigned slot = 0; slot < nos; slot++)
+	{
+		if (getSlotDirectoryEntry(slot, page, slotOffset, slotLen, pageSize) == 0 && slotOffset != MAXXOUT_INDICATOR)
+		{
+			records.push_back(make_pair(slotOffset, slot));
+		}
+	}
+	sort(records.begin(), records.end());
+
+	endPointer = 0;
+	for (unsigned i = 0; i < records.size(); i++)
+	{
+		getSlotDirectoryEntry(records[i].second, page, slotOffset, slotLen, pageSize);
+		if (slotOffset != endPointer)
+		{
+			memmove((char *)page + endPointer, (char *)page + slotOffset, slotLen);
+			updateSlotDirectory(records[i].second, endPointer, slotLen, page, pageSize);
+		}
+		endPointer += slotLen;
+	}
+
+	return 0;
+}
+
+RC RecordBasedFileManager::getContiguousFreeSpace(const void *page, unsigned &endPointer, unsigned &contiguousFreeSpace, const unsigned &pageSize)
+{
+	unsigned nos = 0;
+	getNumberOfSlots(page, nos, pageSize);
+	getPageEndPointer(page, endPointer, pageSize);
+
+	unsigned directoryStart = pageSize - PAGE_FREE_SPACE_SIZE - NUMBER_OF_SLOTS_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - (nos * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
+	contiguousFreeSpace = directoryStart - endPointer;
+	return 0;
+}
+
+bool RecordBasedFileManager::checkIfDeleted(const void *pageBuffer, const unsigned &slotNum, const unsigned &pageSize)
+{
+	unsigned slotOffset = 0;
+	unsigned slotLen = 0;
+	if (getSlotDirectoryEntry(slotNum, pageBuffer, slotOffset, slotLen, pageSize) == 0)
+	{
+		if (slotOffset == MAXXOUT_INDICATOR)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool RecordBasedFileManager::checkIfTombStone(const void *pageBuffer, const unsigned &slotNum, RID &updatedRid, const unsigned &pageSize)
+{
+	unsigned slotOffset = 0;
+	unsigned slotLen = 0;
+	if (getSlotDirectoryEntry(slotNum, pageBuffer, slotOffset, slotLen, pageSize) == 0)
+	{
+		int numberOfFields = 0;
+		memcpy(&numberOfFields, (char *)pageBuffer + slotOffset, RECORD_NUMBER_OF_FIELD_SIZE);
+
+		if (numberOfFields == MAXXOUT_INDICATOR)
+		{
+			updatedRid.pageNum = 0;
+			updatedRid.slotNum = 0;
+			memcpy(&updatedRid.pageNum, (char *)pageBuffer + (slotOffset + RECORD_NUMBER_OF_FIELD_SIZE), PAGE_NUMBER_POINTER);
+			memcpy(&updatedRid.slotNum, (char *)pageBuffer + (slotOffset + RECORD_NUMBER_OF_FIELD_SIZE + PAGE_NUMBER_POINTER), SLOT_NUMBER_POINTER);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+RC RecordBasedFileManager::writeTombstone(void *pageBuffer, const unsigned &slotOffset, const RID &updatedRid)
+{
+	unsigned tSIndicator = MAXXOUT_INDICATOR;
+	memcpy((char *)pageBuffer + slotOffset, &tSIndicator, RECORD_NUMBER_OF_FIELD_SIZE);
+	memcpy((char *)pageBuffer + slotOffset + RECORD_NUMBER_OF_FIELD_SIZE, &updatedRid.pageNum, PAGE_NUMBER_POINTER);
+	memcpy((char *)pageBuffer + slotOffset + (RECORD_NUMBER_OF_FIELD_SIZE + PAGE_NUMBER_POINTER), &updatedRid.slotNum, SLOT_NUMBER_POINTER);
+	return 0;
+}
+
+RC RecordBasedFileManager::freeSlot(void *pageBuffer, const unsigned &slotNum, const unsigned &pageSize)
+{
+	unsigned slotOffset = 0;
+	unsigned slotLen = 0;
+	if (getSlotDirectoryEntry(slotNum, pageBuffer, slotOffset, slotLen, pageSize) != 0 || slotOffset == MAXXOUT_INDICATOR)
+	{
+		return -1;
+	}
+
+	updateSlotDirectory(slotNum, MAXXOUT_INDICATOR, 0, pageBuffer, pageSize);
+	reduceNumberOfRecords(pageBuffer, pageSize);
+	increasePageFreeSpace(pageBuffer, slotLen, pageSize);
+	return 0;
+}
+
+// Free slots at the end of the directory are dropped, no RID that is still in use can name them.
+RC RecordBasedFileManager::trimSlotDirectory(void *pageBuffer, const unsigned &pageSize)
+{
+	unsigned numberOfSlots = 0;
+	getNumberOfSlots(pageBuffer, numberOfSlots, pageSize);
+	unsigned trimmedSlots = 0;
+	while (numberOfSlots > 0 && checkIfDeleted(pageBuffer, numberOfSlots - 1, pageSize))
+	{
+		numberOfSlots--;
+		trimmedSlots++;
+	}
+
+	memcpy((char *)pageBuffer + pageSize - PAGE_FREE_SPACE_SIZE - PAGE_NUMBER_OF_RECORDS_SIZE - NUMBER_OF_SLOTS_SIZE, &numberOfSlots, NUMBER_OF_SLOTS_SIZE);
+	increasePageFreeSpace(pageBuffer, trimmedSlots * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE), pageSize);
+	return 0;
+}
+
+RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid)
+{
+	if (fileHandle.getRecordFormat() == PaxFormat)
+	{
+		return updatePaxRecord(fileHandle, recordDescriptor, data, rid);
+	}
+
+	unsigned pageSize = fileHandle.getPageSize();
+	void *page = malloc(pageSize);
+	memset(page, 0, pageSize);
+	int error = -1;
+
+	if (rid.pageNum >= 0 && rid.slotNum >= 0 && fileHandle.readPage(rid.pageNum, page) == 0)
+	{
+		if (checkIfDeleted(page, rid.slotNum, pageSize))
+		{
+			return -1;
+		}
+
+		// A scan still finds the record through its tombstone, so the tombstone's page takes its new values too.
+		RID updatedRid;
+		RecordView recordView;
+		if (checkIfTombStone(page, rid.slotNum, updatedRid, pageSize))
+		{
+			free(page);
+			RC rc = updateRecord(fileHandle, recordDescriptor, data, updatedRid);
+			if (rc == 0 && recordView.initialize(recordDescriptor) == 0 && recordView.decodeData(data) == 0)
+			{
+				widenZoneMap(fileHandle, rid.pageNum, recordView);
+			}
+			return rc;
+		}
+
+		if (recordView.initialize(recordDescriptor, (RecordFormat)fileHandle.getRecordFormat(), getDictionary(fileHandle)) == 0 &&
+			recordView.decodeData(data) == 0)
+		{
+			unsigned recordSize = recordView.getRecordSize();
+			unsigned slotOffset = 0;
+			unsigned slotLen = 0;
+			if (getSlotDirectoryEntry(rid.slotNum, page, slotOffset, slotLen, pageSize) == 0)
+			{
+				unsigned fs = 0;
+				getPageFreeSpace(page, fs, pageSize);
+				if (recordSize > slotLen && recordSize - slotLen <= fs)
+				{
+					// A record that grows moves after the last one on the page, leaving a hole where it was,
+					// unless it is the last one already. The page is compacted only if neither fits.
+					unsigned endPointer = 0, contiguousFreeSpace = 0;
+					getContiguousFreeSpace(page, endPointer, contiguousFreeSpace, pageSize);
+					if (slotOffset + slotLen == endPointer && recordSize - slotLen <= contiguousFreeSpace)
+					{
+						endPointer = slotOffset;
+					}
+					else if (recordSize > contiguousFreeSpace)
+					{
+						updateSlotDirectory(rid.slotNum, MAXXOUT_INDICATOR, 0, page, pageSize);
+						compactPage(page, endPointer, pageSize);
+					}
+					recordView.createRecord((char *)page + endPointer);
+					updateSlotDirectory(rid.slotNum, endPointer, recordSize, page, pageSize);
+					reducePageFreeSpace(page, recordSize - slotLen, pageSize);
+					error = 0;
+				}
+				else if (recordSize > slotLen)
+				{
+					RID newRid;
+					if (insertRecord(fileHandle, recordDescriptor, data, newRid) == 0 && slotLen >= TOMBSTONE_SIZE)
+					{
+						writeTombstone(page, slotOffset, newRid);
+						updateSlotDirectory(rid.slotNum, slotOffset, TOMBSTONE_SIZE, page, pageSize);
+						increasePageFreeSpace(page, slotLen - TOMBSTONE_SIZE, pageSize);
+						error = 0;
+					}
+				}
+				else
+				{
+					// A record that shrinks or keeps its size is written where it is, what it gave up is a hole.
+					recordView.createRecord((char *)page + slotOffset);
+					updateSlotDirectory(rid.slotNum, slotOffset, recordSize, page, pageSize);
+					increasePageFreeSpace(page, slotLen - recordSize, pageSize);
+					error = 0;
+				}
+			}
+
+			fileHandle.writePage(rid.pageNum, page);
+			updateFreeSpaceMap(fileHandle, rid.pageNum, page);
+			if (error == 0)
+			{
+				widenZoneMap(fileHandle, rid.pageNum, recordView);
+			}
+		}
+	}
+
+	free(page);
+	return error == 0 ? fileHandle.commit() : error;
+}
+
+static unsigned long long getRIDKey(const RID &rid)
+{
+	return ((unsigned long long)rid.pageNum << 32) | rid.slotNum;
+}
+
+RC RecordBasedFileManager::vacuum(FileHandle &fileHandle)
+{
+	unsigned pageSize = fileHandle.getPageSize();
+	unsigned numberOfPages = fileHandle.getNumberOfPages();
+	// PAX pages have neither tombstones nor holes, only their empty pages at the end of the file are dropped.
+	bool pax = fileHandle.getRecordFormat() == PaxFormat;
+
+	// Every tombstone is found first, with its page pinned. One that another tombstone points at is
+	// in the middle of a chain, the record it leads to belongs to the tombstone the chain starts from.
+	unordered_map<unsigned long long, RID> forwards;
+	unordered_set<unsigned long long> forwarded;
+	for (PageNum pageNum = 0; pageNum < numberOfPages && !pax; pageNum++)
+	{
+		void *page = NULL;
+		if (fileHandle.pinPage(pageNum, page) != 0)
+		{
+			return -1;
+		}
+
+		unsigned numberOfSlots = 0;
+		getNumberOfSlots(page, numberOfSlots, pageSize);
+		for (unsigned slotNum = 0; slotNum < numberOfSlots; slotNum++)
+		{
+			RID updatedRid;
+			if (!checkIfDeleted(page, slotNum, pageSize) && checkIfTombStone(page, slotNum, updatedRid, pageSize))
+			{
+				RID rid = {pageNum, slotNum};
+				forwards[getRIDKey(rid)] = updatedRid;
+				forwarded.insert(getRIDKey(updatedRid));
+			}
+		}
+		fileHandle.unpinPage(pageNum, false);
+	}
+
+	// Then every page is read, fixed and written once. A record that moves home is written there before
+	// the slots it leaves are freed, so a crash in between leaves a copy behind, never loses it.
+	void *page = malloc(pageSize);
+	void *otherPage = malloc(pageSize);
+	vector<char> record;
+	int error = 0;
+	for (PageNum pageNum = 0; pageNum < numberOfPages && error == 0 && !pax; pageNum++)
+	{
+		if (fileHandle.readPage(pageNum, page) != 0)
+		{
+			error = -1;
+			break;
+		}
+
+		bool changed = false;
+		unsigned numberOfSlots = 0;
+		getNumberOfSlots(page, numberOfSlots, pageSize);
+		for (unsigned slotNum = 0; slotNum < numberOfSlots; slotNum++)
+		{
+			RID rid = {pageNum, slotNum};
+			unordered_map<unsigned long long, RID>::iterator forward = forwards.find(getRIDKey(rid));
+			if (forward == forwards.end() || forwarded.count(getRIDKey(rid)) != 0)
+			{
+				continue;
+			}
+			changed = true;
+
+			vector<RID> chain(1, forward->second);
+			while (chain.size() <= forwards.size() && (forward = forwards.find(getRIDKey(chain.back()))) != forwards.end())
+			{
+				chain.push_back(forward->second);
+			}
+			RID location = chain.back();
+			chain.pop_back();
+
+			// The record is copied out of wherever it is now, a deleted one leaves nothing to copy.
+			void *locationPage = page;
+			if (location.pageNum != pageNum && (location.pageNum >= numberOfPages || fileHandle.readPage(location.pageNum, otherPage) != 0))
+			{
+				locationPage = NULL;
+			}
+			else if (location.pageNum != pageNum)
+			{
+				locationPage = otherPage;
+			}
+
+			unsigned slotOffset = 0;
+			unsigned slotLen = 0;
+			record.clear();
+			if (locationPage != NULL && !checkIfDeleted(locationPage, location.slotNum, pageSize) &&
+				getSlotDirectoryEntry(location.slotNum, locationPage, slotOffset, slotLen, pageSize) == 0)
+			{
+				record.assign((char *)locationPage + slotOffset, (char *)locationPage + slotOffset + slotLen);
+				chain.push_back(location);
+			}
+
+			getSlotDirectoryEntry(slotNum, page, slotOffset, slotLen, pageSize);
+			unsigned freeSpace = 0;
+			getPageFreeSpace(page, freeSpace, pageSize);
+			if (record.empty())
+			{
+				freeSlot(page, slotNum, pageSize);
+			}
+			else if (record.size() <= slotLen + freeSpace)
+			{
+				// Same as a growing update: after the last record, or in place if it is the last, compacting if neither fits.
+				unsigned endPointer = 0, contiguousFreeSpace = 0;
+				getContiguousFreeSpace(page, endPointer, contiguousFreeSpace, pageSize);
+				if (record.size() <= slotLen || (slotOffset + slotLen == endPointer && record.size() - slotLen <= contiguousFreeSpace))
+				{
+					endPointer = slotOffset;
+				}
+				else if (record.size() > contiguousFreeSpace)
+				{
+					updateSlotDirectory(slotNum, MAXXOUT_INDICATOR, 0, page, pageSize);
+					compactPage(page, endPointer, pageSize);
+				}
+				memcpy((char *)page + endPointer, &record[0], record.size());
+				updateSlotDirectory(slotNum, endPointer, record.size(), page, pageSize);
+				getZoneMap(fileHandle)->merge(pageNum, location.pageNum);
+				increasePageFreeSpace(page, slotLen, pageSize);
+				reducePageFreeSpace(page, record.size(), pageSize);
+				fileHandle.writePage(pageNum, page);
+			}
+			else
+			{
+				writeTombstone(page, slotOffset, location);
+				chain.pop_back();
+			}
+
+			// What the record leaves behind on its way home is freed: the tombstones it went through, and its last copy.
+			for (unsigned i = 0; i < chain.size(); i++)
+			{
+				if (chain[i].pageNum == pageNum)
+				{
+					freeSlot(page, chain[i].slotNum, pageSize);
+				}
+				else if (chain[i].pageNum < numberOfPages && fileHandle.readPage(chain[i].pageNum, otherPage) == 0 &&
+						 freeSlot(otherPage, chain[i].slotNum, pageSize) == 0)
+				{
+					fileHandle.writePage(chain[i].pageNum, otherPage);
+					updateFreeSpaceMap(fileHandle, chain[i].pageNum, otherPage);
+				}
+			}
+		}
+
+		// Records freed on pages already behind leave holes there, which the next insert compacts.
+		unsigned trimmedNumberOfSlots = 0, freeSpace = 0, endPointer = 0, contiguousFreeSpace = 0;
+		trimSlotDirectory(page, pageSize);
+		getNumberOfSlots(page, trimmedNumberOfSlots, pageSize);
+		getPageFreeSpace(page, freeSpace, pageSize);
+		getContiguousFreeSpace(page, endPointer, contiguousFreeSpace, pageSize);
+		if (changed || trimmedNumberOfSlots < numberOfSlots || contiguousFreeSpace < freeSpace)
+		{
+			compactPage(page, endPointer, pageSize);
+			fileHandle.writePage(pageNum, page);
+			updateFreeSpaceMap(fileHandle, pageNum, page);
+			error = fileHandle.commit();
+		}
+	}
+
+	// Pages left without records at the end of the file are dropped.
+	PageNum lastPageNum = numberOfPages;
+	while (error == 0 && lastPageNum > 0 && fileHandle.readPage(lastPageNum - 1, page) == 0)
+	{
+		unsigned numberOfRecords = 0;
+		getNumberOfRecords(page, numberOfRecords, pageSize);
+		if (numberOfRecords != 0)
+		{
+			break;
+		}
+		lastPageNum--;
+	}
+	if (error == 0 && lastPageNum < numberOfPages)
+	{
+		error = fileHandle.truncate(lastPageNum) == 0 ? fileHandle.commit() : -1;
+	}
+
+	free(page);
+	free(otherPage);
+	return error;
+}
+
+RC RecordBasedFileManager::buildZoneMap(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor)
+{
+	ZoneMap *zoneMap = getZoneMap(fileHandle);
+	RecordView recordView;
+	if (zoneMap->clear() != 0 || recordView.initialize(recordDescriptor) != 0)
+	{
+		return -1;
+	}
+
+	vector<string> attributeNames;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++)
+	{
+		attributeNames.push_back(recordDescriptor[i].name);
+	}
+
+	// A record that moved is seen at its tombstone's page too, which only widens that page's zones.
+	RBFM_ScanIterator rbfmScanIterator;
+	if (scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, rbfmScanIterator) != 0)
+	{
+		return -1;
+	}
+	RC rc = 0;
+	RID rid;
+	RecordBatch batch;
+	while (rc == 0 && rbfmScanIterator.getNextBatch(batch) != RBFM_EOF)
+	{
+		for (unsigned i = 0; rc == 0 && i < batch.size(); i++)
+		{
+			rid = batch.getRID(i);
+			rc = recordView.decodeData(batch.getRecord(i)) == 0 ? zoneMap->widen(rid.pageNum, recordView) : -1;
+		}
+	}
+	rbfmScanIterator.close();
+
+	return rc == 0 ? zoneMap->save() : rc;
+}
+
+ZoneMap *RecordBasedFileManager::getZoneMap(FileHandle &fileHandle)
+{
+	lock_guard<mutex> lock(zoneMapsMutex);
+	ZoneMap *&zoneMap = zoneMaps[fileHandle.pagedFile->fileName];
+	if (zoneMap == NULL)
+	{
+		zoneMap = new ZoneMap(fileHandle.pagedFile->fileName);
+		zoneMap->load(fileHandle.getNumberOfPages());
+	}
+	return zoneMap;
+}
+
+RC RecordBasedFileManager::widenZoneMap(FileHandle &fileHandle, const PageNum &pageNum, const RecordView &recordView)
+{
+	return getZoneMap(fileHandle)->widen(pageNum, recordView);
+}
+
+RC RecordBasedFileManager::dropZoneMap(const string &fileName)
+{
+	{
+		lock_guard<mutex> lock(zoneMapsMutex);
+		unordered_map<string, ZoneMap *>::iterator it = zoneMaps.find(fileName);
+		if (it != zoneMaps.end())
+		{
+			delete it->second;
+			zoneMaps.erase(it);
+		}
+	}
+
+	return unlink((fileName + ZONE_MAP_FILE_SUFFIX).c_str()) == 0 || errno == ENOENT ? 0 : -1;
+}
+
+Dictionary *RecordBasedFileManager::getDictionary(FileHandle &fileHandle)
+{
+	if (fileHandle.getRecordFormat() != DictionaryFormat)
+	{
+		return NULL;
+	}
+
+	lock_guard<mutex> lock(dictionariesMutex);
+	Dictionary *&dictionary = dictionaries[fileHandle.pagedFile->fileName];
+	if (dictionary == NULL)
+	{
+		dictionary = new Dictionary(fileHandle.pagedFile->fileName);
+		dictionary->load();
+	}
+	return dictionary;
+}
+
+RC RecordBasedFileManager::dropDictionary(const string &fileName)
+{
+	{
+		lock_guard<mutex> lock(dictionariesMutex);
+		unordered_map<string, Dictionary *>::iterator it = dictionaries.find(fileName);
+		if (it != dictionaries.end())
+		{
+			delete it->second;
+			dictionaries.erase(it);
+		}
+	}
+
+	return unlink((fileName + DICTIONARY_FILE_SUFFIX).c_str()) == 0 || errno == ENOENT ? 0 : -1;
+}
+
+RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const string &attributeName, void *data)
+{
+	if (fileHandle.getRecordFormat() == PaxFormat)
+	{
+		for (unsigned i = 0; i < recordDescriptor.size(); i++)
+		{
+			if (recordDescriptor[i].name.compare(attributeName) == 0)
+			{
+				return readPaxRecord(fileHandle, recordDescriptor, rid, vector<int>(1, i), data);
+			}
+		}
+		return -1;
+	}
+
+	unsigned pageSize = fileHandle.getPageSize();
+	void *page = NULL;
+
+	if (rid.pageNum >= 0 && rid.slotNum >= 0 && fileHandle.pinPage(rid.pageNum, page) == 0)
+	{
+		if (checkIfDeleted(page, rid.slotNum, pageSize))
+		{
+			fileHandle.unpinPage(rid.pageNum, false);
+			return -1;
+		}
+
+		RID updatedRid;
+		if (checkIfTombStone(page, rid.slotNum, updatedRid, pageSize))
+		{
+			fileHandle.unpinPage(rid.pageNum, false);
+			return readAttribute(fileHandle, recordDescriptor, updatedRid, attributeName, data);
+		}
+
+		unsigned slotOffset = 0;
+		unsigned slotLen = 0;
+		if (getSlotDirectoryEntry(rid.slotNum, page, slotOffset, slotLen, pageSize) == 0)
+		{
+			// Only the attribute asked for is read, it is found from the record's end pointers.
+			void *record = (char *)page + slotOffset;
+			unsigned numberOfFields = 0;
+			memcpy(&numberOfFields, (char *)record, RECORD_NUMBER_OF_FIELD_SIZE);
+			for (unsigned i = 0; i < recordDescriptor.size() && numberOfFields == recordDescriptor.size(); i++)
+			{
+				if (recordDescriptor[i].name.compare(attributeName) == 0)
+				{
+					unsigned fieldOffset = 0;
+					unsigned fieldLength = 0;
+					unsigned char nullIndicator = 0;
+					int pointer = sizeof(char);
+					if (RecordView::locateField(record, i, fieldOffset, fieldLength, (RecordFormat)fileHandle.getRecordFormat()))
+					{
+						// A dictionary encoded VarChar is looked up by the code the record keeps.
+						const char *field = (char *)record + fieldOffset;
+						Dictionary *dictionary = getDictionary(fileHandle);
+						if (dictionary != NULL && recordDescriptor[i].type == TypeVarChar)
+						{
+							unsigned code = 0;
+							memcpy(&code, field, sizeof(unsigned));
+							if (fieldLength != sizeof(unsigned) || code >= dictionary->getNumberOfCodes(i))
+							{
+								fileHandle.unpinPage(rid.pageNum, false);
+								return -1;
+							}
+							VarcharView value = dictionary->getValue(i, code);
+							field = value.data;
+							fieldLength = value.length;
+						}
+
+						if (recordDescriptor[i].type == TypeVarChar)
+						{
+							memcpy((char *)data + pointer, &fieldLength, sizeof(int));
+							pointer += sizeof(int);
+						}
+						memcpy((char *)data + pointer, field, fieldLength);
+					}
+					else
+					{
+						nullIndicator = 128; //10000000
+					}
+
+					memcpy(data, &nullIndicator, sizeof(char));
+					fileHandle.unpinPage(rid.pageNum, false);
+					return 0;
+				}
+			}
+		}
+		fileHandle.unpinPage(rid.pageNum, false);
+	}
+	return -1;
+}
+
+RC RecordBasedFileManager::scan(FileHandle &fileHandle,
+								const vector<Attribute> &recordDescriptor,
+								const string &conditionAttribute,
+								const CompOp compOp,
+								const void *value,
+								const vector<string> &attributeNames,
+								RBFM_ScanIterator &rbfm_ScanIterator)
+{
+	vector<int> attributes;
+	for (int i = 0; i < recordDescriptor.size(); i++)
+	{
+		if (find(attributeNames.begin(), attributeNames.end(), recordDescriptor[i].name) != attributeNames.end())
+		{
+			attributes.push_back(i);
+		}
+	}
+	return rbfm_ScanIterator.initialize(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes);
+}
+
+RC RecordBasedFileManager::parallelScan(FileHandle &fileHandle,
+										const vector<Attribute> &recordDescriptor,
+										const string &conditionAttribute,
+										const CompOp compOp,
+										const void *value,
+										const vector<string> &attributeNames,
+										const unsigned numberOfThreads,
+										RBFM_ParallelScanIterator &rbfm_ParallelScanIterator)
+{
+	vector<int> attributes;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++)
+	{
+		if (find(attributeNames.begin(), attributeNames.end(), recordDescriptor[i].name) != attributeNames.end())
+		{
+			attributes.push_back(i);
+		}
+	}
+	return rbfm_ParallelScanIterator.initialize(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes, numberOfThreads);
+}
+
+// A condition is compiled into one of the functions below, one for every type and operator, so checking a record
+// is a single call on the bytes of its field as they lie on the page.
+template <AttrType type>
+static int compareField(const char *field, const unsigned length, const void *value);
+
+template <>
+int compareField<TypeInt>(const char *field, const unsigned length, const void *value)
+{
+	int fieldValue = 0, conditionValue = 0;
+	memcpy(&fieldValue, field, min(length, (unsigned)sizeof(int)));
+	memcpy(&conditionValue, value, sizeof(int));
+	return (fieldValue > conditionValue) - (fieldValue < conditionValue);
+}
+
+template <>
+int compareField<TypeReal>(const char *field, const unsigned length, const void *value)
+{
+	float fieldValue = 0, conditionValue = 0;
+	memcpy(&fieldValue, field, min(length, (unsigned)sizeof(float)));
+	memcpy(&conditionValue, value, sizeof(float));
+	return (fieldValue > conditionValue) - (fieldValue < conditionValue);
+}
+
+template <>
+int compareField<TypeVarChar>(const char *field, const unsigned length, const void *value)
+{
+	unsigned valLength = 0;
+	memcpy(&valLength, (char *)value, sizeof(int));
+	int comparison = memcmp(field, (char *)value + sizeof(int), min(length, valLength));
+	return comparison != 0 ? comparison : (int)length - (int)valLength;
+}
+
+template <CompOp compOp>
+static bool satisfies(const int comparison)
+{
+	switch (compOp)
+	{
+	case EQ_OP:
+		return comparison == 0;
+	case LT_OP:
+		return comparison < 0;
+	case LE_OP:
+		return comparison <= 0;
+	case GT_OP:
+		return comparison > 0;
+	case GE_OP:
+		return comparison >= 0;
+	case NE_OP:
+		return comparison != 0;
+	default:
+		return true;
+	}
+}
+
+template <AttrType type, CompOp compOp>
+static bool evaluatePredicate(const char *field, const unsigned length, const void *value)
+{
+	return satisfies<compOp>(compareField<type>(field, length, value));
+}
+
+template <AttrType type>
+static ScanPredicate selectPredicate(const CompOp compOp)
+{
+	switch (compOp)
+	{
+	case EQ_OP:
+		return evaluatePredicate<type, EQ_OP>;
+	case LT_OP:
+		return evaluatePredicate<type, LT_OP>;
+	case LE_OP:
+		return evaluatePredicate<type, LE_OP>;
+	case GT_OP:
+		return evaluatePredicate<type, GT_OP>;
+	case GE_OP:
+		return evaluatePredicate<type, GE_OP>;
+	case NE_OP:
+		return evaluatePredicate<type, NE_OP>;
+	default:
+		return NULL;
+	}
+}
+
+static ScanPredicate compilePredicate(const AttrType type, const CompOp compOp)
+{
+	switch (type)
+	{
+	case TypeInt:
+		return selectPredicate<TypeInt>(compOp);
+	case TypeReal:
+		return selectPredicate<TypeReal>(compOp);
+	default:
+		return selectPredicate<TypeVarChar>(compOp);
+	}
+}
+
+// Selection kernels. Each compares a column of 4 byte values with a constant, eight values to a byte of the
+// selection. The vector ones compare eight values at a time and take the comparison's mask as the byte, the
+// operators a vector comparison does not have are the ones it does, with the mask inverted.
+template <AttrType type, CompOp compOp>
+static void selectScalar(const void *values, const unsigned first, const unsigned count, const void *value, unsigned char *selection)
+{
+	memset(selection + first / BYTE_SIZE, 0, (count + BYTE_SIZE - 1) / BYTE_SIZE - first / BYTE_SIZE);
+	for (unsigned i = first; i < count; i++)
+	{
+		if (evaluatePredicate<type, compOp>((const char *)values + i * sizeof(int), sizeof(int), value))
+		{
+			selection[i / BYTE_SIZE] |= 1 << (i % BYTE_SIZE);
+		}
+	}
+}
+
+template <AttrType type, CompOp compOp>
+static void selectScalar(const void *values, const unsigned count, const void *value, unsigned char *selection)
+{
+	selectScalar<type, compOp>(values, 0, count, value, selection);
+}
+
+#ifdef SELECTION_KERNELS_X86
+template <CompOp compOp>
+static bool invertsMask()
+{
+	return compOp == NE_OP || compOp == LE_OP || compOp == GE_OP;
+}
+
+template <AttrType type, CompOp compOp>
+__attribute__((target("sse2"))) static unsigned selectFourSse(const char *values, const void *value)
+{
+	if (type == TypeInt)
+	{
+		int constant = 0;
+		memcpy(&constant, value, sizeof(int));
+		__m128i constants = _mm_set1_epi32(constant);
+		__m128i vector = _mm_loadu_si128((const __m128i *)values);
+		__m128i mask = compOp == EQ_OP || compOp == NE_OP ? _mm_cmpeq_epi32(vector, constants)
+						: compOp == GT_OP || compOp == LE_OP ? _mm_cmpgt_epi32(vector, constants)
+															: _mm_cmpgt_epi32(constants, vector);
+		return _mm_movemask_ps(_mm_castsi128_ps(mask));
+	}
+
+	float constant = 0;
+	memcpy(&constant, value, sizeof(float));
+	__m128 constants = _mm_set1_ps(constant);
+	__m128 vector = _mm_loadu_ps((const float *)values);
+	__m128 mask = compOp == EQ_OP || compOp == NE_OP ? _mm_cmpeq_ps(vector, constants)
+				  : compOp == GT_OP || compOp == LE_OP ? _mm_cmpgt_ps(vector, constants)
+													  : _mm_cmplt_ps(vector, constants);
+	return _mm_movemask_ps(mask);
+}
+
+template <AttrType type, CompOp compOp>
+__attribute__((target("sse2"))) static void selectSse(const void *values, const unsigned count, const void *value, unsigned char *selection)
+{
+	unsigned i = 0;
+	for (; i + BYTE_SIZE <= count; i += BYTE_SIZE)
+	{
+		const char *vector = (const char *)values + i * sizeof(int);
+		unsigned mask = selectFourSse<type, compOp>(vector, value) | selectFourSse<type, compOp>(vector + 4 * sizeof(int), value) << 4;
+		selection[i / BYTE_SIZE] = invertsMask<compOp>() ? ~mask : mask;
+	}
+	selectScalar<type, compOp>(values, i, count, value, selection);
+}
+
+template <AttrType type, CompOp compOp>
+__attribute__((target("avx2"))) static void selectAvx2(const void *values, const unsigned count, const void *value, unsigned char *selection)
+{
+	unsigned i = 0;
+	if (type == TypeInt)
+	{
+		int constant = 0;
+		memcpy(&constant, value, sizeof(int));
+		__m256i constants = _mm256_set1_epi32(constant);
+		for (; i + BYTE_SIZE <= count; i += BYTE_SIZE)
+		{
+			__m256i vector = _mm256_loadu_si256((const __m256i *)((const char *)values + i * sizeof(int)));
+			__m256i mask = compOp == EQ_OP || compOp == NE_OP ? _mm256_cmpeq_epi32(vector, constants)
+						   : compOp == GT_OP || compOp == LE_OP ? _mm256_cmpgt_epi32(vector, constants)
+															   : _mm256_cmpgt_epi32(constants, vector);
+			unsigned bits = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+			selection[i / BYTE_SIZE] = invertsMask<compOp>() ? ~bits : bits;
+		}
+	}
+	else
+	{
+		float constant = 0;
+		memcpy(&constant, value, sizeof(float));
+		__m256 constants = _mm256_set1_ps(constant);
+		for (; i + BYTE_SIZE <= count; i += BYTE_SIZE)
+		{
+			__m256 vector = _mm256_loadu_ps((const float *)((const char *)values + i * sizeof(int)));
+			__m256 mask = compOp == EQ_OP || compOp == NE_OP ? _mm256_cmp_ps(vector, constants, _CMP_EQ_OQ)
+						  : compOp == GT_OP || compOp == LE_OP ? _mm256_cmp_ps(vector, constants, _CMP_GT_OQ)
+															  : _mm256_cmp_ps(vector, constants, _CMP_LT_OQ);
+			unsigned bits = _mm256_movemask_ps(mask);
+			selection[i / BYTE_SIZE] = invertsMask<compOp>() ? ~bits : bits;
+		}
+	}
+	selectScalar<type, compOp>(values, i, count, value, selection);
+}
+#endif
+
+template <AttrType type, CompOp compOp>
+static SelectionKernel selectKernel(const InstructionSet instructionSet)
+{
+#ifdef SELECTION_KERNELS_X86
+	switch (instructionSet)
+	{
+	case Avx2Instructions:
+		return selectAvx2<type, compOp>;
+	case SseInstructions:
+		return selectSse<type, compOp>;
+	default:
+		break;
+	}
+#endif
+	return selectScalar<type, compOp>;
+}
+
+template <AttrType type>
+static SelectionKernel selectKernel(const CompOp compOp, const InstructionSet instructionSet)
+{
+	switch (compOp)
+	{
+	case EQ_OP:
+		return selectKernel<type, EQ_OP>(instructionSet);
+	case LT_OP:
+		return selectKernel<type, LT_OP>(instructionSet);
+	case LE_OP:
+		return selectKernel<type, LE_OP>(instructionSet);
+	case GT_OP:
+		return selectKernel<type, GT_OP>(instructionSet);
+	case GE_OP:
+		return selectKernel<type, GE_OP>(instructionSet);
+	case NE_OP:
+		return selectKernel<type, NE_OP>(instructionSet);
+	default:
+		return NULL;
+	}
+}
+
+InstructionSet getInstructionSet()
+{
+#ifdef SELECTION_KERNELS_X86
+	static const InstructionSet instructionSet = __builtin_cpu_supports("avx2") ? Avx2Instructions
+												 : __builtin_cpu_supports("sse2") ? SseInstructions
+																				  : ScalarInstructions;
+	return instructionSet;
+#else
+	return ScalarInstructions;
+#endif
+}
+
+SelectionKernel getSelectionKernel(const AttrType type, const CompOp compOp, const InstructionSet instructionSet)
+{
+	InstructionSet supported = min(instructionSet, getInstructionSet());
+	switch (type)
+	{
+	case TypeInt:
+		return selectKernel<TypeInt>(compOp, supported);
+	case TypeReal:
+		return selectKernel<TypeReal>(compOp, supported);
+	default:
+		return NULL;
+	}
+}
+
+RC RBFM_ScanIterator::initialize(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+								 const string &conditionedField,
+								 const CompOp compOp, const void *value, const vector<int> &attributes)
+{
+	this->rbfm = RecordBasedFileManager::instance();
+	this->fileHandle = fileHandle;
+	this->recordDescriptor = recordDescriptor;
+	this->conditionedField = conditionedField;
+	this->compOp = compOp;
+	this->value = (char *)value;
+	this->attributes = attributes;
+	this->currentRID.pageNum = 0;
+	this->currentRID.slotNum = 0;
+	this->endPageNum = (PageNum)-1;
+	this->pinned = false;
+	this->forwarded = false;
+	RC rc = this->recordView.initialize(recordDescriptor, (RecordFormat)fileHandle.getRecordFormat(), rbfm->getDictionary(fileHandle));
+	if (rc == 0 && recordView.format == PaxFormat)
+	{
+		rc = this->paxLayout.initialize(recordDescriptor, fileHandle.getPageSize());
+	}
+
+	// The condition is resolved once, to the field it is on and a comparison for its type and operator.
+	this->conditionIndex = -1;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++)
+	{
+		if (recordDescriptor[i].name.compare(conditionedField) == 0)
+		{
+			this->conditionIndex = i;
+		}
+	}
+	this->predicate = NULL;
+	this->selectionKernel = NULL;
+	this->selectedPageNum = (PageNum)-1;
+	this->selectedRows = 0;
+	if (conditionIndex >= 0 && value != NULL)
+	{
+		this->predicate = compilePredicate(recordDescriptor[conditionIndex].type, compOp);
+		if (recordView.format == PaxFormat)
+		{
+			this->selectionKernel = getSelectionKernel(recordDescriptor[conditionIndex].type, compOp);
+		}
+	}
+
+	// = and != on a dictionary encoded VarChar compare codes, the value is looked up once. A value without a code is
+	// in no record, it is given one that no value has. The other operators compare the VarChar the code stands for,
+	// once for every code.
+	this->comparesCode = false;
+	this->decodesCondition = false;
+	this->conditionResults.clear();
+	if (predicate != NULL && rc == 0 && recordView.format == DictionaryFormat && recordDescriptor[conditionIndex].type == TypeVarChar)
+	{
+		if (compOp == EQ_OP || compOp == NE_OP)
+		{
+			VarcharView conditionValue;
+			memcpy(&conditionValue.length, value, sizeof(int));
+			conditionValue.data = (const char *)value + sizeof(int);
+			if (!recordView.dictionary->findCode(conditionIndex, conditionValue, conditionCode))
+			{
+				this->conditionCode = UINT_MAX;
+			}
+			this->predicate = compilePredicate(TypeInt, compOp);
+			this->comparesCode = true;
+		}
+		else
+		{
+			this->decodesCondition = true;
+		}
+	}
+
+	// Pages are passed over on the file's zone map, for any condition but one that almost every page satisfies.
+	this->zoneMap = NULL;
+	this->skippedPageCounter = 0;
+	if (predicate != NULL && compOp != NE_OP && this->fileHandle.pagedFile != NULL)
+	{
+		this->zoneMap = rbfm->getZoneMap(this->fileHandle);
+		if (!zoneMap->isUsable(recordDescriptor))
+		{
+			this->zoneMap = NULL;
+		}
+	}
+	return rc;
+}
+
+RC RBFM_ScanIterator::getNextRecord(RID &rid, void *data)
+{
+	if (findNextRecord() != 0)
+	{
+		return RBFM_EOF;
+	}
+
+	if (recordView.format == PaxFormat)
+	{
+		paxLayout.createData(page, currentRID.slotNum, attributes, data);
+	}
+	else
+	{
+		recordView.createData(attributes, data);
+	}
+	rid = currentRID;
+	currentRID.slotNum++;
+	return releasePages();
+}
+
+RC RBFM_ScanIterator::getNextBatch(RecordBatch &batch)
+{
+	// The page stays pinned from one record to the next, it is only let go when the scan moves past it.
+	batch.clear();
+	while (!batch.isFull() && findNextRecord() == 0)
+	{
+		if (recordView.format == PaxFormat)
+		{
+			unsigned length = paxLayout.getDataSize(page, currentRID.slotNum, attributes);
+			paxLayout.createData(page, currentRID.slotNum, attributes, batch.getFreeSpace(length));
+			batch.addRecord(currentRID, length);
+		}
+		else
+		{
+			unsigned length = recordView.getDataSize(attributes);
+			recordView.createData(attributes, batch.getFreeSpace(length));
+			batch.addRecord(currentRID, length);
+		}
+		currentRID.slotNum++;
+		releaseForwardedPage();
+	}
+	releasePages();
+
+	return batch.size() > 0 ? 0 : RBFM_EOF;
+}
+
+// Moves currentRID to the next record that satisfies the condition and decodes it into recordView,
+// unless it is a row of a PAX page, which is read from the page with paxLayout.
+// Its page, and the page it was forwarded to, are left pinned for as long as it is read.
+RC RBFM_ScanIterator::findNextRecord()
+{
+	// A condition on a field the records do not have, or without a value, holds for none of them.
+	if (compOp != NO_OP && predicate == NULL)
+	{
+		return RBFM_EOF;
+	}
+
+	unsigned numberOfPages = min(this->fileHandle.getNumberOfPages(), endPageNum);
+	unsigned pageSize = this->fileHandle.getPageSize();
+	for (; currentRID.pageNum < numberOfPages; currentRID.pageNum++, currentRID.slotNum = 0)
+	{
+		if (!pinned || pinnedPageNum != currentRID.pageNum)
+		{
+			releasePages();
+			if (zoneMap != NULL && !zoneMap->mayMatch(currentRID.pageNum, conditionIndex, compOp, value))
+			{
+				skippedPageCounter++;
+				continue;
+			}
+			if (fileHandle.pinPage(currentRID.pageNum, page) != 0)
+			{
+				continue;
+			}
+			pinned = true;
+			pinnedPageNum = currentRID.pageNum;
+		}
+
+		unsigned numberOfSlots = 0;
+		rbfm->getNumberOfSlots(page, numberOfSlots, pageSize);
+		// An Int or Real condition is checked for every row of a PAX page at once, straight off its minipage.
+		if (selectionKernel != NULL && (selectedPageNum != currentRID.pageNum || selectedRows < numberOfSlots))
+		{
+			selection.resize((numberOfSlots + BYTE_SIZE - 1) / BYTE_SIZE);
+			selectionKernel((char *)page + paxLayout.minipages[conditionIndex], numberOfSlots, value, selection.data());
+			selectedPageNum = currentRID.pageNum;
+			selectedRows = numberOfSlots;
+		}
+		for (; currentRID.slotNum < numberOfSlots; currentRID.slotNum++)
+		{
+			// A PAX row is checked on the minipage of its condition field, the others are only read once it holds.
+			if (recordView.format == PaxFormat)
+			{
+				unsigned fieldLength = 0;
+				const char *field = NULL;
+				if (selectionKernel != NULL && !(selection[currentRID.slotNum / BYTE_SIZE] & (1 << (currentRID.slotNum % BYTE_SIZE))))
+				{
+					continue;
+				}
+				if (paxLayout.isUsed(page, currentRID.slotNum) &&
+					(compOp == NO_OP || ((field = paxLayout.getField(page, conditionIndex, currentRID.slotNum, fieldLength)) != NULL &&
+										 (selectionKernel != NULL || predicate(field, fieldLength, value)))))
+				{
+					return 0;
+				}
+				continue;
+			}
+
+			unsigned slotOffset = 0;
+			unsigned slotLen = 0;
+			if (rbfm->getSlotDirectoryEntry(currentRID.slotNum, page, slotOffset, slotLen, pageSize) != 0 || slotOffset == MAXXOUT_INDICATOR)
+			{
+				continue;
+			}
+
+			void *record = (char *)page + slotOffset;
+			unsigned numberOfFields = 0;
+			memcpy(&numberOfFields, (char *)record, RECORD_NUMBER_OF_FIELD_SIZE);
+			if (numberOfFields == MAXXOUT_INDICATOR)
+			{
+				unsigned pageNum = 0;
+				unsigned slotNum = 0;
+				int pointer = RECORD_NUMBER_OF_FIELD_SIZE;
+				memcpy(&pageNum, (char *)record + pointer, PAGE_NUMBER_POINTER);
+				pointer += SLOT_NUMBER_POINTER;
+				memcpy(&slotNum, (char *)record + pointer, SLOT_NUMBER_POINTER);
+				void *forwardedPage = NULL;
+				if (fileHandle.pinPage(pageNum, forwardedPage) == 0)
+				{
+					forwarded = true;
+					forwardedPageNum = pageNum;
+					// A record deleted after it moved leaves its tombstone pointing at a free slot.
+					if (rbfm->getSlotDirectoryEntry(slotNum, forwardedPage, slotOffset, slotLen, pageSize) == 0 && slotOffset != MAXXOUT_INDICATOR)
+					{
+						record = (char *)forwardedPage + slotOffset;
+					}
+				}
+			}
+
+			// The condition is checked on the stored field, a record is only decoded once it holds.
+			unsigned storedNumberOfFields = 0;
+			memcpy(&storedNumberOfFields, (char *)record, RECORD_NUMBER_OF_FIELD_SIZE);
+			bool satisfied = storedNumberOfFields == recordView.numberOfFields;
+			if (satisfied && compOp != NO_OP)
+			{
+				unsigned fieldOffset = 0;
+				unsigned fieldLength = 0;
+				satisfied = RecordView::locateField(record, conditionIndex, fieldOffset, fieldLength, recordView.format);
+				const char *field = (char *)record + fieldOffset;
+				if (satisfied && decodesCondition)
+				{
+					// Only the condition's VarChar is looked up, the record is decoded once it holds.
+					unsigned code = 0;
+					memcpy(&code, field, sizeof(unsigned));
+					satisfied = fieldLength == sizeof(unsigned) && code < recordView.dictionary->getNumberOfCodes(conditionIndex);
+					if (satisfied && code >= conditionResults.size())
+					{
+						conditionResults.resize(code + 1, -1);
+					}
+					if (satisfied && conditionResults[code] < 0)
+					{
+						VarcharView conditionValue = recordView.dictionary->getValue(conditionIndex, code);
+						conditionResults[code] = predicate(conditionValue.data, conditionValue.length, value);
+					}
+					satisfied = satisfied && conditionResults[code];
+				}
+				else
+				{
+					satisfied = satisfied && predicate(field, fieldLength, comparesCode ? &conditionCode : value);
+				}
+			}
+
+			if (satisfied && recordView.decodeRecord(record, attributes) == 0)
+			{
+				return 0;
+			}
+			releaseForwardedPage();
+		}
+	}
+
+	releasePages();
+	return RBFM_EOF;
+}
+
+// Records are read in place from the pinned page, a forwarded record from its own pinned page.
+RC RBFM_ScanIterator::releaseForwardedPage()
+{
+	if (!forwarded)
+	{
+		return 0;
+	}
+
+	forwarded = false;
+	return fileHandle.unpinPage(forwardedPageNum, false);
+}
+
+RC RBFM_ScanIterator::releasePages()
+{
+	releaseForwardedPage();
+	if (!pinned)
+	{
+		return 0;
+	}
+
+	pinned = false;
+	return fileHandle.unpinPage(pinnedPageNum, false);
+}
+
+RC RBFM_ScanIterator::setPageRange(const PageNum firstPageNum, const PageNum endPageNum)
+{
+	releasePages();
+	this->currentRID.pageNum = firstPageNum;
+	this->currentRID.slotNum = 0;
+	this->endPageNum = endPageNum;
+	return 0;
+}
+
+unsigned RBFM_ScanIterator::getNumberOfSkippedPages()
+{
+	return skippedPageCounter;
+}
+
+unsigned RBFM_ScanIterator::getPageSize()
+{
+	return fileHandle.getPageSize();
+}
+
+RecordFormat RBFM_ScanIterator::getRecordFormat()
+{
+	return (RecordFormat)fileHandle.getRecordFormat();
+}
+
+bool RBFM_ScanIterator::getCode(const unsigned attribute, unsigned &code, Dictionary *&dictionary, unsigned &field) const
+{
+	if (attribute >= attributes.size() || !recordView.getCode(attributes[attribute], code))
+	{
+		return false;
+	}
+
+	dictionary = recordView.dictionary;
+	field = attributes[attribute];
+	return true;
+}
+
+RC RBFM_ScanIterator::close()
+{
+	releasePages();
+	currentRID.pageNum = -1;
+	currentRID.slotNum = -1;
+	return 0;
+}
+
+BatchQueue::BatchQueue(const unsigned capacity)
+{
+	unsigned size = 1;
+	while (size < capacity)
+	{
+		size <<= 1;
+	}
+
+	this->cells = new Cell[size];
+	this->mask = size - 1;
+	for (unsigned i = 0; i < size; i++)
+	{
+		cells[i].sequence.store(i, memory_order_relaxed);
+		cells[i].batch = NULL;
+	}
+	this->pushPosition.store(0, memory_order_relaxed);
+	this->popPosition.store(0, memory_order_relaxed);
+}
+
+BatchQueue::~BatchQueue()
+{
+	delete[] cells;
+}
+
+// A cell is free for the push at position when its sequence is position, and holds that push's batch once
+// it is position + 1. A pop hands it back for the next lap by setting it to position + the capacity.
+bool BatchQueue::push(RecordBatch *batch)
+{
+	unsigned position = pushPosition.load(memory_order_relaxed);
+	Cell *cell = NULL;
+	while (true)
+	{
+		cell = &cells[position & mask];
+		int difference = (int)(cell->sequence.load(memory_order_acquire) - position);
+		if (difference == 0 && pushPosition.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+		{
+			break;
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		else if (difference > 0)
+		{
+			position = pushPosition.load(memory_order_relaxed);
+		}
+	}
+
+	cell->batch = batch;
+	cell->sequence.store(position + 1, memory_order_release);
+	return true;
+}
+
+bool BatchQueue::pop(RecordBatch *&batch)
+{
+	unsigned position = popPosition.load(memory_order_relaxed);
+	Cell *cell = NULL;
+	while (true)
+	{
+		cell = &cells[position & mask];
+		int difference = (int)(cell->sequence.load(memory_order_acquire) - (position + 1));
+		if (difference == 0 && popPosition.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+		{
+			break;
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		else if (difference > 0)
+		{
+			position = popPosition.load(memory_order_relaxed);
+		}
+	}
+
+	batch = cell->batch;
+	cell->sequence.store(position + mask + 1, memory_order_release);
+	return true;
+}
+
+RBFM_ParallelScanIterator::~RBFM_ParallelScanIterator()
+{
+	close();
+}
+
+RC RBFM_ParallelScanIterator::initialize(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+										 const string &conditionedField, const CompOp compOp, const void *value,
+										 const vector<int> &attributes, const unsigned numberOfThreads)
+{
+	close();
+	if (numberOfThreads == 0)
+	{
+		return -1;
+	}
+
+	this->numberOfPages = fileHandle.getNumberOfPages();
+	this->scanIterators.assign(numberOfThreads, RBFM_ScanIterator());
+	for (unsigned i = 0; i < numberOfThreads; i++)
+	{
+		if (scanIterators[i].initialize(fileHandle, recordDescriptor, conditionedField, compOp, value, attributes) != 0)
+		{
+			scanIterators.clear();
+			return -1;
+		}
+	}
+
+	// Every batch is always in one of the queues, a worker's or the consumer's hands, so neither queue fills up.
+	unsigned numberOfBatches = numberOfThreads * SCAN_QUEUE_SIZE;
+	this->fullBatches = new BatchQueue(numberOfBatches);
+	this->freeBatches = new BatchQueue(numberOfBatches);
+	for (unsigned i = 0; i < numberOfBatches; i++)
+	{
+		batches.push_back(new RecordBatch());
+		freeBatches->push(batches.back());
+	}
+
+	this->currentBatch = NULL;
+	this->currentRecord = 0;
+	this->nextMorsel.store(0);
+	this->stopping.store(false);
+	this->runningWorkers.store(numberOfThreads);
+	for (unsigned i = 0; i < numberOfThreads; i++)
+	{
+		workers.push_back(thread(&RBFM_ParallelScanIterator::scanMorsels, this, i));
+	}
+	return 0;
+}
+
+void RBFM_ParallelScanIterator::scanMorsels(const unsigned worker)
+{
+	RBFM_ScanIterator &scanIterator = scanIterators[worker];
+	RecordBatch *batch = NULL;
+	for (unsigned morsel = nextMorsel++; morsel * SCAN_MORSEL_SIZE < numberOfPages && !stopping.load(); morsel = nextMorsel++)
+	{
+		scanIterator.setPageRange(morsel * SCAN_MORSEL_SIZE, min(numberOfPages, (morsel + 1) * SCAN_MORSEL_SIZE));
+		while (!stopping.load())
+		{
+			if (batch == NULL && !freeBatches->pop(batch))
+			{
+				this_thread::yield();
+				continue;
+			}
+
+			if (scanIterator.getNextBatch(*batch) == RBFM_EOF)
+			{
+				break;
+			}
+			fullBatches->push(batch);
+			batch = NULL;
+		}
+	}
+
+	if (batch != NULL)
+	{
+		freeBatches->push(batch);
+	}
+	scanIterator.releasePages();
+	runningWorkers--;
+}
+
+RC RBFM_ParallelScanIterator::takeBatch()
+{
+	if (currentBatch != NULL)
+	{
+		freeBatches->push(currentBatch);
+		currentBatch = NULL;
+	}
+
+	while (!fullBatches->pop(currentBatch))
+	{
+		// A worker pushes its last batch before it counts itself out, so one more look settles it.
+		if (runningWorkers.load() == 0 && !fullBatches->pop(currentBatch))
+		{
+			currentBatch = NULL;
+			return RBFM_EOF;
+		}
+		if (currentBatch != NULL)
+		{
+			break;
+		}
+		this_thread::yield();
+	}
+
+	currentRecord = 0;
+	return 0;
+}
+
+RC RBFM_ParallelScanIterator::getNextRecord(RID &rid, void *data)
+{
+	while (currentBatch == NULL || currentRecord >= currentBatch->size())
+	{
+		if (fullBatches == NULL || takeBatch() != 0)
+		{
+			return RBFM_EOF;
+		}
+	}
+
+	rid = currentBatch->getRID(currentRecord);
+	memcpy(data, currentBatch->getRecord(currentRecord), currentBatch->getLength(currentRecord));
+	currentRecord++;
+	return 0;
+}
+
+RC RBFM_ParallelScanIterator::getNextBatch(RecordBatch &batch)
+{
+	batch.clear();
+	while (!batch.isFull())
+	{
+		if (currentBatch == NULL || currentRecord >= currentBatch->size())
+		{
+			if (fullBatches == NULL || takeBatch() != 0)
+			{
+				break;
+			}
+			continue;
+		}
+
+		unsigned length = currentBatch->getLength(currentRecord);
+		memcpy(batch.getFreeSpace(length), currentBatch->getRecord(currentRecord), length);
+		batch.addRecord(currentBatch->getRID(currentRecord), length);
+		currentRecord++;
+	}
+
+	return batch.size() > 0 ? 0 : RBFM_EOF;
+}
+
+unsigned RBFM_ParallelScanIterator::getNumberOfSkippedPages()
+{
+	// A worker's counter is only read once it has stopped writing to it.
+	unsigned skippedPageCounter = 0;
+	for (unsigned i = 0; runningWorkers.load() == 0 && i < scanIterators.size(); i++)
+	{
+		skippedPageCounter += scanIterators[i].getNumberOfSkippedPages();
+	}
+	return skippedPageCounter;
+}
+
+unsigned RBFM_ParallelScanIterator::getPageSize()
+{
+	// The size of a file's pages never changes, so it is read from a worker's handle while the worker runs.
+	return scanIterators.empty() ? PAGE_SIZE : scanIterators[0].getPageSize();
+}
+
+RecordFormat RBFM_ParallelScanIterator::getRecordFormat()
+{
+	return scanIterators.empty() ? VariableWidthFormat : scanIterators[0].getRecordFormat();
+}
+
+RC RBFM_ParallelScanIterator::close()
+{
+	stopping.store(true);
+	for (unsigned i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	workers.clear();
+
+	for (unsigned i = 0; i < scanIterators.size(); i++)
+	{
+		scanIterators[i].close();
+	}
+	scanIterators.clear();
+
+	for (unsigned i = 0; i < batches.size(); i++)
+	{
+		delete batches[i];
+	}
+	batches.clear();
+	delete fullBatches;
+	delete freeBatches;
+	fullBatches = NULL;
+	freeBatches = NULL;
+	currentBatch = NULL;
+	return 0;
+}
+
+RecordBatch::RecordBatch(const unsigned capacity)
+{
+	this->capacity = capacity;
+	this->numberOfRecords = 0;
+	this->offsets.push_back(0);
+	this->data = NULL;
+	this->dataSize = 0;
+}
+
+RecordBatch::~RecordBatch()
+{
+	free(data);
+}
+
+RC RecordBatch::clear()
+{
+	numberOfRecords = 0;
+	rids.clear();
+	offsets.resize(1);
+	selection.clear();
+	return 0;
+}
+
+void *RecordBatch::getFreeSpace(const unsigned length)
+{
+	unsigned needed = offsets.back() + length;
+	if (needed > dataSize)
+	{
+		dataSize = max(needed, 2 * dataSize);
+		data = (char *)realloc(data, dataSize);
+	}
+
+	return data + offsets.back();
+}
+
+RC RecordBatch::addRecord(const RID &rid, const unsigned length)
+{
+	rids.push_back(rid);
+	offsets.push_back(offsets.back() + length);
+	selection.push_back(numberOfRecords);
+	numberOfRecords++;
+	return 0;
+}
+
+bool RecordBatch::isFull() const
+{
+	return numberOfRecords >= capacity;
+}
+
+unsigned RecordBatch::size() const
+{
+	return selection.size();
+}
+
+const void *RecordBatch::getRecord(const unsigned i) const
+{
+	return data + offsets[selection[i]];
+}
+
+RID RecordBatch::getRID(const unsigned i) const
+{
+	return rids[selection[i]];
+}
+
+unsigned RecordBatch::getLength(const unsigned i) const
+{
+	return offsets[selection[i] + 1] - offsets[selection[i]];
+}
+
+RC RBFM_InsertStream::initialize(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor)
+{
+	this->rbfm = RecordBasedFileManager::instance();
+	this->fileHandle = &fileHandle;
+	this->pageSize = fileHandle.getPageSize();
+	this->page = NULL;
+	if (this->recordView.initialize(recordDescriptor, (RecordFormat)fileHandle.getRecordFormat(), rbfm->getDictionary(fileHandle)) != 0 ||
+		(recordView.format == PaxFormat && this->paxLayout.initialize(recordDescriptor, pageSize) != 0))
+	{
+		return -1;
+	}
+	this->page = malloc(pageSize);
+
+	// Records go on after those of the last page, the pages before it are left as they are.
+	unsigned numberOfPages = fileHandle.getNumberOfPages();
+	if (numberOfPages == 0)
+	{
+		return startPage();
+	}
+
+	if (fileHandle.readPage(numberOfPages - 1, page) != 0)
+	{
+		free(page);
+		page = NULL;
+		return -1;
+	}
+	pageNum = numberOfPages - 1;
+	appended = true;
+	dirty = false;
+	if (recordView.format != PaxFormat)
+	{
+		rbfm->compactPage(page, endPointer, pageSize);
+	}
+	rbfm->getNumberOfSlots(page, numberOfSlots, pageSize);
+	return 0;
+}
+
+RC RBFM_InsertStream::insertRecord(const void *data, RID &rid)
+{
+	if (page == NULL || recordView.decodeData(data) != 0)
+	{
+		return -1;
+	}
+
+	// On a PAX page the rows simply follow the highest one used.
+	if (recordView.format == PaxFormat)
+	{
+		if (numberOfSlots == paxLayout.numberOfRows && (writeCurrentPage() != 0 || startPage() != 0))
+		{
+			return -1;
+		}
+		if (paxLayout.writeRow(page, numberOfSlots, recordView) != 0)
+		{
+			return -1;
+		}
+		paxLayout.setUsed(page, numberOfSlots, true);
+		rbfm->increaseNumberOfSlots(page, pageSize);
+		rbfm->increaseNumberOfRecords(page, pageSize);
+		rbfm->reducePageFreeSpace(page, paxLayout.rowSize, pageSize);
+		rbfm->widenZoneMap(*fileHandle, pageNum, recordView);
+
+		rid.pageNum = pageNum;
+		rid.slotNum = numberOfSlots;
+		numberOfSlots++;
+		dirty = true;
+		return 0;
+	}
+
+	unsigned recordSize = recordView.getRecordSize();
+	unsigned metadataSize = PAGE_FREE_SPACE_SIZE + NUMBER_OF_SLOTS_SIZE + PAGE_NUMBER_OF_RECORDS_SIZE + ((numberOfSlots + 1) * (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE));
+	if (endPointer + recordSize + metadataSize > pageSize)
+	{
+		// A record that does not fit on an empty page never will.
+		if (numberOfSlots == 0 || writeCurrentPage() != 0 || startPage() != 0)
+		{
+			return -1;
+		}
+		return insertRecord(data, rid);
+	}
+
+	recordView.createRecord((char *)page + endPointer);
+	rbfm->updateSlotDirectory(numberOfSlots, endPointer, recordSize, page, pageSize);
+	rbfm->increaseNumberOfSlots(page, pageSize);
+	rbfm->increaseNumberOfRecords(page, pageSize);
+	rbfm->reducePageFreeSpace(page, recordSize + (SLOT_OFFSET_SIZE + SLOT_LENGTH_SIZE), pageSize);
+	rbfm->widenZoneMap(*fileHandle, pageNum, recordView);
+
+	rid.pageNum = pageNum;
+	rid.slotNum = numberOfSlots;
+	endPointer += recordSize;
+	numberOfSlots++;
+	dirty = true;
+	return 0;
+}
+
+RC RBFM_InsertStream::writeCurrentPage()
+{
+	if (!dirty)
+	{
+		return 0;
+	}
+
+	RC rc = appended ? fileHandle->writePage(pageNum, page) : fileHandle->appendPage(page);
+	if (rc != 0)
+	{
+		return -1;
+	}
+	appended = true;
+	dirty = false;
+	return rbfm->updateFreeSpaceMap(*fileHandle, pageNum, page);
+}
+
+RC RBFM_InsertStream::startPage()
+{
+	memset(page, 0, pageSize);
+	if (recordView.format == PaxFormat)
+	{
+		paxLayout.initializePage(page);
+	}
+	else
+	{
+		rbfm->initializePageWithMetadata(page, pageSize);
+	}
+	pageNum = fileHandle->getNumberOfPages();
+	appended = false;
+	dirty = false;
+	endPointer = 0;
+	numberOfSlots = 0;
+	return 0;
+}
+
+RC RBFM_InsertStream::close()
+{
+	if (page == NULL)
+	{
+		return -1;
+	}
+
+	RC rc = writeCurrentPage();
+	free(page);
+	page = NULL;
+	return rc == 0 ? fileHandle->commit() : rc;
+}
+
+// Compares a zone value with another of the same field: an Int, a Real, or the prefix of a VarChar.
+static int compareZoneValue(const AttrType type, const char *zoneValue, const void *value)
+{
+	switch (type)
+	{
+	case TypeInt:
+		return compareField<TypeInt>(zoneValue, sizeof(int), value);
+	case TypeReal:
+		return compareField<TypeReal>(zoneValue, sizeof(float), value);
+	default:
+		return memcmp(zoneValue, value, ZONE_PREFIX_SIZE);
+	}
+}
+
+// The first ZONE_PREFIX_SIZE bytes of a VarChar, padded with zeros. A string never has a larger prefix than one it is smaller than.
+static void getZonePrefix(const char *data, const unsigned length, char *prefix)
+{
+	memset(prefix, 0, ZONE_PREFIX_SIZE);
+	memcpy(prefix, data, min(length, (unsigned)ZONE_PREFIX_SIZE));
+}
+
+RC ZoneMap::load(const unsigned numberOfPages)
+{
+	lock_guard<mutex> lock(zoneMutex);
+	dirty = false;
+	numberOfFields = 0;
+	types.clear();
+	zones.clear();
+	firstDirtyPageNum = UINT_MAX;
+	endDirtyPageNum = 0;
+
+	int mapFd = ::open((fileName + ZONE_MAP_FILE_SUFFIX).c_str(), O_RDONLY);
+	if (mapFd < 0)
+	{
+		upToDate = numberOfPages == 0;
+		return 0;
+	}
+
+	unsigned header[2] = {0, 0};
+	struct stat mapInfo;
+	int error = fstat(mapFd, &mapInfo) == 0 && pread(mapFd, header, sizeof(header), 0) == sizeof(header) ? 0 : -1;
+	if (error == 0)
+	{
+		numberOfFields = header[1];
+		types.resize(numberOfFields);
+		ssize_t size = numberOfFields * sizeof(AttrType);
+		error = mapInfo.st_size >= getHeaderSize() && pread(mapFd, types.data(), size, sizeof(header)) == size ? 0 : -1;
+	}
+	if (error == 0)
+	{
+		zones.resize(mapInfo.st_size - getHeaderSize());
+		ssize_t size = zones.size();
+		error = pread(mapFd, zones.data(), size, getHeaderSize()) == size ? 0 : -1;
+	}
+	::close(mapFd);
+
+	upToDate = error == 0 && header[0] == 1 && (numberOfFields == 0 ? zones.empty() : zones.size() % (numberOfFields * ZONE_PREFIX_SIZE * 2) == 0);
+	if (!upToDate)
+	{
+		numberOfFields = 0;
+		types.clear();
+		zones.clear();
+	}
+	return error;
+}
+
+RC ZoneMap::save()
+{
+	lock_guard<mutex> lock(zoneMutex);
+	if (!dirty || !upToDate)
+	{
+		return 0;
+	}
+
+	int mapFd = ::open((fileName + ZONE_MAP_FILE_SUFFIX).c_str(), O_WRONLY | O_CREAT, 0644);
+	if (mapFd < 0)
+	{
+		return -1;
+	}
+
+	// The zones and the types first, then the header that says they are up to date.
+	int error = 0;
+	unsigned headerSize = getHeaderSize();
+	unsigned pageZoneSize = numberOfFields * ZONE_PREFIX_SIZE * 2;
+	if (firstDirtyPageNum < endDirtyPageNum)
+	{
+		ssize_t size = (endDirtyPageNum - firstDirtyPageNum) * pageZoneSize;
+		error = pwrite(mapFd, zones.data() + firstDirtyPageNum * pageZoneSize, size, headerSize + firstDirtyPageNum * pageZoneSize) == size ? 0 : -1;
+	}
+	unsigned header[2] = {1, numberOfFields};
+	ssize_t size = numberOfFields * sizeof(AttrType);
+	if (error != 0 || ftruncate(mapFd, headerSize + zones.size()) != 0 || pwrite(mapFd, types.data(), size, sizeof(header)) != size ||
+		pwrite(mapFd, header, sizeof(header), 0) != sizeof(header))
+	{
+		error = -1;
+	}
+	if (::close(mapFd) != 0)
+	{
+		error = -1;
+	}
+
+	if (error == 0)
+	{
+		dirty = false;
+		firstDirtyPageNum = UINT_MAX;
+		endDirtyPageNum = 0;
+	}
+	return error;
+}
+
+RC ZoneMap::clear()
+{
+	lock_guard<mutex> lock(zoneMutex);
+	upToDate = true;
+	dirty = true;
+	numberOfFields = 0;
+	types.clear();
+	zones.clear();
+	firstDirtyPageNum = UINT_MAX;
+	endDirtyPageNum = 0;
+	return unlink((fileName + ZONE_MAP_FILE_SUFFIX).c_str()) == 0 || errno == ENOENT ? 0 : -1;
+}
+
+bool ZoneMap::isUsable(const vector<Attribute> &recordDescriptor)
+{
+	lock_guard<mutex> lock(zoneMutex);
+	if (!upToDate || (numberOfFields != 0 && numberOfFields != recordDescriptor.size()))
+	{
+		return false;
+	}
+
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		if (types[i] != recordDescriptor[i].type)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+RC ZoneMap::widen(const PageNum pageNum, const RecordView &recordView)
+{
+	lock_guard<mutex> lock(zoneMutex);
+	if (!upToDate)
+	{
+		return 0;
+	}
+
+	if (numberOfFields == 0)
+	{
+		numberOfFields = recordView.numberOfFields;
+		types = recordView.types;
+	}
+	// A record of another descriptor, such as one written after the table changed, leaves the map out of date.
+	if (markOutOfDate() != 0 || recordView.numberOfFields != numberOfFields || recordView.types != types)
+	{
+		upToDate = false;
+		return 0;
+	}
+
+	resize(pageNum + 1);
+	char prefix[ZONE_PREFIX_SIZE];
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		if (recordView.isNull(i))
+		{
+			continue;
+		}
+
+		const char *value = recordView.getField(i);
+		if (types[i] == TypeVarChar)
+		{
+			getZonePrefix(value, recordView.getLength(i), prefix);
+			value = prefix;
+		}
+		else if (recordView.getLength(i) < ZONE_PREFIX_SIZE)
+		{
+			// A field shorter than an int is widened the way getInt() reads it.
+			memset(prefix, 0, ZONE_PREFIX_SIZE);
+			memcpy(prefix, value, recordView.getLength(i));
+			value = prefix;
+		}
+		char *zone = getZone(pageNum, i);
+		if (compareZoneValue(types[i], zone, value) > 0)
+		{
+			memcpy(zone, value, ZONE_PREFIX_SIZE);
+		}
+		if (compareZoneValue(types[i], zone + ZONE_PREFIX_SIZE, value) < 0)
+		{
+			memcpy(zone + ZONE_PREFIX_SIZE, value, ZONE_PREFIX_SIZE);
+		}
+	}
+
+	firstDirtyPageNum = min(firstDirtyPageNum, pageNum);
+	endDirtyPageNum = max(endDirtyPageNum, pageNum + 1);
+	return 0;
+}
+
+RC ZoneMap::merge(const PageNum pageNum, const PageNum otherPageNum)
+{
+	lock_guard<mutex> lock(zoneMutex);
+	if (!upToDate)
+	{
+		return 0;
+	}
+
+	// A page the map has no zones for holds records it has not seen.
+	if (markOutOfDate() != 0 || numberOfFields == 0 || (otherPageNum + 1) * numberOfFields * ZONE_PREFIX_SIZE * 2 > zones.size())
+	{
+		upToDate = false;
+		return 0;
+	}
+
+	resize(pageNum + 1);
+	for (unsigned i = 0; i < numberOfFields; i++)
+	{
+		char *zone = getZone(pageNum, i);
+		const char *otherZone = getZone(otherPageNum, i);
+		if (compareZoneValue(types[i], zone, otherZone) > 0)
+		{
+			memcpy(zone, otherZone, ZONE_PREFIX_SIZE);
+		}
+		if (compareZoneValue(types[i], zone + ZONE_PREFIX_SIZE, otherZone + ZONE_PREFIX_SIZE) < 0)
+		{
+			memcpy(zone + ZONE_PREFIX_SIZE, otherZone + ZONE_PREFIX_SIZE, ZONE_PREFIX_SIZE);
+		}
+	}
+
+	firstDirtyPageNum = min(firstDirtyPageNum, pageNum);
+	endDirtyPageNum = max(endDirtyPageNum, pageNum + 1);
+	return 0;
+}
+
+bool ZoneMap::mayMatch(const PageNum pageNum, const unsigned field, const CompOp compOp, const void *value)
+{
+	lock_guard<mutex> lock(zoneMutex);
+	if (!upToDate || field >= numberOfFields || (pageNum + 1) * numberOfFields * ZONE_PREFIX_SIZE * 2 > zones.size())
+	{
+		return true;
+	}
+
+	// A string may be larger than another with the same prefix, so prefixes only rule out what they order strictly.
+	char prefix[ZONE_PREFIX_SIZE];
+	bool strict = types[field] != TypeVarChar;
+	if (!strict)
+	{
+		unsigned length = 0;
+		memcpy(&length, value, sizeof(int));
+		getZonePrefix((const char *)value + sizeof(int), length, prefix);
+		value = prefix;
+	}
+	const char *zone = getZone(pageNum, field);
+	int minComparison = compareZoneValue(types[field], zone, value);
+	int maxComparison = compareZoneValue(types[field], zone + ZONE_PREFIX_SIZE, value);
+
+	switch (compOp)
+	{
+	case EQ_OP:
+		return minComparison <= 0 && maxComparison >= 0;
+	case LT_OP:
+		return strict ? minComparison < 0 : minComparison <= 0;
+	case LE_OP:
+		return minComparison <= 0;
+	case GT_OP:
+		return strict ? maxComparison > 0 : maxComparison >= 0;
+	case GE_OP:
+		return maxComparison >= 0;
+	default:
+		return true;
+	}
+}
+
+RC ZoneMap::markOutOfDate()
+{
+	if (dirty)
+	{
+		return 0;
+	}
+
+	unsigned header = 0;
+	int mapFd = ::open((fileName + ZONE_MAP_FILE_SUFFIX).c_str(), O_WRONLY | O_CREAT, 0644);
+	int error = mapFd >= 0 && pwrite(mapFd, &header, sizeof(header), 0) == sizeof(header) ? 0 : -1;
+	if (mapFd >= 0 && ::close(mapFd) != 0)
+	{
+		error = -1;
+	}
+
+	dirty = error == 0;
+	return error;
+}
+
+char *ZoneMap::getZone(const PageNum pageNum, const unsigned field)
+{
+	return &zones[(pageNum * numberOfFields + field) * ZONE_PREFIX_SIZE * 2];
+}
+
+void ZoneMap::resize(const PageNum numberOfPages)
+{
+	unsigned pageZoneSize = numberOfFields * ZONE_PREFIX_SIZE * 2;
+	PageNum pageNum = zones.size() / pageZoneSize;
+	if (pageNum >= numberOfPages)
+	{
+		return;
+	}
+
+	firstDirtyPageNum = min(firstDirtyPageNum, pageNum);
+	endDirtyPageNum = max(endDirtyPageNum, numberOfPages);
+	zones.resize(numberOfPages * pageZoneSize);
+	for (; pageNum < numberOfPages; pageNum++)
+	{
+		for (unsigned i = 0; i < numberOfFields; i++)
+		{
+			// The smallest value above the largest, so that nothing is in the zone until a record widens it.
+			char *zone = getZone(pageNum, i);
+			if (types[i] == TypeInt)
+			{
+				int smallest = INT_MAX, largest = INT_MIN;
+				memcpy(zone, &smallest, sizeof(int));
+				memcpy(zone + ZONE_PREFIX_SIZE, &largest, sizeof(int));
+			}
+			else if (types[i] == TypeReal)
+			{
+				float smallest = INFINITY, largest = -INFINITY;
+				memcpy(zone, &smallest, sizeof(float));
+				memcpy(zone + ZONE_PREFIX_SIZE, &largest, sizeof(float));
+			}
+			else
+			{
+				memset(zone, 0xFF, ZONE_PREFIX_SIZE);
+				memset(zone + ZONE_PREFIX_SIZE, 0, ZONE_PREFIX_SIZE);
+			}
+		}
+	}
+}
+
+unsigned ZoneMap::getHeaderSize() const
+{
+	return sizeof(unsigned) * 2 + numberOfFields * sizeof(AttrType);
+}
+
+// FNV-1a over the characters.
+size_t VarcharViewHash::operator()(const VarcharView &value) const
+{
+	size_t hash = 14695981039346656037ULL;
+	for (unsigned i = 0; i < value.length; i++)
+	{
+		hash = (hash ^ (unsigned char)value.data[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool VarcharViewEqual::operator()(const VarcharView &left, const VarcharView &right) const
+{
+	return left.length == right.length && memcmp(left.data, right.data, left.length) == 0;
+}
+
+Dictionary::~Dictionary()
+{
+	close();
+}
+
+// The file is every value in the order it was given its code, as its field, its length and its characters.
+// A value cut short by a write that did not finish has no record holding its code, and is written over.
+RC Dictionary::load()
+{
+	lock_guard<mutex> lock(dictionaryMutex);
+	values.clear();
+	codes.clear();
+	fileSize = 0;
+
+	int loadFd = ::open((fileName + DICTIONARY_FILE_SUFFIX).c_str(), O_RDONLY);
+	if (loadFd < 0)
+	{
+		return errno == ENOENT ? 0 : -1;
+	}
+
+	struct stat dictionaryInfo;
+	vector<char> contents;
+	int error = fstat(loadFd, &dictionaryInfo) == 0 ? 0 : -1;
+	if (error == 0)
+	{
+		contents.resize(dictionaryInfo.st_size);
+		error = pread(loadFd, contents.data(), contents.size(), 0) == (ssize_t)contents.size() ? 0 : -1;
+	}
+	::close(loadFd);
+
+	unsigned header[2] = {0, 0};
+	while (error == 0 && fileSize + sizeof(header) <= contents.size())
+	{
+		memcpy(header, contents.data() + fileSize, sizeof(header));
+		if (header[1] > contents.size() - fileSize - sizeof(header))
+		{
+			break;
+		}
+		addValue(header[0], contents.data() + fileSize + sizeof(header), header[1]);
+		fileSize += sizeof(header) + header[1];
+	}
+	return error;
+}
+
+RC Dictionary::close()
+{
+	lock_guard<mutex> lock(dictionaryMutex);
+	if (dictionaryFd < 0)
+	{
+		return 0;
+	}
+
+	int error = ::close(dictionaryFd);
+	dictionaryFd = -1;
+	return error == 0 ? 0 : -1;
+}
+
+RC Dictionary::getCode(const unsigned field, const VarcharView &value, unsigned &code)
+{
+	lock_guard<mutex> lock(dictionaryMutex);
+	if (field < codes.size())
+	{
+		unordered_map<VarcharView, unsigned, VarcharViewHash, VarcharViewEqual>::const_iterator it = codes[field].find(value);
+		if (it != codes[field].end())
+		{
+			code = it->second;
+			return 0;
+		}
+	}
+
+	// A new value is on disk before its code is given out.
+	if (dictionaryFd < 0)
+	{
+		dictionaryFd = ::open((fileName + DICTIONARY_FILE_SUFFIX).c_str(), O_WRONLY | O_CREAT, 0644);
+		if (dictionaryFd < 0)
+		{
+			return -1;
+		}
+	}
+	unsigned header[2] = {field, value.length};
+	struct iovec entry[2] = {{header, sizeof(header)}, {(void *)value.data, value.length}};
+	ssize_t size = sizeof(header) + value.length;
+	if (pwritev(dictionaryFd, entry, 2, fileSize) != size)
+	{
+		return -1;
+	}
+	fileSize += size;
+
+	addValue(field, value.data, value.length);
+	code = values[field].size() - 1;
+	return 0;
+}
+
+bool Dictionary::findCode(const unsigned field, const VarcharView &value, unsigned &code)
+{
+	lock_guard<mutex> lock(dictionaryMutex);
+	if (field >= codes.size())
+	{
+		return false;
+	}
+
+	unordered_map<VarcharView, unsigned, VarcharViewHash, VarcharViewEqual>::const_iterator it = codes[field].find(value);
+	if (it == codes[field].end())
+	{
+		return false;
+	}
+	code = it->second;
+	return true;
+}
+
+VarcharView Dictionary::getValue(const unsigned field, const unsigned code) const
+{
+	const string &value = values[field][code];
+	VarcharView view;
+	view.data = value.data();
+	view.length = value.size();
+	return view;
+}
+
+unsigned Dictionary::getNumberOfCodes(const unsigned field) const
+{
+	return field < values.size() ? values[field].size() : 0;
+}
+
+void Dictionary::addValue(const unsigned field, const char *data, const unsigned length)
+{
+	if (field >= values.size())
+	{
+		values.resize(field + 1);
+		codes.resize(field + 1);
+	}
+
+	// The key is a view of the string the deque keeps, which stays where it is.
+	values[field].push_back(string(data, length));
+	codes[field][getValue(field, values[field].size() - 1)] = values[field].size() - 1;
+}
@@ -8,6 +8,12 @@
 #define SLOT_NUMBER_POINTER 2
 #define MAXXOUT_INDICATOR 65535
 #define TOMBSTONE_SIZE 6
+#define RECORD_BATCH_SIZE 128 // records a batch holds unless it is given another capacity
+#define SCAN_MORSEL_SIZE 16   // pages a parallel scan worker takes at a time
+#define SCAN_QUEUE_SIZE 4     // batches every worker of a parallel scan may have waiting for the consumer
+#define ZONE_MAP_FILE_SUFFIX ".zmap"
+#define ZONE_PREFIX_SIZE 4    // bytes of a VarChar a zone map keeps
+#define DICTIONARY_FILE_SUFFIX ".dict"
 #include <string>
 #include <vector>
 #include <climits>
@@ -22,6 +28,9 @@
 #include <memory.h>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <unordered_set>
+#include <deque>
 
 #include "../rbf/pfm.h"
 
@@ -80,6 +89,20 @@ The scan iterator is NOT required to be implemented for the part 1 of the projec
 
 #define RBFM_EOF (-1) // end of a scan operator
 
+// How the records of a file are laid out on its pages, chosen when the file is created and kept in its header page.
+// A VariableWidthFormat record has an end pointer for every field that is not null. A FixedWidthFormat record is
+// for descriptors of Int and Real fields only: the field count, the null bytes, then 4 bytes for every field, null
+// or not. Every field is at an offset known from the descriptor, and every record of the file has the same size.
+// PaxFormat pages store their records column by column instead, see PaxLayout. A DictionaryFormat record is laid
+// out like a VariableWidthFormat one, but keeps the 4 byte code of every VarChar instead of its characters, see Dictionary.
+typedef enum
+{
+  VariableWidthFormat = 0,
+  FixedWidthFormat,
+  PaxFormat,
+  DictionaryFormat
+} RecordFormat;
+
 class RecordManager
 {
 public:
@@ -104,8 +127,248 @@ public:
   void *rawData;
 };
 
+// A VarChar field where it lies in its record, it is not null terminated.
+struct VarcharView
+{
+  const char *data; // first character
+  unsigned length;  // number of characters
+};
+
+// Hash and equality of the characters of VarcharViews, for hash tables keyed on VarChars without copying them out.
+struct VarcharViewHash
+{
+  size_t operator()(const VarcharView &value) const;
+};
+
+struct VarcharViewEqual
+{
+  bool operator()(const VarcharView &left, const VarcharView &right) const;
+};
+
+// The distinct values of the VarChar fields of a DictionaryFormat file. Every field has codes of its own, given out
+// from 0 in the order its values are first written, so a record holds a 4 byte code for each of its VarChars and
+// two records have the same value in a field exactly when they have the same code. A value keeps its code after
+// the last record holding it is deleted. The dictionary is kept next to the file in fileName + DICTIONARY_FILE_SUFFIX,
+// a new value is appended to it before any record with its code is written. Codes are turned back into values
+// without a lock, so a file may not be written while it is read on other threads, as for a parallel scan.
+class Dictionary
+{
+public:
+  Dictionary(const string &fileName) : fileName(fileName), fileSize(0), dictionaryFd(-1){};
+  ~Dictionary();
+
+  RC load();
+  RC close();                                                                  // the file is opened again on the next new value
+  RC getCode(const unsigned field, const VarcharView &value, unsigned &code);  // a new code if the value has none
+  bool findCode(const unsigned field, const VarcharView &value, unsigned &code); // false if the value has no code
+  VarcharView getValue(const unsigned field, const unsigned code) const;       // code was given out for field
+  unsigned getNumberOfCodes(const unsigned field) const;
+
+private:
+  Dictionary(const Dictionary &);
+  Dictionary &operator=(const Dictionary &);
+
+  void addValue(const unsigned field, const char *data, const unsigned length);
+
+public:
+  string fileName;
+  deque<deque<string> > values; // by field, then code, a deque never moves what it holds when it grows at the end
+  vector<unordered_map<VarcharView, unsigned, VarcharViewHash, VarcharViewEqual> > codes; // views of the strings in values
+  off_t fileSize;                // where the next value is appended
+  int dictionaryFd;              // -1 until a value is appended
+  mutex dictionaryMutex;
+};
+
+// RecordView reads the fields of a record where they lie instead of copying them out.
+// A record is decoded into a table of field offsets once, after which every field is
+// reached in O(1). The view owns none of the record's bytes, so it is only valid for
+// as long as they are, and it can be reused for any number of records of its descriptor
+// without allocating. A DictionaryFormat record is the exception: decoding it looks its VarChars up in the
+// dictionary and copies the fields decoded into the view, in the data format.
+class RecordView
+{
+public:
+  RecordView() : format(VariableWidthFormat), numberOfFields(0), nullFlag(NULL), fields(NULL), dictionary(NULL){};
+  RecordView(const vector<Attribute> &recordDescriptor, const RecordFormat format = VariableWidthFormat, Dictionary *dictionary = NULL);
+  ~RecordView(){};
+
+  // -1 if the format cannot hold the descriptor's records, or there is no dictionary for DictionaryFormat
+  RC initialize(const vector<Attribute> &recordDescriptor, const RecordFormat format = VariableWidthFormat, Dictionary *dictionary = NULL);
+  RC decodeRecord(const void *record); // the format records are stored in on a page
+  RC decodeRecord(const void *record, const vector<int> &attributes); // only the given fields, the others are not read
+  RC decodeData(const void *data);     // the format of insertRecord() and readRecord(), new VarChars get codes for DictionaryFormat
+  RC createData(void *data) const;
+  RC createData(const vector<int> &attributes, void *data) const; // only the given fields, in that order
+  unsigned getDataSize() const;                                   // bytes createData(data) writes
+  unsigned getDataSize(const vector<int> &attributes) const;      // bytes createData(attributes, data) writes
+  RC createRecord(void *record) const;                            // the format records are stored in on a page
+  unsigned getRecordSize() const;                                 // bytes createRecord(record) writes
+  bool isNull(const unsigned i) const;
+  bool hasNulls() const;
+  const char *getField(const unsigned i) const;
+  unsigned getLength(const unsigned i) const;
+  int getInt(const unsigned i) const;
+  float getFloat(const unsigned i) const;
+  VarcharView getVarchar(const unsigned i) const;
+  bool getCode(const unsigned i, unsigned &code) const; // false unless it is a VarChar of a DictionaryFormat record, not null, decoded
+  static bool locateField(const void *record, const unsigned i, unsigned &offset, unsigned &length, // false if it is null
+                          const RecordFormat format = VariableWidthFormat);
+  static bool isFixedWidth(const vector<Attribute> &recordDescriptor); // whether FixedWidthFormat can hold its records, 4 byte Ints and Reals
+
+private:
+  RC locateFields(const void *record);              // decodeRecord() without looking a DictionaryFormat record's VarChars up
+  RC lookUpVarchars(const vector<int> *attributes); // NULL for all the fields
+
+public:
+  RecordFormat format;
+  unsigned numberOfFields;
+  vector<AttrType> types;
+  vector<unsigned> widths; // bytes of every Int and Real in the data format, their declared length
+  const unsigned char *nullFlag;
+  const char *fields;      // the bytes a field offset counts from
+  vector<unsigned> offset; // start of every field, past a VarChar's length in the data format
+  vector<unsigned> length; // length of every field, 0 if it is null
+  Dictionary *dictionary;  // for DictionaryFormat
+  vector<unsigned> codes;     // code of every VarChar decoded, for DictionaryFormat
+  vector<VarcharView> values; // what they stand for
+  vector<char> decoded;       // a DictionaryFormat record, or the fields decoded of it, in the data format
+};
+
+// Where the fields of the rows on a PaxFormat page are. A page holds up to numberOfRows rows, stored column by
+// column: a minipage for every field, with the value of every row at the same width (4 bytes, or for a VarChar
+// its 4 length bytes and room for its declared length), then a null bitmap for every field and a bitmap of the
+// rows in use. A row is found by its number, the slot number of its RID, and reading a field only touches that
+// field's minipage and null bitmap. The page trailer is the one slotted pages have, without a slot directory:
+// the free space counts the bytes of the rows not in use, and the number of slots is the highest row used + 1.
+class PaxLayout
+{
+public:
+  PaxLayout() : numberOfFields(0), numberOfRows(0), rowSize(0), bitmapSize(0), nullBitmaps(0), usedBitmap(0), pageSize(0){};
+  RC initialize(const vector<Attribute> &recordDescriptor, const unsigned pageSize); // -1 if not even one row fits on a page, or an Int or a Real is not 4 bytes
+
+  RC initializePage(void *page) const;
+  bool isUsed(const void *page, const unsigned row) const;
+  void setUsed(void *page, const unsigned row, const bool used) const;
+  const char *getField(const void *page, const unsigned field, const unsigned row, unsigned &length) const; // NULL if it is null
+  RC writeRow(void *page, const unsigned row, const RecordView &recordView) const; // a record decoded with decodeData()
+  RC createData(const void *page, const unsigned row, const vector<int> &attributes, void *data) const; // only the given fields, in that order
+  unsigned getDataSize(const void *page, const unsigned row, const vector<int> &attributes) const;   // bytes createData() writes
+
+public:
+  unsigned numberOfFields;
+  unsigned numberOfRows;
+  unsigned rowSize;           // bytes a row takes over all the minipages
+  vector<AttrType> types;
+  vector<unsigned> widths;    // bytes a row takes in every minipage
+  vector<unsigned> minipages; // where every minipage starts
+  unsigned bitmapSize;        // bytes of every bitmap
+  unsigned nullBitmaps;       // where the null bitmap of the first field starts, those of the others follow
+  unsigned usedBitmap;
+  unsigned pageSize;
+};
+
+// RecordBatch holds the records an iterator returns at once, one after another in a single buffer
+// in the format of insertRecord(). The selection vector names the records that are still in the batch,
+// so an operator can drop some without moving the others. The buffer only ever grows, a batch that is
+// cleared and refilled allocates nothing once it has held its largest records.
+//  RecordBatch batch;
+//  while (iterator.getNextBatch(batch) != RBFM_EOF) {
+//    for (unsigned i = 0; i < batch.size(); i++)
+//      process batch.getRecord(i);
+//  }
+
+class RecordBatch
+{
+public:
+  RecordBatch(const unsigned capacity = RECORD_BATCH_SIZE);
+  ~RecordBatch();
+
+  RC clear();
+  void *getFreeSpace(const unsigned length); // where the next record of at most length bytes goes
+  RC addRecord(const RID &rid, const unsigned length);
+  bool isFull() const;
+  unsigned size() const; // records selected
+  const void *getRecord(const unsigned i) const;
+  RID getRID(const unsigned i) const;
+  unsigned getLength(const unsigned i) const;
+
+private:
+  RecordBatch(const RecordBatch &);
+  RecordBatch &operator=(const RecordBatch &);
+
+public:
+  unsigned capacity;
+  unsigned numberOfRecords;  // records added, selected or not
+  vector<RID> rids;
+  vector<unsigned> offsets;  // start of every record in data, and the end of the last one
+  vector<unsigned> selection; // records still in the batch, in order
+  char *data;
+  unsigned dataSize;
+};
+
+// The smallest and largest value of every field on every page of a file, for scans to pass over the pages
+// that cannot hold a record satisfying their condition. A VarChar is kept by its first ZONE_PREFIX_SIZE bytes,
+// padded with zeros. Writing a record widens the zone of the page it is written to, deleting one leaves it as
+// it was, so a zone may be wider than what its page holds but never narrower. The map is kept next to the file
+// in fileName + ZONE_MAP_FILE_SUFFIX: it is marked out of date on disk before it first changes and written back
+// when the file is closed, so a map found out of date, or missing for a file that has pages, is not used until
+// it is built again.
+class ZoneMap
+{
+public:
+  ZoneMap(const string &fileName) : fileName(fileName), upToDate(false), dirty(false), numberOfFields(0), firstDirtyPageNum(UINT_MAX), endDirtyPageNum(0){};
+
+  RC load(const unsigned numberOfPages); // with no map on disk, only an empty file has an up to date one
+  RC save();                             // the zones changed since the last save, then the map is up to date on disk
+  RC clear();                            // no zones, up to date, for a file that is built again from its records
+  bool isUsable(const vector<Attribute> &recordDescriptor); // up to date, for records of this descriptor
+  RC widen(const PageNum pageNum, const RecordView &recordView); // for a record decoded with decodeData()
+  RC merge(const PageNum pageNum, const PageNum otherPageNum);   // otherPageNum's zones into pageNum's
+  bool mayMatch(const PageNum pageNum, const unsigned field, const CompOp compOp, const void *value);
+
+private:
+  ZoneMap(const ZoneMap &);
+  ZoneMap &operator=(const ZoneMap &);
+
+  RC markOutOfDate();
+  char *getZone(const PageNum pageNum, const unsigned field); // its smallest value, then its largest
+  void resize(const PageNum numberOfPages);                  // new pages get empty zones
+  unsigned getHeaderSize() const;
+
+public:
+  string fileName;
+  bool upToDate;
+  bool dirty;                // changed since it was marked out of date on disk
+  unsigned numberOfFields;   // 0 until the first record widens it
+  vector<AttrType> types;
+  vector<char> zones;        // ZONE_PREFIX_SIZE * 2 bytes for every field of every page
+  PageNum firstDirtyPageNum; // the pages whose zones changed since the last save
+  PageNum endDirtyPageNum;
+  mutex zoneMutex;
+};
+
 class RecordBasedFileManager;
 
+// A scan condition compiled for the type of its field and its operator, given the field's bytes as they are stored.
+typedef bool (*ScanPredicate)(const char *field, const unsigned length, const void *value);
+
+// The vector instructions selection kernels are built with, ScalarInstructions where there are none.
+typedef enum
+{
+  ScalarInstructions = 0,
+  SseInstructions,
+  Avx2Instructions
+} InstructionSet;
+
+// A condition on an Int or Real column, checked for count values at once. The values are 4 bytes each, one after
+// another, and bit i of selection, least significant first, is set if value i satisfies the condition with value.
+// The bits after the last value are cleared up to the end of its byte.
+typedef void (*SelectionKernel)(const void *values, const unsigned count, const void *value, unsigned char *selection);
+
+InstructionSet getInstructionSet(); // the widest set the CPU has, found once
+// NULL for a VarChar column or NO_OP, vector instructions wider than the CPU has are not used
+SelectionKernel getSelectionKernel(const AttrType type, const CompOp compOp, const InstructionSet instructionSet = getInstructionSet());
+
 // RBFM_ScanIterator is an iterator to go through records
 // The way to use it is like the following:
 //  RBFM_ScanIterator rbfmScanIterator;
@@ -118,7 +381,11 @@ class RecordBasedFileManager;
 class RBFM_ScanIterator
 {
 public:
-  RBFM_ScanIterator(){};
+  RBFM_ScanIterator()
+      : rbfm(NULL), compOp(NO_OP), value(NULL), conditionIndex(-1), predicate(NULL), comparesCode(false), conditionCode(0),
+        decodesCondition(false), selectionKernel(NULL), selectedPageNum(0), selectedRows(0), zoneMap(NULL),
+        skippedPageCounter(0), currentRID(), endPageNum(0), page(NULL), pinned(false), pinnedPageNum(0), forwarded(false),
+        forwardedPageNum(0){};
 
   ~RBFM_ScanIterator(){};
   RC initialize(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
@@ -129,8 +396,18 @@ public:
   // a satisfying record needs to be fetched from the file.
   // "data" follows the same format as RecordBasedFileManager::insertRecord().
   RC getNextRecord(RID &rid, void *data); // { return RBFM_EOF; };
+  RC getNextBatch(RecordBatch &batch);     // as many satisfying records as the batch holds, RBFM_EOF if there are none
   RC close();                             // { return -1; };
-  RC createData(const RecordManager recordManager, RID &rid, void *data, const int i, const int j);
+  RC findNextRecord();
+  RC releaseForwardedPage();
+  RC releasePages();
+  RC setPageRange(const PageNum firstPageNum, const PageNum endPageNum); // only scan the pages from first up to end
+  unsigned getNumberOfSkippedPages();      // pages passed over because their zones cannot match the condition
+  unsigned getPageSize();                  // of the file scanned
+  RecordFormat getRecordFormat();          // of the file scanned
+  // The code of a projected attribute in the record getNextRecord() returned last, with the dictionary and the field
+  // it is looked up in, see RecordView::getCode().
+  bool getCode(const unsigned attribute, unsigned &code, Dictionary *&dictionary, unsigned &field) const;
 
 public:
   RecordBasedFileManager *rbfm;
@@ -140,16 +417,154 @@ public:
   CompOp compOp;
   void *value;
   vector<int> attributes;
+  int conditionIndex;
+  ScanPredicate predicate;
+  bool comparesCode;        // = and != on a dictionary encoded VarChar compare conditionCode with the stored code
+  unsigned conditionCode;
+  bool decodesCondition;    // the other operators on one look the stored code up first
+  vector<signed char> conditionResults; // whether the value of every code holds, -1 until it is looked up
+  PaxLayout paxLayout;     // for a PaxFormat file
+  SelectionKernel selectionKernel; // checks a PAX page's condition minipage at once, if the condition is on an Int or Real
+  vector<unsigned char> selection; // rows of that page that satisfy it
+  PageNum selectedPageNum;
+  unsigned selectedRows;           // rows the selection covers, the page may have gained some since
+  ZoneMap *zoneMap;                // NULL if the file has none up to date, or the condition cannot use it
+  unsigned skippedPageCounter;
   RID currentRID;
+  PageNum endPageNum;
+  RecordView recordView;
+  void *page;               // the page currentRID is on, while it is pinned
+  bool pinned;
+  PageNum pinnedPageNum;
+  bool forwarded;           // whether the current record's forwarded page is pinned
+  PageNum forwardedPageNum;
+};
+
+// A bounded queue of batches that any number of threads push to and pop from without taking a lock.
+// Every cell has a sequence number saying whether it is free or holds a batch on the current lap
+// around the ring, so a thread claims a cell with one compare-and-swap on the position it is at.
+class BatchQueue
+{
+public:
+  BatchQueue(const unsigned capacity); // rounded up to a power of two
+  ~BatchQueue();
+
+  bool push(RecordBatch *batch); // false if the queue is full
+  bool pop(RecordBatch *&batch); // false if it is empty
+
+private:
+  BatchQueue(const BatchQueue &);
+  BatchQueue &operator=(const BatchQueue &);
+
+  struct Cell
+  {
+    atomic<unsigned> sequence;
+    RecordBatch *batch;
+  };
+
+  Cell *cells;
+  unsigned mask;
+  atomic<unsigned> pushPosition;
+  atomic<unsigned> popPosition;
+};
+
+// RBFM_ParallelScanIterator scans a file with a pool of worker threads. The pages are split into morsels
+// of SCAN_MORSEL_SIZE pages, which the workers take in turn and scan into batches. Full batches go to the
+// consumer through a BatchQueue and come back empty through another, so a worker that gets too far ahead
+// waits for the consumer. Records come out a morsel at a time, in no particular order between morsels.
+// It is used like RBFM_ScanIterator, and the file may not be changed while it is open.
+
+class RBFM_ParallelScanIterator
+{
+public:
+  RBFM_ParallelScanIterator() : fullBatches(NULL), freeBatches(NULL), currentBatch(NULL){};
+
+  ~RBFM_ParallelScanIterator();
+  RC initialize(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                const string &conditionedField, const CompOp compOp, const void *value,
+                const vector<int> &attributes, const unsigned numberOfThreads);
+
+  RC getNextRecord(RID &rid, void *data);
+  RC getNextBatch(RecordBatch &batch);
+  RC close(); // stops the workers and waits for them
+  unsigned getNumberOfSkippedPages(); // by all the workers, 0 until they are done
+  unsigned getPageSize();             // of the file scanned
+  RecordFormat getRecordFormat();     // of the file scanned
+
+private:
+  RBFM_ParallelScanIterator(const RBFM_ParallelScanIterator &);
+  RBFM_ParallelScanIterator &operator=(const RBFM_ParallelScanIterator &);
+
+  void scanMorsels(const unsigned worker);
+  RC takeBatch(); // the next full batch in currentBatch, RBFM_EOF once the workers are done
+
+public:
+  vector<RBFM_ScanIterator> scanIterators; // one for every worker, each on its own copy of the file handle
+  vector<thread> workers;
+  vector<RecordBatch *> batches;
+  BatchQueue *fullBatches;
+  BatchQueue *freeBatches;
+  PageNum numberOfPages;
+  atomic<unsigned> nextMorsel;
+  atomic<unsigned> runningWorkers;
+  atomic<bool> stopping;
+  RecordBatch *currentBatch;
+  unsigned currentRecord;
+};
+
+// RBFM_InsertStream loads records into a file a page at a time.
+// Records are encoded straight into a page kept in memory, which is written once, when it is full or
+// the stream is closed. Nothing else may insert into the file while a stream on it is open.
+//  RBFM_InsertStream rbfmInsertStream;
+//  rbfm.insertStream(..., rbfmInsertStream);
+//  while (more data) {
+//    rbfmInsertStream.insertRecord(data, rid);
+//  }
+//  rbfmInsertStream.close();
+
+class RBFM_InsertStream
+{
+public:
+  RBFM_InsertStream() : page(NULL){};
+
+  ~RBFM_InsertStream(){};
+  RC initialize(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor);
+
+  // "data" follows the same format as RecordBasedFileManager::insertRecord().
+  RC insertRecord(const void *data, RID &rid);
+  RC close(); // writes the last page and commits
+
+private:
+  RC writeCurrentPage();
+  RC startPage();
+
+public:
+  RecordBasedFileManager *rbfm;
+  FileHandle *fileHandle;
+  unsigned pageSize;
+  RecordView recordView;
+  PaxLayout paxLayout;  // for a PaxFormat file
+  void *page;
+  PageNum pageNum;      // the page being filled
+  bool appended;        // whether it is already in the file
+  bool dirty;           // whether it has records that are not written yet
+  unsigned endPointer;  // where the next record goes
+  unsigned numberOfSlots;
 };
 
 class RecordBasedFileManager
 {
+  friend class RBFM_InsertStream;
+
 public:
   static RecordBasedFileManager *instance();
 
   RC createFile(const string &fileName);
 
+  RC createFile(const string &fileName, const unsigned pageSize);
+
+  RC createFile(const string &fileName, const unsigned pageSize, const RecordFormat format);
+
   RC destroyFile(const string &fileName);
 
   RC openFile(const string &fileName, FileHandle &fileHandle);
@@ -174,6 +589,13 @@ public:
 
   RC readRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data);
 
+  // Bulk loading: every record is inserted as by insertRecord(), but a page is only written once it is full.
+  // rids gets the RID of every record, in the order of data.
+  RC insertRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<const void *> &data, vector<RID> &rids);
+
+  // Same, for loads too large to hold in memory, the records are given to the stream one by one.
+  RC insertStream(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, RBFM_InsertStream &rbfm_InsertStream);
+
   // This method will be mainly used for debugging/testing.
   // The format is as follows:
   // field1-name: field1-value  field2-name: field2-value ... \n
@@ -200,26 +622,58 @@ IMPORTANT, PLEASE READ: All methods below this comment (other than the construct
           const vector<string> &attributeNames, // a list of projected attributes
           RBFM_ScanIterator &rbfm_ScanIterator);
 
-  RC getSlotDirectoryEntry(const unsigned &slotNum, const void* pageBuffer, unsigned &slotOffset, unsigned &slotLen);
-  RC getNumberOfSlots(const void *pageBuffer, unsigned &numberOfSlots);
+  // Same as scan(), with the pages split between numberOfThreads worker threads.
+  RC parallelScan(FileHandle &fileHandle,
+                  const vector<Attribute> &recordDescriptor,
+                  const string &conditionAttribute,
+                  const CompOp compOp,
+                  const void *value,
+                  const vector<string> &attributeNames,
+                  const unsigned numberOfThreads,
+                  RBFM_ParallelScanIterator &rbfm_ParallelScanIterator);
+
+  // Gives back the space updates and deletes left behind, a page at a time, without changing any RID.
+  // Records moved behind a tombstone go back to their page if they fit there again, otherwise their
+  // tombstone is pointed straight at them. Tombstones of deleted records are freed, pages with holes
+  // are compacted and slots freed at the end of a directory are dropped. Empty pages at the end of the
+  // file are truncated, appends reuse their space.
+  RC vacuum(FileHandle &fileHandle);
+
+  // Builds the file's zone map again from the records it holds, which also narrows the zones deletes left too wide.
+  RC buildZoneMap(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor);
+  ZoneMap *getZoneMap(FileHandle &fileHandle); // loaded the first time the file's map is needed
+  Dictionary *getDictionary(FileHandle &fileHandle); // NULL unless the file is DictionaryFormat, loaded the first time it is needed
+
+  RC getSlotDirectoryEntry(const unsigned &slotNum, const void* pageBuffer, unsigned &slotOffset, unsigned &slotLen, const unsigned &pageSize);
+  RC getNumberOfSlots(const void *pageBuffer, unsigned &numberOfSlots, const unsigned &pageSize);
 
 private:
-  RC getPageFreeSpace(const void *pageBuffer, unsigned &freeSpace);
-  RC reducePageFreeSpace(const void *pageBuffer, const unsigned &freeSpace);
-  RC increasePageFreeSpace(const void *pageBuffer, const unsigned &freeSpace);
-  RC getNumberOfRecords(const void *pageBuffer, unsigned &numberOfRecords);
-  RC updateSlotDirectory(const unsigned &slotNum, const unsigned &slotOffset, const unsigned &slotLen, void *pageBuffer);
-  RC shiftRecordsToLeft(const unsigned &modifyingSlotNum, const unsigned &delta, void *pageBuffer);
-  RC shiftRecordsToRight(const unsigned &modifyingSlotNum, const unsigned &delta, void *pageBuffer);
-  RC initializePageWithMetadata(void *pageBuffer);
-  RC getAvailableSlot(void* pageBuffer, unsigned &availableSlotNum);
-  bool checkIfDeleted(const void* pageBuffer, const unsigned &slotNum);
-  bool checkIfTombStone(const void* pageBuffer, const unsigned &slotNum, RID &updatedRid);
-  RC updateFullSlotDirectory(const unsigned &modifyingSlotNum, void *pageBuffer, const unsigned &delta, const bool &negative);
-  RC reduceNumberOfRecords(const void* pageBuffer);
-  RC increaseNumberOfRecords(const void* pageBuffer);
-  RC increaseNumberOfSlots(const void* pageBuffer);
-  RC getPageEndPointer(const void* page, unsigned &endPointer);
+  RC getPageFreeSpace(const void *pageBuffer, unsigned &freeSpace, const unsigned &pageSize);
+  RC reducePageFreeSpace(const void *pageBuffer, const unsigned &freeSpace, const unsigned &pageSize);
+  RC increasePageFreeSpace(const void *pageBuffer, const unsigned &freeSpace, const unsigned &pageSize);
+  RC getNumberOfRecords(const void *pageBuffer, unsigned &numberOfRecords, const unsigned &pageSize);
+  RC updateSlotDirectory(const unsigned &slotNum, const unsigned &slotOffset, const unsigned &slotLen, void *pageBuffer, const unsigned &pageSize);
+  RC compactPage(void *pageBuffer, unsigned &endPointer, const unsigned &pageSize);
+  RC getContiguousFreeSpace(const void *pageBuffer, unsigned &endPointer, unsigned &contiguousFreeSpace, const unsigned &pageSize);
+  RC initializePageWithMetadata(void *pageBuffer, const unsigned &pageSize);
+  RC getAvailableSlot(void* pageBuffer, unsigned &availableSlotNum, const unsigned &pageSize);
+  bool checkIfDeleted(const void* pageBuffer, const unsigned &slotNum, const unsigned &pageSize);
+  bool checkIfTombStone(const void* pageBuffer, const unsigned &slotNum, RID &updatedRid, const unsigned &pageSize);
+  RC reduceNumberOfRecords(const void* pageBuffer, const unsigned &pageSize);
+  RC increaseNumberOfRecords(const void* pageBuffer, const unsigned &pageSize);
+  RC increaseNumberOfSlots(const void* pageBuffer, const unsigned &pageSize);
+  RC getPageEndPointer(const void* page, unsigned &endPointer, const unsigned &pageSize);
+  RC updateFreeSpaceMap(FileHandle &fileHandle, const PageNum &pageNum, const void *pageBuffer);
+  RC freeSlot(void *pageBuffer, const unsigned &slotNum, const unsigned &pageSize);
+  RC trimSlotDirectory(void *pageBuffer, const unsigned &pageSize);
+  RC writeTombstone(void *pageBuffer, const unsigned &slotOffset, const RID &updatedRid);
+  RC insertPaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid);
+  RC readPaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const vector<int> &attributes, void *data);
+  RC updatePaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid);
+  RC deletePaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid);
+  RC widenZoneMap(FileHandle &fileHandle, const PageNum &pageNum, const RecordView &recordView);
+  RC dropZoneMap(const string &fileName);
+  RC dropDictionary(const string &fileName);
 
 protected:
   RecordBasedFileManager();
@@ -228,6 +682,10 @@ protected:
 private:
   static RecordBasedFileManager *_rbf_manager;
   static PagedFileManager *pfm;
+  unordered_map<string, ZoneMap *> zoneMaps; // by file name, kept once loaded
+  mutex zoneMapsMutex;
+  unordered_map<string, Dictionary *> dictionaries; // by file name, kept once loaded
+  mutex dictionariesMutex;
 };
 
 #endif
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Notes where the bulk loaded records went. They fill their pages one after another, in the order they came.
+void expectRecords(const vector<RID> &rids, const vector<string> &records,
+		map<pair<unsigned, unsigned>, string> &expected, vector<RID> &deleted)
+{
+	assert(rids.size() == records.size() && "Every record should get a RID.");
+	for (unsigned i = 0; i < rids.size(); i++)
+	{
+		assert(expected.find(make_pair(rids[i].pageNum, rids[i].slotNum)) == expected.end() && "Every record should get a RID of its own.");
+		assert((i == 0 || rids[i].pageNum > rids[i - 1].pageNum ||
+				(rids[i].pageNum == rids[i - 1].pageNum && rids[i].slotNum == rids[i - 1].slotNum + 1)) &&
+				"A page should be filled before the next one is started.");
+		expectRecord(rids[i], records[i], expected, deleted);
+	}
+}
+
+void RBFTest_BulkLoad_File(RecordBasedFileManager *rbfm, string fileName, const unsigned pageSize)
+{
+	RC rc;
+	FileHandle fileHandle;
+	vector<Attribute> recordDescriptor;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+	void *record = malloc(PAGE_SIZE);
+
+	createAndOpenFile(rbfm, fileName, pageSize, VariableWidthFormat, fileHandle);
+
+	createRoundTripRecordDescriptor(recordDescriptor, 1000);
+
+	// A batch in memory, a page written at a time.
+	vector<string> records;
+	vector<const void *> data;
+	for (int i = 0; i < 1000; i++)
+	{
+		int recordSize = prepareRoundTripRecord(recordDescriptor, i, 0, 20 + (i % 10) * 90, record);
+		records.push_back(string((char *)record, recordSize));
+	}
+	for (unsigned i = 0; i < records.size(); i++)
+	{
+		data.push_back(records[i].data());
+	}
+	vector<RID> rids;
+	rc = rbfm->insertRecords(fileHandle, recordDescriptor, data, rids);
+	assert(rc == success && "Inserting the records should not fail.");
+	expectRecords(rids, records, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	// The bulk loaded pages take ordinary updates and deletes.
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 1, 1000, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	// A stream after the file was reopened, a record at a time.
+	RBFM_InsertStream rbfmInsertStream;
+	rc = rbfm->insertStream(fileHandle, recordDescriptor, rbfmInsertStream);
+	assert(rc == success && "Opening an insert stream should not fail.");
+	records.clear();
+	rids.clear();
+	for (int i = 1000; i < 2500; i++)
+	{
+		RID rid;
+		int recordSize = prepareRoundTripRecord(recordDescriptor, i, 0, 20 + (i % 10) * 90, record);
+		rc = rbfmInsertStream.insertRecord(record, rid);
+		assert(rc == success && "Inserting a record into the stream should not fail.");
+		records.push_back(string((char *)record, recordSize));
+		rids.push_back(rid);
+	}
+	rc = rbfmInsertStream.close();
+	assert(rc == success && "Closing the insert stream should not fail.");
+	expectRecords(rids, records, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2, 1000, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2500, 300, 1000, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	closeAndDestroyFile(rbfm, fileName, fileHandle);
+
+	free(record);
+}
+
+int RBFTest_BulkLoad(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Insert Records, in a batch and through an insert stream
+	// 2. Read Record, Read Attribute, Scan
+	// 3. Update Record, Delete Record, Insert Record on the loaded pages
+	// 4. Close and Open Record-Based File
+	cout << endl << "***** In RBF Test Case Bulk Load *****" << endl;
+
+	RBFTest_BulkLoad_File(rbfm, "test_bulkload", PAGE_SIZE);
+	RBFTest_BulkLoad_File(rbfm, "test_bulkload_16k", 4 * PAGE_SIZE);
+
+	cout << "RBF Test Case Bulk Load Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test bulk loading
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_bulkload");
+	remove("test_bulkload_16k");
+
+	RC rcmain = RBFTest_BulkLoad(rbfm);
+	return rcmain;
+}
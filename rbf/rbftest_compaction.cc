@@ -0,0 +1,149 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+#include <algorithm>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// The bytes between the records of a page, which lie from its start on
+unsigned getHoleSize(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const PageNum pageNum)
+{
+	void *page = malloc(PAGE_SIZE);
+	RC rc = fileHandle.readPage(pageNum, page);
+	assert(rc == success && "Reading a page should not fail.");
+
+	unsigned numberOfSlots = 0;
+	rc = rbfm->getNumberOfSlots(page, numberOfSlots, PAGE_SIZE);
+	assert(rc == success && "Reading the slot directory should not fail.");
+	vector<pair<unsigned, unsigned> > records;
+	for (unsigned slotNum = 0; slotNum < numberOfSlots; slotNum++)
+	{
+		unsigned slotOffset = 0, slotLen = 0;
+		rc = rbfm->getSlotDirectoryEntry(slotNum, page, slotOffset, slotLen, PAGE_SIZE);
+		assert(rc == success && "Reading the slot directory should not fail.");
+		if (slotOffset != MAXXOUT_INDICATOR)
+		{
+			records.push_back(make_pair(slotOffset, slotLen));
+		}
+	}
+	free(page);
+
+	sort(records.begin(), records.end());
+	unsigned holeSize = 0, recordsEnd = 0;
+	for (unsigned i = 0; i < records.size(); i++)
+	{
+		holeSize += records[i].first - recordsEnd;
+		recordsEnd = records[i].first + records[i].second;
+	}
+	return holeSize;
+}
+
+int RBFTest_Compaction(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Insert Record, into a page whose free space is in holes
+	// 2. Update Record, shrinking and growing in place
+	// 3. Delete Record
+	// 4. Read Record, Read Attribute, Scan
+	// 5. Close and Open Record-Based File
+	cout << endl << "***** In RBF Test Case Compaction *****" << endl;
+
+	string fileName = "test_compaction";
+	FileHandle fileHandle;
+	vector<Attribute> recordDescriptor;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+
+	createAndOpenFile(rbfm, fileName, PAGE_SIZE, VariableWidthFormat, fileHandle);
+
+	// The first page is filled up.
+	createRoundTripRecordDescriptor(recordDescriptor, 1000);
+	vector<RID> firstPage;
+	RID rid;
+	int index = 0;
+	do
+	{
+		insertRoundTripRecord(rbfm, fileHandle, recordDescriptor, index++, 300, rid, expected, deleted);
+		if (rid.pageNum == 0)
+		{
+			firstPage.push_back(rid);
+		}
+	} while (rid.pageNum == 0);
+	assert(firstPage.size() > 8 && "The first page should hold many records.");
+	assert(getHoleSize(rbfm, fileHandle, 0) == 0 && "Inserts should leave no holes.");
+
+	// An insert tries the last page first, so that one is left without room for a 700 character record.
+	while (fileHandle.isPageFree(fileHandle.getNumberOfPages() - 1, 700))
+	{
+		insertRoundTripRecord(rbfm, fileHandle, recordDescriptor, index++, 300, rid, expected, deleted);
+	}
+	unsigned numberOfPages = fileHandle.getNumberOfPages();
+
+	// Deletes and shrinking updates leave holes all over the first page, none of them big enough for a 700 character record.
+	for (unsigned k = 0; k < firstPage.size(); k++)
+	{
+		if (k % 2 == 1)
+		{
+			deleteRoundTripRecord(rbfm, fileHandle, recordDescriptor, firstPage[k], expected, deleted);
+		}
+		else if (k % 4 == 0)
+		{
+			updateRoundTripRecord(rbfm, fileHandle, recordDescriptor, firstPage[k], k, 1, 10, expected);
+		}
+	}
+	assert(getHoleSize(rbfm, fileHandle, 0) > 0 && "Deletes and shrinking updates should leave holes.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	// Only a compacted page has room for them all, and compacting it closes every hole.
+	for (unsigned i = 0; i < 3; i++)
+	{
+		insertRoundTripRecord(rbfm, fileHandle, recordDescriptor, index++, 700, rid, expected, deleted);
+		assert(rid.pageNum == 0 && "The holes together should make room on the first page.");
+		assert(fileHandle.getNumberOfPages() == numberOfPages && "No page should be added.");
+	}
+	assert(getHoleSize(rbfm, fileHandle, 0) == 0 && "Compacting the page should leave no holes.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	// The shrunk records grow back, on the page or moved off it.
+	for (unsigned k = 0; k < firstPage.size(); k += 4)
+	{
+		updateRoundTripRecord(rbfm, fileHandle, recordDescriptor, firstPage[k], k, 2, 300, expected);
+	}
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	// More pages, with holes that are filled again.
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, index, 500, 800, expected, deleted);
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 3, 900, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, index + 500, 200, 400, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	closeAndDestroyFile(rbfm, fileName, fileHandle);
+
+	cout << "RBF Test Case Compaction Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test records going into the holes deletes and updates leave on a page
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_compaction");
+
+	RC rcmain = RBFTest_Compaction(rbfm);
+	return rcmain;
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+int RBFTest_Compression(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Create Record-Based File, with its pages compressed
+	// 2. Insert Record, Update Record, Delete Record
+	// 3. Read Record, Read Attribute, Scan
+	// 4. Close and Open Record-Based File, the page map read back
+	cout << endl << "***** In RBF Test Case Compression *****" << endl;
+
+	RC rc;
+	string fileName = "test_compression";
+	string pageMapFileName = fileName + PAGE_MAP_FILE_SUFFIX;
+	FileHandle fileHandle;
+	vector<Attribute> recordDescriptor;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+
+	PagedFileManager::instance()->setCompression(true);
+	rc = rbfm->createFile(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+	PagedFileManager::instance()->setCompression(false);
+
+	rc = createFileShouldSucceed(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+
+	createRoundTripRecordDescriptor(recordDescriptor, 1000);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 0, 2000, 600, expected, deleted);
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 1, 1000, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	struct stat pageMapStat;
+	assert(stat(pageMapFileName.c_str(), &pageMapStat) == 0 && "A compressed file should have a page map.");
+
+	// The pages are decompressed from where the page map says they are.
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	double compressionRatio = 0, decompressThroughput = 0;
+	rc = fileHandle.collectCompressionCounterValues(compressionRatio, decompressThroughput);
+	assert(rc == success && "Collecting the compression counters should not fail.");
+	assert(compressionRatio > 1 && "Repeated characters should compress.");
+
+	// Pages that compress worse outgrow their slots and move.
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2000, 500, 1000, expected, deleted);
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2, 1000, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	rc = destroyFileShouldSucceed(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	assert(stat(pageMapFileName.c_str(), &pageMapStat) != 0 && "The page map should be destroyed with the file.");
+
+	cout << "RBF Test Case Compression Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test files with compressed pages
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_compression");
+	remove("test_compression.pmap");
+
+	RC rcmain = RBFTest_Compression(rbfm);
+	return rcmain;
+}
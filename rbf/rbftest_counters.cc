@@ -0,0 +1,131 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Asserts the counter values of a handle
+void checkCounterValues(FileHandle &fileHandle, const unsigned readPageCount, const unsigned writePageCount,
+		const unsigned appendPageCount)
+{
+	unsigned readPageCount1 = 0, writePageCount1 = 0, appendPageCount1 = 0;
+	RC rc = fileHandle.collectCounterValues(readPageCount1, writePageCount1, appendPageCount1);
+	assert(rc == success && "Collecting the counter values should not fail.");
+	assert(readPageCount1 == readPageCount && "The read counter should be correct.");
+	assert(writePageCount1 == writePageCount && "The write counter should be correct.");
+	assert(appendPageCount1 == appendPageCount && "The append counter should be correct.");
+}
+
+int RBFTest_Counters(PagedFileManager *pfm)
+{
+	// Functions tested
+	// 1. Create File
+	// 2. Open File, twice at the same time and again after closing it
+	// 3. Append Page, Read Page, Write Page
+	// 4. Get Counter Values
+	// 5. Close File
+	cout << endl << "***** In RBF Test Case Counters *****" << endl;
+
+	RC rc;
+	string fileName = "test_counters";
+
+	rc = pfm->createFile(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	rc = createFileShouldSucceed(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	checkCounterValues(fileHandle, 0, 0, 0);
+
+	void *data = malloc(PAGE_SIZE);
+	memset(data, 'c', PAGE_SIZE);
+	for (unsigned i = 0; i < 3; i++)
+	{
+		rc = fileHandle.appendPage(data);
+		assert(rc == success && "Appending a page should not fail.");
+	}
+	rc = fileHandle.readPage(0, data);
+	assert(rc == success && "Reading a page should not fail.");
+	rc = fileHandle.writePage(1, data);
+	assert(rc == success && "Writing a page should not fail.");
+	checkCounterValues(fileHandle, 1, 1, 3);
+
+	// A second handle starts at the totals of the sessions closed so far, which do not include the first one's.
+	FileHandle fileHandle2;
+	rc = pfm->openFile(fileName, fileHandle2);
+	assert(rc == success && "Opening the file should not fail.");
+	checkCounterValues(fileHandle2, 0, 0, 0);
+
+	for (unsigned i = 0; i < 3; i++)
+	{
+		rc = fileHandle2.readPage(i, data);
+		assert(rc == success && "Reading a page should not fail.");
+	}
+	rc = fileHandle2.appendPage(data);
+	assert(rc == success && "Appending a page should not fail.");
+	checkCounterValues(fileHandle2, 3, 0, 1);
+	checkCounterValues(fileHandle, 1, 1, 3);
+
+	// Each handle adds its own share when it is closed.
+	rc = pfm->closeFile(fileHandle2);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = fileHandle.writePage(0, data);
+	assert(rc == success && "Writing a page should not fail.");
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	checkCounterValues(fileHandle, 4, 2, 4);
+
+	rc = fileHandle.readPage(3, data);
+	assert(rc == success && "Reading a page should not fail.");
+	checkCounterValues(fileHandle, 5, 2, 4);
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	checkCounterValues(fileHandle, 5, 2, 4);
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = pfm->destroyFile(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	rc = destroyFileShouldSucceed(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	free(data);
+
+	cout << "RBF Test Case Counters Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test the page counters kept in the header page
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test_counters");
+
+	RC rcmain = RBFTest_Counters(pfm);
+	return rcmain;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Size of the file's dictionary on disk, -1 if it has none
+int getDictionarySize(const string &fileName)
+{
+	struct stat dictionaryStat;
+	if (stat((fileName + DICTIONARY_FILE_SUFFIX).c_str(), &dictionaryStat) != 0)
+	{
+		return -1;
+	}
+	return dictionaryStat.st_size;
+}
+
+// Checks that the pages keep a code in place of every Name, so a record takes fewer bytes than its Name has characters
+void checkEncodedRecords(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const map<pair<unsigned, unsigned>, string> &expected)
+{
+	void *page = malloc(PAGE_SIZE);
+	PageNum pageNum = UINT_MAX;
+	map<pair<unsigned, unsigned>, string>::const_iterator it;
+	for (it = expected.begin(); it != expected.end(); it++)
+	{
+		if (it->second[0] & (1 << 7))
+		{
+			continue;
+		}
+		if (it->first.first != pageNum)
+		{
+			pageNum = it->first.first;
+			RC rc = fileHandle.readPage(pageNum, page);
+			assert(rc == success && "Reading a page should not fail.");
+		}
+		int length = 0;
+		memcpy(&length, it->second.data() + 1, sizeof(int));
+		unsigned slotOffset = 0, slotLen = 0;
+		RC rc = rbfm->getSlotDirectoryEntry(it->first.second, page, slotOffset, slotLen, PAGE_SIZE);
+		assert(rc == success && "Reading the slot directory should not fail.");
+		assert((length < 100 || slotLen < (unsigned)length) && "A record should keep the code of its Name, not its characters.");
+	}
+	free(page);
+}
+
+int RBFTest_Dictionary(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Create Record-Based File, in DictionaryFormat
+	// 2. Insert Record, Update Record, Delete Record
+	// 3. Read Record, Read Attribute, Scan
+	// 4. Close and Open Record-Based File, with the dictionary kept next to the file
+	// 5. Destroy Record-Based File, and its dictionary
+	cout << endl << "***** In RBF Test Case Dictionary *****" << endl;
+
+	string fileName = "test_dictionary";
+	FileHandle fileHandle;
+	vector<Attribute> recordDescriptor;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+
+	createAndOpenFile(rbfm, fileName, PAGE_SIZE, DictionaryFormat, fileHandle);
+
+	// The VarChars repeat a letter, so many records share each of them.
+	createRoundTripRecordDescriptor(recordDescriptor, 1000);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 0, 2000, 1000, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+	assert(getDictionarySize(fileName) > 0 && "The dictionary should be written next to the file.");
+	checkEncodedRecords(rbfm, fileHandle, expected);
+
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 1, 1000, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2000, 300, 1000, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	RC rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+	int dictionarySize = getDictionarySize(fileName);
+
+	// The codes in the records are looked up in the dictionary read back from disk.
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	assert(fileHandle.getRecordFormat() == DictionaryFormat && "The file should keep its record format.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	// Values written before keep their codes, so records written again add nothing to the dictionary.
+	map<pair<unsigned, unsigned>, string>::iterator it;
+	for (it = expected.begin(); it != expected.end(); it++)
+	{
+		RID rid;
+		rid.pageNum = it->first.first;
+		rid.slotNum = it->first.second;
+		rc = rbfm->updateRecord(fileHandle, recordDescriptor, it->second.data(), rid);
+		assert(rc == success && "Updating a record should not fail.");
+	}
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+	assert(getDictionarySize(fileName) == dictionarySize && "Values already in the dictionary should not be added again.");
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2, 1000, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2300, 300, 1000, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+	checkEncodedRecords(rbfm, fileHandle, expected);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	closeAndDestroyFile(rbfm, fileName, fileHandle);
+	assert(getDictionarySize(fileName) == -1 && "Destroying the file should remove its dictionary.");
+
+	cout << "RBF Test Case Dictionary Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test files in DictionaryFormat
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_dictionary");
+	remove("test_dictionary.dict");
+
+	RC rcmain = RBFTest_Dictionary(rbfm);
+	return rcmain;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Record Descriptor of Ints and Reals only, which FixedWidthFormat can hold
+void createFixedWidthRecordDescriptor(vector<Attribute> &recordDescriptor)
+{
+	Attribute attr;
+	for (unsigned i = 0; i < 9; i++)
+	{
+		attr.name = "Field" + to_string(i);
+		attr.type = i % 3 == 1 ? TypeReal : TypeInt;
+		attr.length = (AttrLength)4;
+		recordDescriptor.push_back(attr);
+	}
+}
+
+// Checks that every record takes the same bytes on its page, so that none was moved off it and left a pointer behind
+void checkRecordSizes(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const map<pair<unsigned, unsigned>, string> &expected)
+{
+	void *page = malloc(PAGE_SIZE);
+	PageNum pageNum = UINT_MAX;
+	unsigned recordSize = 0;
+	map<pair<unsigned, unsigned>, string>::const_iterator it;
+	for (it = expected.begin(); it != expected.end(); it++)
+	{
+		if (it->first.first != pageNum)
+		{
+			pageNum = it->first.first;
+			RC rc = fileHandle.readPage(pageNum, page);
+			assert(rc == success && "Reading a page should not fail.");
+		}
+		unsigned slotOffset = 0, slotLen = 0;
+		RC rc = rbfm->getSlotDirectoryEntry(it->first.second, page, slotOffset, slotLen, PAGE_SIZE);
+		assert(rc == success && "Reading the slot directory should not fail.");
+		recordSize = recordSize == 0 ? slotLen : recordSize;
+		assert(slotLen == recordSize && "Every record should take the same bytes, nulls or not.");
+	}
+	free(page);
+}
+
+int RBFTest_FixedWidth(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Create Record-Based File, in FixedWidthFormat
+	// 2. Insert Record, Update Record, Delete Record
+	// 3. Read Record, Read Attribute, Scan
+	// 4. Close and Open Record-Based File
+	cout << endl << "***** In RBF Test Case Fixed Width *****" << endl;
+
+	RC rc;
+	string fileName = "test_fixedwidth";
+	FileHandle fileHandle;
+	vector<Attribute> recordDescriptor;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+
+	createAndOpenFile(rbfm, fileName, PAGE_SIZE, FixedWidthFormat, fileHandle);
+
+	// A VarChar has no fixed width.
+	vector<Attribute> varcharRecordDescriptor;
+	createRoundTripRecordDescriptor(varcharRecordDescriptor, 100);
+	void *record = malloc(PAGE_SIZE);
+	RID rid;
+	prepareRoundTripRecord(varcharRecordDescriptor, 0, 0, 100, record);
+	rc = rbfm->insertRecord(fileHandle, varcharRecordDescriptor, record, rid);
+	assert(rc != success && "A record with a VarChar should not go into a fixed width file.");
+
+	// Nor has an Int narrower than 4 bytes, such as a 1 byte flag.
+	vector<Attribute> narrowRecordDescriptor;
+	createFixedWidthRecordDescriptor(narrowRecordDescriptor);
+	narrowRecordDescriptor[0].length = (AttrLength)1;
+	memset(record, 0, 2);
+	rc = rbfm->insertRecord(fileHandle, narrowRecordDescriptor, record, rid);
+	assert(rc != success && "A record with a 1 byte Int should not go into a fixed width file.");
+	free(record);
+
+	createFixedWidthRecordDescriptor(recordDescriptor);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 0, 3000, 0, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	// Every version of a record has the same size, so updates stay in place, nulls or not.
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 1, 0, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 3000, 500, 0, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	checkRecordSizes(rbfm, fileHandle, expected);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2, 0, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 3500, 500, 0, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+	checkRecordSizes(rbfm, fileHandle, expected);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	closeAndDestroyFile(rbfm, fileName, fileHandle);
+
+	cout << "RBF Test Case Fixed Width Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test files in FixedWidthFormat
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_fixedwidth");
+
+	RC rcmain = RBFTest_FixedWidth(rbfm);
+	return rcmain;
+}
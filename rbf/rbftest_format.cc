@@ -0,0 +1,116 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Overwrites the format version in the header page of the file
+void writeFormatVersion(const string &fileName, const unsigned formatVersion)
+{
+	FILE *file = fopen(fileName.c_str(), "r+b");
+	assert(file != NULL && "The file should exist.");
+	fseek(file, HEADER_FORMAT_VERSION_OFFSET, SEEK_SET);
+	fwrite(&formatVersion, sizeof(unsigned), 1, file);
+	fclose(file);
+}
+
+int RBFTest_Format(PagedFileManager *pfm)
+{
+	// Functions tested
+	// 1. Create File
+	// 2. Open File, of this format version and of others
+	// 3. Append Page, Read Page
+	// 4. Close File
+	cout << endl << "***** In RBF Test Case Format *****" << endl;
+
+	RC rc;
+	string fileName = "test_format";
+	string oldFileName = "test_format_old";
+
+	rc = pfm->createFile(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	rc = createFileShouldSucceed(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening a file of this format version should not fail.");
+
+	void *data = malloc(PAGE_SIZE);
+	void *buffer = malloc(PAGE_SIZE);
+	for (unsigned i = 0; i < PAGE_SIZE; i++)
+	{
+		*((char *)data + i) = i % 94 + 32;
+	}
+	rc = fileHandle.appendPage(data);
+	assert(rc == success && "Appending a page should not fail.");
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	// A file of another version has its pages elsewhere.
+	writeFormatVersion(fileName, PAGED_FILE_FORMAT_VERSION + 1);
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc != success && "Opening a file of another format version should fail.");
+
+	writeFormatVersion(fileName, PAGED_FILE_FORMAT_VERSION);
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening a file of this format version should not fail.");
+
+	rc = fileHandle.readPage(0, buffer);
+	assert(rc == success && "Reading a page should not fail.");
+	assert(memcmp(data, buffer, PAGE_SIZE) == 0 && "The page should be the one appended.");
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	// A file written before there were free-space map pages: a header page of counters and zeros,
+	// then a data page right after it.
+	FILE *oldFile = fopen(oldFileName.c_str(), "wb");
+	assert(oldFile != NULL && "Writing the old file should not fail.");
+	memset(buffer, 0, PAGE_SIZE);
+	fwrite(buffer, 1, PAGE_SIZE, oldFile);
+	fwrite(data, 1, PAGE_SIZE, oldFile);
+	fclose(oldFile);
+
+	rc = pfm->openFile(oldFileName, fileHandle);
+	assert(rc != success && "Opening a file without a format version should fail.");
+
+	rc = pfm->destroyFile(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	rc = destroyFileShouldSucceed(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	rc = pfm->destroyFile(oldFileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	free(data);
+	free(buffer);
+
+	cout << "RBF Test Case Format Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test the format version of paged files
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test_format");
+	remove("test_format_old");
+
+	RC rcmain = RBFTest_Format(pfm);
+	return rcmain;
+}
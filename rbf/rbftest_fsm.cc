@@ -0,0 +1,128 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Deletes every record on the page and returns how many there were
+unsigned deletePage(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+		const PageNum pageNum, map<pair<unsigned, unsigned>, string> &expected, vector<RID> &deleted)
+{
+	unsigned count = 0;
+	map<pair<unsigned, unsigned>, string>::iterator it = expected.lower_bound(make_pair(pageNum, 0));
+	while (it != expected.end() && it->first.first == pageNum)
+	{
+		RID rid;
+		rid.pageNum = it->first.first;
+		rid.slotNum = it->first.second;
+		it++;
+		deleteRoundTripRecord(rbfm, fileHandle, recordDescriptor, rid, expected, deleted);
+		count++;
+	}
+	return count;
+}
+
+// The first page the free-space map offers for requiredSpace, or UINT_MAX if it offers none
+PageNum getFreePage(FileHandle &fileHandle, const unsigned requiredSpace)
+{
+	PageNum pageNum = 0;
+	return fileHandle.findFreePage(requiredSpace, pageNum) == success ? pageNum : UINT_MAX;
+}
+
+int RBFTest_FSM(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Insert Record, with the free-space map finding the page
+	// 2. Find Free Page, after inserts and deletes and after reopening
+	// 3. Read Record, Read Attribute
+	// 4. Update Record
+	// 5. Delete Record
+	// 6. Scan
+	// 7. Close and Open Record-Based File, the map read back
+	cout << endl << "***** In RBF Test Case FSM *****" << endl;
+
+	string fileName = "test_fsm";
+	FileHandle fileHandle;
+	vector<Attribute> recordDescriptor;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+
+	createAndOpenFile(rbfm, fileName, PAGE_SIZE, VariableWidthFormat, fileHandle);
+
+	// Two records fill a page, so the file soon has data pages under a second map page.
+	// None of them has room for a third of a page more.
+	createRoundTripRecordDescriptor(recordDescriptor, 2000);
+	RID rid;
+	int index = 0;
+	while (fileHandle.getNumberOfPages() <= FSM_PAGES_PER_MAP_PAGE + 8)
+	{
+		insertRoundTripRecord(rbfm, fileHandle, recordDescriptor, index++, 1500, rid, expected, deleted);
+	}
+	unsigned numberOfPages = fileHandle.getNumberOfPages();
+	const unsigned emptySpace = PAGE_SIZE * 3 / 4;
+	assert(getFreePage(fileHandle, emptySpace) == UINT_MAX && "No page should have room before the deletes.");
+
+	// The map accounts for the space freed under either map page, and inserts find it instead of appending.
+	PageNum firstPage = 2;
+	PageNum secondPage = FSM_PAGES_PER_MAP_PAGE + 2;
+	unsigned freedInSecond = deletePage(rbfm, fileHandle, recordDescriptor, secondPage, expected, deleted);
+	assert(freedInSecond > 1 && "The page should have held more than one record.");
+	assert(getFreePage(fileHandle, emptySpace) == secondPage && "The map should offer the page emptied under the second map page.");
+
+	unsigned freed = freedInSecond + deletePage(rbfm, fileHandle, recordDescriptor, firstPage, expected, deleted);
+	assert(getFreePage(fileHandle, emptySpace) == firstPage && "The map should offer the lowest emptied page.");
+
+	unsigned reusedInSecond = 0;
+	for (unsigned i = 0; i < freed; i++)
+	{
+		insertRoundTripRecord(rbfm, fileHandle, recordDescriptor, index++, 1500, rid, expected, deleted);
+		reusedInSecond += rid.pageNum == secondPage ? 1 : 0;
+	}
+	assert(fileHandle.getNumberOfPages() == numberOfPages && "Inserts should go to the freed pages.");
+	assert(reusedInSecond > 0 && "Inserts should find the freed page under the second map page.");
+	assert(getFreePage(fileHandle, emptySpace) == UINT_MAX && "The map should account for the space the inserts took.");
+
+	// Records grow, which moves some of them, shrink and go away.
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 1, 1900, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	// The map is read back with the file.
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	numberOfPages = fileHandle.getNumberOfPages();
+	PageNum freePage = min(getFreePage(fileHandle, emptySpace), secondPage + 2);
+	freed = deletePage(rbfm, fileHandle, recordDescriptor, secondPage + 2, expected, deleted);
+	assert(getFreePage(fileHandle, emptySpace) == freePage && "The map read back should account for a delete.");
+	for (unsigned i = 0; i < freed; i++)
+	{
+		insertRoundTripRecord(rbfm, fileHandle, recordDescriptor, index++, 1500, rid, expected, deleted);
+	}
+	assert(fileHandle.getNumberOfPages() == numberOfPages && "Inserts after reopening should go to the freed page.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	closeAndDestroyFile(rbfm, fileName, fileHandle);
+
+	cout << "RBF Test Case FSM Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test the free-space map of the record-based file manager
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_fsm");
+
+	RC rcmain = RBFTest_FSM(rbfm);
+	return rcmain;
+}
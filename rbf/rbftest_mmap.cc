@@ -0,0 +1,107 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+int RBFTest_Mmap(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Create Record-Based File, opened with MappedBackend
+	// 2. Insert Record, Update Record, Delete Record
+	// 3. Read Record, Read Attribute, Scan
+	// 4. Close and Open Record-Based File, with MappedBackend and PositionalBackend
+	cout << endl << "***** In RBF Test Case Mmap *****" << endl;
+
+	RC rc;
+	string fileName = "test_mmap";
+	PagedFileManager *pfm = PagedFileManager::instance();
+	FileHandle fileHandle;
+	vector<Attribute> recordDescriptor;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+
+	rc = rbfm->createFile(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	rc = createFileShouldSucceed(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	// Logged files are never mapped.
+	rc = pfm->setCommitMode(NoLogging);
+	assert(rc == success && "Setting the commit mode should not fail.");
+
+	rc = pfm->setIOBackend(MappedBackend);
+	assert(rc == success && "Setting the I/O backend should not fail.");
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+
+	createRoundTripRecordDescriptor(recordDescriptor, 100);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 0, 3000, 100, expected, deleted);
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 1, 100, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	// The pages changed in the mapping are in the file once it is closed, whatever reads it next.
+	rc = pfm->setIOBackend(PositionalBackend);
+	assert(rc == success && "Setting the I/O backend should not fail.");
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2, 100, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 3000, 500, 100, expected, deleted);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = pfm->setIOBackend(MappedBackend);
+	assert(rc == success && "Setting the I/O backend should not fail.");
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = pfm->setIOBackend(DEFAULT_IO_BACKEND);
+	assert(rc == success && "Setting the I/O backend should not fail.");
+
+	rc = pfm->setCommitMode(DEFAULT_COMMIT_MODE);
+	assert(rc == success && "Setting the commit mode should not fail.");
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	rc = destroyFileShouldSucceed(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	cout << "RBF Test Case Mmap Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test files opened with MappedBackend
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_mmap");
+
+	RC rcmain = RBFTest_Mmap(rbfm);
+	return rcmain;
+}
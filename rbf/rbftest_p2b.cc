@@ -136,9 +136,9 @@ int RBFTest_private_2b(RecordBasedFileManager *rbfm) {
             return -1;
         }
     } else {
-        // Each page can only contain one record. So, readPageCountDiff should be greater than 50
-        // since the system needs to go through all pages from the beginning.
-        if (readPageCountDiff < numRecords) {
+        // Each page can only contain one record. The free-space map already knows that no page
+        // has room, so the insert must append a page without going through all pages from the beginning.
+        if (readPageCountDiff >= numRecords || appendPageCountDiff < 1) {
             cout << "The implementation regarding insertRecord() is not correct." << endl;
             cout << "***** [FAIL] Test Case Private 2b Failed! *****" << endl;
             rc = rbfm->closeFile(fileHandle);
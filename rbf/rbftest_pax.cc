@@ -0,0 +1,165 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Reads the Id of a round-trip record, false if it is null
+bool getId(const string &record, int &id)
+{
+	if (record[0] & (1 << 6))
+	{
+		return false;
+	}
+	int offset = 1;
+	if ((record[0] & (1 << 7)) == 0)
+	{
+		int length = 0;
+		memcpy(&length, record.data() + offset, sizeof(int));
+		offset += sizeof(int) + length;
+	}
+	memcpy(&id, record.data() + offset, sizeof(int));
+	return true;
+}
+
+// Checks that every page keeps the Ids of its records together in one minipage, each at the place of its row
+void checkColumnLayout(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+		const map<pair<unsigned, unsigned>, string> &expected, const unsigned pageSize)
+{
+	PaxLayout layout;
+	RC rc = layout.initialize(recordDescriptor, pageSize);
+	assert(rc == success && "A PAX layout should fit the descriptor.");
+	assert(layout.minipages[0] < layout.minipages[1] && layout.minipages[1] < layout.minipages[2] && "The minipages should follow one another.");
+	assert(layout.minipages[2] - layout.minipages[1] == layout.numberOfRows * sizeof(int) && "The Id minipage should hold an Int for every row.");
+
+	void *page = malloc(pageSize);
+	PageNum pageNum = UINT_MAX;
+	map<pair<unsigned, unsigned>, string>::const_iterator it;
+	for (it = expected.begin(); it != expected.end(); it++)
+	{
+		if (it->first.first != pageNum)
+		{
+			pageNum = it->first.first;
+			rc = fileHandle.readPage(pageNum, page);
+			assert(rc == success && "Reading a page should not fail.");
+		}
+		int id = 0;
+		if (getId(it->second, id))
+		{
+			assert(memcmp((char *)page + layout.minipages[1] + it->first.second * sizeof(int), &id, sizeof(int)) == 0 &&
+					"The Id of a record should be in the Id minipage, at the place of its row.");
+		}
+	}
+	free(page);
+}
+
+// Checks that a scan on Id > value, which the selection kernel answers a minipage at a time,
+// returns exactly the expected records whose Id is not null and above it
+void checkConditionalScan(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const vector<Attribute> &recordDescriptor,
+		const map<pair<unsigned, unsigned>, string> &expected, const int value)
+{
+	unsigned numberOfMatches = 0;
+	map<pair<unsigned, unsigned>, string>::const_iterator it;
+	for (it = expected.begin(); it != expected.end(); it++)
+	{
+		int id = 0;
+		numberOfMatches += getId(it->second, id) && id > value ? 1 : 0;
+	}
+
+	vector<string> attributeNames;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++)
+	{
+		attributeNames.push_back(recordDescriptor[i].name);
+	}
+	RBFM_ScanIterator rbfmScanIterator;
+	RC rc = rbfm->scan(fileHandle, recordDescriptor, "Id", GT_OP, &value, attributeNames, rbfmScanIterator);
+	assert(rc == success && "Scanning the file should not fail.");
+
+	RID rid;
+	void *returnedData = malloc(PAGE_SIZE);
+	unsigned found = 0;
+	while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+	{
+		it = expected.find(make_pair(rid.pageNum, rid.slotNum));
+		assert(it != expected.end() && "A scan should only return the records of the file.");
+		assert(memcmp(it->second.data(), returnedData, it->second.size()) == 0 && "Scanned record should be the same");
+		found++;
+	}
+	rbfmScanIterator.close();
+	assert(found == numberOfMatches && "A conditional scan should return every record that matches.");
+	free(returnedData);
+}
+
+void RBFTest_Pax_File(RecordBasedFileManager *rbfm, string fileName, const unsigned pageSize)
+{
+	FileHandle fileHandle;
+	vector<Attribute> recordDescriptor;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+
+	createAndOpenFile(rbfm, fileName, pageSize, PaxFormat, fileHandle);
+
+	// A row has room for the whole VarChar, so a grown record stays where it is.
+	createRoundTripRecordDescriptor(recordDescriptor, 100);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 0, 2000, 100, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+	checkColumnLayout(fileHandle, recordDescriptor, expected, pageSize);
+	checkConditionalScan(rbfm, fileHandle, recordDescriptor, expected, 1000 * 31);
+
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 1, 100, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2000, 300, 100, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+	checkColumnLayout(fileHandle, recordDescriptor, expected, pageSize);
+	checkConditionalScan(rbfm, fileHandle, recordDescriptor, expected, 1000 * 31);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+
+	updateRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2, 100, expected, deleted);
+	insertRoundTripRecords(rbfm, fileHandle, recordDescriptor, 2300, 300, 100, expected, deleted);
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+	checkConditionalScan(rbfm, fileHandle, recordDescriptor, expected, 1500 * 31);
+
+	reopenFile(rbfm, fileName, fileHandle, recordDescriptor, expected, deleted);
+	checkColumnLayout(fileHandle, recordDescriptor, expected, pageSize);
+
+	closeAndDestroyFile(rbfm, fileName, fileHandle);
+}
+
+int RBFTest_Pax(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Create Record-Based File, in PaxFormat
+	// 2. Insert Record, Update Record, Delete Record
+	// 3. Read Record, Read Attribute, Scan with and without a condition
+	// 4. Close and Open Record-Based File
+	cout << endl << "***** In RBF Test Case PAX *****" << endl;
+
+	RBFTest_Pax_File(rbfm, "test_pax", PAGE_SIZE);
+	RBFTest_Pax_File(rbfm, "test_pax_16k", 4 * PAGE_SIZE);
+
+	cout << "RBF Test Case PAX Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test files in PaxFormat
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_pax");
+	remove("test_pax_16k");
+
+	RC rcmain = RBFTest_Pax(rbfm);
+	return rcmain;
+}
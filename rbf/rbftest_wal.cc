@@ -0,0 +1,255 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <stdio.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Inserts, updates and deletes records, each change committed as the file's commit mode says,
+// and keeps what the file should hold by RID.
+void loadFile(RecordBasedFileManager *rbfm, const string &fileName, FileHandle &fileHandle,
+		map<pair<unsigned, unsigned>, string> &expected, vector<RID> &deleted)
+{
+	RC rc;
+	RID rid;
+	void *record = malloc(PAGE_SIZE);
+	vector<Attribute> recordDescriptor;
+	createRoundTripRecordDescriptor(recordDescriptor, 2000);
+
+	rc = rbfm->createFile(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+
+	vector<RID> rids;
+	for (int i = 0; i < 400; i++)
+	{
+		int recordSize = prepareRoundTripRecord(recordDescriptor, i, 0, 50 + (i % 9) * 100, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success && "Inserting a record should not fail.");
+		expected[make_pair(rid.pageNum, rid.slotNum)] = string((char *)record, recordSize);
+		rids.push_back(rid);
+	}
+
+	// Growing records move to other pages, which logs the pages on both sides.
+	for (int i = 0; i < (int)rids.size(); i += 4)
+	{
+		rid = rids[i];
+		int recordSize = prepareRoundTripRecord(recordDescriptor, i, 1, 1800, record);
+		rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success && "Updating a record should not fail.");
+		expected[make_pair(rid.pageNum, rid.slotNum)] = string((char *)record, recordSize);
+	}
+
+	// Deleted last, so that no record moves into a slot they free.
+	for (int i = 1; i < (int)rids.size(); i += 11)
+	{
+		rid = rids[i];
+		rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rid);
+		assert(rc == success && "Deleting a record should not fail.");
+		expected.erase(make_pair(rid.pageNum, rid.slotNum));
+		deleted.push_back(rid);
+	}
+
+	free(record);
+}
+
+// Reads the redo LSN stamped in the header page of the file
+unsigned long long readRedoLSN(const string &fileName)
+{
+	unsigned long long redoLSN = 0;
+	FILE *file = fopen(fileName.c_str(), "rb");
+	assert(file != NULL && "The file should exist.");
+	fseek(file, HEADER_REDO_LSN_OFFSET, SEEK_SET);
+	size_t count = fread(&redoLSN, sizeof(redoLSN), 1, file);
+	fclose(file);
+	assert(count == 1 && "The header page should hold a redo LSN.");
+	return redoLSN;
+}
+
+// Updates the last record to a copy with its last byte changed, or back to what it should be
+void rewriteLastRecord(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+		const map<pair<unsigned, unsigned>, string> &expected, const bool changed)
+{
+	RID rid;
+	rid.pageNum = expected.rbegin()->first.first;
+	rid.slotNum = expected.rbegin()->first.second;
+	string record = expected.rbegin()->second;
+	if (changed)
+	{
+		record[record.size() - 1] ^= 1;
+	}
+	RC rc = rbfm->updateRecord(fileHandle, recordDescriptor, record.data(), rid);
+	assert(rc == success && "Updating a record should not fail.");
+}
+
+// Loads fileName under commitMode in a child process killed before it closes the file.
+void crashWhileLoading(RecordBasedFileManager *rbfm, const string &fileName, const CommitMode commitMode)
+{
+	pid_t child = fork();
+	if (child == 0)
+	{
+		FileHandle fileHandle;
+		map<pair<unsigned, unsigned>, string> expected;
+		vector<RID> deleted;
+		PagedFileManager::instance()->setCommitMode(commitMode);
+		loadFile(rbfm, fileName, fileHandle, expected, deleted);
+
+		// A group commit is durable once the writer thread has synced the log.
+		if (commitMode == GroupCommit)
+		{
+			usleep(10 * WAL_FLUSH_INTERVAL * 1000);
+		}
+		// The file is never closed, so its dirty pages die with the buffer pool.
+		kill(getpid(), SIGKILL);
+	}
+
+	int status = 0;
+	waitpid(child, &status, 0);
+	assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL && "The loading process should be killed.");
+}
+
+// Loads fileName under GroupCommit in a child process that lets the page writer checkpoint the file,
+// once with no page pinned and once with one, and is killed after a change logged past both.
+void crashAfterCheckpoints(RecordBasedFileManager *rbfm, const string &fileName)
+{
+	pid_t child = fork();
+	if (child == 0)
+	{
+		FileHandle fileHandle;
+		map<pair<unsigned, unsigned>, string> expected;
+		vector<RID> deleted;
+		vector<Attribute> recordDescriptor;
+		createRoundTripRecordDescriptor(recordDescriptor, 2000);
+		PagedFileManager::instance()->setCommitMode(GroupCommit);
+		loadFile(rbfm, fileName, fileHandle, expected, deleted);
+
+		// With no page pinned, the file is written back and recovery skips the whole log.
+		usleep(2 * CHECKPOINT_INTERVAL * 1000);
+		unsigned long long redoLSN = readRedoLSN(fileName);
+		assert(redoLSN > 0 && "A checkpoint should stamp the redo LSN.");
+
+		// With the first page pinned, a checkpoint only skips the records of the pages written back since.
+		void *page = NULL;
+		RC rc = fileHandle.pinPage(0, page);
+		assert(rc == success && "Pinning a page should not fail.");
+		rewriteLastRecord(rbfm, fileHandle, recordDescriptor, expected, true);
+		usleep(2 * CHECKPOINT_INTERVAL * 1000);
+		assert(readRedoLSN(fileName) > redoLSN && "A checkpoint with a page pinned should move the redo LSN.");
+
+		// The page of the last change stays pinned, so no checkpoint skips it before the crash.
+		rc = fileHandle.pinPage(expected.rbegin()->first.first, page);
+		assert(rc == success && "Pinning a page should not fail.");
+		rewriteLastRecord(rbfm, fileHandle, recordDescriptor, expected, false);
+		usleep(10 * WAL_FLUSH_INTERVAL * 1000);
+		kill(getpid(), SIGKILL);
+	}
+
+	int status = 0;
+	waitpid(child, &status, 0);
+	assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL && "The loading process should be killed.");
+}
+
+int RBFTest_WAL(RecordBasedFileManager *rbfm)
+{
+	// Functions tested
+	// 1. Insert Record, Update Record, Delete Record under GroupCommit and SyncCommit
+	// 2. Checkpoints of the page writer, with and without a page pinned
+	// 3. Crash without Close Record-Based File
+	// 4. Open Record-Based File, which redoes the log from the redo LSN on
+	// 5. Read Record, Read Attribute, Scan
+	cout << endl << "***** In RBF Test Case WAL *****" << endl;
+
+	RC rc;
+	string referenceFileName = "test_wal_reference";
+	string fileNames[] = { "test_wal_group", "test_wal_sync", "test_wal_checkpoint" };
+	CommitMode commitModes[] = { GroupCommit, SyncCommit, GroupCommit };
+
+	// The children fork before this process starts any thread.
+	for (unsigned m = 0; m < 3; m++)
+	{
+		if (m < 2)
+		{
+			crashWhileLoading(rbfm, fileNames[m], commitModes[m]);
+		}
+		else
+		{
+			crashAfterCheckpoints(rbfm, fileNames[m]);
+		}
+
+		struct stat logStat;
+		rc = stat((fileNames[m] + WAL_FILE_SUFFIX).c_str(), &logStat);
+		assert(rc == success && logStat.st_size > 0 && "The crash should leave the log behind.");
+		assert((m < 2 || (unsigned long long)logStat.st_size > readRedoLSN(fileNames[m])) &&
+				"The log should go on past the redo LSN.");
+	}
+
+	// The same changes without logging put every record at the same RID.
+	FileHandle fileHandle;
+	map<pair<unsigned, unsigned>, string> expected;
+	vector<RID> deleted;
+	PagedFileManager::instance()->setCommitMode(NoLogging);
+	loadFile(rbfm, referenceFileName, fileHandle, expected, deleted);
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	vector<Attribute> recordDescriptor;
+	createRoundTripRecordDescriptor(recordDescriptor, 2000);
+	for (unsigned m = 0; m < 3; m++)
+	{
+		PagedFileManager::instance()->setCommitMode(commitModes[m]);
+
+		// Every committed change is back, byte for byte, and again once the recovered file was closed.
+		for (unsigned open = 0; open < 2; open++)
+		{
+			rc = rbfm->openFile(fileNames[m], fileHandle);
+			assert(rc == success && "Opening the crashed file should not fail.");
+			checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+			rc = rbfm->closeFile(fileHandle);
+			assert(rc == success && "Closing the file should not fail.");
+		}
+
+		rc = rbfm->destroyFile(fileNames[m]);
+		assert(rc == success && "Destroying the file should not fail.");
+
+		rc = destroyFileShouldSucceed(fileNames[m]);
+		assert(rc == success && "Destroying the file should not fail.");
+	}
+	PagedFileManager::instance()->setCommitMode(DEFAULT_COMMIT_MODE);
+
+	rc = rbfm->destroyFile(referenceFileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	cout << "RBF Test Case WAL Finished! The result will be examined." << endl << endl;
+
+	return 0;
+}
+
+int main()
+{
+	// To test recovery from the write-ahead log after a crash
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test_wal_reference");
+	remove("test_wal_group");
+	remove("test_wal_group.wal");
+	remove("test_wal_sync");
+	remove("test_wal_sync.wal");
+	remove("test_wal_checkpoint");
+	remove("test_wal_checkpoint.wal");
+
+	RC rcmain = RBFTest_WAL(rbfm);
+	return rcmain;
+}
@@ -9,6 +9,8 @@
 #include <stdexcept>
 #include <stdio.h> 
 #include <math.h>
+#include <map>
+#include <algorithm>
 
 #include "pfm.h"
 #include "rbfm.h"
@@ -911,3 +913,335 @@ void setAttrNull(void * src, ushort attrNum, bool isNull)
 	setBit(*((byte *) src + bytes), isNull, pos);
 }
 
+// Record Descriptor for the round-trip tests: a VarChar, an Int and a Real, each of which may be null
+void createRoundTripRecordDescriptor(vector<Attribute> &recordDescriptor,
+		const int nameLength) {
+	Attribute attr;
+	attr.name = "Name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) nameLength;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "Id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "Score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+// Prepares the record index of a round-trip test over any descriptor. Field i is null when (index + i) % 7 == 3,
+// and a VarChar holds varcharLength characters, at most its length. Each version of a record has other values.
+int prepareRoundTripRecord(const vector<Attribute> &recordDescriptor,
+		const int index, const int version, const int varcharLength,
+		void *buffer) {
+	int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(
+			recordDescriptor.size());
+	memset(buffer, 0, nullFieldsIndicatorActualSize);
+	int offset = nullFieldsIndicatorActualSize;
+
+	for (unsigned i = 0; i < recordDescriptor.size(); i++) {
+		if ((index + i) % 7 == 3) {
+			setAttrNull(buffer, i, true);
+			continue;
+		}
+
+		if (recordDescriptor[i].type == TypeVarChar) {
+			int length = min(varcharLength, (int) recordDescriptor[i].length);
+			char text = (index + version + i) % 26 + 97;
+			memcpy((char *) buffer + offset, &length, sizeof(int));
+			offset += sizeof(int);
+			memset((char *) buffer + offset, text, length);
+			offset += length;
+		} else if (recordDescriptor[i].type == TypeInt) {
+			int value = index * 31 + version * 7 + i;
+			memcpy((char *) buffer + offset, &value, sizeof(int));
+			offset += sizeof(int);
+		} else {
+			float value = index + version * 0.25 + i * 0.5;
+			memcpy((char *) buffer + offset, &value, sizeof(float));
+			offset += sizeof(float);
+		}
+	}
+	return offset;
+}
+
+// Writes the given fields of a record, in that order, as readAttribute() and a projected scan return them
+int projectRecord(const vector<Attribute> &recordDescriptor,
+		const void *record, const vector<int> &attributes, void *buffer) {
+	int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(
+			recordDescriptor.size());
+	int projectedIndicatorActualSize = getActualByteForNullsIndicator(
+			attributes.size());
+	memset(buffer, 0, projectedIndicatorActualSize);
+	int offset = projectedIndicatorActualSize;
+
+	for (unsigned k = 0; k < attributes.size(); k++) {
+		int pointer = nullFieldsIndicatorActualSize;
+		for (int i = 0; i <= attributes[k]; i++) {
+			unsigned bytes = 0;
+			unsigned bit = 0;
+			getByteOffset(i, bytes, bit);
+			bool isNull = *((const unsigned char *) record + bytes) & (1 << bit);
+			int length = 0;
+			if (!isNull) {
+				length = sizeof(int);
+				if (recordDescriptor[i].type == TypeVarChar) {
+					memcpy(&length, (const char *) record + pointer, sizeof(int));
+					length += sizeof(int);
+				}
+			}
+
+			if (i == attributes[k]) {
+				if (isNull) {
+					setAttrNull(buffer, k, true);
+				}
+				memcpy((char *) buffer + offset, (const char *) record + pointer, length);
+				offset += length;
+			}
+			pointer += length;
+		}
+	}
+	return offset;
+}
+
+// Checks a file against the records it should hold, by RID, and the RIDs it should no longer have:
+// every record reads back byte for byte, whole and a field at a time, and a full and a projected scan
+// return each of them at its RID. A record that moved is also returned at the page it moved to, and read there.
+void checkRoundTrip(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const vector<Attribute> &recordDescriptor,
+		const map<pair<unsigned, unsigned>, string> &expected,
+		const vector<RID> &deleted) {
+	RC rc;
+	void *returnedData = malloc(PAGE_SIZE);
+	void *projectedData = malloc(PAGE_SIZE);
+	vector<int> lastField(1, recordDescriptor.size() - 1);
+	// A scan returns the projected fields in the order of the descriptor.
+	vector<int> projection;
+	projection.push_back(0);
+	projection.push_back(recordDescriptor.size() - 1);
+
+	map<pair<unsigned, unsigned>, string>::const_iterator it;
+	for (it = expected.begin(); it != expected.end(); it++) {
+		RID rid;
+		rid.pageNum = it->first.first;
+		rid.slotNum = it->first.second;
+		rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returnedData);
+		assert(rc == success && "Reading a record should not fail.");
+		assert(memcmp(it->second.data(), returnedData, it->second.size()) == 0 && "Returned Data should be the same");
+
+		int size = projectRecord(recordDescriptor, it->second.data(), lastField, projectedData);
+		rc = rbfm->readAttribute(fileHandle, recordDescriptor, rid, recordDescriptor[lastField[0]].name, returnedData);
+		assert(rc == success && "Reading an attribute should not fail.");
+		assert(memcmp(projectedData, returnedData, size) == 0 && "Returned attribute should be the same");
+	}
+
+	// The slot of a deleted record may since hold a record that moved there, and nothing else.
+	for (unsigned i = 0; i < deleted.size(); i++) {
+		rc = rbfm->readRecord(fileHandle, recordDescriptor, deleted[i], returnedData);
+		bool copy = false;
+		for (it = expected.begin(); rc == success && it != expected.end() && !copy; it++) {
+			copy = memcmp(it->second.data(), returnedData, it->second.size()) == 0;
+		}
+		assert((rc != success || copy) && "Reading a deleted record should fail.");
+	}
+
+	for (unsigned projected = 0; projected < 2; projected++) {
+		vector<string> attributeNames;
+		for (unsigned i = 0; i < recordDescriptor.size(); i++) {
+			attributeNames.push_back(recordDescriptor[i].name);
+		}
+		if (projected == 1) {
+			attributeNames.clear();
+			for (unsigned k = 0; k < projection.size(); k++) {
+				attributeNames.push_back(recordDescriptor[projection[k]].name);
+			}
+		}
+
+		// Every record that should be there comes back once at its RID, anything else is a copy of one of them.
+		vector<string> records;
+		for (it = expected.begin(); it != expected.end(); it++) {
+			string record = it->second;
+			if (projected == 1) {
+				int size = projectRecord(recordDescriptor, it->second.data(), projection, projectedData);
+				record = string((char *) projectedData, size);
+			}
+			records.push_back(record);
+		}
+		sort(records.begin(), records.end());
+
+		RBFM_ScanIterator rbfmScanIterator;
+		rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, rbfmScanIterator);
+		assert(rc == success && "Scanning the file should not fail.");
+
+		RID rid;
+		unsigned found = 0;
+		while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+			it = expected.find(make_pair(rid.pageNum, rid.slotNum));
+			if (it != expected.end()) {
+				string record = it->second;
+				if (projected == 1) {
+					int size = projectRecord(recordDescriptor, it->second.data(), projection, projectedData);
+					record = string((char *) projectedData, size);
+				}
+				assert(memcmp(record.data(), returnedData, record.size()) == 0 && "Scanned record should be the same");
+				found++;
+			} else {
+				bool copy = false;
+				for (unsigned i = 0; i < records.size() && !copy; i++) {
+					copy = memcmp(records[i].data(), returnedData, records[i].size()) == 0;
+				}
+				assert(copy && "A scan should only return the records of the file.");
+			}
+		}
+		rbfmScanIterator.close();
+		assert(found == expected.size() && "A scan should return every record of the file.");
+	}
+
+	free(returnedData);
+	free(projectedData);
+}
+
+// Notes that the record went to rid. A deleted RID given out again is no longer expected to be gone.
+void expectRecord(const RID &rid, const string &record,
+		map<pair<unsigned, unsigned>, string> &expected,
+		vector<RID> &deleted) {
+	expected[make_pair(rid.pageNum, rid.slotNum)] = record;
+	for (unsigned i = 0; i < deleted.size(); i++) {
+		if (deleted[i].pageNum == rid.pageNum && deleted[i].slotNum == rid.slotNum) {
+			deleted.erase(deleted.begin() + i);
+			break;
+		}
+	}
+}
+
+// Inserts the round-trip record of index, with VarChars of varcharLength characters, and notes where it went
+void insertRoundTripRecord(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const vector<Attribute> &recordDescriptor, const int index,
+		const int varcharLength, RID &rid,
+		map<pair<unsigned, unsigned>, string> &expected,
+		vector<RID> &deleted) {
+	void *record = malloc(PAGE_SIZE);
+	int recordSize = prepareRoundTripRecord(recordDescriptor, index, 0, varcharLength, record);
+	RC rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+	assert(rc == success && "Inserting a record should not fail.");
+	expectRecord(rid, string((char *) record, recordSize), expected, deleted);
+	free(record);
+}
+
+// Updates the record at rid to the given version of the round-trip record of index
+void updateRoundTripRecord(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const vector<Attribute> &recordDescriptor, const RID &rid,
+		const int index, const int version, const int varcharLength,
+		map<pair<unsigned, unsigned>, string> &expected) {
+	void *record = malloc(PAGE_SIZE);
+	int recordSize = prepareRoundTripRecord(recordDescriptor, index, version, varcharLength, record);
+	RC rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rid);
+	assert(rc == success && "Updating a record should not fail.");
+	expected[make_pair(rid.pageNum, rid.slotNum)] = string((char *) record, recordSize);
+	free(record);
+}
+
+// Deletes the record at rid, and notes that it is gone
+void deleteRoundTripRecord(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const vector<Attribute> &recordDescriptor, const RID &rid,
+		map<pair<unsigned, unsigned>, string> &expected,
+		vector<RID> &deleted) {
+	RC rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rid);
+	assert(rc == success && "Deleting a record should not fail.");
+	expected.erase(make_pair(rid.pageNum, rid.slotNum));
+	deleted.push_back(rid);
+}
+
+// Inserts numberOfRecords round-trip records from firstIndex on, with VarChars of up to varcharLength characters,
+// and notes where they went.
+void insertRoundTripRecords(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const vector<Attribute> &recordDescriptor, const int firstIndex,
+		const int numberOfRecords, const int varcharLength,
+		map<pair<unsigned, unsigned>, string> &expected,
+		vector<RID> &deleted) {
+	for (int index = firstIndex; index < firstIndex + numberOfRecords; index++) {
+		RID rid;
+		insertRoundTripRecord(rbfm, fileHandle, recordDescriptor, index,
+				varcharLength * (1 + index % 4) / 4, rid, expected, deleted);
+	}
+}
+
+// Updates every fifth expected record to a new version, alternately grown to varcharLength characters, which may
+// move it, and shrunk to a tenth of that, then deletes every thirteenth. The deletes come last so that no record
+// moves into a slot they free.
+void updateRoundTripRecords(RecordBasedFileManager *rbfm, FileHandle &fileHandle,
+		const vector<Attribute> &recordDescriptor, const int version,
+		const int varcharLength,
+		map<pair<unsigned, unsigned>, string> &expected,
+		vector<RID> &deleted) {
+	map<pair<unsigned, unsigned>, string>::iterator it;
+	unsigned k = 0;
+	for (it = expected.begin(); it != expected.end(); it++, k++) {
+		if (k % 5 != 0) {
+			continue;
+		}
+		RID rid;
+		rid.pageNum = it->first.first;
+		rid.slotNum = it->first.second;
+		updateRoundTripRecord(rbfm, fileHandle, recordDescriptor, rid, k, version,
+				k % 10 == 0 ? varcharLength : varcharLength / 10, expected);
+	}
+
+	k = 0;
+	for (it = expected.begin(); it != expected.end(); k++) {
+		RID rid;
+		rid.pageNum = it->first.first;
+		rid.slotNum = it->first.second;
+		it++;
+		if (k % 13 == 0) {
+			deleteRoundTripRecord(rbfm, fileHandle, recordDescriptor, rid, expected, deleted);
+		}
+	}
+}
+
+// Creates a file of the given page size and record format, and opens it
+void createAndOpenFile(RecordBasedFileManager *rbfm, string fileName,
+		const unsigned pageSize, const RecordFormat format,
+		FileHandle &fileHandle) {
+	RC rc = rbfm->createFile(fileName, pageSize, format);
+	assert(rc == success && "Creating the file should not fail.");
+
+	rc = createFileShouldSucceed(fileName);
+	assert(rc == success && "Creating the file should not fail.");
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	assert(fileHandle.getRecordFormat() == (unsigned) format && "The file should keep its record format.");
+}
+
+// Closes the file and opens it again, which should find every record where it was
+void reopenFile(RecordBasedFileManager *rbfm, const string &fileName,
+		FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+		const map<pair<unsigned, unsigned>, string> &expected,
+		const vector<RID> &deleted) {
+	unsigned format = fileHandle.getRecordFormat();
+	RC rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success && "Opening the file should not fail.");
+	assert(fileHandle.getRecordFormat() == format && "The file should keep its record format.");
+	checkRoundTrip(rbfm, fileHandle, recordDescriptor, expected, deleted);
+}
+
+// Closes the file and destroys it
+void closeAndDestroyFile(RecordBasedFileManager *rbfm, string fileName,
+		FileHandle &fileHandle) {
+	RC rc = rbfm->closeFile(fileHandle);
+	assert(rc == success && "Closing the file should not fail.");
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+
+	rc = destroyFileShouldSucceed(fileName);
+	assert(rc == success && "Destroying the file should not fail.");
+}
@@ -217,13 +217,32 @@ RC RelationManager::insertInSystemColumn(const unsigned &tableId, const vector<A
 }
 
 RC RelationManager::createTable(const string &tableName, const vector<Attribute> &attrs)
+{
+    return createTable(tableName, attrs, PAGE_SIZE);
+}
+
+RC RelationManager::createTable(const string &tableName, const vector<Attribute> &attrs, const unsigned pageSize)
+{
+    // Tables of Int and Real columns only store their tuples fixed width.
+    return createTable(tableName, attrs, pageSize, RecordView::isFixedWidth(attrs) ? FixedWidthFormat : VariableWidthFormat);
+}
+
+RC RelationManager::createTable(const string &tableName, const vector<Attribute> &attrs, const unsigned pageSize, const RecordFormat format)
 {
     unsigned tableId;
     string tableFileName = tableName + ".tbl";
 
+    // The table file keeps the format, not the catalog. Tuples the format cannot hold are turned away now.
+    PaxLayout paxLayout;
+    if ((format == FixedWidthFormat && !RecordView::isFixedWidth(attrs)) ||
+        (format == PaxFormat && paxLayout.initialize(attrs, pageSize) != 0))
+    {
+        return -1;
+    }
+
     if (insertInSystemTable(tableName, tableFileName, tableId) == 0 && insertInSystemColumn(tableId, attrs) == 0)
     {
-        return rbfm->createFile(tableFileName);
+        return rbfm->createFile(tableFileName, pageSize, format);
     }
 
     return -1;
@@ -650,8 +669,8 @@ RC RelationManager::deleteTuple(const string &tableName, const RID &rid)
             FileHandle fileHandle;
             if (rbfm->openFile(tableFileName, fileHandle) == 0)
             {
-                void *data = malloc(PAGE_SIZE);
-                memset(data, 0, PAGE_SIZE);
+                void *data = malloc(fileHandle.getPageSize());
+                memset(data, 0, fileHandle.getPageSize());
                 if (rbfm->readRecord(fileHandle, recordDescriptor, rid, data) == 0)
                 {
                     if (rbfm->deleteRecord(fileHandle, recordDescriptor, rid) == 0)
@@ -794,7 +813,8 @@ RC RelationManager::scan(const string &tableName,
                          const CompOp compOp,
                          const void *value,
                          const vector<string> &attributeNames,
-                         RM_ScanIterator &rm_ScanIterator)
+                         RM_ScanIterator &rm_ScanIterator,
+                         const unsigned numberOfThreads)
 {
     unsigned tableId = 0;
     string tableFileName;
@@ -818,6 +838,18 @@ RC RelationManager::scan(const string &tableName,
                                value,
                                attributeNames,
                                rm_ScanIterator.rbfmsi);
+            if (rc == 0 && numberOfThreads > 1)
+            {
+                rm_ScanIterator.rbfmpsi = new RBFM_ParallelScanIterator();
+                rc = rbfm->parallelScan(rm_ScanIterator.rbfmsi.fileHandle,
+                                        recordDescriptor,
+                                        conditionAttribute,
+                                        compOp,
+                                        value,
+                                        attributeNames,
+                                        numberOfThreads,
+                                        *rm_ScanIterator.rbfmpsi);
+            }
             return rc;
         }
     }
@@ -827,14 +859,93 @@ RC RelationManager::scan(const string &tableName,
 
 RC RM_ScanIterator::getNextTuple(RID &rid, void *data)
 {
+    if (rbfmpsi != NULL)
+    {
+        return rbfmpsi->getNextRecord(rid, data);
+    }
     return rbfmsi.getNextRecord(rid, data);
 }
 
+RC RM_ScanIterator::getNextBatch(RecordBatch &batch)
+{
+    if (rbfmpsi != NULL)
+    {
+        return rbfmpsi->getNextBatch(batch);
+    }
+    return rbfmsi.getNextBatch(batch);
+}
+
 RC RM_ScanIterator::close()
 {
+    if (rbfmpsi != NULL)
+    {
+        rbfmpsi->close();
+        delete rbfmpsi;
+        rbfmpsi = NULL;
+    }
     return rbfmsi.close() == 0 && rbfmsi.rbfm->closeFile(rbfmsi.fileHandle) == 0;
 }
 
+unsigned RM_ScanIterator::getNumberOfSkippedPages()
+{
+    if (rbfmpsi != NULL)
+    {
+        return rbfmpsi->getNumberOfSkippedPages();
+    }
+    return rbfmsi.getNumberOfSkippedPages();
+}
+
+unsigned RM_ScanIterator::getPageSize()
+{
+    if (rbfmpsi != NULL)
+    {
+        return rbfmpsi->getPageSize();
+    }
+    return rbfmsi.getPageSize();
+}
+
+RecordFormat RM_ScanIterator::getRecordFormat()
+{
+    if (rbfmpsi != NULL)
+    {
+        return rbfmpsi->getRecordFormat();
+    }
+    return rbfmsi.getRecordFormat();
+}
+
+bool RM_ScanIterator::getCode(const unsigned attribute, unsigned &code, Dictionary *&dictionary, unsigned &field)
+{
+    return rbfmpsi == NULL && rbfmsi.getCode(attribute, code, dictionary, field);
+}
+
+RC RelationManager::vacuumTable(const string &tableName)
+{
+    unsigned tableId;
+    string tableFileName;
+    SystemFlag flag;
+    RID ridDummy;
+    if (getTableInfo(tableName, tableId, tableFileName, flag, ridDummy) != 0)
+    {
+        return -1;
+    }
+
+    // The zones of the pages records left are rebuilt from what the pages still hold.
+    vector<Attribute> recordDescriptor;
+    FileHandle fileHandle;
+    if (getAttributes(tableName, recordDescriptor) == 0 && rbfm->openFile(tableFileName, fileHandle) == 0)
+    {
+        RC rc = rbfm->vacuum(fileHandle);
+        if (rc == 0)
+        {
+            rc = rbfm->buildZoneMap(fileHandle, recordDescriptor);
+        }
+        rbfm->closeFile(fileHandle);
+        return rc;
+    }
+
+    return -1;
+}
+
 RC RelationManager::createIndex(const string &tableName, const string &attributeName)
 {
     unsigned tableId;
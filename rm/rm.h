@@ -43,15 +43,27 @@ using namespace std;
 class RM_ScanIterator
 {
 public:
-  RM_ScanIterator(){};
-  ~RM_ScanIterator(){};
+  RM_ScanIterator() : rbfmpsi(NULL){};
+  ~RM_ScanIterator() { delete rbfmpsi; }; // stops the workers of a scan that was not closed
 
   // "data" follows the same format as RelationManager::insertTuple()
   RC getNextTuple(RID &rid, void *data);
+  RC getNextBatch(RecordBatch &batch); // as many satisfying tuples as the batch holds, RM_EOF if there are none
   RC close();
+  unsigned getNumberOfSkippedPages();   // pages the table's zone map ruled out, see ZoneMap
+  unsigned getPageSize();               // of the table's file
+  RecordFormat getRecordFormat();       // of the table's file
+  // The code of a projected VarChar of a DictionaryFormat table in the tuple getNextTuple() returned last,
+  // false for any other attribute and on worker threads. See RBFM_ScanIterator::getCode().
+  bool getCode(const unsigned attribute, unsigned &code, Dictionary *&dictionary, unsigned &field);
+
+private:
+  RM_ScanIterator(const RM_ScanIterator &);
+  RM_ScanIterator &operator=(const RM_ScanIterator &);
 
 public:
   RBFM_ScanIterator rbfmsi;
+  RBFM_ParallelScanIterator *rbfmpsi; // NULL unless the scan runs on worker threads
 };
 
 // RM_IndexScanIterator is an iterator to go through index entries
@@ -80,6 +92,13 @@ public:
 
   RC createTable(const string &tableName, const vector<Attribute> &attrs);
 
+  // Same, with the table file's pages pageSize bytes (a power of two from PAGE_SIZE to MAX_PAGE_SIZE)
+  RC createTable(const string &tableName, const vector<Attribute> &attrs, const unsigned pageSize);
+
+  // Same, with the tuples stored in the given format, PaxFormat for analytic tables scanned a few columns at a time,
+  // DictionaryFormat for tables whose VarChars take few distinct values
+  RC createTable(const string &tableName, const vector<Attribute> &attrs, const unsigned pageSize, const RecordFormat format);
+
   RC deleteTable(const string &tableName);
 
   RC getAttributes(const string &tableName, vector<Attribute> &attrs);
@@ -100,12 +119,18 @@ public:
 
   // Scan returns an iterator to allow the caller to go through the results one by one.
   // Do not store entire results in the scan iterator.
+  // With more than one thread the table is scanned by that many workers, and the tuples come in no set order.
   RC scan(const string &tableName,
           const string &conditionAttribute,
           const CompOp compOp,                  // comparison type such as "<" and "="
           const void *value,                    // used in the comparison
           const vector<string> &attributeNames, // a list of projected attributes
-          RM_ScanIterator &rm_ScanIterator);
+          RM_ScanIterator &rm_ScanIterator,
+          const unsigned numberOfThreads = 1);
+
+  // Brings moved tuples home and gives back the space deleted ones held.
+  // Every RID stays valid, so the table's indexes are left as they are. The zone map is built again.
+  RC vacuumTable(const string &tableName);
   
   RC createIndex(const string &tableName, const string &attributeName);
 
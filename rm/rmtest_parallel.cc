@@ -0,0 +1,160 @@
+#include "rm_test_util.h"
+
+// Size of a tuple in the format scan() returns it
+int getTupleSize(const vector<Attribute> &attrs, const void *data)
+{
+    int nullAttributesIndicatorActualSize = getActualByteForNullsIndicator(attrs.size());
+    int offset = nullAttributesIndicatorActualSize;
+    for (unsigned i = 0; i < attrs.size(); i++)
+    {
+        if (((const unsigned char *)data)[i / 8] & (1 << (7 - i % 8)))
+        {
+            continue;
+        }
+        int length = sizeof(int);
+        if (attrs[i].type == TypeVarChar)
+        {
+            memcpy(&length, (const char *)data + offset, sizeof(int));
+            length += sizeof(int);
+        }
+        offset += length;
+    }
+    return offset;
+}
+
+// Every tuple a scan returns, with its RID
+void scanTable(const string &tableName, const vector<Attribute> &attrs, const string &conditionAttribute,
+               const CompOp compOp, const void *value, const vector<string> &attributeNames,
+               const unsigned numberOfThreads, multiset<pair<pair<unsigned, unsigned>, string> > &tuples)
+{
+    vector<Attribute> projectedAttrs;
+    for (unsigned i = 0; i < attrs.size(); i++)
+    {
+        if (find(attributeNames.begin(), attributeNames.end(), attrs[i].name) != attributeNames.end())
+        {
+            projectedAttrs.push_back(attrs[i]);
+        }
+    }
+
+    RM_ScanIterator rmsi;
+    RC rc = rm->scan(tableName, conditionAttribute, compOp, value, attributeNames, rmsi, numberOfThreads);
+    assert(rc == success && "RelationManager::scan() should not fail.");
+
+    RID rid;
+    void *returnedData = malloc(PAGE_SIZE);
+    tuples.clear();
+    while (rmsi.getNextTuple(rid, returnedData) != RM_EOF)
+    {
+        string tuple((char *)returnedData, getTupleSize(projectedAttrs, returnedData));
+        tuples.insert(make_pair(make_pair(rid.pageNum, rid.slotNum), tuple));
+    }
+    rmsi.close();
+    free(returnedData);
+}
+
+RC TEST_RM_PARALLEL(const string &tableName)
+{
+    // Functions Tested:
+    // 1. Scan on 1, 2 and 4 worker threads, with and without a condition and a projection,
+    //    of a table whose tuples were updated and moved
+    cout << endl
+         << "***** In RM Test Case Parallel *****" << endl;
+
+    vector<Attribute> attrs;
+    createRoundTripRecordDescriptor(attrs, 1000);
+    rm->deleteTable(tableName);
+    RC rc = rm->createTable(tableName, attrs);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+
+    // Tuples that grow out of their full page move and leave a forwarding address behind.
+    RID rid;
+    vector<RID> rids;
+    void *tuple = malloc(PAGE_SIZE);
+    int numTuples = 3000;
+    for (int i = 0; i < numTuples; i++)
+    {
+        prepareRoundTripRecord(attrs, i, 0, 100 + (i % 5) * 100, tuple);
+        rc = rm->insertTuple(tableName, tuple, rid);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+        rids.push_back(rid);
+    }
+    set<pair<unsigned, unsigned> > deleted;
+    for (int i = 0; i < numTuples; i++)
+    {
+        if (i % 17 == 0)
+        {
+            rc = rm->deleteTuple(tableName, rids[i]);
+            assert(rc == success && "RelationManager::deleteTuple() should not fail.");
+            deleted.insert(make_pair(rids[i].pageNum, rids[i].slotNum));
+        }
+        else if (i % 3 == 0)
+        {
+            prepareRoundTripRecord(attrs, i, 1, 900, tuple);
+            rc = rm->updateTuple(tableName, tuple, rids[i]);
+            assert(rc == success && "RelationManager::updateTuple() should not fail.");
+        }
+    }
+
+    vector<string> attributeNames;
+    for (unsigned i = 0; i < attrs.size(); i++)
+    {
+        attributeNames.push_back(attrs[i].name);
+    }
+    vector<string> projectedNames;
+    projectedNames.push_back(attrs[0].name);
+    projectedNames.push_back(attrs[2].name);
+    int idValue = numTuples * 31 / 2;
+
+    // The serial scan returns every tuple that is left, with the bytes of its last version.
+    multiset<pair<pair<unsigned, unsigned>, string> > serialTuples;
+    scanTable(tableName, attrs, "", NO_OP, NULL, attributeNames, 1, serialTuples);
+    for (int i = 0; i < numTuples; i++)
+    {
+        if (deleted.count(make_pair(rids[i].pageNum, rids[i].slotNum)) != 0)
+        {
+            continue;
+        }
+        int tupleSize = prepareRoundTripRecord(attrs, i, i % 3 == 0 ? 1 : 0, i % 3 == 0 ? 900 : 100 + (i % 5) * 100, tuple);
+        assert(serialTuples.count(make_pair(make_pair(rids[i].pageNum, rids[i].slotNum), string((char *)tuple, tupleSize))) == 1 &&
+               "A scan should return every tuple at its RID.");
+    }
+
+    // Workers return the same tuples at the same RIDs, in another order.
+    unsigned numberOfThreads[] = {1, 2, 4};
+    for (unsigned t = 0; t < 3; t++)
+    {
+        multiset<pair<pair<unsigned, unsigned>, string> > tuples;
+        scanTable(tableName, attrs, "", NO_OP, NULL, attributeNames, numberOfThreads[t], tuples);
+        if (tuples != serialTuples)
+        {
+            cout << "***** [FAIL] A scan on " << numberOfThreads[t] << " workers returned other tuples. RM Test Case Parallel failed. *****" << endl;
+            free(tuple);
+            return -1;
+        }
+
+        multiset<pair<pair<unsigned, unsigned>, string> > serialProjected;
+        scanTable(tableName, attrs, attrs[1].name, GT_OP, &idValue, projectedNames, 1, serialProjected);
+        scanTable(tableName, attrs, attrs[1].name, GT_OP, &idValue, projectedNames, numberOfThreads[t], tuples);
+        if (tuples != serialProjected || serialProjected.empty())
+        {
+            cout << "***** [FAIL] A conditional scan on " << numberOfThreads[t] << " workers returned other tuples. RM Test Case Parallel failed. *****" << endl;
+            free(tuple);
+            return -1;
+        }
+    }
+
+    rc = rm->deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    free(tuple);
+
+    cout << "***** RM Test Case Parallel Finished. The result will be examined. *****" << endl
+         << endl;
+
+    return success;
+}
+
+int main()
+{
+    RC rcmain = TEST_RM_PARALLEL("tbl_parallel");
+    return rcmain;
+}
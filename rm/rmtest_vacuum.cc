@@ -0,0 +1,174 @@
+#include "rm_test_util.h"
+
+// Pages of the table's file
+unsigned getNumberOfPages(const string &tableName)
+{
+    FileHandle fileHandle;
+    RC rc = rbfm->openFile(tableName + ".tbl", fileHandle);
+    assert(rc == success && "Opening the table's file should not fail.");
+    unsigned numberOfPages = fileHandle.getNumberOfPages();
+    rbfm->closeFile(fileHandle);
+    return numberOfPages;
+}
+
+// Where the Id of a round-trip tuple lies, after its nulls indicator and its Name unless that is null
+int getIdOffset(const void *tuple)
+{
+    int offset = 1;
+    if ((*(const unsigned char *)tuple & (1 << 7)) == 0)
+    {
+        offset += sizeof(int) + *(const int *)((const char *)tuple + offset);
+    }
+    return offset;
+}
+
+// A round-trip tuple whose Id, the indexed attribute, is the same in every version:
+// updateTuple() leaves the indexes as they are.
+int prepareVacuumTuple(const vector<Attribute> &attrs, const int index, const int version, const int varcharLength, void *buffer)
+{
+    int tupleSize = prepareRoundTripRecord(attrs, index, version, varcharLength, buffer);
+    unsigned char nullsIndicator = *(unsigned char *)buffer;
+    if ((nullsIndicator & (1 << 6)) == 0)
+    {
+        int id = index;
+        memcpy((char *)buffer + getIdOffset(buffer), &id, sizeof(int));
+    }
+    return tupleSize;
+}
+
+RC TEST_RM_VACUUM(const string &tableName)
+{
+    // Functions Tested:
+    // 1. Vacuum Table, of a table with an index whose tuples moved and were deleted
+    // 2. Read Tuple at the RIDs from before
+    // 3. Index Scan
+    cout << endl
+         << "***** In RM Test Case Vacuum *****" << endl;
+
+    vector<Attribute> attrs;
+    createRoundTripRecordDescriptor(attrs, 1000);
+    rm->deleteTable(tableName);
+    RC rc = rm->createTable(tableName, attrs);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+    rc = rm->createIndex(tableName, attrs[1].name);
+    assert(rc == success && "RelationManager::createIndex() should not fail.");
+
+    RID rid;
+    vector<RID> rids;
+    void *tuple = malloc(PAGE_SIZE);
+    void *returnedData = malloc(PAGE_SIZE);
+    int numTuples = 2000;
+    for (int i = 0; i < numTuples; i++)
+    {
+        prepareVacuumTuple(attrs, i, 0, 200, tuple);
+        rc = rm->insertTuple(tableName, tuple, rid);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+        rids.push_back(rid);
+    }
+
+    // Grown tuples move to pages at the end of the file, then half the tuples go away, leaving room at home.
+    map<pair<unsigned, unsigned>, string> expected;
+    for (int i = 0; i < numTuples; i++)
+    {
+        int tupleSize = 0;
+        if (i % 8 == 0)
+        {
+            tupleSize = prepareVacuumTuple(attrs, i, 1, 700, tuple);
+            rc = rm->updateTuple(tableName, tuple, rids[i]);
+            assert(rc == success && "RelationManager::updateTuple() should not fail.");
+        }
+        else
+        {
+            tupleSize = prepareVacuumTuple(attrs, i, 0, 200, tuple);
+        }
+        expected[make_pair(rids[i].pageNum, rids[i].slotNum)] = string((char *)tuple, tupleSize);
+    }
+    for (int i = 1; i < numTuples; i += 2)
+    {
+        rc = rm->deleteTuple(tableName, rids[i]);
+        assert(rc == success && "RelationManager::deleteTuple() should not fail.");
+        expected.erase(make_pair(rids[i].pageNum, rids[i].slotNum));
+    }
+
+    unsigned numberOfPages = getNumberOfPages(tableName);
+    rc = rm->vacuumTable(tableName);
+    assert(rc == success && "RelationManager::vacuumTable() should not fail.");
+    if (getNumberOfPages(tableName) >= numberOfPages)
+    {
+        cout << "***** [FAIL] Vacuum should give back pages: " << numberOfPages << " before, "
+             << getNumberOfPages(tableName) << " after. RM Test Case Vacuum failed. *****" << endl;
+        free(tuple);
+        free(returnedData);
+        return -1;
+    }
+
+    // Every RID from before still reads its latest tuple, and deleted ones stay gone.
+    for (int i = 0; i < numTuples; i++)
+    {
+        map<pair<unsigned, unsigned>, string>::iterator it = expected.find(make_pair(rids[i].pageNum, rids[i].slotNum));
+        rc = rm->readTuple(tableName, rids[i], returnedData);
+        if (it == expected.end())
+        {
+            assert(rc != success && "Reading a deleted tuple should fail.");
+            continue;
+        }
+        assert(rc == success && "RelationManager::readTuple() should not fail.");
+        if (memcmp(it->second.data(), returnedData, it->second.size()) != 0)
+        {
+            cout << "***** [FAIL] readTuple() after vacuum returned another tuple. RM Test Case Vacuum failed. *****" << endl;
+            free(tuple);
+            free(returnedData);
+            return -1;
+        }
+    }
+
+    // The index was left as it was and leads to the same tuples.
+    unsigned numberOfKeys = 0;
+    for (map<pair<unsigned, unsigned>, string>::iterator it = expected.begin(); it != expected.end(); it++)
+    {
+        numberOfKeys += (it->second[0] & (1 << 6)) == 0 ? 1 : 0;
+    }
+    RM_IndexScanIterator rmisi;
+    rc = rm->indexScan(tableName, attrs[1].name, NULL, NULL, true, true, rmisi);
+    assert(rc == success && "RelationManager::indexScan() should not fail.");
+    int key = 0;
+    unsigned numberOfEntries = 0;
+    while (rmisi.getNextEntry(rid, &key) != RM_EOF)
+    {
+        map<pair<unsigned, unsigned>, string>::iterator it = expected.find(make_pair(rid.pageNum, rid.slotNum));
+        assert(it != expected.end() && "The index should only lead to tuples that are left.");
+        rc = rm->readTuple(tableName, rid, returnedData);
+        assert(rc == success && "RelationManager::readTuple() should not fail.");
+        int id = 0;
+        memcpy(&id, (char *)returnedData + getIdOffset(returnedData), sizeof(int));
+        if (memcmp(it->second.data(), returnedData, it->second.size()) != 0 || id != key)
+        {
+            cout << "***** [FAIL] The index leads to another tuple after vacuum. RM Test Case Vacuum failed. *****" << endl;
+            rmisi.close();
+            free(tuple);
+            free(returnedData);
+            return -1;
+        }
+        numberOfEntries++;
+    }
+    rmisi.close();
+    assert(numberOfEntries == numberOfKeys && "The index should lead to every tuple with a key.");
+
+    rc = rm->destroyIndex(tableName, attrs[1].name);
+    assert(rc == success && "RelationManager::destroyIndex() should not fail.");
+    rc = rm->deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    free(tuple);
+    free(returnedData);
+
+    cout << "***** RM Test Case Vacuum Finished. The result will be examined. *****" << endl
+         << endl;
+
+    return success;
+}
+
+int main()
+{
+    RC rcmain = TEST_RM_VACUUM("tbl_vacuum");
+    return rcmain;
+}
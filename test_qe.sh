@@ -36,5 +36,7 @@ make
 ./qetest_p10
 ./qetest_p11
 ./qetest_p12
+./qetest_zonemap
+./qetest_dictionary
 
 make clean
@@ -30,5 +30,16 @@ make
 ./rbftest_p3
 ./rbftest_p4
 ./rbftest_p5
+./rbftest_fsm
+./rbftest_wal
+./rbftest_compression
+./rbftest_compaction
+./rbftest_bulkload
+./rbftest_fixedwidth
+./rbftest_pax
+./rbftest_dictionary
+./rbftest_format
+./rbftest_mmap
+./rbftest_counters
 
 make clean
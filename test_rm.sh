@@ -45,5 +45,7 @@ make
 ./rmtest_p7
 ./rmtest_p8
 ./rmtest_p9
+./rmtest_parallel
+./rmtest_vacuum
 
 make clean